@@ -41,12 +41,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "ddl0ddl.h"
 #include "dict0crea.h"
 #include "row0merge.h"
+#include "read0read.h"
 #include "pars0pars.h"
 #include "api0ucode.h"
 #include "lock0types.h"
 #include "row0sel.h"
 #include "lock0lock.h"
 #include "rem0cmp.h"
+#include "hash0hash.h"
 #include "ut0dbg.h" /* for UT_DBG_ENTER_FUNC */
 
 UNIV_STATIC const char* GEN_CLUST_INDEX = "GEN_CLUST_INDEX";
@@ -149,8 +151,66 @@ typedef struct ib_cursor_struct {
 	ib_match_mode_t	match_mode;	/* ib_cursor_moveto match mode */
 
 	row_prebuilt_t*	prebuilt;	/* For reading rows */
+
+	byte*		col_map;	/* NULL, or for each column of the
+					table nonzero if ib_cursor_read_row()
+					reads it, see ib_cursor_set_columns();
+					points to col_map_buf */
+
+	byte*		col_map_buf;	/* NULL, or the buffer for col_map
+					allocated from heap */
+
+	ibool		covering;	/* TRUE if the cursor is on a
+					secondary index that stores all
+					columns of col_map in full */
+
+	ibool		cluster_access;	/* TRUE if ib_cursor_set_cluster_access()
+					was called; the clustered index is
+					not accessed if covering is TRUE */
+
+	ibool		zero_copy;	/* TRUE if ib_cursor_read_row()
+					may point the tuple to the row
+					cache instead of copying the
+					record, see ib_cursor_set_zero_copy() */
+
+	ulint		dict_version;	/* dict_table_t::version of the
+					table when the prebuilt struct was
+					created */
+
+	hash_node_t	hash;		/* Hash chain node in
+					ib_cursor_cache.hash */
+
+	ulint		fold;		/* Fold of the table id when the
+					cursor was cached; the id changes
+					if the table is truncated */
+
+	UT_LIST_NODE_T(struct ib_cursor_struct)
+			lru;		/* List node in ib_cursor_cache.lru */
 } ib_cursor_t;
 
+/* Maximum number of closed cursors kept in ib_cursor_cache */
+#define IB_CURSOR_CACHE_SIZE	64
+
+/* Closed cursors that ib_create_cursor() can reuse for the same table.
+A cached cursor does not hold a handle on its table: it is reused only
+if the version of the table object that is being opened is the one that
+its prebuilt struct and query graphs were created for. No other table
+object has the same version, so this proves that the table is still in
+the cache and has the same indexes. */
+typedef struct ib_cursor_cache_struct {
+	os_fast_mutex_t	mutex;		/* Mutex protecting the fields
+					below */
+
+	hash_table_t*	hash;		/* Cursors hashed by table id, or
+					NULL if the cache is not in use */
+
+	UT_LIST_BASE_NODE_T(ib_cursor_t)
+			lru;		/* Cursors in the order they were
+					closed, most recent first */
+} ib_cursor_cache_t;
+
+UNIV_STATIC ib_cursor_cache_t	ib_cursor_cache;
+
 /* InnoDB table columns used during table and index schema creation. */
 typedef struct ib_col_struct {
 	const char*	name;		/* Name of column */
@@ -309,10 +369,24 @@ ib_open_table_by_id(
 	table_id = ut_dulint_create(0, (ulint) tid);
 
 	if (!locked) {
-		dict_mutex_enter();
+		/* Try to find a cached table without dict_sys->mutex. */
+		table = dict_table_get_on_id_nolock(table_id, TRUE);
+	} else {
+		table = NULL;
 	}
 
-	table = dict_table_get_using_id(srv_force_recovery, table_id, TRUE);
+	if (table == NULL) {
+		if (!locked) {
+			dict_mutex_enter();
+		}
+
+		table = dict_table_get_using_id(
+			srv_force_recovery, table_id, TRUE);
+
+		if (!locked) {
+			dict_mutex_exit();
+		}
+	}
 
 	if (table != NULL && table->ibd_file_missing) {
 
@@ -320,15 +394,11 @@ ib_open_table_by_id(
 			"The .ibd file for table %s is missing.\n",
 			table->name);
 
-		dict_table_decrement_handle_count(table, TRUE);
+		dict_table_decrement_handle_count(table, locked);
 
 		table = NULL;
 	}
 
-	if (!locked) {
-		dict_mutex_exit();
-	}
-
 	return(table);
 }
 
@@ -486,20 +556,27 @@ UNIV_INLINE
 void
 ib_read_tuple(
 /*==========*/
-	ib_cursor_t*	cursor,		/*!< in: InnoDB cursor instance */
+	const byte*	col_map,	/*!< in: NULL, or nonzero for each
+					table column to read; the other
+					columns are read as SQL NULL */
+	const dict_index_t* index,	/*!< in: index of rec; a row tuple
+					can also be read from a secondary
+					index record, the columns that it
+					does not store are then SQL NULL */
 	const rec_t*	rec,		/*!< in: Record to read */
 	ib_bool_t	page_format,	/*!< in: IB_TRUE if compressed format */
+	ib_bool_t	zero_copy,	/*!< in: IB_TRUE if rec stays valid
+					until the cursor is moved and the
+					tuple can point to it */
 	ib_tuple_t*	tuple)		/*!< in: tuple to read into */
 {
 	ulint		i;
-	void*		ptr;
-	rec_t*		copy;
+	const rec_t*	copy;
 	ulint		rec_meta_data;
 	ulint		n_index_fields;
 	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
 	ulint*		offsets	= offsets_;
 	dtuple_t*	dtuple = tuple->ptr;
-	const dict_index_t* index = tuple->index;
 
 	UT_DBG_ENTER_FUNC;
 
@@ -511,35 +588,53 @@ ib_read_tuple(
 	rec_meta_data = rec_get_info_bits(rec, page_format);
 	dtuple_set_info_bits(dtuple, rec_meta_data);
 
-	/* Make a copy of the rec. */
-	ptr = mem_heap_alloc(tuple->heap, rec_offs_size(offsets));
-	copy = rec_copy(ptr, rec, offsets);
+	if (zero_copy || col_map != NULL) {
+		/* Either the tuple points to rec or the columns that
+		are read are copied one by one below. */
+		copy = rec;
+	} else {
+		void*	ptr;
+
+		/* Make a copy of the rec. */
+		ptr = mem_heap_alloc(tuple->heap, rec_offs_size(offsets));
+		copy = rec_copy(ptr, rec, offsets);
 
-	/* Avoid a debug assertion in rec_offs_validate(). */
-	rec_offs_make_valid(rec, index, (ulint*) offsets);
+		/* Avoid a debug assertion in rec_offs_validate(). */
+		rec_offs_make_valid(rec, index, (ulint*) offsets);
+	}
 
 	n_index_fields = ut_min(
 		rec_offs_n_fields(offsets), dtuple_get_n_fields(dtuple));
 
+	if (tuple->type == TPL_ROW && !dict_index_is_clust(index)) {
+		/* A covering read fills only the columns that the
+		secondary index stores; the tuple may still hold the
+		values of the previous row in the others. */
+		for (i = 0; i < dtuple_get_n_fields(dtuple); ++i) {
+			dfield_set_null(dtuple_get_nth_field(dtuple, i));
+		}
+	}
+
 	for (i = 0; i < n_index_fields; ++i) {
 		ulint		len;
 		const byte*	data;
 		dfield_t*	dfield;
+		ulint		col_no;
 
-		if (tuple->type == TPL_ROW) {
-			const dict_col_t*	col;
-			ulint			col_no;
-			const dict_field_t*	index_field;
-
-			index_field = dict_index_get_nth_field(index, i);
-			col = dict_field_get_col(index_field);
-			col_no = dict_col_get_no(col);
+		col_no = dict_col_get_no(
+			dict_field_get_col(dict_index_get_nth_field(index, i)));
 
+		if (tuple->type == TPL_ROW) {
 			dfield = dtuple_get_nth_field(dtuple, col_no);
 		} else {
 			dfield = dtuple_get_nth_field(dtuple, i);
 		}
 
+		if (col_map != NULL && !col_map[col_no]) {
+			dfield_set_null(dfield);
+			continue;
+		}
+
 		data = rec_get_nth_field(copy, offsets, i, &len);
 
 		/* Fetch and copy any externally stored column. */
@@ -554,6 +649,11 @@ ib_read_tuple(
 				tuple->heap);
 
 			ut_a(len != UNIV_SQL_NULL);
+
+		} else if (col_map != NULL && !zero_copy
+			   && len != UNIV_SQL_NULL) {
+
+			data = mem_heap_dup(tuple->heap, data, len);
 		}
 
 		dfield_set_data(dfield, data, len);
@@ -717,6 +817,203 @@ ib_api_version(void)
 	       | IB_API_VERSION_AGE);
 }
 
+/********************************************************************//**
+Free a context struct for a table handle. */
+UNIV_STATIC
+void
+ib_qry_proc_free(
+/*=============*/
+	ib_qry_proc_t*	q_proc)		/*!< in, own: qproc struct */
+{
+	UT_DBG_ENTER_FUNC;
+
+	que_graph_free_recursive(q_proc->grph.ins);
+	que_graph_free_recursive(q_proc->grph.upd);
+	que_graph_free_recursive(q_proc->grph.sel);
+
+	memset(q_proc, 0x0, sizeof(*q_proc));
+}
+
+/*****************************************************************//**
+Free a cursor instance. */
+UNIV_STATIC
+void
+ib_cursor_free(
+/*===========*/
+	ib_cursor_t*	cursor,		/*!< in, own: cursor */
+	ibool		dict_locked)	/*!< in: TRUE if dict was locked */
+{
+	ib_qry_proc_free(&cursor->q_proc);
+
+	row_prebuilt_free(cursor->prebuilt, dict_locked);
+
+	mem_heap_free(cursor->query_heap);
+	mem_heap_free(cursor->heap);
+}
+
+/*****************************************************************//**
+Initialize the cache of closed cursors. */
+UNIV_STATIC
+void
+ib_cursor_cache_init(void)
+/*======================*/
+{
+	ut_a(ib_cursor_cache.hash == NULL);
+
+	os_fast_mutex_init(&ib_cursor_cache.mutex);
+
+	UT_LIST_INIT(ib_cursor_cache.lru);
+
+	ib_cursor_cache.hash = hash_create(2 * IB_CURSOR_CACHE_SIZE);
+}
+
+/*****************************************************************//**
+Free the cursors in the cache of closed cursors and the cache itself. */
+UNIV_STATIC
+void
+ib_cursor_cache_close(void)
+/*=======================*/
+{
+	ib_cursor_t*	cursor;
+
+	if (ib_cursor_cache.hash == NULL) {
+
+		return;
+	}
+
+	while ((cursor = UT_LIST_GET_FIRST(ib_cursor_cache.lru)) != NULL) {
+
+		UT_LIST_REMOVE(lru, ib_cursor_cache.lru, cursor);
+
+		/* The cached cursor holds no handle on the table. */
+		cursor->prebuilt->table = NULL;
+		ib_cursor_free(cursor, FALSE);
+	}
+
+	hash_table_free(ib_cursor_cache.hash);
+	ib_cursor_cache.hash = NULL;
+
+	os_fast_mutex_free(&ib_cursor_cache.mutex);
+}
+
+/*****************************************************************//**
+Remove a closed cursor of a table from the cursor cache.
+@return	cursor, or NULL if none could be reused */
+UNIV_STATIC
+ib_cursor_t*
+ib_cursor_cache_get(
+/*================*/
+	dict_table_t*	table)		/*!< in: table, opened by the caller */
+{
+	ib_cursor_t*	cursor;
+	ib_cursor_t*	stale = NULL;
+	ulint		fold;
+
+	if (ib_cursor_cache.hash == NULL) {
+
+		return(NULL);
+	}
+
+	fold = ut_fold_dulint(table->id);
+
+	os_fast_mutex_lock(&ib_cursor_cache.mutex);
+
+	HASH_SEARCH(hash, ib_cursor_cache.hash, fold, ib_cursor_t*, cursor,
+		    ut_ad(cursor->prebuilt->trx == NULL),
+		    cursor->fold == fold && cursor->prebuilt->table == table);
+
+	if (cursor != NULL) {
+		HASH_DELETE(ib_cursor_t, hash, ib_cursor_cache.hash,
+			    fold, cursor);
+		UT_LIST_REMOVE(lru, ib_cursor_cache.lru, cursor);
+
+		/* The table may have been freed and the memory reused
+		for this table, or its indexes may have changed. */
+		if (cursor->dict_version != table->version) {
+			stale = cursor;
+			cursor = NULL;
+		}
+	}
+
+	if (cursor != NULL) {
+		srv_n_cursor_cache_hits++;
+	} else {
+		srv_n_cursor_cache_misses++;
+	}
+
+	os_fast_mutex_unlock(&ib_cursor_cache.mutex);
+
+	if (stale != NULL) {
+		stale->prebuilt->table = NULL;
+		ib_cursor_free(stale, FALSE);
+	}
+
+	return(cursor);
+}
+
+/*****************************************************************//**
+Add a closed cursor to the cursor cache, releasing its table handle.
+@return	TRUE if the cursor was cached, FALSE if it must be freed */
+UNIV_STATIC
+ibool
+ib_cursor_cache_put(
+/*================*/
+	ib_cursor_t*	cursor,		/*!< in, own: cursor */
+	ibool		dict_locked)	/*!< in: TRUE if dict was locked */
+{
+	ib_cursor_t*	evicted = NULL;
+	row_prebuilt_t*	prebuilt = cursor->prebuilt;
+	dict_table_t*	table = prebuilt->table;
+	ib_qry_grph_t*	grph = &cursor->q_proc.grph;
+
+	if (ib_cursor_cache.hash == NULL
+	    || cursor->dict_version != table->version) {
+
+		return(FALSE);
+	}
+
+	row_prebuilt_reset(prebuilt);
+
+	if (grph->ins != NULL) {
+		grph->ins->trx = NULL;
+	}
+
+	if (grph->upd != NULL) {
+		grph->upd->trx = NULL;
+	}
+
+	/* Keep prebuilt->table for matching in ib_cursor_cache_get(). */
+	dict_table_decrement_handle_count(table, dict_locked);
+
+	os_fast_mutex_lock(&ib_cursor_cache.mutex);
+
+	cursor->fold = ut_fold_dulint(table->id);
+
+	HASH_INSERT(ib_cursor_t, hash, ib_cursor_cache.hash,
+		    cursor->fold, cursor);
+	UT_LIST_ADD_FIRST(lru, ib_cursor_cache.lru, cursor);
+
+	if (UT_LIST_GET_LEN(ib_cursor_cache.lru) > IB_CURSOR_CACHE_SIZE) {
+
+		evicted = UT_LIST_GET_LAST(ib_cursor_cache.lru);
+
+		UT_LIST_REMOVE(lru, ib_cursor_cache.lru, evicted);
+		HASH_DELETE(ib_cursor_t, hash, ib_cursor_cache.hash,
+			    evicted->fold, evicted);
+
+		srv_n_cursor_cache_evictions++;
+	}
+
+	os_fast_mutex_unlock(&ib_cursor_cache.mutex);
+
+	if (evicted != NULL) {
+		evicted->prebuilt->table = NULL;
+		ib_cursor_free(evicted, FALSE);
+	}
+
+	return(TRUE);
+}
+
 /*****************************************************************//**
 Initialize the InnoDB engine. This must be called prior to calling
 any other InnoDB API function.
@@ -781,6 +1078,10 @@ ib_startup(
 		err = innobase_start_or_create();
 	}
 
+	if (err == DB_SUCCESS) {
+		ib_cursor_cache_init();
+	}
+
 	return(err);
 }
 
@@ -795,6 +1096,10 @@ ib_shutdown(
 {
 	ib_err_t	err;
 
+	/* The cached query graphs point to the data dictionary. */
+	ib_sql_cache_close();
+	ib_cursor_cache_close();
+
 	err = ib_cfg_shutdown();
 	if (err != DB_SUCCESS) {
 		ib_logger(ib_stream, "ib_cfg_shutdown(): %s; "
@@ -869,6 +1174,30 @@ ib_trx_begin(
 	return((ib_trx_t) trx);
 }
 
+/*****************************************************************//**
+Begin a read-only transaction. This will allocate a new transaction
+handle that is never assigned a transaction id or a rollback segment.
+@return	innobase txn handle */
+
+ib_trx_t
+ib_trx_begin_read_only(
+/*===================*/
+	ib_trx_level_t	ib_trx_level)	/*!< in: trx isolation level */
+{
+	trx_t*		trx;
+	ib_err_t	err;
+
+	UT_DBG_ENTER_FUNC;
+
+	trx = trx_allocate_for_client(NULL);
+	trx->read_only = TRUE;
+
+	err = ib_trx_start((ib_trx_t) trx, ib_trx_level);
+	ut_a(err == DB_SUCCESS);
+
+	return((ib_trx_t) trx);
+}
+
 /*****************************************************************//**
 Get the transaction's state.
 @return	transaction state */
@@ -1929,6 +2258,132 @@ ib_copy_index_definition(
 	return(index_def);
 }
 
+/*****************************************************************//**
+Blocks the modifications of a table by S-locking it in a transaction of
+its own, after waiting for the transactions that hold locks on the table
+for modifying it.
+@return	the locking transaction, or NULL if the lock was not granted */
+UNIV_STATIC
+trx_t*
+ib_table_block_writers(
+/*===================*/
+	dict_table_t*	table,		/*!< in: table */
+	ib_err_t*	err)		/*!< out: DB_SUCCESS or err code */
+{
+	trx_t*		lock_trx;
+	ib_bool_t	started;
+
+	lock_trx = trx_allocate_for_client(NULL);
+	started = trx_start(lock_trx, ULINT_UNDEFINED);
+	ut_a(started);
+
+	*err = ib_trx_lock_table_with_retry(lock_trx, table, LOCK_S);
+
+	if (*err != DB_SUCCESS) {
+		trx_general_rollback(lock_trx, FALSE, NULL);
+		trx_free_for_client(lock_trx);
+		lock_trx = NULL;
+	}
+
+	return(lock_trx);
+}
+
+/*****************************************************************//**
+Lets the writers of a table that were blocked by ib_table_block_writers()
+go on. */
+UNIV_STATIC
+void
+ib_table_unblock_writers(
+/*=====================*/
+	trx_t*		lock_trx)	/*!< in/out: the locking transaction */
+{
+	trx_commit(lock_trx);
+	trx_free_for_client(lock_trx);
+}
+
+/*****************************************************************//**
+Builds a secondary index that was created while the writers of its table
+were blocked, letting them go on while the table is scanned and sorted.
+Their changes are logged and applied to the index, and the writers are
+blocked again before the last changes are applied.
+@return	DB_SUCCESS or err code */
+UNIV_STATIC
+ib_err_t
+ib_build_secondary_index_online(
+/*============================*/
+	trx_t*		usr_trx,	/*!< in: transaction */
+	dict_table_t*	table,		/*!< in: parent table of index */
+	dict_index_t*	index,		/*!< in/out: index to build */
+	trx_t**		lock_trx)	/*!< in/out: the transaction that
+					blocks the writers of the table */
+{
+	ib_err_t	err;
+	ib_err_t	lock_err;
+	read_view_t*	view;
+	mem_heap_t*	heap;
+
+	/* From now on, the changes to the index are logged. Read the
+	rows as of now, so that the table scan misses no row that the
+	log does not cover. */
+
+	row_merge_log_create(index);
+
+	heap = mem_heap_create(256);
+
+	mutex_enter(&kernel_mutex);
+	view = read_view_open_now(usr_trx->id, heap);
+	mutex_exit(&kernel_mutex);
+
+	ib_table_unblock_writers(*lock_trx);
+	*lock_trx = NULL;
+
+	err = row_merge_build_indexes(usr_trx, table, table, &index, 1,
+				      NULL, view);
+
+	mutex_enter(&kernel_mutex);
+	read_view_close(view);
+	mutex_exit(&kernel_mutex);
+
+	mem_heap_free(heap);
+
+	if (err == DB_SUCCESS) {
+		/* Apply the bulk of the log while the table can
+		still be modified. */
+		err = row_merge_log_apply(usr_trx, index);
+	}
+
+	/* The index can only be completed or dropped while the table
+	is not being modified: keep trying until the writers are blocked.
+	The caller unblocks them after renaming or dropping the index. */
+
+	while ((*lock_trx = ib_table_block_writers(table, &lock_err))
+	       == NULL) {
+
+		ut_print_timestamp(ib_stream);
+		ib_logger(ib_stream,
+			  "  InnoDB: Error %lu while waiting for the"
+			  " transactions modifying table ", (ulong) lock_err);
+		ut_print_name(ib_stream, usr_trx, TRUE, table->name);
+		ib_logger(ib_stream, " to complete, retrying.\n");
+	}
+
+	/* The log removes the entries of deleted rows from the index, so
+	that a read view that was opened before now may miss versions of
+	rows that it should see. Let only the read views that see the
+	blocking transaction as committed use the index. */
+
+	index->trx_id = (ib_uint64_t)
+		ut_conv_dulint_to_longlong((*lock_trx)->id);
+
+	if (err == DB_SUCCESS) {
+		err = row_merge_log_apply(usr_trx, index);
+	}
+
+	row_merge_log_free(index, err != DB_SUCCESS);
+
+	return(err);
+}
+
 /*****************************************************************//**
 (Re)Create a secondary index.
 @return	DB_SUCCESS or err code */
@@ -1940,6 +2395,10 @@ ib_build_secondary_index(
 	dict_table_t*	table,		/*!< in: parent table of index */
 	ib_index_def_t*	ib_index_def,	/*!< in: index definition */
 	ib_bool_t	create,		/*!< in: TRUE if part of table create */
+	trx_t**		lock_trx,	/*!< in/out: the transaction that
+					blocks the writers of the table if
+					the index is to be built online,
+					or NULL */
 	dict_index_t**	index)		/*!< out: index created */
 {
 	ib_err_t	err;
@@ -2005,9 +2464,15 @@ ib_build_secondary_index(
 
 		(*index)->cmp_ctx = NULL;
 
-	       /* Read the clustered index records and build the index. */
-		err = row_merge_build_indexes(
-			usr_trx, table, table, index, 1, NULL);
+		if (lock_trx != NULL) {
+			err = ib_build_secondary_index_online(
+				usr_trx, table, *index, lock_trx);
+		} else {
+			/* Read the clustered index records and build
+			the index. */
+			err = row_merge_build_indexes(
+				usr_trx, table, table, index, 1, NULL, NULL);
+		}
 	}
 
 	return(err);
@@ -2284,7 +2749,7 @@ ib_table_copy(
 
 	/* Build the actual indexes. */
 	err = row_merge_build_indexes(
-		trx, src_table, dst_table, indexes, n_indexes, NULL);
+		trx, src_table, dst_table, indexes, n_indexes, NULL, NULL);
 
 	return(err);
 }
@@ -2379,7 +2844,8 @@ ib_create_indexes(
 			/* Since this is part of CREATE TABLE, set the
 			create flag to IB_TRUE. */
 			err = ib_build_secondary_index(
-				ddl_trx, table, ib_index_def, IB_TRUE, &index);
+				ddl_trx, table, ib_index_def, IB_TRUE,
+				NULL, &index);
 		} else {
 			/* There can be at most one cluster definition. */
 			ut_a(ib_clust_index_def == ib_index_def);
@@ -2690,6 +3156,7 @@ ib_create_secondary_index(
 	ib_err_t	err;
 	dict_index_t*	index = NULL;
 	trx_t*		ddl_trx = NULL;
+	trx_t*		lock_trx = NULL;
 	ib_index_def_t*	ib_index_def = (ib_index_def_t*) ib_idx_sch;
 	trx_t*		usr_trx = ib_index_def->usr_trx;
 	dict_table_t*	table = ib_index_def->table;
@@ -2701,17 +3168,43 @@ ib_create_secondary_index(
 	ut_a(ib_index_def->schema == NULL);
 	ut_a(!ib_index_def->clustered);
 
-	err = ib_trx_lock_table_with_retry(usr_trx, table, LOCK_S);
+	if (lock_trx_has_table_lock(usr_trx, table, LOCK_IX)) {
+		/* We have modified the table: block the other writers
+		until we commit. */
+		err = ib_trx_lock_table_with_retry(usr_trx, table, LOCK_S);
+	} else {
+		/* Build the index online: the writers are blocked only
+		while the index is being created, completed and renamed. */
+		err = ib_trx_lock_table_with_retry(usr_trx, table, LOCK_IS);
+
+		if (err == DB_SUCCESS) {
+			ib_err_t	lock_err;
+
+			/* A writer that is rolling back latches the data
+			dictionary: release it while waiting for the
+			writers, or we could wait for each other until the
+			lock wait times out. The IS lock keeps the table
+			from being dropped meanwhile. */
+			ib_schema_unlock((ib_trx_t) usr_trx);
+
+			lock_trx = ib_table_block_writers(table, &err);
+
+			lock_err = ib_schema_lock_exclusive((ib_trx_t) usr_trx);
+			ut_a(lock_err == DB_SUCCESS);
+		}
+	}
 
 	if (err == DB_SUCCESS) {
+		ib_err_t	lock_err;
 
 		/* Since this is part of ALTER TABLE set the create flag
 		to IB_FALSE. */
 		err = ib_build_secondary_index(
-			usr_trx, table, ib_index_def, IB_FALSE, &index);
+			usr_trx, table, ib_index_def, IB_FALSE,
+			lock_trx != NULL ? &lock_trx : NULL, &index);
 
-		err = ib_schema_lock_exclusive((ib_trx_t) usr_trx);
-		ut_a(err == DB_SUCCESS);
+		lock_err = ib_schema_lock_exclusive((ib_trx_t) usr_trx);
+		ut_a(lock_err == DB_SUCCESS);
 
 		if (index != NULL && err != DB_SUCCESS) {
 			row_merge_drop_indexes(usr_trx, table, &index, 1);
@@ -2757,6 +3250,10 @@ ib_create_secondary_index(
 		trx_free_for_client(ddl_trx);
 	}
 
+	if (lock_trx != NULL) {
+		ib_table_unblock_writers(lock_trx);
+	}
+
 	return(err);
 }
 
@@ -2859,7 +3356,8 @@ ib_index_drop(
 }
 
 /*****************************************************************//**
-Create an internal cursor instance.
+Create an internal cursor instance, reusing a closed cursor of the
+table if one is cached.
 @return	DB_SUCCESS or err code */
 UNIV_STATIC
 ib_err_t
@@ -2872,17 +3370,31 @@ ib_create_cursor(
 {
 	mem_heap_t*	heap;
 	ib_cursor_t*	cursor;
-	ib_err_t	err = DB_SUCCESS;
+	row_prebuilt_t*	prebuilt;
 	dulint		id = ut_dulint_create(0, (ulint) index_id);
 
 	UT_DBG_ENTER_FUNC;
 
-	heap = mem_heap_create(sizeof(*cursor) * 2);
+	/* A cached cursor takes over the table handle of the caller. */
+	cursor = ib_cursor_cache_get(table);
 
-	if (heap != NULL) {
-		row_prebuilt_t*	prebuilt;
+	if (cursor != NULL) {
+		cursor->match_mode = IB_CLOSEST_MATCH;
+		cursor->zero_copy = FALSE;
+		cursor->col_map = NULL;
+		cursor->covering = FALSE;
+		cursor->cluster_access = FALSE;
 
-		cursor = mem_heap_zalloc(heap, sizeof(*cursor));
+		row_prebuilt_clear_preds(cursor->prebuilt);
+	} else {
+		heap = mem_heap_create(sizeof(*cursor) * 2);
+
+		if (heap == NULL) {
+
+			return(DB_OUT_OF_MEMORY);
+		}
+
+		cursor = mem_heap_zalloc(heap, sizeof(*cursor));
 
 		cursor->heap = heap;
 
@@ -2894,41 +3406,47 @@ ib_create_cursor(
 			return(DB_OUT_OF_MEMORY);
 		}
 
+		cursor->dict_version = table->version;
+
 		cursor->prebuilt = row_prebuilt_create(table);
+	}
 
-		prebuilt = cursor->prebuilt;
+	prebuilt = cursor->prebuilt;
 
-		prebuilt->trx = trx;
-		prebuilt->table = table;
-		prebuilt->select_lock_type = LOCK_NONE;
+	prebuilt->trx = trx;
+	prebuilt->table = table;
+	prebuilt->select_lock_type = LOCK_NONE;
 
-		if (index_id > 0) {
-			prebuilt->index = dict_index_get_on_id_low(table, id);
-		} else {
-			prebuilt->index = dict_table_get_first_index(table);
-		}
+	if (prebuilt->sel_graph != NULL) {
+		/* The graph of a cached cursor was built by an earlier
+		transaction. */
+		prebuilt->sel_graph->trx = trx;
+	}
 
-		ut_a(prebuilt->index != NULL);
+	if (index_id > 0) {
+		prebuilt->index = dict_index_get_on_id_low(table, id);
+	} else {
+		prebuilt->index = dict_table_get_first_index(table);
+	}
 
-		if (prebuilt->trx != NULL) {
-			++prebuilt->trx->n_client_tables_in_use;
+	ut_a(prebuilt->index != NULL);
 
-			 prebuilt->index_usable =
-				row_merge_is_index_usable(
-					prebuilt->trx, prebuilt->index);
+	if (prebuilt->trx != NULL) {
+		++prebuilt->trx->n_client_tables_in_use;
 
-			/* Assign a read view if the transaction does
-			not have it yet */
+		 prebuilt->index_usable =
+			row_merge_is_index_usable(
+				prebuilt->trx, prebuilt->index);
 
-			trx_assign_read_view(prebuilt->trx);
-		}
+		/* Assign a read view if the transaction does
+		not have it yet */
 
-		*ib_crsr = (ib_crsr_t) cursor;
-	} else {
-		err = DB_OUT_OF_MEMORY;
+		trx_assign_read_view(prebuilt->trx);
 	}
 
-	return(err);
+	*ib_crsr = (ib_crsr_t) cursor;
+
+	return(DB_SUCCESS);
 }
 
 /*****************************************************************//**
@@ -3064,9 +3582,14 @@ ib_cursor_open_index_using_name(
 	if (index_id > 0) {
 		err = ib_create_cursor(
 			ib_crsr, table, index_id, cursor->prebuilt->trx);
+	} else {
+		/* Release the handle that the search above acquired. */
+		dict_table_decrement_handle_count(
+			table, trx != NULL
+			&& ib_schema_lock_is_exclusive((ib_trx_t) trx));
 	}
 
-	if (ib_crsr != NULL) {
+	if (*ib_crsr != NULL) {
 		const ib_cursor_t*	cursor;
 
 		cursor = *(ib_cursor_t**) ib_crsr;
@@ -3136,23 +3659,6 @@ ib_cursor_open_table(
 	return(err);
 }
 
-/********************************************************************//**
-Free a context struct for a table handle. */
-UNIV_STATIC
-void
-ib_qry_proc_free(
-/*=============*/
-	ib_qry_proc_t*	q_proc)		/*!< in, own: qproc struct */
-{
-	UT_DBG_ENTER_FUNC;
-
-	que_graph_free_recursive(q_proc->grph.ins);
-	que_graph_free_recursive(q_proc->grph.upd);
-	que_graph_free_recursive(q_proc->grph.sel);
-
-	memset(q_proc, 0x0, sizeof(*q_proc));
-}
-
 /*****************************************************************//**
 Reset the cursor.
 @return	DB_SUCCESS or err code */
@@ -3173,14 +3679,12 @@ ib_cursor_reset(
 		--prebuilt->trx->n_client_tables_in_use;
 	}
 
-	/* The fields in this data structure are allocated from
-	the query heap and so need to be reset too. */
-	ib_qry_proc_free(&cursor->q_proc);
-
-	mem_heap_empty(cursor->query_heap);
-
+	/* The query graphs are kept for the next transaction, see
+	ib_insert_query_graph_create() and ib_update_vector_create(). */
 	row_prebuilt_reset(prebuilt);
 
+	cursor->cluster_access = FALSE;
+
 	return(DB_SUCCESS);
 }
 
@@ -3196,24 +3700,20 @@ ib_cursor_close(
 	ib_cursor_t*	cursor = (ib_cursor_t*) ib_crsr;
 	row_prebuilt_t*	prebuilt = cursor->prebuilt;
 	trx_t*		trx = prebuilt->trx;
+	ibool		dict_locked;
 
 	UT_DBG_ENTER_FUNC;
 
-	ib_qry_proc_free(&cursor->q_proc);
-
 	/* The transaction could have been detached from the cursor. */
 	if (trx != NULL && trx->n_client_tables_in_use > 0) {
 		--trx->n_client_tables_in_use;
 	}
 
-	if (trx && ib_schema_lock_is_exclusive((ib_trx_t) trx)) {
-		row_prebuilt_free(cursor->prebuilt, TRUE);
-	} else {
-		row_prebuilt_free(cursor->prebuilt, FALSE);
-	}
+	dict_locked = trx && ib_schema_lock_is_exclusive((ib_trx_t) trx);
 
-	mem_heap_free(cursor->query_heap);
-	mem_heap_free(cursor->heap);
+	if (!ib_cursor_cache_put(cursor, dict_locked)) {
+		ib_cursor_free(cursor, dict_locked);
+	}
 
 	return(DB_SUCCESS);
 }
@@ -3276,11 +3776,16 @@ ib_execute_insert_query_graph(
 
 	UT_DBG_ENTER_FUNC;
 
+	trx = ins_graph->trx;
+
+	if (UNIV_UNLIKELY(trx->read_only)) {
+
+		return(DB_READONLY);
+	}
+
 	/* This is a short term solution to fix the purge lag. */
 	ib_delay_dml_if_needed();
 
-	trx = ins_graph->trx;
-
 	savept = trx_savept_take(trx);
 
 	thr = que_fork_get_first_thr(ins_graph);
@@ -3342,6 +3847,10 @@ ib_insert_query_graph_create(
 			pars_complete_graph_for_exec(node->ins, trx, heap));
 
 		grph->ins->state = QUE_FORK_ACTIVE;
+	} else {
+		/* The graph may have been created by an earlier
+		transaction of the cursor. */
+		q_proc->grph.ins->trx = trx;
 	}
 }
 
@@ -3446,12 +3955,16 @@ ib_update_vector_create(
 
 	if (node->upd == NULL) {
 		node->upd = row_create_update_node(table, heap);
-	}
 
-	grph->upd = que_node_get_parent(
-		pars_complete_graph_for_exec(node->upd, trx, heap));
+		grph->upd = que_node_get_parent(
+			pars_complete_graph_for_exec(node->upd, trx, heap));
 
-	grph->upd->state = QUE_FORK_ACTIVE;
+		grph->upd->state = QUE_FORK_ACTIVE;
+	} else {
+		/* The graph may have been created by an earlier
+		transaction of the cursor. */
+		grph->upd->trx = trx;
+	}
 
 	return(node->upd->update);
 }
@@ -3631,6 +4144,11 @@ ib_execute_update_query_graph(
 	/* The transaction must be running. */
 	ut_a(trx->conc_state != TRX_NOT_STARTED);
 
+	if (UNIV_UNLIKELY(trx->read_only)) {
+
+		return(DB_READONLY);
+	}
+
 	node = q_proc->node.upd;
 
 	/* This is a short term solution to fix the purge lag. */
@@ -3680,7 +4198,8 @@ ib_execute_update_query_graph(
 }
 
 /*****************************************************************//**
-Update a row in a table.
+Update a row in a table. This is not allowed while the cursor reads
+only some of the columns, see ib_cursor_set_columns().
 @return	DB_SUCCESS or err code */
 
 ib_err_t
@@ -3700,6 +4219,13 @@ ib_cursor_update_row(
 
 	UT_DBG_ENTER_FUNC;
 
+	/* The columns that were not read are SQL NULL in the old tuple,
+	and ib_calc_diff() would write them back as such. */
+	if (cursor->col_map != NULL) {
+
+		return(DB_INVALID_INPUT);
+	}
+
 	if (dict_index_is_clust(prebuilt->index)) {
 		pcur = cursor->prebuilt->pcur;
 	} else if (prebuilt->need_to_access_clustered
@@ -3762,7 +4288,7 @@ ib_delete_row(
 	upd = ib_update_vector_create(cursor);
 
 	page_format = dict_table_is_comp(index->table);
-	ib_read_tuple(cursor, rec, page_format, tuple);
+	ib_read_tuple(NULL, index, rec, page_format, IB_FALSE, tuple);
 
 	upd->n_fields = ib_tuple_get_n_cols(ib_tpl);
 
@@ -3872,6 +4398,7 @@ ib_cursor_read_row(
 	ib_tpl_t	ib_tpl)		/*!< out: read cols into this tuple */
 {
 	ib_err_t	err;
+	const dict_index_t* index;
 	ib_tuple_t*	tuple = (ib_tuple_t*) ib_tpl;
 	ib_cursor_t*	cursor = (ib_cursor_t*) ib_crsr;
 
@@ -3879,6 +4406,14 @@ ib_cursor_read_row(
 
 	ut_a(cursor->prebuilt->trx->conc_state != TRX_NOT_STARTED);
 
+	if (cursor->covering && tuple->type == TPL_ROW) {
+		/* The row is read from the secondary index record. */
+		ut_ad(!cursor->prebuilt->need_to_access_clustered);
+		index = cursor->prebuilt->index;
+	} else {
+		index = tuple->index;
+	}
+
 	/* When searching with IB_EXACT_MATCH set, row_search_for_client()
 	will not position the persistent cursor but will copy the record
 	found into the row cache. It should be the only entry. */
@@ -3894,8 +4429,16 @@ ib_cursor_read_row(
                 rec = row_sel_row_cache_get(cursor->prebuilt);
                 ut_a(rec != NULL);
 
-                if (!rec_get_deleted_flag(rec, page_format)) {
-                        ib_read_tuple(cursor, rec, page_format, tuple);
+		/* A consistent read can return a delete-marked secondary
+		index record after finding in the clustered index that it
+		belongs to the version of the row in the read view. */
+                if (!rec_get_deleted_flag(rec, page_format)
+		    || !dict_index_is_clust(index)) {
+			/* The row cache entry is overwritten only
+			when the cursor is moved. */
+                        ib_read_tuple(
+				cursor->col_map, index, rec, page_format,
+				cursor->zero_copy, tuple);
 			err = DB_SUCCESS;
                 } else{
                         err = DB_RECORD_NOT_FOUND;
@@ -3926,7 +4469,10 @@ ib_cursor_read_row(
 			rec = btr_pcur_get_rec(pcur);
 
 			if (!rec_get_deleted_flag(rec, page_format)) {
-				ib_read_tuple(cursor, rec, page_format, tuple);
+				/* The page latch is released below. */
+				ib_read_tuple(
+					cursor->col_map, index, rec,
+					page_format, IB_FALSE, tuple);
 				err = DB_SUCCESS;
 			} else{
 				err = DB_RECORD_NOT_FOUND;
@@ -4137,6 +4683,107 @@ ib_set_client_compare(
 	ib_client_compare = client_cmp_func;
 }
 
+/*****************************************************************//**
+Set whether ib_cursor_read_row() may point the column values of the
+tuple to the cursor's copy of the current row instead of copying them
+to the tuple's heap. The values are then valid only until the cursor is
+moved or closed; externally stored columns are always copied. */
+
+void
+ib_cursor_set_zero_copy(
+/*====================*/
+	ib_crsr_t	ib_crsr,	/*!< in/out: InnoDB cursor */
+	ib_bool_t	zero_copy)	/*!< in: IB_TRUE to enable */
+{
+	ib_cursor_t*	cursor = (ib_cursor_t*) ib_crsr;
+
+	UT_DBG_ENTER_FUNC;
+
+	cursor->zero_copy = zero_copy;
+}
+
+/*****************************************************************//**
+Set the columns that ib_cursor_read_row() reads. The other columns are
+read as SQL NULL, and externally stored columns that are not read are
+not fetched. A tuple read this way must not be passed to
+ib_cursor_update_row(). If the cursor is on a secondary index that stores
+all the columns, rows are read from it without clustered index lookups.
+This must be called before the cursor is positioned.
+@return	DB_SUCCESS or err code */
+
+ib_err_t
+ib_cursor_set_columns(
+/*==================*/
+	ib_crsr_t		ib_crsr,	/*!< in/out: InnoDB cursor */
+	const ib_ulint_t*	cols,		/*!< in: column numbers of the
+						table, as in the tuples of
+						ib_clust_read_tuple_create() */
+	ib_ulint_t		n_cols)		/*!< in: number of columns in
+						cols, or 0 to read all */
+{
+	ulint		i;
+	ib_cursor_t*	cursor = (ib_cursor_t*) ib_crsr;
+	dict_table_t*	table = cursor->prebuilt->table;
+	dict_index_t*	index = cursor->prebuilt->index;
+	ulint		n_user_cols = dict_table_get_n_user_cols(table);
+
+	UT_DBG_ENTER_FUNC;
+
+	for (i = 0; i < n_cols; ++i) {
+		if (cols[i] >= n_user_cols) {
+
+			return(DB_INVALID_INPUT);
+		}
+	}
+
+	cursor->covering = FALSE;
+
+	if (n_cols == 0) {
+		cursor->col_map = NULL;
+		cursor->prebuilt->need_to_access_clustered =
+			cursor->cluster_access;
+
+		return(DB_SUCCESS);
+	}
+
+	/* The buffer is kept for the lifetime of the cursor, including
+	its reuse from the cursor cache, so that setting the columns again
+	does not grow the heap. */
+	if (cursor->col_map_buf == NULL) {
+		cursor->col_map_buf = mem_heap_alloc(
+			cursor->heap, dict_table_get_n_cols(table));
+	}
+
+	cursor->col_map = cursor->col_map_buf;
+
+	memset(cursor->col_map, 0x0, dict_table_get_n_cols(table));
+
+	for (i = 0; i < n_cols; ++i) {
+		cursor->col_map[cols[i]] = 1;
+	}
+
+	if (!dict_index_is_clust(index)) {
+		cursor->covering = TRUE;
+
+		for (i = 0; i < n_cols; ++i) {
+			if (dict_index_get_nth_col_pos(index, cols[i])
+			    == ULINT_UNDEFINED) {
+
+				cursor->covering = FALSE;
+				break;
+			}
+		}
+	}
+
+	/* Visibility is still checked with the PAGE_MAX_TRX_ID of the
+	secondary index page, and row_search_for_client() falls back to
+	the clustered index record only if that check fails. */
+	cursor->prebuilt->need_to_access_clustered =
+		cursor->cluster_access && !cursor->covering;
+
+	return(DB_SUCCESS);
+}
+
 /*****************************************************************//**
 Set the cursor search mode. */
 
@@ -4191,29 +4838,20 @@ ib_col_is_capped(
 }
 
 /*****************************************************************//**
-Set a column of the tuple. Make a copy using the tuple's heap.
+Set a field to a value in the format of ib_col_set_value(). Make a copy
+using the heap if the field has no buffer large enough.
 @return	DB_SUCCESS or error code */
-
+UNIV_STATIC
 ib_err_t
-ib_col_set_value(
-/*=============*/
-	ib_tpl_t	ib_tpl,		/*!< in: tuple instance */
-	ib_ulint_t	col_no,		/*!< in: column index in tuple */
+ib_dfield_set_value(
+/*================*/
+	mem_heap_t*	heap,		/*!< in: heap for the copy */
+	dfield_t*	dfield,		/*!< in/out: field, with its type */
 	const void*	src,		/*!< in: data value */
-	ib_ulint_t	len)		/*!< in: data value len */
+	ulint		len)		/*!< in: data value len */
 {
 	const dtype_t*  dtype;
-	dfield_t*	dfield;
 	void*		dst = NULL;
-	ib_tuple_t*	tuple = (ib_tuple_t*) ib_tpl;
-
-	UT_DBG_ENTER_FUNC;
-
-#ifdef UNIV_DEBUG
-	mem_heap_verify(tuple->heap);
-#endif
-
-	dfield = ib_col_get_dfield(tuple, col_no);
 
 	/* User wants to set the column to NULL. */
 	if (len == IB_SQL_NULL) {
@@ -4238,11 +4876,11 @@ ib_col_set_value(
 		len = ut_min(len, dtype_get_len(dtype));
 
 		if (dst == NULL) {
-			dst = mem_heap_alloc(tuple->heap, dtype_get_len(dtype));
+			dst = mem_heap_alloc(heap, dtype_get_len(dtype));
 			ut_a(dst != NULL);
 		}
 	} else if (dst == NULL || len > dfield_get_len(dfield)) {
-		dst = mem_heap_alloc(tuple->heap, len);
+		dst = mem_heap_alloc(heap, len);
 	}
 
 	if (dst == NULL) {
@@ -4318,11 +4956,38 @@ ib_col_set_value(
 		dfield_set_len(dfield, len);
 	}
 
+	return(DB_SUCCESS);
+}
+
+/*****************************************************************//**
+Set a column of the tuple. Make a copy using the tuple's heap.
+@return	DB_SUCCESS or error code */
+
+ib_err_t
+ib_col_set_value(
+/*=============*/
+	ib_tpl_t	ib_tpl,		/*!< in: tuple instance */
+	ib_ulint_t	col_no,		/*!< in: column index in tuple */
+	const void*	src,		/*!< in: data value */
+	ib_ulint_t	len)		/*!< in: data value len */
+{
+	ib_err_t	err;
+	ib_tuple_t*	tuple = (ib_tuple_t*) ib_tpl;
+
+	UT_DBG_ENTER_FUNC;
+
 #ifdef UNIV_DEBUG
 	mem_heap_verify(tuple->heap);
 #endif
 
-	return(DB_SUCCESS);
+	err = ib_dfield_set_value(
+		tuple->heap, ib_col_get_dfield(tuple, col_no), src, len);
+
+#ifdef UNIV_DEBUG
+	mem_heap_verify(tuple->heap);
+#endif
+
+	return(err);
 }
 
 /*****************************************************************//**
@@ -5358,8 +6023,10 @@ ib_schema_lock_exclusive(
 	ib_err_t	err = DB_SUCCESS;
 	trx_t*		trx = (trx_t*) ib_trx;
 
-	if (trx->dict_operation_lock_mode == 0
-	    || trx->dict_operation_lock_mode == RW_X_LATCH) {
+	if (trx->read_only) {
+		err = DB_READONLY;
+	} else if (trx->dict_operation_lock_mode == 0
+		   || trx->dict_operation_lock_mode == RW_X_LATCH) {
 
 		dict_lock_data_dictionary((trx_t*) ib_trx);
 	} else {
@@ -5561,7 +6228,205 @@ ib_cursor_set_cluster_access(
 
 	UT_DBG_ENTER_FUNC;
 
-	prebuilt->need_to_access_clustered = TRUE;
+	cursor->cluster_access = TRUE;
+
+	/* A covering secondary index makes the lookup unnecessary. */
+	prebuilt->need_to_access_clustered = !cursor->covering;
+}
+
+/*****************************************************************//**
+Check whether the secondary index of a cursor stores all the columns set
+by ib_cursor_set_columns(), so that rows can be read from it without a
+clustered index lookup.
+@return	IB_TRUE if the index covers the columns */
+
+ib_bool_t
+ib_cursor_is_covering(
+/*==================*/
+	ib_crsr_t	ib_crsr)	/*!< in: InnoDB cursor */
+{
+	const ib_cursor_t*	cursor = (const ib_cursor_t*) ib_crsr;
+
+	UT_DBG_ENTER_FUNC;
+
+	return(cursor->covering);
+}
+
+/*****************************************************************//**
+Add a predicate of the form "column op value" to a cursor. Rows that do
+not satisfy all the predicates of the cursor are skipped by
+row_search_for_client(). This must be called before the cursor is
+positioned.
+@return	DB_SUCCESS or err code */
+
+ib_err_t
+ib_cursor_add_predicate(
+/*====================*/
+	ib_crsr_t	ib_crsr,	/*!< in/out: InnoDB cursor */
+	ib_ulint_t	col_no,		/*!< in: column number of the table,
+					as in the tuples of
+					ib_clust_read_tuple_create() */
+	ib_pred_op_t	op,		/*!< in: comparison operator */
+	const void*	src,		/*!< in: value to compare with */
+	ib_ulint_t	len)		/*!< in: length of src, or
+					IB_SQL_NULL */
+{
+	ib_err_t	err;
+	dfield_t	dfield;
+	mem_heap_t*	heap;
+	ib_cursor_t*	cursor = (ib_cursor_t*) ib_crsr;
+	row_prebuilt_t*	prebuilt = cursor->prebuilt;
+	dict_table_t*	table = prebuilt->table;
+
+	UT_DBG_ENTER_FUNC;
+
+	if (col_no >= dict_table_get_n_user_cols(table)
+	    || op < IB_PRED_EQ || op > IB_PRED_GE
+	    || (len == IB_SQL_NULL
+		&& op != IB_PRED_EQ && op != IB_PRED_NE)) {
+
+		return(DB_INVALID_INPUT);
+	}
+
+	dict_col_copy_type(
+		dict_table_get_nth_col(table, col_no), dfield_get_type(&dfield));
+
+	dfield_set_data(&dfield, NULL, 0);
+
+	/* row_prebuilt_add_pred() copies the value to the heap of the
+	predicates of the cursor. */
+	heap = mem_heap_create(64);
+
+	err = ib_dfield_set_value(heap, &dfield, src, len);
+
+	if (err == DB_SUCCESS) {
+		/* The values of ib_pred_op_t are those of
+		enum row_sel_pred_op. */
+		row_prebuilt_add_pred(
+			prebuilt, col_no, (enum row_sel_pred_op) op, &dfield);
+	}
+
+	mem_heap_free(heap);
+
+	return(err);
+}
+
+/*****************************************************************//**
+Remove all the predicates of a cursor. */
+
+void
+ib_cursor_clear_predicates(
+/*=======================*/
+	ib_crsr_t	ib_crsr)	/*!< in/out: InnoDB cursor */
+{
+	ib_cursor_t*	cursor = (ib_cursor_t*) ib_crsr;
+
+	UT_DBG_ENTER_FUNC;
+
+	row_prebuilt_clear_preds(cursor->prebuilt);
+}
+
+/*****************************************************************//**
+Compute aggregates over a range of the index of a cursor inside the
+engine, without returning the rows through the cursor. See
+row_search_aggregate() for where the range ends.
+@return	DB_SUCCESS or err code */
+
+ib_err_t
+ib_cursor_aggregate(
+/*================*/
+	ib_crsr_t	ib_crsr,	/*!< in/out: InnoDB cursor */
+	ib_tpl_t	ib_tpl,		/*!< in: NULL, or the key where the
+					range starts */
+	ib_srch_mode_t	ib_srch_mode,	/*!< in: search mode of ib_tpl */
+	ib_aggr_t*	aggrs,		/*!< in/out: aggregates */
+	ib_ulint_t	n_aggrs)	/*!< in: number of aggregates */
+{
+	ulint		i;
+	ib_err_t	err;
+	row_sel_aggr_t*	sel_aggrs;
+	ib_tuple_t*	tuple = (ib_tuple_t*) ib_tpl;
+	ib_cursor_t*	cursor = (ib_cursor_t*) ib_crsr;
+	row_prebuilt_t*	prebuilt = cursor->prebuilt;
+	dict_table_t*	table = prebuilt->table;
+	dtuple_t*	search_tuple = prebuilt->search_tuple;
+
+	UT_DBG_ENTER_FUNC;
+
+	if (n_aggrs == 0) {
+		return(DB_INVALID_INPUT);
+	}
+
+	for (i = 0; i < n_aggrs; ++i) {
+		const dict_col_t*	col;
+
+		if (aggrs[i].op == IB_AGGR_COUNT) {
+			continue;
+		} else if (aggrs[i].op < IB_AGGR_SUM
+			   || aggrs[i].op > IB_AGGR_MAX
+			   || aggrs[i].col_no
+			   >= dict_table_get_n_user_cols(table)) {
+
+			return(DB_INVALID_INPUT);
+		}
+
+		col = dict_table_get_nth_col(table, aggrs[i].col_no);
+
+		if (col->mtype != DATA_INT
+		    && col->mtype != DATA_FLOAT
+		    && col->mtype != DATA_DOUBLE) {
+
+			return(DB_DATA_MISMATCH);
+		}
+	}
+
+	if (tuple != NULL) {
+		ulint	n_fields;
+
+		ut_a(tuple->type == TPL_KEY);
+
+		n_fields = dict_index_get_n_ordering_defined_by_user(
+			prebuilt->index);
+
+		dtuple_set_n_fields(search_tuple, n_fields);
+		dtuple_set_n_fields_cmp(search_tuple, n_fields);
+
+		/* Do a shallow copy */
+		for (i = 0; i < n_fields; ++i) {
+			dfield_copy(dtuple_get_nth_field(search_tuple, i),
+				    dtuple_get_nth_field(tuple->ptr, i));
+		}
+	} else {
+		/* Start at the beginning of the index. */
+		dtuple_set_n_fields(search_tuple, 0);
+		ib_srch_mode = IB_CUR_G;
+	}
+
+	sel_aggrs = mem_alloc(n_aggrs * sizeof(*sel_aggrs));
+
+	for (i = 0; i < n_aggrs; ++i) {
+		/* The values of ib_aggr_op_t are those of
+		enum row_sel_aggr_op. */
+		sel_aggrs[i].op = (enum row_sel_aggr_op) aggrs[i].op;
+		sel_aggrs[i].col_no = aggrs[i].col_no;
+	}
+
+	ut_a(prebuilt->select_lock_type <= LOCK_NUM);
+
+	err = row_search_aggregate(
+		srv_force_recovery, ib_srch_mode, prebuilt,
+		(ib_match_t) cursor->match_mode, sel_aggrs, n_aggrs);
+
+	for (i = 0; i < n_aggrs; ++i) {
+		aggrs[i].n_values = sel_aggrs[i].n_vals;
+		aggrs[i].i64 = sel_aggrs[i].i64;
+		aggrs[i].u64 = sel_aggrs[i].u64;
+		aggrs[i].dbl = sel_aggrs[i].dbl;
+	}
+
+	mem_free(sel_aggrs);
+
+	return(err);
 }
 
 /*****************************************************************//**
@@ -28,11 +28,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "buf0buf.h" /* for buf_pool */
 #include "buf0lru.h" /* for buf_LRU_* */
 #include "db0err.h"
+#include "fil0fil.h" /* for fil_set_max_n_open() */
 #include "log0recv.h"
 #include "srv0srv.h"
 #include "srv0start.h"
 #include "trx0sys.h"	/* for trx_sys_file_format_name_to_id() */
 #include "os0sync.h"
+#include "os0proc.h"
 
 UNIV_STATIC	char*	srv_file_flush_method_str = NULL;
 
@@ -289,6 +291,74 @@ ib_cfg_var_get_adaptive_hash_index(
 }
 /* @} */
 
+/** Names of the values of the config variable "buffer_pool_numa_policy",
+indexed by enum os_numa_policy_enum */
+UNIV_STATIC const char*	ib_cfg_numa_policy_names[] = {
+	"default",
+	"interleave",
+	"local"
+};
+
+/*******************************************************************//**
+Set the value of the config variable "buffer_pool_numa_policy".
+ib_cfg_var_set_buffer_pool_numa_policy() @{
+@return	DB_SUCCESS if set successfully */
+UNIV_STATIC
+ib_err_t
+ib_cfg_var_set_buffer_pool_numa_policy(
+/*===================================*/
+	struct ib_cfg_var*	cfg_var,/*!< in/out: configuration variable to
+					manipulate, must be
+					"buffer_pool_numa_policy" */
+	const void*		value)	/*!< in: value to set, must point to
+					char* variable */
+{
+	ulint		i;
+
+	ut_a(strcasecmp(cfg_var->name, "buffer_pool_numa_policy") == 0);
+	ut_a(cfg_var->type == IB_CFG_TEXT);
+
+	for (i = 0; i < UT_ARR_SIZE(ib_cfg_numa_policy_names); ++i) {
+
+		if (strcasecmp(*(char**) value,
+			       ib_cfg_numa_policy_names[i]) == 0) {
+
+			os_numa_policy = i;
+
+			return(DB_SUCCESS);
+		}
+	}
+
+	return(DB_INVALID_INPUT);
+}
+/* @} */
+
+/*******************************************************************//**
+Retrieve the value of the config variable "buffer_pool_numa_policy".
+ib_cfg_var_get_buffer_pool_numa_policy() @{
+@return	DB_SUCCESS if retrieved successfully */
+UNIV_STATIC
+ib_err_t
+ib_cfg_var_get_buffer_pool_numa_policy(
+/*===================================*/
+	const struct ib_cfg_var*	cfg_var,/*!< in: configuration
+						variable whose value to
+						retrieve, must be
+						"buffer_pool_numa_policy" */
+	void*				value)	/*!< out: place to store
+						the retrieved value, must
+						point to char* variable */
+{
+	ut_a(strcasecmp(cfg_var->name, "buffer_pool_numa_policy") == 0);
+	ut_a(cfg_var->type == IB_CFG_TEXT);
+	ut_a(os_numa_policy < UT_ARR_SIZE(ib_cfg_numa_policy_names));
+
+	*(const char**) value = ib_cfg_numa_policy_names[os_numa_policy];
+
+	return(DB_SUCCESS);
+}
+/* @} */
+
 /*******************************************************************//**
 Set the value of the config variable "data_file_path".
 ib_cfg_var_set_data_file_path() @{
@@ -435,6 +505,33 @@ ib_cfg_var_validate_data_home_dir(
 }
 /* @} */
 
+/*******************************************************************//**
+Check the value of the config variable "sort_buffer_size". The buffer is
+allocated with os_mem_alloc_large() and split into merge blocks, so that
+the size must be a multiple of UNIV_PAGE_SIZE.
+ib_cfg_var_validate_sort_buffer_size() @{
+@return	DB_SUCCESS if value is valid */
+UNIV_STATIC
+ib_err_t
+ib_cfg_var_validate_sort_buffer_size(
+/*=================================*/
+	const struct ib_cfg_var*cfg_var,/*!< in/out: configuration variable to
+					check, must be "sort_buffer_size" */
+	const void*		value)	/*!< in: value to check, must point to
+					ulint variable */
+{
+	ut_a(strcasecmp(cfg_var->name, "sort_buffer_size") == 0);
+	ut_a(cfg_var->type == IB_CFG_ULINT);
+
+	if (*(ulint*) value % UNIV_PAGE_SIZE != 0) {
+
+		return(DB_INVALID_INPUT);
+	}
+
+	return(ib_cfg_var_validate_numeric(cfg_var, value));
+}
+/* @} */
+
 /*******************************************************************//**
 Set the value of the config variable "log_group_home_dir".
 ib_cfg_var_set_log_group_home_dir @{
@@ -615,6 +712,37 @@ ib_cfg_var_set_lru_old_blocks_pct(
 
 /* ib_cfg_var_get_generic() is used to get the value of lru_old_blocks_pct */
 
+/*******************************************************************//**
+Set the value of the config variable "open_files".
+ib_cfg_var_set_open_files() @{
+@return	DB_SUCCESS if set successfully */
+UNIV_STATIC
+ib_err_t
+ib_cfg_var_set_open_files(
+/*======================*/
+	struct ib_cfg_var*	cfg_var,/*!< in/out: configuration variable to
+					manipulate, must be "open_files" */
+	const void*		value)	/*!< in: value to set, must point to
+					ulint variable */
+{
+	ib_err_t	ret;
+
+	ut_a(strcasecmp(cfg_var->name, "open_files") == 0);
+	ut_a(cfg_var->type == IB_CFG_ULINT);
+
+	ret = ib_cfg_var_set_generic(cfg_var, value);
+
+	if (ret == DB_SUCCESS) {
+		/* Adjust the tablespace memory cache if it exists */
+		fil_set_max_n_open(srv_max_n_open_files);
+	}
+
+	return(ret);
+}
+/* @} */
+
+/* ib_cfg_var_get_generic() is used to get the value of open_files */
+
 /* There is no ib_cfg_var_set_version() */
 
 /*******************************************************************//**
@@ -696,6 +824,16 @@ UNIV_STATIC const ib_cfg_var_t cfg_vars_defaults[] = {
 	 STRUCT_FLD(get,	ib_cfg_var_get_generic),
 	 STRUCT_FLD(tank,	&srv_buf_pool_size)},
 
+	{STRUCT_FLD(name,	"buffer_pool_numa_policy"),
+	 STRUCT_FLD(type,	IB_CFG_TEXT),
+	 STRUCT_FLD(flag,	IB_CFG_FLAG_READONLY_AFTER_STARTUP),
+	 STRUCT_FLD(min_val,	0),
+	 STRUCT_FLD(max_val,	0),
+	 STRUCT_FLD(validate,	NULL),
+	 STRUCT_FLD(set,	ib_cfg_var_set_buffer_pool_numa_policy),
+	 STRUCT_FLD(get,	ib_cfg_var_get_buffer_pool_numa_policy),
+	 STRUCT_FLD(tank,	NULL)},
+
 	{STRUCT_FLD(name,	"checksums"),
 	 STRUCT_FLD(type,	IB_CFG_IBOOL),
 	 STRUCT_FLD(flag,	IB_CFG_FLAG_READONLY_AFTER_STARTUP),
@@ -726,6 +864,28 @@ UNIV_STATIC const ib_cfg_var_t cfg_vars_defaults[] = {
 	 STRUCT_FLD(get,	ib_cfg_var_get_generic),
 	 STRUCT_FLD(tank,	&srv_data_home)},
 
+	/* New, not present in InnoDB/MySQL */
+	{STRUCT_FLD(name,	"deadlock_detect"),
+	 STRUCT_FLD(type,	IB_CFG_IBOOL),
+	 STRUCT_FLD(flag,	IB_CFG_FLAG_NONE),
+	 STRUCT_FLD(min_val,	0),
+	 STRUCT_FLD(max_val,	0),
+	 STRUCT_FLD(validate,	NULL),
+	 STRUCT_FLD(set,	ib_cfg_var_set_generic),
+	 STRUCT_FLD(get,	ib_cfg_var_get_generic),
+	 STRUCT_FLD(tank,	&srv_deadlock_detect)},
+
+	/* New, not present in InnoDB/MySQL */
+	{STRUCT_FLD(name,	"dict_cache_max_tables"),
+	 STRUCT_FLD(type,	IB_CFG_ULINT),
+	 STRUCT_FLD(flag,	IB_CFG_FLAG_NONE),
+	 STRUCT_FLD(min_val,	0),
+	 STRUCT_FLD(max_val,	ULINT_MAX),
+	 STRUCT_FLD(validate,	ib_cfg_var_validate_numeric),
+	 STRUCT_FLD(set,	ib_cfg_var_set_generic),
+	 STRUCT_FLD(get,	ib_cfg_var_get_generic),
+	 STRUCT_FLD(tank,	&srv_dict_cache_max_tables)},
+
 	{STRUCT_FLD(name,	"doublewrite"),
 	 STRUCT_FLD(type,	IB_CFG_IBOOL),
 	 STRUCT_FLD(flag,	IB_CFG_FLAG_READONLY_AFTER_STARTUP),
@@ -807,6 +967,16 @@ UNIV_STATIC const ib_cfg_var_t cfg_vars_defaults[] = {
 	 STRUCT_FLD(get,	ib_cfg_var_get_generic),
 	 STRUCT_FLD(tank,	&srv_io_capacity)},
 
+	{STRUCT_FLD(name,	"large_pages"),
+	 STRUCT_FLD(type,	IB_CFG_IBOOL),
+	 STRUCT_FLD(flag,	IB_CFG_FLAG_READONLY_AFTER_STARTUP),
+	 STRUCT_FLD(min_val,	0),
+	 STRUCT_FLD(max_val,	0),
+	 STRUCT_FLD(validate,	NULL),
+	 STRUCT_FLD(set,	ib_cfg_var_set_generic),
+	 STRUCT_FLD(get,	ib_cfg_var_get_generic),
+	 STRUCT_FLD(tank,	&os_use_large_pages)},
+
 	{STRUCT_FLD(name,	"lock_wait_timeout"),
 	 STRUCT_FLD(type,	IB_CFG_ULINT),
 	 STRUCT_FLD(flag,	IB_CFG_FLAG_NONE),
@@ -897,13 +1067,24 @@ UNIV_STATIC const ib_cfg_var_t cfg_vars_defaults[] = {
 	 STRUCT_FLD(get,	ib_cfg_var_get_generic),
 	 STRUCT_FLD(tank,	&buf_LRU_old_threshold_ms)},
 
+	/* New, not present in InnoDB/MySQL */
+	{STRUCT_FLD(name,	"online_log_max_size"),
+	 STRUCT_FLD(type,	IB_CFG_ULINT),
+	 STRUCT_FLD(flag,	IB_CFG_FLAG_NONE),
+	 STRUCT_FLD(min_val,	65536),
+	 STRUCT_FLD(max_val,	ULINT_MAX),
+	 STRUCT_FLD(validate,	ib_cfg_var_validate_numeric),
+	 STRUCT_FLD(set,	ib_cfg_var_set_generic),
+	 STRUCT_FLD(get,	ib_cfg_var_get_generic),
+	 STRUCT_FLD(tank,	&srv_online_log_max_size)},
+
 	{STRUCT_FLD(name,	"open_files"),
 	 STRUCT_FLD(type,	IB_CFG_ULINT),
-	 STRUCT_FLD(flag,	IB_CFG_FLAG_READONLY_AFTER_STARTUP),
+	 STRUCT_FLD(flag,	IB_CFG_FLAG_NONE),
 	 STRUCT_FLD(min_val,	10),
 	 STRUCT_FLD(max_val,	IB_UINT64_T_MAX),
 	 STRUCT_FLD(validate,	ib_cfg_var_validate_numeric),
-	 STRUCT_FLD(set,	ib_cfg_var_set_generic),
+	 STRUCT_FLD(set,	ib_cfg_var_set_open_files),
 	 STRUCT_FLD(get,	ib_cfg_var_get_generic),
 	 STRUCT_FLD(tank,	&srv_max_n_open_files)},
 
@@ -960,6 +1141,38 @@ UNIV_STATIC const ib_cfg_var_t cfg_vars_defaults[] = {
 	 STRUCT_FLD(get,	ib_cfg_var_get_generic),
 	 STRUCT_FLD(tank,	&ses_rollback_on_timeout)},
 
+	{STRUCT_FLD(name,	"rollback_segments"),
+	 STRUCT_FLD(type,	IB_CFG_ULINT),
+	 STRUCT_FLD(flag,	IB_CFG_FLAG_READONLY_AFTER_STARTUP),
+	 STRUCT_FLD(min_val,	1),
+	 STRUCT_FLD(max_val,	TRX_SYS_MAX_RSEGS),
+	 STRUCT_FLD(validate,	ib_cfg_var_validate_numeric),
+	 STRUCT_FLD(set,	ib_cfg_var_set_generic),
+	 STRUCT_FLD(get,	ib_cfg_var_get_generic),
+	 STRUCT_FLD(tank,	&srv_rollback_segments)},
+
+	/* New, not present in InnoDB/MySQL */
+	{STRUCT_FLD(name,	"sort_buffer_size"),
+	 STRUCT_FLD(type,	IB_CFG_ULINT),
+	 STRUCT_FLD(flag,	IB_CFG_FLAG_READONLY_AFTER_STARTUP),
+	 STRUCT_FLD(min_val,	65536),
+	 STRUCT_FLD(max_val,	64 * 1024 * 1024),
+	 STRUCT_FLD(validate,	ib_cfg_var_validate_sort_buffer_size),
+	 STRUCT_FLD(set,	ib_cfg_var_set_generic),
+	 STRUCT_FLD(get,	ib_cfg_var_get_generic),
+	 STRUCT_FLD(tank,	&srv_sort_buf_size)},
+
+	/* New, not present in InnoDB/MySQL */
+	{STRUCT_FLD(name,	"sort_threads"),
+	 STRUCT_FLD(type,	IB_CFG_ULINT),
+	 STRUCT_FLD(flag,	IB_CFG_FLAG_NONE),
+	 STRUCT_FLD(min_val,	1),
+	 STRUCT_FLD(max_val,	64),
+	 STRUCT_FLD(validate,	ib_cfg_var_validate_numeric),
+	 STRUCT_FLD(set,	ib_cfg_var_set_generic),
+	 STRUCT_FLD(get,	ib_cfg_var_get_generic),
+	 STRUCT_FLD(tank,	&srv_sort_threads)},
+
 	{STRUCT_FLD(name,	"stats_sample_pages"),
 	 STRUCT_FLD(type,	IB_CFG_ULINT),
 	 STRUCT_FLD(flag,	IB_CFG_FLAG_NONE),
@@ -196,6 +196,10 @@ handle_new_error:
 			trx_general_rollback(trx, TRUE, savept);
 		}
 		break;
+	case DB_READONLY:
+		/* The table lock was refused before anything was
+		modified: there is nothing to roll back. */
+		break;
 	case DB_LOCK_WAIT:
 		srv_suspend_user_thread(thr);
 
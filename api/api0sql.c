@@ -31,11 +31,38 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "pars0pars.h"
 #include "que0que.h"
 #include "trx0roll.h"
+#include "hash0hash.h"
 #include "api0api.h"
 
 UNIV_STATIC int				api_sql_enter_func_enabled = 0;
 #define UT_DBG_ENTER_FUNC_ENABLED	api_sql_enter_func_enabled
 
+/** A statement of the internal SQL parser. Its query graph is kept
+for the next execution, when only the values bound to it change. */
+struct ib_sql_stmt_struct {
+	char*		sql;		/*!< SQL text */
+	que_t*		graph;		/*!< query graph, or NULL if the
+					statement has to be parsed */
+	ibool		cached;		/*!< TRUE if in ib_sql_cache */
+	hash_node_t	hash;		/*!< hash chain node in
+					ib_sql_cache.hash */
+	UT_LIST_NODE_T(ib_sql_stmt_t)
+			lru;		/*!< list node in ib_sql_cache.lru */
+};
+
+/** Maximum number of statements in ib_sql_cache */
+#define IB_SQL_CACHE_SIZE	64
+
+/** Statements executed by ib_exec_sql() and ib_exec_ddl_sql(),
+protected by dict_sys->mutex */
+UNIV_STATIC struct {
+	hash_table_t*	hash;		/*!< statements hashed by SQL text,
+					or NULL if the cache is empty */
+	UT_LIST_BASE_NODE_T(ib_sql_stmt_t)
+			lru;		/*!< statements in the order of
+					their last use, most recent first */
+} ib_sql_cache;
+
 /*********************************************************************//**
 Function to parse ib_exec_sql() and ib_exec_ddl_sql() args.
 @return	own: info struct */
@@ -150,42 +177,174 @@ ib_exec_vsql(
 }
 
 /*********************************************************************//**
-Execute arbitrary SQL using InnoDB's internal parser. The statement
-is executed in a new transaction. Table name parameters must be prefixed
-with a '$' symbol and variables with ':'
-@return	DB_SUCCESS or error code */
+Creates a statement of the internal SQL parser.
+@return	own: statement */
+UNIV_STATIC
+ib_sql_stmt_t*
+ib_sql_stmt_create(
+/*===============*/
+	const char*	sql)		/*!< in: SQL text */
+{
+	ib_sql_stmt_t*	stmt;
+
+	stmt = mem_alloc(sizeof *stmt);
+
+	stmt->sql = mem_strdup(sql);
+	stmt->graph = NULL;
+	stmt->cached = FALSE;
+
+	return(stmt);
+}
+
+/*********************************************************************//**
+Frees a statement of the internal SQL parser. The caller must own
+dict_sys->mutex. */
+UNIV_STATIC
+void
+ib_sql_stmt_free(
+/*=============*/
+	ib_sql_stmt_t*	stmt)		/*!< in, own: statement */
+{
+	ut_ad(mutex_own(&dict_sys->mutex));
+
+	if (stmt->graph != NULL) {
+		que_graph_free(stmt->graph);
+	}
+
+	mem_free(stmt->sql);
+	mem_free(stmt);
+}
+
+/*********************************************************************//**
+Looks up a statement in ib_sql_cache, adding it if it is not there. The
+caller must own dict_sys->mutex.
+@return	statement */
+UNIV_STATIC
+ib_sql_stmt_t*
+ib_sql_cache_get(
+/*=============*/
+	const char*	sql)		/*!< in: SQL text */
+{
+	ib_sql_stmt_t*	stmt;
+	ulint		fold	= ut_fold_string(sql);
+
+	ut_ad(mutex_own(&dict_sys->mutex));
+
+	if (ib_sql_cache.hash == NULL) {
+		ib_sql_cache.hash = hash_create(2 * IB_SQL_CACHE_SIZE);
+		UT_LIST_INIT(ib_sql_cache.lru);
+	}
+
+	HASH_SEARCH(hash, ib_sql_cache.hash, fold, ib_sql_stmt_t*, stmt,
+		    ut_ad(stmt->cached), !strcmp(stmt->sql, sql));
+
+	if (stmt != NULL) {
+		UT_LIST_REMOVE(lru, ib_sql_cache.lru, stmt);
+		UT_LIST_ADD_FIRST(lru, ib_sql_cache.lru, stmt);
+
+		return(stmt);
+	}
+
+	if (UT_LIST_GET_LEN(ib_sql_cache.lru) >= IB_SQL_CACHE_SIZE) {
+		ib_sql_stmt_t*	old = UT_LIST_GET_LAST(ib_sql_cache.lru);
+
+		UT_LIST_REMOVE(lru, ib_sql_cache.lru, old);
+		HASH_DELETE(ib_sql_stmt_t, hash, ib_sql_cache.hash,
+			    ut_fold_string(old->sql), old);
+		ib_sql_stmt_free(old);
+	}
+
+	stmt = ib_sql_stmt_create(sql);
+	stmt->cached = TRUE;
+
+	HASH_INSERT(ib_sql_stmt_t, hash, ib_sql_cache.hash, fold, stmt);
+	UT_LIST_ADD_FIRST(lru, ib_sql_cache.lru, stmt);
+
+	return(stmt);
+}
 
+/*********************************************************************//**
+Runs a statement of the internal SQL parser, parsing it unless the query
+graph of the previous execution can be bound to info. The caller must own
+dict_sys->mutex.
+@return	DB_SUCCESS or error code */
+UNIV_STATIC
 ib_err_t
-ib_exec_sql(
-/*========*/
-	const char*     sql,            /*!< in: sql to execute */
-	ib_ulint_t	n_args,         /*!< in: no. of args */
-	...)
+ib_sql_stmt_eval(
+/*=============*/
+	ib_sql_stmt_t*	stmt,		/*!< in/out: statement */
+	pars_info_t*	info,		/*!< in, own: bound values */
+	trx_t*		trx)		/*!< in: transaction */
 {
-	va_list         ap;
-	trx_t*          trx;
 	ib_err_t	err;
-	pars_info_t*    info;
 
-	UT_DBG_ENTER_FUNC;
+	ut_ad(mutex_own(&dict_sys->mutex));
 
-	va_start(ap, n_args);
+	/* A table or index that the graph points to may have been
+	freed since the graph was parsed. */
 
-	info = ib_exec_vsql(sql, n_args, ap);
+	if (stmt->graph != NULL
+	    && (!pars_graph_tables_valid(stmt->graph)
+		|| !pars_info_rebind(stmt->graph, info))) {
 
-	va_end(ap);
+		que_graph_free(stmt->graph);
+		stmt->graph = NULL;
+	}
+
+	if (stmt->graph == NULL) {
+		/* The graph takes the ownership of info. */
+		stmt->graph = pars_sql(info, stmt->sql);
+		info = NULL;
+	}
+
+	err = que_eval_graph(stmt->graph, trx);
+
+	if (err != DB_SUCCESS) {
+		/* Do not run the graph again in an unknown state. */
+		que_graph_free(stmt->graph);
+		stmt->graph = NULL;
+	}
+
+	if (info != NULL) {
+		/* The graph pointed to the values of info: they are
+		not used any more. */
+		pars_info_free(info);
+	}
+
+	return(err);
+}
+
+/*********************************************************************//**
+Runs a statement of the internal SQL parser in a new transaction.
+@return	DB_SUCCESS or error code */
+UNIV_STATIC
+ib_err_t
+ib_sql_stmt_exec(
+/*=============*/
+	ib_sql_stmt_t*	stmt,		/*!< in/out: statement, or NULL
+					to look up sql in ib_sql_cache */
+	const char*	sql,		/*!< in: SQL text if stmt == NULL */
+	pars_info_t*	info)		/*!< in, own: bound values */
+{
+	trx_t*          trx;
+	ib_err_t	err;
+	int		started;
 
 	/* We use the private SQL parser of Innobase to generate
 	the query graphs needed to execute the SQL statement. */
 
 	trx = trx_allocate_for_client(NULL);
-	err = trx_start(trx, ULINT_UNDEFINED);
-	ut_a(err == DB_SUCCESS);
+	started = trx_start(trx, ULINT_UNDEFINED);
+	ut_a(started);
 	trx->op_info = "exec client sql";
 
 	dict_mutex_enter();
-	/* Note that we've already acquired the dictionary mutex. */
-	err = que_eval_sql(info, sql, FALSE, trx);
+
+	if (stmt == NULL) {
+		stmt = ib_sql_cache_get(sql);
+	}
+
+	err = ib_sql_stmt_eval(stmt, info, trx);
 	ut_a(err == DB_SUCCESS);
 	dict_mutex_exit();
 
@@ -202,32 +361,22 @@ ib_exec_sql(
 }
 
 /*********************************************************************//**
-Execute arbitrary SQL using InnoDB's internal parser. The statement
-is executed in a background transaction. It will lock the data
-dictionary lock for the duration of the query.
+Runs a statement of the internal SQL parser in a background transaction,
+holding the data dictionary lock for the duration of the query.
 @return	DB_SUCCESS or error code */
-
+UNIV_STATIC
 ib_err_t
-ib_exec_ddl_sql(
-/*============*/
-	const char*	sql,		/*!< in: sql to execute */
-	ib_ulint_t	n_args,		/*!< in: no. of args */
-	...)
+ib_sql_stmt_exec_ddl(
+/*=================*/
+	ib_sql_stmt_t*	stmt,		/*!< in/out: statement, or NULL
+					to look up sql in ib_sql_cache */
+	const char*	sql,		/*!< in: SQL text if stmt == NULL */
+	pars_info_t*	info)		/*!< in, own: bound values */
 {
-	va_list         ap;
 	trx_t*          trx;
 	ib_err_t	err;
-	pars_info_t*    info;
 	int		started;
 
-	UT_DBG_ENTER_FUNC;
-
-	va_start(ap, n_args);
-
-	info = ib_exec_vsql(sql, n_args, ap);
-
-	va_end(ap);
-
 	/* We use the private SQL parser of Innobase to generate
 	the query graphs needed to execute the SQL statement. */
 
@@ -239,9 +388,14 @@ ib_exec_ddl_sql(
 	err = ib_schema_lock_exclusive((ib_trx_t) trx);
 	ut_a(err == DB_SUCCESS);
 
-	/* Note that we've already acquired the dictionary mutex by
-	setting reserve_dict_mutex to FALSE. */
-	err = que_eval_sql(info, sql, FALSE, trx);
+	/* Note that the dictionary mutex is acquired together with
+	the dictionary lock. */
+
+	if (stmt == NULL) {
+		stmt = ib_sql_cache_get(sql);
+	}
+
+	err = ib_sql_stmt_eval(stmt, info, trx);
 	ut_a(err == DB_SUCCESS);
 
 	ib_schema_unlock((ib_trx_t) trx);
@@ -258,3 +412,176 @@ ib_exec_ddl_sql(
 	return(err);
 }
 
+/*********************************************************************//**
+Execute arbitrary SQL using InnoDB's internal parser. The statement
+is executed in a new transaction. Table name parameters must be prefixed
+with a '$' symbol and variables with ':'. The query graph is cached by
+the SQL text and reused when the statement is executed again.
+@return	DB_SUCCESS or error code */
+
+ib_err_t
+ib_exec_sql(
+/*========*/
+	const char*     sql,            /*!< in: sql to execute */
+	ib_ulint_t	n_args,         /*!< in: no. of args */
+	...)
+{
+	va_list         ap;
+	pars_info_t*    info;
+
+	UT_DBG_ENTER_FUNC;
+
+	va_start(ap, n_args);
+
+	info = ib_exec_vsql(sql, n_args, ap);
+
+	va_end(ap);
+
+	return(ib_sql_stmt_exec(NULL, sql, info));
+}
+
+/*********************************************************************//**
+Execute arbitrary SQL using InnoDB's internal parser. The statement
+is executed in a background transaction. It will lock the data
+dictionary lock for the duration of the query. The query graph is cached
+by the SQL text and reused when the statement is executed again.
+@return	DB_SUCCESS or error code */
+
+ib_err_t
+ib_exec_ddl_sql(
+/*============*/
+	const char*	sql,		/*!< in: sql to execute */
+	ib_ulint_t	n_args,		/*!< in: no. of args */
+	...)
+{
+	va_list         ap;
+	pars_info_t*    info;
+
+	UT_DBG_ENTER_FUNC;
+
+	va_start(ap, n_args);
+
+	info = ib_exec_vsql(sql, n_args, ap);
+
+	va_end(ap);
+
+	return(ib_sql_stmt_exec_ddl(NULL, sql, info));
+}
+
+/*********************************************************************//**
+Prepare a statement of InnoDB's internal parser for repeated execution
+with ib_exec_prepared_sql() or ib_exec_prepared_ddl_sql(). The statement
+is parsed when it is first executed and parsed again only if the data
+dictionary or the bound table names have changed.
+@return	DB_SUCCESS or error code */
+
+ib_err_t
+ib_sql_prepare(
+/*===========*/
+	const char*	sql,		/*!< in: sql to prepare */
+	ib_sql_stmt_t**	stmt)		/*!< out: prepared statement */
+{
+	UT_DBG_ENTER_FUNC;
+
+	*stmt = ib_sql_stmt_create(sql);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************//**
+Execute a prepared statement of InnoDB's internal parser in a new
+transaction. The arguments are given as for ib_exec_sql().
+@return	DB_SUCCESS or error code */
+
+ib_err_t
+ib_exec_prepared_sql(
+/*=================*/
+	ib_sql_stmt_t*	stmt,		/*!< in/out: prepared statement */
+	ib_ulint_t	n_args,		/*!< in: no. of args */
+	...)
+{
+	va_list         ap;
+	pars_info_t*    info;
+
+	UT_DBG_ENTER_FUNC;
+
+	va_start(ap, n_args);
+
+	info = ib_exec_vsql(stmt->sql, n_args, ap);
+
+	va_end(ap);
+
+	return(ib_sql_stmt_exec(stmt, NULL, info));
+}
+
+/*********************************************************************//**
+Execute a prepared statement of InnoDB's internal parser in a background
+transaction, holding the data dictionary lock for the duration of the
+query. The arguments are given as for ib_exec_ddl_sql().
+@return	DB_SUCCESS or error code */
+
+ib_err_t
+ib_exec_prepared_ddl_sql(
+/*=====================*/
+	ib_sql_stmt_t*	stmt,		/*!< in/out: prepared statement */
+	ib_ulint_t	n_args,		/*!< in: no. of args */
+	...)
+{
+	va_list         ap;
+	pars_info_t*    info;
+
+	UT_DBG_ENTER_FUNC;
+
+	va_start(ap, n_args);
+
+	info = ib_exec_vsql(stmt->sql, n_args, ap);
+
+	va_end(ap);
+
+	return(ib_sql_stmt_exec_ddl(stmt, NULL, info));
+}
+
+/*********************************************************************//**
+Free a statement prepared with ib_sql_prepare(). */
+
+void
+ib_sql_free(
+/*========*/
+	ib_sql_stmt_t*	stmt)		/*!< in, own: prepared statement */
+{
+	UT_DBG_ENTER_FUNC;
+
+	ut_a(!stmt->cached);
+
+	dict_mutex_enter();
+	ib_sql_stmt_free(stmt);
+	dict_mutex_exit();
+}
+
+/*********************************************************************//**
+Free the statements cached by ib_exec_sql() and ib_exec_ddl_sql(). Must
+be called before the data dictionary is shut down. */
+
+void
+ib_sql_cache_close(void)
+/*====================*/
+{
+	ib_sql_stmt_t*	stmt;
+
+	if (ib_sql_cache.hash == NULL) {
+
+		return;
+	}
+
+	dict_mutex_enter();
+
+	while ((stmt = UT_LIST_GET_FIRST(ib_sql_cache.lru)) != NULL) {
+		UT_LIST_REMOVE(lru, ib_sql_cache.lru, stmt);
+		ib_sql_stmt_free(stmt);
+	}
+
+	hash_table_free(ib_sql_cache.hash);
+	ib_sql_cache.hash = NULL;
+
+	dict_mutex_exit();
+}
@@ -23,6 +23,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include "univ.i"
 #include "srv0srv.h"
+#include "sync0sync.h"
 #include "api0api.h"
 #include "api0ucode.h"
 
@@ -158,6 +159,104 @@ UNIV_STATIC const ib_status_t status_vars[] = {
 	{"lock_max_wait_time_in_secs",IB_STATUS_ULINT,
 		&export_vars.innodb_row_lock_time_max},
 
+	{"lock_deadlock_checks",	IB_STATUS_ULINT,
+		&export_vars.innodb_deadlock_checks},
+
+	{"lock_deadlocks",		IB_STATUS_ULINT,
+		&export_vars.innodb_deadlocks},
+
+	{"lock_deadlock_search_too_long",IB_STATUS_ULINT,
+		&export_vars.innodb_deadlock_too_long},
+
+	{"lock_deadlock_check_time_in_us",IB_STATUS_I64,
+		&export_vars.innodb_deadlock_check_time},
+
+	{"lock_deadlock_check_max_time_in_us",IB_STATUS_I64,
+		&export_vars.innodb_deadlock_check_time_max},
+
+	{"lock_rec_hash_cells",		IB_STATUS_ULINT,
+		&export_vars.innodb_lock_rec_hash_cells},
+
+	{"lock_rec_hash_searches",	IB_STATUS_ULINT,
+		&export_vars.innodb_lock_rec_hash_searches},
+
+	{"lock_rec_hash_chain_steps",	IB_STATUS_ULINT,
+		&export_vars.innodb_lock_rec_hash_steps},
+
+	{"lock_rec_hash_max_chain_steps",IB_STATUS_ULINT,
+		&export_vars.innodb_lock_rec_hash_max_steps},
+
+	{"lock_rec_nolock_checks",	IB_STATUS_ULINT,
+		&export_vars.innodb_lock_rec_hash_nolock},
+
+	/* Memory heaps */
+	{"mem_heap_block_cache_hits",	IB_STATUS_ULINT,
+		&export_vars.innodb_mem_block_cache_hits},
+
+	{"mem_heap_block_cache_misses",	IB_STATUS_ULINT,
+		&export_vars.innodb_mem_block_cache_misses},
+
+	/* Dictionary cache */
+	{"dict_cache_tables",		IB_STATUS_ULINT,
+		&export_vars.innodb_dict_cache_tables},
+
+	{"dict_cache_hits",		IB_STATUS_ULINT,
+		&export_vars.innodb_dict_cache_hits},
+
+	{"dict_cache_misses",		IB_STATUS_ULINT,
+		&export_vars.innodb_dict_cache_misses},
+
+	{"dict_cache_evictions",	IB_STATUS_ULINT,
+		&export_vars.innodb_dict_cache_evictions},
+
+	/* Cursor cache */
+	{"cursor_cache_hits",		IB_STATUS_ULINT,
+		&export_vars.innodb_cursor_cache_hits},
+
+	{"cursor_cache_misses",		IB_STATUS_ULINT,
+		&export_vars.innodb_cursor_cache_misses},
+
+	{"cursor_cache_evictions",	IB_STATUS_ULINT,
+		&export_vars.innodb_cursor_cache_evictions},
+
+
+	/* Mutex and rw-lock spin waits */
+	{"sync_mutex_spin_waits",	IB_STATUS_I64,
+		&export_vars.innodb_mutex_spin_waits},
+
+	{"sync_mutex_spin_rounds",	IB_STATUS_I64,
+		&export_vars.innodb_mutex_spin_rounds},
+
+	{"sync_mutex_os_waits",		IB_STATUS_I64,
+		&export_vars.innodb_mutex_os_waits},
+
+	{"sync_mutex_os_yields",	IB_STATUS_I64,
+		&export_vars.innodb_mutex_os_yields},
+
+	{"sync_rw_shared_spin_waits",	IB_STATUS_I64,
+		&export_vars.innodb_rw_s_spin_waits},
+
+	{"sync_rw_shared_spin_rounds",	IB_STATUS_I64,
+		&export_vars.innodb_rw_s_spin_rounds},
+
+	{"sync_rw_shared_os_waits",	IB_STATUS_I64,
+		&export_vars.innodb_rw_s_os_waits},
+
+	{"sync_rw_shared_os_yields",	IB_STATUS_I64,
+		&export_vars.innodb_rw_s_os_yields},
+
+	{"sync_rw_excl_spin_waits",	IB_STATUS_I64,
+		&export_vars.innodb_rw_x_spin_waits},
+
+	{"sync_rw_excl_spin_rounds",	IB_STATUS_I64,
+		&export_vars.innodb_rw_x_spin_rounds},
+
+	{"sync_rw_excl_os_waits",	IB_STATUS_I64,
+		&export_vars.innodb_rw_x_os_waits},
+
+	{"sync_rw_excl_os_yields",	IB_STATUS_I64,
+		&export_vars.innodb_rw_x_os_yields},
+
 
 	/* Row operations */
 	{"row_total_read",		IB_STATUS_ULINT,
@@ -252,3 +351,60 @@ ib_status_get_i64(
 	return(err);
 }
 
+/*******************************************************************//**
+Report the contention on the mutexes and rw-locks by the source line
+that creates them.
+@return	DB_SUCCESS */
+
+ib_err_t
+ib_status_latch_iterate(
+/*====================*/
+	ib_status_latch_visitor_t
+			visitor,	/*!< in: visitor function */
+	void*		arg)		/*!< in: argument passed to the
+					visitor function */
+{
+	ulint			i;
+	ulint			n_sites;
+	sync_site_stats_t*	site_stats;
+
+	/* The visitor is invoked on a copy, so that it does not run
+	while the latch lists are being held. */
+	site_stats = sync_site_stats_collect(&n_sites);
+
+	for (i = 0; i < n_sites; i++) {
+		ib_latch_stats_t	stats;
+		const sync_site_stats_t*	ss = &site_stats[i];
+
+		stats.file = ss->cfile_name;
+		stats.line = ss->cline;
+		stats.rw_lock = ss->rw_lock ? IB_TRUE : IB_FALSE;
+		stats.n_latches = ss->n_latches;
+		stats.n_acquired = ss->stats.n_acquired;
+		stats.n_spin_waits = ss->stats.n_spin_waits;
+		stats.n_spin_rounds = ss->stats.n_spin_rounds;
+		stats.n_os_yields = ss->stats.n_os_yields;
+		stats.n_os_waits = ss->stats.n_os_waits;
+		stats.wait_time = ss->stats.wait_time;
+
+		if (visitor(arg, &stats)) {
+			break;
+		}
+	}
+
+	if (site_stats != NULL) {
+		ut_free(site_stats);
+	}
+
+	return(DB_SUCCESS);
+}
+
+/*******************************************************************//**
+Reset the contention counters of all mutexes and rw-locks. */
+
+void
+ib_status_latch_reset(void)
+/*=======================*/
+{
+	sync_site_stats_reset();
+}
@@ -760,6 +760,9 @@ buf_chunk_init(
 		return(NULL);
 	}
 
+	/* Place the pages on NUMA nodes before they are touched. */
+	os_mem_set_numa_policy(chunk->mem, chunk->mem_size);
+
 	/* Allocate the block descriptors from
 	the start of the memory block. */
 	chunk->blocks = chunk->mem;
@@ -249,7 +249,10 @@ UNIV_STATIC
 void
 buf_LRU_drop_page_hash_for_tablespace(
 /*==================================*/
-	ulint	id)	/*!< in: space id */
+	ulint			id,	/*!< in: space id */
+	const dict_index_t*	index)	/*!< in: drop only the entries
+					that point to this index,
+					or NULL for all */
 {
 	buf_page_t*	bpage;
 	ulint*		page_arr;
@@ -259,8 +262,10 @@ buf_LRU_drop_page_hash_for_tablespace(
 	zip_size = fil_space_get_zip_size(id);
 
 	if (UNIV_UNLIKELY(zip_size == ULINT_UNDEFINED)) {
-		/* Somehow, the tablespace does not exist.  Nothing to drop. */
-		ut_ad(0);
+		/* Somehow, the tablespace does not exist.  Nothing to drop.
+		The table of index may have been dropped after the caller
+		released the dictionary latches. */
+		ut_ad(index != NULL);
 		return;
 	}
 
@@ -284,7 +289,9 @@ scan_again:
 		if (buf_page_get_state(bpage) != BUF_BLOCK_FILE_PAGE
 		    || bpage->space != id
 		    || bpage->buf_fix_count > 0
-		    || bpage->io_fix != BUF_IO_NONE) {
+		    || bpage->io_fix != BUF_IO_NONE
+		    || (index != NULL
+			&& ((buf_block_t*) bpage)->index != index)) {
 			/* We leave the fixed pages as is in this scan.
 			To be dealt with later in the final scan. */
 			mutex_exit(block_mutex);
@@ -343,6 +350,24 @@ next_page:
 	ut_free(page_arr);
 }
 
+/******************************************************************//**
+Drops the adaptive hash index entries that point to the pages of an
+index, before the index is evicted from the dictionary cache. This is a
+'best effort' attempt like buf_LRU_drop_page_hash_for_tablespace():
+the caller must check btr_search_info_get_ref_count() afterwards. The
+caller need not hold any dictionary latch: index is only compared with
+the index pointers of the blocks, and it cannot be freed while any of
+them points to it. */
+UNIV_INTERN
+void
+buf_LRU_drop_page_hash_for_index(
+/*=============================*/
+	ulint			space,	/*!< in: index->space */
+	const dict_index_t*	index)	/*!< in: index, possibly freed */
+{
+	buf_LRU_drop_page_hash_for_tablespace(space, index);
+}
+
 /******************************************************************//**
 Invalidates all pages belonging to a given tablespace when we are deleting
 the data file(s) of that tablespace. */
@@ -361,7 +386,7 @@ buf_LRU_invalidate_tablespace(
 	attempt and does not guarantee that all pages hash entries
 	will be dropped. We get rid of remaining page hash entries
 	one by one below. */
-	buf_LRU_drop_page_hash_for_tablespace(id);
+	buf_LRU_drop_page_hash_for_tablespace(id, NULL);
 
 scan_again:
 	buf_pool_mutex_enter();
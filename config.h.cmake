@@ -22,6 +22,7 @@
 #cmakedefine HAVE_GETCWD
 #cmakedefine HAVE_GETPAGESIZE
 #cmakedefine HAVE_GETRUSAGE
+#cmakedefine HAVE_IB_PAUSE_INSTRUCTION
 #cmakedefine HAVE_INDEX
 #cmakedefine HAVE_INT16_T
 #cmakedefine HAVE_INT32_T
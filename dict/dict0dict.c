@@ -36,6 +36,7 @@ UNIV_INTERN dict_index_t*	dict_ind_compact;
 
 #ifndef UNIV_HOTBACKUP
 #include "buf0buf.h"
+#include "buf0lru.h"
 #include "data0type.h"
 #include "mach0data.h"
 #include "dict0boot.h"
@@ -78,6 +79,13 @@ UNIV_INTERN rw_lock_t	dict_operation_lock;
 					hash table fixed size in bytes */
 #define DICT_POOL_PER_VARYING	4	/*!< buffer pool max size per data
 					dictionary varying size in bytes */
+#define DICT_HASH_N_MUTEXES	64	/*!< number of mutexes protecting
+					each of the hash tables of tables;
+					must be a power of 2 */
+#define DICT_EVICT_MAX_VISITS	128	/*!< most tables that one pass of
+					dict_make_room_in_cache() looks at */
+#define DICT_EVICT_BATCH	32	/*!< most tables that one pass of
+					dict_make_room_in_cache() evicts */
 
 /** Identifies generated InnoDB foreign key names */
 UNIV_STATIC char	dict_ibfk[] = "_ibfk_";
@@ -259,6 +267,17 @@ dict_table_decrement_handle_count(
 	dict_table_t*	table,		/*!< in/out: table */
 	ibool		dict_locked)	/*!< in: TRUE=data dictionary locked */
 {
+#ifdef HAVE_ATOMIC_BUILTINS
+	ulint	n_handles;
+
+	UT_NOT_USED(dict_locked);
+
+	n_handles = os_atomic_increment_ulint(
+		&table->n_handles_opened, (ulint) -1);
+
+	/* The count before the decrement must have been positive. */
+	ut_a(n_handles + 1 > 0);
+#else /* HAVE_ATOMIC_BUILTINS */
 	if (!dict_locked) {
 		mutex_enter(&dict_sys->mutex);
 	}
@@ -271,6 +290,7 @@ dict_table_decrement_handle_count(
 	if (!dict_locked) {
 		mutex_exit(&dict_sys->mutex);
 	}
+#endif /* HAVE_ATOMIC_BUILTINS */
 }
 
 /************************************************************************
@@ -282,6 +302,13 @@ dict_table_increment_handle_count(
 	dict_table_t*	table,		/*!< in/out: table */
 	ibool		dict_locked)	/*!< in: TRUE=data dictionary locked */
 {
+#ifdef HAVE_ATOMIC_BUILTINS
+	/* dict_table_get_nolock() increments the count without
+	dict_sys->mutex. */
+	UT_NOT_USED(dict_locked);
+
+	os_atomic_increment_ulint(&table->n_handles_opened, 1);
+#else /* HAVE_ATOMIC_BUILTINS */
 	if (!dict_locked) {
 		mutex_enter(&dict_sys->mutex);
 	}
@@ -293,6 +320,38 @@ dict_table_increment_handle_count(
 	if (!dict_locked) {
 		mutex_exit(&dict_sys->mutex);
 	}
+#endif /* HAVE_ATOMIC_BUILTINS */
+}
+
+/********************************************************************//**
+Marks a table completely loaded, so that dict_table_get_nolock() and
+dict_table_get_on_id_nolock() may return it. */
+UNIV_STATIC
+void
+dict_table_set_loaded(
+/*==================*/
+	dict_table_t*	table)	/*!< in/out: table */
+{
+	ulint	fold;
+	ulint	id_fold;
+
+	ut_ad(mutex_own(&dict_sys->mutex));
+
+	if (table->loaded) {
+
+		return;
+	}
+
+	fold = ut_fold_string(table->name);
+	id_fold = ut_fold_dulint(table->id);
+
+	hash_mutex_enter(dict_sys->table_hash, fold);
+	hash_mutex_enter(dict_sys->table_id_hash, id_fold);
+
+	table->loaded = TRUE;
+
+	hash_mutex_exit(dict_sys->table_id_hash, id_fold);
+	hash_mutex_exit(dict_sys->table_hash, fold);
 }
 #endif /* !UNIV_HOTBACKUP */
 
@@ -608,7 +667,19 @@ dict_init(void)
 	dict_sys->table_id_hash = hash_create(buf_pool_get_curr_size()
 					      / (DICT_POOL_PER_TABLE_HASH
 						 * UNIV_WORD_SIZE));
+	hash_create_mutexes(dict_sys->table_hash, DICT_HASH_N_MUTEXES,
+			    SYNC_DICT_NAME_HASH);
+	hash_create_mutexes(dict_sys->table_id_hash, DICT_HASH_N_MUTEXES,
+			    SYNC_DICT_ID_HASH);
+	dict_sys->n_hits = 0;
+	dict_sys->n_misses = 0;
+	dict_sys->n_evicted = 0;
+	dict_sys->nolock_hits = mem_alloc(2 * DICT_HASH_N_MUTEXES
+					  * sizeof(dict_hit_counter_t));
+	memset(dict_sys->nolock_hits, 0x0,
+	       2 * DICT_HASH_N_MUTEXES * sizeof(dict_hit_counter_t));
 	dict_sys->size = 0;
+	dict_sys->version = 0;
 
 	UT_LIST_INIT(dict_sys->table_LRU);
 
@@ -633,15 +704,23 @@ dict_table_get(
 {
 	dict_table_t*	table;
 
-	mutex_enter(&dict_sys->mutex);
+	table = dict_table_get_nolock(table_name, ref_count);
 
-	table = dict_table_get_low(table_name);
+	if (table == NULL) {
+		mutex_enter(&dict_sys->mutex);
 
-	if (ref_count && table != NULL) {
-		dict_table_increment_handle_count(table, TRUE);
-	}
+		table = dict_table_get_low(table_name);
 
-	mutex_exit(&dict_sys->mutex);
+		if (table != NULL) {
+			if (ref_count) {
+				dict_table_increment_handle_count(table, TRUE);
+			}
+
+			dict_table_set_loaded(table);
+		}
+
+		mutex_exit(&dict_sys->mutex);
+	}
 
 	if (table != NULL && !table->stat_initialized) {
 		/* If table->ibd_file_missing == TRUE, this will
@@ -672,11 +751,141 @@ dict_table_get_using_id(
 
 	table = dict_table_get_on_id_low(recovery, table_id);
 
-	if (ref_count && table != NULL) {
-		dict_table_increment_handle_count(table, TRUE);
+	if (table != NULL) {
+		if (ref_count) {
+			dict_table_increment_handle_count(table, TRUE);
+		}
+
+		dict_table_set_loaded(table);
+	}
+
+	return(table);
+}
+
+/**********************************************************************//**
+Looks up a completely loaded table by name in the dictionary cache without
+reserving dict_sys->mutex, and optionally increments its open handle count.
+The lookup fails while dict_operation_lock is reserved in exclusive mode.
+@return	table, NULL if the caller must look the table up with dict_sys->mutex */
+UNIV_INTERN
+dict_table_t*
+dict_table_get_nolock(
+/*==================*/
+	const char*	table_name,	/*!< in: table name */
+	ibool		ref_count)	/*!< in: whether to increment the open
+					handle count on the table */
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	dict_table_t*	table;
+	ulint		fold;
+
+	ut_ad(table_name);
+
+	fold = ut_fold_string(table_name);
+
+	hash_mutex_enter(dict_sys->table_hash, fold);
+
+	/* Data dictionary operations may change or free the table
+	objects. dict_lock_data_dictionary() waits for the threads
+	holding hash mutexes after reserving dict_operation_lock, so
+	no handle can be opened here after the operation has checked
+	that a table has none. */
+
+	if (rw_lock_get_writer(&dict_operation_lock) != RW_LOCK_NOT_LOCKED) {
+		table = NULL;
+	} else {
+		HASH_SEARCH(name_hash, dict_sys->table_hash, fold,
+			    dict_table_t*, table, ut_ad(table->cached),
+			    !strcmp(table->name, table_name));
+
+		if (table != NULL && !table->loaded) {
+			table = NULL;
+		} else if (table != NULL) {
+			if (ref_count) {
+				dict_table_increment_handle_count(
+					table, FALSE);
+			}
+
+			dict_sys->nolock_hits[hash_get_mutex_no(
+					dict_sys->table_hash, fold)].n++;
+
+			if (!table->accessed) {
+				table->accessed = TRUE;
+			}
+		}
+	}
+
+	hash_mutex_exit(dict_sys->table_hash, fold);
+
+	return(table);
+#else /* HAVE_ATOMIC_BUILTINS */
+	/* The open handle counts are protected by dict_sys->mutex. */
+	UT_NOT_USED(table_name);
+	UT_NOT_USED(ref_count);
+
+	return(NULL);
+#endif /* HAVE_ATOMIC_BUILTINS */
+}
+
+/**********************************************************************//**
+Looks up a completely loaded table by id in the dictionary cache without
+reserving dict_sys->mutex, and optionally increments its open handle count.
+The lookup fails while dict_operation_lock is reserved in exclusive mode.
+@return	table, NULL if the caller must look the table up with dict_sys->mutex */
+UNIV_INTERN
+dict_table_t*
+dict_table_get_on_id_nolock(
+/*========================*/
+	dulint		table_id,	/*!< in: table id */
+	ibool		ref_count)	/*!< in: whether to increment the open
+					handle count on the table */
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	dict_table_t*	table;
+	ulint		fold;
+
+	fold = ut_fold_dulint(table_id);
+
+	hash_mutex_enter(dict_sys->table_id_hash, fold);
+
+	/* See dict_table_get_nolock(). */
+
+	if (rw_lock_get_writer(&dict_operation_lock) != RW_LOCK_NOT_LOCKED) {
+		table = NULL;
+	} else {
+		HASH_SEARCH(id_hash, dict_sys->table_id_hash, fold,
+			    dict_table_t*, table, ut_ad(table->cached),
+			    !ut_dulint_cmp(table->id, table_id));
+
+		if (table != NULL && !table->loaded) {
+			table = NULL;
+		} else if (table != NULL) {
+			if (ref_count) {
+				dict_table_increment_handle_count(
+					table, FALSE);
+			}
+
+			dict_sys->nolock_hits[DICT_HASH_N_MUTEXES
+					      + hash_get_mutex_no(
+						      dict_sys->table_id_hash,
+						      fold)].n++;
+
+			if (!table->accessed) {
+				table->accessed = TRUE;
+			}
+		}
 	}
 
+	hash_mutex_exit(dict_sys->table_id_hash, fold);
+
 	return(table);
+#else /* HAVE_ATOMIC_BUILTINS */
+	/* The open handle counts are protected by dict_sys->mutex. */
+	UT_NOT_USED(table_id);
+	UT_NOT_USED(ref_count);
+
+	return(NULL);
+#endif /* HAVE_ATOMIC_BUILTINS */
 }
 
 /**************************************************************************
@@ -748,6 +957,7 @@ dict_table_add_to_cache(
 	dict_table_add_system_columns(table, heap);
 
 	table->cached = TRUE;
+	table->version = ++dict_sys->version;
 
 	fold = ut_fold_string(table->name);
 	id_fold = ut_fold_dulint(table->id);
@@ -773,9 +983,11 @@ dict_table_add_to_cache(
 	/* Look for a table with the same name: error if such exists */
 	{
 		dict_table_t*	table2;
+		hash_mutex_enter(dict_sys->table_hash, fold);
 		HASH_SEARCH(name_hash, dict_sys->table_hash, fold,
 			    dict_table_t*, table2, ut_ad(table2->cached),
 			    ut_strcmp(table2->name, table->name) == 0);
+		hash_mutex_exit(dict_sys->table_hash, fold);
 		ut_a(table2 == NULL);
 
 #ifdef UNIV_DEBUG
@@ -790,9 +1002,11 @@ dict_table_add_to_cache(
 	/* Look for a table with the same id: error if such exists */
 	{
 		dict_table_t*	table2;
+		hash_mutex_enter(dict_sys->table_id_hash, id_fold);
 		HASH_SEARCH(id_hash, dict_sys->table_id_hash, id_fold,
 			    dict_table_t*, table2, ut_ad(table2->cached),
 			    ut_dulint_cmp(table2->id, table->id) == 0);
+		hash_mutex_exit(dict_sys->table_id_hash, id_fold);
 		ut_a(table2 == NULL);
 
 #ifdef UNIV_DEBUG
@@ -805,12 +1019,16 @@ dict_table_add_to_cache(
 	}
 
 	/* Add table to hash table of tables */
+	hash_mutex_enter(dict_sys->table_hash, fold);
 	HASH_INSERT(dict_table_t, name_hash, dict_sys->table_hash, fold,
 		    table);
+	hash_mutex_exit(dict_sys->table_hash, fold);
 
 	/* Add table to hash table of tables based on table id */
+	hash_mutex_enter(dict_sys->table_id_hash, id_fold);
 	HASH_INSERT(dict_table_t, id_hash, dict_sys->table_id_hash, id_fold,
 		    table);
+	hash_mutex_exit(dict_sys->table_id_hash, id_fold);
 	/* Add table to LRU list of tables */
 	UT_LIST_ADD_FIRST(table_LRU, dict_sys->table_LRU, table);
 
@@ -874,6 +1092,8 @@ dict_table_rename_in_cache(
 	ut_ad(table);
 	ut_ad(mutex_own(&(dict_sys->mutex)));
 
+	table->version = ++dict_sys->version;
+
 	old_size = mem_heap_get_size(table->heap);
 	old_name = table->name;
 
@@ -882,9 +1102,11 @@ dict_table_rename_in_cache(
 	/* Look for a table with the same name: error if such exists */
 	{
 		dict_table_t*	table2;
+		hash_mutex_enter(dict_sys->table_hash, fold);
 		HASH_SEARCH(name_hash, dict_sys->table_hash, fold,
 			    dict_table_t*, table2, ut_ad(table2->cached),
 			    (ut_strcmp(table2->name, new_name) == 0));
+		hash_mutex_exit(dict_sys->table_hash, fold);
 		if (UNIV_LIKELY_NULL(table2)) {
 			ut_print_timestamp(ib_stream);
 			ib_logger(ib_stream,
@@ -921,13 +1143,17 @@ dict_table_rename_in_cache(
 	}
 
 	/* Remove table from the hash tables of tables */
+	hash_mutex_enter(dict_sys->table_hash, ut_fold_string(old_name));
 	HASH_DELETE(dict_table_t, name_hash, dict_sys->table_hash,
 		    ut_fold_string(old_name), table);
+	hash_mutex_exit(dict_sys->table_hash, ut_fold_string(old_name));
 	table->name = mem_heap_strdup(table->heap, new_name);
 
 	/* Add table to hash table of tables */
+	hash_mutex_enter(dict_sys->table_hash, fold);
 	HASH_INSERT(dict_table_t, name_hash, dict_sys->table_hash, fold,
 		    table);
+	hash_mutex_exit(dict_sys->table_hash, fold);
 	dict_sys->size += (mem_heap_get_size(table->heap) - old_size);
 
 	/* Update the table_name field in indexes */
@@ -1086,13 +1312,17 @@ dict_table_change_id_in_cache(
 
 	/* Remove the table from the hash table of id's */
 
+	hash_mutex_enter(dict_sys->table_id_hash, ut_fold_dulint(table->id));
 	HASH_DELETE(dict_table_t, id_hash, dict_sys->table_id_hash,
 		    ut_fold_dulint(table->id), table);
+	hash_mutex_exit(dict_sys->table_id_hash, ut_fold_dulint(table->id));
 	table->id = new_id;
 
 	/* Add the table back to the hash table */
+	hash_mutex_enter(dict_sys->table_id_hash, ut_fold_dulint(table->id));
 	HASH_INSERT(dict_table_t, id_hash, dict_sys->table_id_hash,
 		    ut_fold_dulint(table->id), table);
+	hash_mutex_exit(dict_sys->table_id_hash, ut_fold_dulint(table->id));
 }
 
 /**********************************************************************//**
@@ -1146,10 +1376,14 @@ dict_table_remove_from_cache(
 	}
 
 	/* Remove table from the hash tables of tables */
+	hash_mutex_enter(dict_sys->table_hash, ut_fold_string(table->name));
 	HASH_DELETE(dict_table_t, name_hash, dict_sys->table_hash,
 		    ut_fold_string(table->name), table);
+	hash_mutex_exit(dict_sys->table_hash, ut_fold_string(table->name));
+	hash_mutex_enter(dict_sys->table_id_hash, ut_fold_dulint(table->id));
 	HASH_DELETE(dict_table_t, id_hash, dict_sys->table_id_hash,
 		    ut_fold_dulint(table->id), table);
+	hash_mutex_exit(dict_sys->table_id_hash, ut_fold_dulint(table->id));
 
 	/* Remove table from LRU list of tables */
 	UT_LIST_REMOVE(table_LRU, dict_sys->table_LRU, table);
@@ -1484,6 +1718,12 @@ dict_index_add_to_cache(
 		return(DB_CORRUPTION);
 	}
 
+	if (!dict_index_is_clust(index)) {
+		/* Insert graphs that were built before do not maintain
+		the new index. */
+		table->version = ++dict_sys->version;
+	}
+
 	/* Build the cache internal representation of the index,
 	containing also the added system fields */
 
@@ -1629,6 +1869,8 @@ dict_index_remove_from_cache(
 	ut_ad(index->magic_n == DICT_INDEX_MAGIC_N);
 	ut_ad(mutex_own(&(dict_sys->mutex)));
 
+	table->version = ++dict_sys->version;
+
 	/* We always create search info whether or not adaptive
 	hash index is enabled or not. */
 	info = index->search_info;
@@ -4846,6 +5088,37 @@ dict_unfreeze_data_dictionary(
 	trx->dict_operation_lock_mode = 0;
 }
 
+/*************************************************************************
+Waits for the threads that may have searched the hash tables of tables
+in dict_table_get_nolock() or dict_table_get_on_id_nolock() before the
+caller reserved dict_operation_lock in exclusive mode. The threads that
+reserve a hash mutex after this will see the exclusive lock. */
+UNIV_STATIC
+void
+dict_hash_wait_for_readers(void)
+/*============================*/
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	ulint	i;
+
+# ifdef UNIV_SYNC_DEBUG
+	ut_ad(rw_lock_own(&dict_operation_lock, RW_LOCK_EX));
+# endif /* UNIV_SYNC_DEBUG */
+
+	for (i = 0; i < DICT_HASH_N_MUTEXES; i++) {
+		mutex_t*	mutex;
+
+		mutex = hash_get_nth_mutex(dict_sys->table_hash, i);
+		mutex_enter(mutex);
+		mutex_exit(mutex);
+
+		mutex = hash_get_nth_mutex(dict_sys->table_id_hash, i);
+		mutex_enter(mutex);
+		mutex_exit(mutex);
+	}
+#endif /* HAVE_ATOMIC_BUILTINS */
+}
+
 /*************************************************************************
 Locks the data dictionary exclusively for performing a table create or other
 data dictionary modification operation. */
@@ -4865,6 +5138,8 @@ dict_lock_data_dictionary(
 	trx->dict_operation_lock_mode = RW_X_LATCH;
 
 	mutex_enter(&(dict_sys->mutex));
+
+	dict_hash_wait_for_readers();
 }
 
 /*************************************************************************
@@ -4886,6 +5161,279 @@ dict_unlock_data_dictionary(
 	trx->dict_operation_lock_mode = 0;
 }
 
+/**********************************************************************//**
+Checks if a table is unused, so that it may be evicted from the dictionary
+cache. Does not look at the table locks or at the adaptive hash index.
+@return	TRUE if the table may be evicted */
+UNIV_STATIC
+ibool
+dict_table_can_be_evicted_low(
+/*==========================*/
+	const dict_table_t*	table)	/*!< in: table */
+{
+	const dict_index_t*	index;
+
+	ut_ad(mutex_own(&dict_sys->mutex));
+
+	/* The system tables and the insert buffer trees are never
+	evicted. A table that nobody has looked up may still be in
+	the middle of a CREATE TABLE. */
+	if (ut_dulint_cmp(table->id, DICT_FIELDS_ID) <= 0
+	    || ut_dulint_cmp(table->id, DICT_IBUF_ID_MIN) >= 0
+	    || !table->loaded
+	    || table->ibd_file_missing
+	    || table->n_handles_opened > 0
+	    || table->n_foreign_key_checks_running > 0
+	    || UT_LIST_GET_LEN(table->foreign_list) > 0
+	    || UT_LIST_GET_LEN(table->referenced_list) > 0) {
+
+		return(FALSE);
+	}
+
+	for (index = dict_table_get_first_index(table);
+	     index != NULL;
+	     index = dict_table_get_next_index(index)) {
+
+		if (dict_index_is_online(index)) {
+
+			return(FALSE);
+		}
+	}
+
+	return(TRUE);
+}
+
+/**********************************************************************//**
+Checks if a table can be evicted from the dictionary cache now.
+@return	TRUE if the table can be evicted */
+UNIV_STATIC
+ibool
+dict_table_can_be_evicted(
+/*======================*/
+	const dict_table_t*	table)	/*!< in: table */
+{
+	const dict_index_t*	index;
+	ibool			locked;
+
+	ut_ad(mutex_own(&dict_sys->mutex));
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(rw_lock_own(&dict_operation_lock, RW_LOCK_EX));
+#endif /* UNIV_SYNC_DEBUG */
+
+	if (!dict_table_can_be_evicted_low(table)) {
+
+		return(FALSE);
+	}
+
+	mutex_enter(&kernel_mutex);
+	locked = UT_LIST_GET_LEN(table->locks) > 0;
+	mutex_exit(&kernel_mutex);
+
+	if (locked) {
+
+		return(FALSE);
+	}
+
+	/* dict_index_remove_from_cache() would wait until the adaptive
+	hash index entries that point to the index have been dropped.
+	Leave the table for the next round. */
+	for (index = dict_table_get_first_index(table);
+	     index != NULL;
+	     index = dict_table_get_next_index(index)) {
+
+		if (btr_search_info_get_ref_count(index->search_info) > 0) {
+
+			return(FALSE);
+		}
+	}
+
+	return(TRUE);
+}
+
+/**********************************************************************//**
+Evicts unused tables from the end of dict_sys->table_LRU until the
+dictionary cache holds at most srv_dict_cache_max_tables tables. One call
+looks at no more than DICT_EVICT_MAX_VISITS tables and evicts no more than
+DICT_EVICT_BATCH tables.
+@return	number of tables evicted */
+UNIV_INTERN
+ulint
+dict_make_room_in_cache(void)
+/*=========================*/
+{
+	dict_table_t*		table;
+	ulint			n_visits;
+	ulint			n_wanted;
+	ulint			i;
+	dulint			ids[DICT_EVICT_BATCH];
+	ulint			n_ids		= 0;
+	ulint			ahi_space[DICT_EVICT_BATCH];
+	const dict_index_t*	ahi_index[DICT_EVICT_BATCH];
+	ulint			n_ahi		= 0;
+	ulint			n_evicted	= 0;
+	ulint			max_tables	= srv_dict_cache_max_tables;
+
+	/* Unlatched check: do not disturb the lookups when there
+	is room. */
+	if (max_tables == 0
+	    || UT_LIST_GET_LEN(dict_sys->table_LRU) <= max_tables) {
+
+		return(0);
+	}
+
+	/* Pick the candidates holding only dict_sys->mutex, which the
+	lookups of the tables in the cache do not need. */
+
+	mutex_enter(&dict_sys->mutex);
+
+	n_wanted = UT_LIST_GET_LEN(dict_sys->table_LRU);
+
+	if (n_wanted <= max_tables) {
+		mutex_exit(&dict_sys->mutex);
+
+		return(0);
+	}
+
+	n_wanted = ut_min(n_wanted - max_tables, DICT_EVICT_BATCH);
+
+	/* The lookups do not move the tables in table_LRU, because
+	the lookups that do not reserve dict_sys->mutex are not allowed
+	to. Instead they set dict_table_t::accessed, and we give each
+	accessed table a second chance by moving it to the start of
+	the list (the CLOCK approximation of LRU). Tables that are in
+	use are moved there too, so that the next pass looks at other
+	tables. */
+	table = UT_LIST_GET_LAST(dict_sys->table_LRU);
+
+	for (n_visits = 0;
+	     table != NULL && n_visits < DICT_EVICT_MAX_VISITS
+	     && n_ids < n_wanted;
+	     n_visits++) {
+
+		dict_table_t*		prev_table;
+		const dict_index_t*	index;
+		ulint			n_hashed	= 0;
+
+		prev_table = UT_LIST_GET_PREV(table_LRU, table);
+
+		if (table->accessed || !dict_table_can_be_evicted_low(table)) {
+			table->accessed = FALSE;
+
+			UT_LIST_REMOVE(table_LRU, dict_sys->table_LRU, table);
+			UT_LIST_ADD_FIRST(table_LRU, dict_sys->table_LRU,
+					  table);
+
+			table = prev_table;
+			continue;
+		}
+
+		for (index = dict_table_get_first_index(table);
+		     index != NULL;
+		     index = dict_table_get_next_index(index)) {
+
+			if (btr_search_info_get_ref_count(
+				    index->search_info) > 0) {
+
+				n_hashed++;
+			}
+		}
+
+		if (n_ahi + n_hashed <= DICT_EVICT_BATCH) {
+
+			for (index = dict_table_get_first_index(table);
+			     index != NULL;
+			     index = dict_table_get_next_index(index)) {
+
+				if (btr_search_info_get_ref_count(
+					    index->search_info) > 0) {
+
+					ahi_space[n_ahi] = index->space;
+					ahi_index[n_ahi] = index;
+					n_ahi++;
+				}
+			}
+
+			ids[n_ids++] = table->id;
+		}
+
+		table = prev_table;
+	}
+
+	mutex_exit(&dict_sys->mutex);
+
+	/* Drop the adaptive hash index entries without holding any
+	dictionary latch: this scans the whole buffer pool. The indexes
+	cannot be freed while entries point to them. */
+	for (i = 0; i < n_ahi; i++) {
+		buf_LRU_drop_page_hash_for_index(ahi_space[i], ahi_index[i]);
+	}
+
+	if (n_ids == 0) {
+
+		return(0);
+	}
+
+	rw_lock_x_lock(&dict_operation_lock);
+	mutex_enter(&dict_sys->mutex);
+
+	/* Make sure that no thread is between the lookup of a table
+	in dict_table_get_nolock() and the increment of its handle
+	count, and that no thread sets dict_table_t::accessed while
+	we look at it. */
+	dict_hash_wait_for_readers();
+
+	for (i = 0; i < n_ids; i++) {
+		ulint	fold	= ut_fold_dulint(ids[i]);
+
+		/* The table may have been dropped or evicted by another
+		thread since we released dict_sys->mutex. */
+		hash_mutex_enter(dict_sys->table_id_hash, fold);
+		HASH_SEARCH(id_hash, dict_sys->table_id_hash, fold,
+			    dict_table_t*, table, ut_ad(table->cached),
+			    !ut_dulint_cmp(table->id, ids[i]));
+		hash_mutex_exit(dict_sys->table_id_hash, fold);
+
+		if (table != NULL && !table->accessed
+		    && dict_table_can_be_evicted(table)) {
+
+			dict_table_remove_from_cache(table);
+			dict_sys->n_evicted++;
+			n_evicted++;
+		}
+	}
+
+	mutex_exit(&dict_sys->mutex);
+	rw_lock_x_unlock(&dict_operation_lock);
+
+	return(n_evicted);
+}
+
+/**********************************************************************//**
+Gets the counters of the dictionary cache. The counters are read without
+a latch. */
+UNIV_INTERN
+void
+dict_get_cache_stats(
+/*=================*/
+	ulint*	n_tables,	/*!< out: number of cached tables */
+	ulint*	n_hits,		/*!< out: number of lookups that found
+				the table in the cache */
+	ulint*	n_misses,	/*!< out: number of lookups that had to
+				load the table */
+	ulint*	n_evicted)	/*!< out: number of evicted tables */
+{
+	ulint	i;
+
+	*n_tables = UT_LIST_GET_LEN(dict_sys->table_LRU);
+	*n_hits = dict_sys->n_hits;
+	*n_misses = dict_sys->n_misses;
+	*n_evicted = dict_sys->n_evicted;
+
+	for (i = 0; i < 2 * DICT_HASH_N_MUTEXES; i++) {
+		*n_hits += dict_sys->nolock_hits[i].n;
+	}
+}
+
 /**************************************************************************
 Closes the data dictionary module. */
 UNIV_INTERN
@@ -4918,12 +5466,16 @@ dict_close(void)
 		}
 	}
 
+	hash_free_mutexes(dict_sys->table_hash);
 	hash_table_free(dict_sys->table_hash);
 
 	/* The elements are the same instance as in dict_sys->table_hash,
 	therefore we don't delete the individual elements. */
+	hash_free_mutexes(dict_sys->table_id_hash);
 	hash_table_free(dict_sys->table_id_hash);
 
+	mem_free(dict_sys->nolock_hits);
+
 	/* Acquire only because it's a pre-condition. */
 	mutex_enter(&dict_sys->mutex);
 
@@ -105,10 +105,23 @@ Some operating systems do not support many open files at the same time,
 though NT seems to tolerate at least 900 open files. Therefore, we put the
 open files in an LRU-list. If we need to open another file, we may close the
 file at the end of the LRU-list. When an i/o-operation is pending on a file,
-the file cannot be closed. We take the file nodes with pending i/o-operations
-out of the LRU-list and keep a count of pending operations. When an operation
-completes, we decrement the count and return the file node to the LRU-list if
-the count drops to zero. */
+the file cannot be closed. We keep a count of pending operations in each file
+node, and skip the nodes with pending operations when we look for a file to
+close.
+
+An i/o on a file that is already open does not reserve fil_system->mutex.
+The hash table of spaces has an array of mutexes, and fil_io() looks up the
+space and increments the pending i/o count of the file node holding only the
+mutex of the hash cell. The pending i/o counts are updated with atomic
+operations, so that a completed read only decrements the count. The space
+objects are inserted to and removed from the hash table, and the files are
+opened and closed, holding both fil_system->mutex and the hash cell mutex.
+Since fil_io() cannot move the file node in the LRU-list without
+fil_system->mutex, it sets a flag in the node instead, and the node gets a
+second chance when we look for a file to close. */
+
+/** Number of mutexes protecting fil_system->spaces; a power of 2 */
+#define FIL_SPACE_HASH_N_MUTEXES	64
 
 /** The number of fsyncs done to the log */
 UNIV_INTERN ulint	fil_n_log_flushes			= 0;
@@ -136,7 +149,10 @@ struct fil_node_struct {
 	ulint		n_pending;
 				/*!< count of pending i/o's on this file;
 				closing of the file is not allowed if
-				this is > 0 */
+				this is > 0; updated with atomic operations
+				if HAVE_ATOMIC_BUILTINS, and incremented
+				only while holding fil_system->mutex or
+				the fil_system->spaces mutex of the space */
 	ulint		n_pending_flushes;
 				/*!< count of pending flushes on this file;
 				closing of the file is not allowed if
@@ -150,6 +166,10 @@ struct fil_node_struct {
 				/*!< link field for the file chain */
 	UT_LIST_NODE_T(fil_node_t) LRU;
 				/*!< link field for the LRU list */
+	ibool		accessed;/*!< TRUE if fil_io() has used the open
+				file since fil_try_to_close_file_in_LRU()
+				last moved the node to the start of the
+				LRU list */
 	ulint		magic_n;/*!< FIL_NODE_MAGIC_N */
 };
 
@@ -239,16 +259,16 @@ struct fil_system_struct {
 #endif /* !UNIV_HOTBACKUP */
 	hash_table_t*	spaces;		/*!< The hash table of spaces in the
 					system; they are hashed on the space
-					id */
+					id; modified while holding both the
+					mutex above and the mutex of the hash
+					cell, and searched holding either */
 	hash_table_t*	name_hash;	/*!< hash table based on the space
 					name */
 	UT_LIST_BASE_NODE_T(fil_node_t) LRU;
 					/*!< base node for the LRU list of the
-					most recently used open files with no
-					pending i/o's; if we start an i/o on
-					the file, we first remove it from this
-					list, and return it to the start of
-					the list when the i/o ends;
+					most recently used open files; the
+					files with pending i/o's stay in the
+					list but are not closed;
 					log files and the system tablespace are
 					not put to this list: they are opened
 					after the startup, and kept open until
@@ -388,6 +408,48 @@ fil_space_free(
 				/* out: TRUE if success */
 	ulint		id,	/* in: space id */
 	ibool		own_mutex);/* in: TRUE if own system->mutex */
+/********************************************************************//**
+Increments the count of pending i/o's on a file node. The caller must hold
+the fil_system mutex or the fil_system->spaces mutex of the space. */
+UNIV_INLINE
+void
+fil_node_inc_pending(
+/*=================*/
+	fil_node_t*	node)	/*!< in/out: file node */
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	os_atomic_increment_ulint(&node->n_pending, 1);
+#else /* HAVE_ATOMIC_BUILTINS */
+	ut_ad(mutex_own(&fil_system->mutex));
+
+	node->n_pending++;
+#endif /* HAVE_ATOMIC_BUILTINS */
+}
+
+/********************************************************************//**
+Decrements the count of pending i/o's on a file node. Without atomic
+builtins, the caller must hold the fil_system mutex. */
+UNIV_INLINE
+void
+fil_node_dec_pending(
+/*=================*/
+	fil_node_t*	node)	/*!< in/out: file node */
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	ulint	n_pending;
+
+	n_pending = os_atomic_increment_ulint(&node->n_pending, (ulint) -1);
+
+	/* The count before the decrement must have been positive. */
+	ut_a(n_pending + 1 > 0);
+#else /* HAVE_ATOMIC_BUILTINS */
+	ut_ad(mutex_own(&fil_system->mutex));
+	ut_a(node->n_pending > 0);
+
+	node->n_pending--;
+#endif /* HAVE_ATOMIC_BUILTINS */
+}
+
 /********************************************************************//**
 Reset variables. */
 UNIV_INTERN
@@ -471,11 +533,15 @@ fil_space_get_by_id(
 
 	ut_ad(mutex_own(&fil_system->mutex));
 
+	hash_mutex_enter(fil_system->spaces, id);
+
 	HASH_SEARCH(hash, fil_system->spaces, id,
 		    fil_space_t*, space,
 		    ut_ad(space->magic_n == FIL_SPACE_MAGIC_N),
 		    space->id == id);
 
+	hash_mutex_exit(fil_system->spaces, id);
+
 	return(space);
 }
 
@@ -646,6 +712,7 @@ fil_node_create(
 	node->magic_n = FIL_NODE_MAGIC_N;
 	node->n_pending = 0;
 	node->n_pending_flushes = 0;
+	node->accessed = FALSE;
 
 	node->modification_counter = 0;
 	node->flush_counter = 0;
@@ -672,7 +739,9 @@ fil_node_create(
 
 	node->space = space;
 
+	hash_mutex_enter(fil_system->spaces, id);
 	UT_LIST_ADD_LAST(chain, space->chain, node);
+	hash_mutex_exit(fil_system->spaces, id);
 
 	if (id < SRV_LOG_SPACE_FIRST_ID && fil_system->max_assigned_id < id) {
 
@@ -848,7 +917,10 @@ add_size:
 
 	ut_a(ret);
 
+	/* fil_io() may use the handle as soon as it sees the flag */
+	hash_mutex_enter(system->spaces, space->id);
 	node->open = TRUE;
+	hash_mutex_exit(system->spaces, space->id);
 
 	system->n_open++;
 
@@ -859,7 +931,9 @@ add_size:
 }
 
 /**********************************************************************//**
-Closes a file. */
+Closes a file. The caller must hold the fil_system mutex and the
+fil_system->spaces mutex of the space, so that fil_io() cannot start an
+i/o on the file. */
 UNIV_STATIC
 void
 fil_node_close_file(
@@ -871,6 +945,7 @@ fil_node_close_file(
 
 	ut_ad(node && system);
 	ut_ad(mutex_own(&(system->mutex)));
+	ut_ad(mutex_own(hash_get_mutex(system->spaces, node->space->id)));
 	ut_a(node->open);
 	ut_a(node->n_pending == 0);
 	ut_a(node->n_pending_flushes == 0);
@@ -909,10 +984,12 @@ fil_try_to_close_file_in_LRU(
 				cannot close a file */
 {
 	fil_node_t*	node;
+	ulint		n_visits;
 
 	ut_ad(mutex_own(&fil_system->mutex));
 
 	node = UT_LIST_GET_LAST(fil_system->LRU);
+	n_visits = 2 * UT_LIST_GET_LEN(fil_system->LRU);
 
 	if (print_info) {
 		ib_logger(ib_stream,
@@ -920,15 +997,41 @@ fil_try_to_close_file_in_LRU(
 			(ulong) UT_LIST_GET_LEN(fil_system->LRU));
 	}
 
-	while (node != NULL) {
-		if (node->modification_counter == node->flush_counter
+	while (node != NULL && n_visits-- > 0) {
+		fil_node_t*	prev_node = UT_LIST_GET_PREV(LRU, node);
+		mutex_t*	hash_mutex;
+
+		if (node->accessed) {
+			/* fil_io() has used the file since we last
+			looked at it: give it a second chance */
+			node->accessed = FALSE;
+
+			UT_LIST_REMOVE(LRU, fil_system->LRU, node);
+			UT_LIST_ADD_FIRST(LRU, fil_system->LRU, node);
+
+			node = prev_node != NULL
+				? prev_node
+				: UT_LIST_GET_LAST(fil_system->LRU);
+			continue;
+		}
+
+		hash_mutex = hash_get_mutex(fil_system->spaces,
+					    node->space->id);
+		mutex_enter(hash_mutex);
+
+		if (node->n_pending == 0
+		    && node->modification_counter == node->flush_counter
 		    && node->n_pending_flushes == 0) {
 
 			fil_node_close_file(node, fil_system);
 
+			mutex_exit(hash_mutex);
+
 			return(TRUE);
 		}
 
+		mutex_exit(hash_mutex);
+
 		if (print_info && node->n_pending_flushes > 0) {
 			ib_logger(ib_stream, "InnoDB: cannot close file ");
 			ut_print_filename(ib_stream, node->name);
@@ -946,7 +1049,7 @@ fil_try_to_close_file_in_LRU(
 				(long) node->flush_counter);
 		}
 
-		node = UT_LIST_GET_PREV(LRU, node);
+		node = prev_node;
 	}
 
 	return(FALSE);
@@ -1071,7 +1174,8 @@ close_more:
 }
 
 /*******************************************************************//**
-Frees a file node object from a tablespace memory cache. */
+Frees a file node object from a tablespace memory cache. The caller must
+hold the fil_system mutex and the fil_system->spaces mutex of the space. */
 UNIV_STATIC
 void
 fil_node_free(
@@ -1082,6 +1186,7 @@ fil_node_free(
 {
 	ut_ad(node && system && space);
 	ut_ad(mutex_own(&(system->mutex)));
+	ut_ad(mutex_own(hash_get_mutex(system->spaces, space->id)));
 	ut_a(node->magic_n == FIL_NODE_MAGIC_N);
 	ut_a(node->n_pending == 0);
 
@@ -1134,6 +1239,8 @@ fil_space_truncate_start(
 
 	ut_a(space);
 
+	hash_mutex_enter(fil_system->spaces, id);
+
 	while (trunc_len > 0) {
 		node = UT_LIST_GET_FIRST(space->chain);
 
@@ -1144,6 +1251,8 @@ fil_space_truncate_start(
 		fil_node_free(node, fil_system, space);
 	}
 
+	hash_mutex_exit(fil_system->spaces, id);
+
 	mutex_exit(&fil_system->mutex);
 }
 #endif /* UNIV_LOG_ARCHIVE */
@@ -1279,7 +1388,9 @@ try_again:
 
 	rw_lock_create(&space->latch, SYNC_FSP);
 
+	hash_mutex_enter(fil_system->spaces, id);
 	HASH_INSERT(fil_space_t, hash, fil_system->spaces, id, space);
+	hash_mutex_exit(fil_system->spaces, id);
 
 	HASH_INSERT(fil_space_t, name_hash, fil_system->name_hash,
 		    ut_fold_string(name), space);
@@ -1379,7 +1490,10 @@ fil_space_free(
 		return(FALSE);
 	}
 
+	/* After this, fil_io() cannot find the space any more */
+	hash_mutex_enter(fil_system->spaces, id);
 	HASH_DELETE(fil_space_t, hash, fil_system->spaces, id, space);
+	hash_mutex_exit(fil_system->spaces, id);
 
 	namespace = fil_space_get_by_name(space->name);
 	ut_a(namespace);
@@ -1400,6 +1514,8 @@ fil_space_free(
 	ut_a(space->magic_n == FIL_SPACE_MAGIC_N);
 	ut_a(0 == space->n_pending_flushes);
 
+	hash_mutex_enter(fil_system->spaces, id);
+
 	fil_node = UT_LIST_GET_FIRST(space->chain);
 
 	while (fil_node != NULL) {
@@ -1408,6 +1524,8 @@ fil_space_free(
 		fil_node = UT_LIST_GET_FIRST(space->chain);
 	}
 
+	hash_mutex_exit(fil_system->spaces, id);
+
 	ut_a(0 == UT_LIST_GET_LEN(space->chain));
 
 	if (!own_mutex) {
@@ -1582,6 +1700,8 @@ fil_init(
 	mutex_create(&fil_system->mutex, SYNC_ANY_LATCH);
 
 	fil_system->spaces = hash_create(hash_size);
+	hash_create_mutexes(fil_system->spaces, FIL_SPACE_HASH_N_MUTEXES,
+			    SYNC_FIL_SPACE_HASH);
 	fil_system->name_hash = hash_create(hash_size);
 
 	UT_LIST_INIT(fil_system->LRU);
@@ -1598,6 +1718,39 @@ fil_init(
 	UT_LIST_INIT(fil_system->space_list);
 }
 
+/****************************************************************//**
+Changes the maximum number of open files of the tablespace memory cache,
+and closes the files that exceed the new limit if they have no pending
+i/o's or unflushed writes. Does nothing if the cache does not exist. */
+UNIV_INTERN
+void
+fil_set_max_n_open(
+/*===============*/
+	ulint	max_n_open)	/*!< in: max number of open files */
+{
+	ut_a(max_n_open > 0);
+
+	if (fil_system == NULL) {
+		/* fil_init() will be passed srv_max_n_open_files */
+
+		return;
+	}
+
+	mutex_enter(&fil_system->mutex);
+
+	fil_system->max_n_open = max_n_open;
+
+	/* The files that cannot be closed now are closed by
+	fil_mutex_enter_and_prepare_for_io() when it needs to open
+	a file */
+	while (fil_system->n_open > fil_system->max_n_open
+	       && fil_try_to_close_file_in_LRU(FALSE)) {
+		/* No op */
+	}
+
+	mutex_exit(&fil_system->mutex);
+}
+
 /*******************************************************************//**
 Opens all log files and system tablespace data files. They stay open until the
 database server shutdown. This should be called at a server startup after the
@@ -1682,12 +1835,17 @@ fil_close_all_files(void)
 
 		node = UT_LIST_GET_FIRST(space->chain);
 
+		hash_mutex_enter(fil_system->spaces, space->id);
+
 		while (node != NULL) {
 			if (node->open) {
 				fil_node_close_file(node, fil_system);
 			}
 			node = UT_LIST_GET_NEXT(chain, node);
 		}
+
+		hash_mutex_exit(fil_system->spaces, space->id);
+
 		space = UT_LIST_GET_NEXT(space_list, space);
 		fil_space_free(prev_space->id, TRUE);
 	}
@@ -2293,7 +2451,11 @@ try_again:
 	ut_a(space);
 	ut_a(space->n_pending_ibuf_merges == 0);
 
+	/* fil_io() checks the flag holding the hash mutex. The i/o's
+	that it started before we set the flag are in node->n_pending. */
+	hash_mutex_enter(fil_system->spaces, id);
 	space->is_being_deleted = TRUE;
+	hash_mutex_exit(fil_system->spaces, id);
 
 	ut_a(UT_LIST_GET_LEN(space->chain) == 1);
 	node = UT_LIST_GET_FIRST(space->chain);
@@ -2555,6 +2717,8 @@ retry:
 	operating systems can rename an open file. For the closing we have to
 	wait until there are no pending i/o's or flushes on the file. */
 
+	hash_mutex_enter(fil_system->spaces, id);
+
 	space->stop_ios = TRUE;
 
 	ut_a(UT_LIST_GET_LEN(space->chain) == 1);
@@ -2564,6 +2728,7 @@ retry:
 		/* There are pending i/o's or flushes, sleep for a while and
 		retry */
 
+		hash_mutex_exit(fil_system->spaces, id);
 		mutex_exit(&fil_system->mutex);
 
 		os_thread_sleep(20000);
@@ -2573,6 +2738,7 @@ retry:
 	} else if (node->modification_counter > node->flush_counter) {
 		/* Flush the space */
 
+		hash_mutex_exit(fil_system->spaces, id);
 		mutex_exit(&fil_system->mutex);
 
 		os_thread_sleep(20000);
@@ -2587,6 +2753,8 @@ retry:
 		fil_node_close_file(node, fil_system);
 	}
 
+	hash_mutex_exit(fil_system->spaces, id);
+
 	/* Check that the old name in the space is right */
 
 	if (old_name_was_specified) {
@@ -4234,18 +4402,17 @@ fil_node_prepare_for_io(
 		ut_a(node->n_pending == 0);
 
 		fil_node_open_file(node, system, space);
-	}
 
-	if (node->n_pending == 0 && space->purpose == FIL_TABLESPACE
-	    && space->id != 0) {
-		/* The node is in the LRU list, remove it */
+	} else if (space->purpose == FIL_TABLESPACE && space->id != 0) {
+		/* Move the node to the start of the LRU list */
 
 		ut_a(UT_LIST_GET_LEN(system->LRU) > 0);
 
 		UT_LIST_REMOVE(LRU, system->LRU, node);
+		UT_LIST_ADD_FIRST(LRU, system->LRU, node);
 	}
 
-	node->n_pending++;
+	fil_node_inc_pending(node);
 }
 
 /********************************************************************//**
@@ -4265,10 +4432,6 @@ fil_node_complete_io(
 	ut_ad(system);
 	ut_ad(mutex_own(&(system->mutex)));
 
-	ut_a(node->n_pending > 0);
-
-	node->n_pending--;
-
 	if (type == OS_FILE_WRITE) {
 		system->modification_counter++;
 		node->modification_counter = system->modification_counter;
@@ -4282,11 +4445,102 @@ fil_node_complete_io(
 		}
 	}
 
-	if (node->n_pending == 0 && node->space->purpose == FIL_TABLESPACE
-	    && node->space->id != 0) {
-		/* The node must be put back to the LRU list */
-		UT_LIST_ADD_FIRST(LRU, system->LRU, node);
+	/* Decrement the count only now, so that a thread that sees
+	it drop to zero also sees the modification counter. */
+	fil_node_dec_pending(node);
+}
+
+/********************************************************************//**
+Updates the data structures when an i/o operation posted by fil_io()
+finishes. A completed read only decrements the pending i/o count of the
+node, without reserving the fil_system mutex. */
+UNIV_STATIC
+void
+fil_node_complete_io_nolock(
+/*========================*/
+	fil_node_t*	node,	/*!< in: file node */
+	ulint		type)	/*!< in: OS_FILE_WRITE or OS_FILE_READ */
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	if (type == OS_FILE_READ) {
+		fil_node_dec_pending(node);
+
+		return;
+	}
+#endif /* HAVE_ATOMIC_BUILTINS */
+
+	mutex_enter(&fil_system->mutex);
+
+	fil_node_complete_io(node, fil_system, type);
+
+	mutex_exit(&fil_system->mutex);
+}
+
+/********************************************************************//**
+Looks up the file node for an i/o in a file that is open, and increments
+the pending i/o count of the node, without reserving the fil_system
+mutex.
+@return file node, or NULL if the caller must use
+fil_mutex_enter_and_prepare_for_io() and fil_node_prepare_for_io() */
+UNIV_STATIC
+fil_node_t*
+fil_node_prepare_for_io_nolock(
+/*===========================*/
+	ulint	space_id,	/*!< in: space id */
+	ulint*	block_offset)	/*!< in/out: offset in number of blocks
+				in the space; out: in the file node, if
+				the node was found */
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	fil_space_t*	space;
+	fil_node_t*	node	= NULL;
+	ulint		offset	= *block_offset;
+
+	hash_mutex_enter(fil_system->spaces, space_id);
+
+	HASH_SEARCH(hash, fil_system->spaces, space_id,
+		    fil_space_t*, space,
+		    ut_ad(space->magic_n == FIL_SPACE_MAGIC_N),
+		    space->id == space_id);
+
+	/* A space that is being renamed or deleted, or a file that is
+	closed or whose size we do not know yet, needs the slow path */
+
+	if (space != NULL && !space->stop_ios && !space->is_being_deleted) {
+
+		for (node = UT_LIST_GET_FIRST(space->chain);
+		     node != NULL && node->size > 0
+		     && node->size <= offset;
+		     node = UT_LIST_GET_NEXT(chain, node)) {
+
+			offset -= node->size;
+		}
+
+		if (node != NULL && (node->size == 0 || !node->open)) {
+			node = NULL;
+		}
+	}
+
+	if (node != NULL) {
+		fil_node_inc_pending(node);
+
+		if (!node->accessed) {
+			node->accessed = TRUE;
+		}
+
+		*block_offset = offset;
 	}
+
+	hash_mutex_exit(fil_system->spaces, space_id);
+
+	return(node);
+#else /* HAVE_ATOMIC_BUILTINS */
+	/* The pending i/o counts are protected by the fil_system mutex */
+	UT_NOT_USED(space_id);
+	UT_NOT_USED(block_offset);
+
+	return(NULL);
+#endif /* HAVE_ATOMIC_BUILTINS */
 }
 
 /********************************************************************//**
@@ -4406,6 +4660,16 @@ fil_io(
 		srv_data_written+= len;
 	}
 
+	/* Try to start the i/o on an open file without the fil_system
+	mutex */
+
+	node = fil_node_prepare_for_io_nolock(space_id, &block_offset);
+
+	if (UNIV_LIKELY(node != NULL)) {
+
+		goto do_io;
+	}
+
 	/* Reserve the fil_system mutex and make sure that we can open at
 	least one file while holding it, if the file is not already open */
 
@@ -4475,6 +4739,7 @@ fil_io(
 	/* Now we have made the changes in the data structures of fil_system */
 	mutex_exit(&fil_system->mutex);
 
+do_io:
 	/* Calculate the low 32 bits and the high 32 bits of the file offset */
 
 	if (!zip_size) {
@@ -4527,11 +4792,7 @@ fil_io(
 		/* The i/o operation is already completed when we return from
 		os_aio: */
 
-		mutex_enter(&fil_system->mutex);
-
-		fil_node_complete_io(node, fil_system, type);
-
-		mutex_exit(&fil_system->mutex);
+		fil_node_complete_io_nolock(node, type);
 
 		ut_ad(fil_validate());
 	}
@@ -4579,11 +4840,7 @@ fil_aio_wait(
 
 	os_set_io_thread_op_info(segment, "complete io for fil node");
 
-	mutex_enter(&fil_system->mutex);
-
-	fil_node_complete_io(fil_node, fil_system, type);
-
-	mutex_exit(&fil_system->mutex);
+	fil_node_complete_io_nolock(fil_node, type);
 
 	ut_ad(fil_validate());
 
@@ -4823,7 +5080,6 @@ fil_validate(void)
 	fil_node = UT_LIST_GET_FIRST(fil_system->LRU);
 
 	while (fil_node != NULL) {
-		ut_a(fil_node->n_pending == 0);
 		ut_a(fil_node->open);
 		ut_a(fil_node->space->purpose == FIL_TABLESPACE);
 		ut_a(fil_node->space->id != 0);
@@ -4934,6 +5190,7 @@ fil_close(void)
 			mem_free(prev_space);
 		}
 	}
+	hash_free_mutexes(system->spaces);
 	hash_table_free(system->spaces);
 
 	/* The elements in this hash table are the same in system->spaces,
@@ -190,5 +190,7 @@ hash_free_mutexes_func(
 	}
 
 	mem_free(table->mutexes);
+	table->mutexes = NULL;
+	table->n_mutexes = 0;
 }
 #endif /* !UNIV_HOTBACKUP */
@@ -305,6 +305,63 @@ typedef enum {
 					a prefix of a fixed length column) */
 } ib_match_mode_t;
 
+/** @enum ib_pred_op_t Comparison operators of the predicates added with
+ib_cursor_add_predicate() */
+typedef enum {
+	IB_PRED_EQ = 1,			/*!< column = value, or column IS NULL
+					if the value is IB_SQL_NULL */
+
+	IB_PRED_NE = 2,			/*!< column <> value, or column IS NOT
+					NULL if the value is IB_SQL_NULL */
+
+	IB_PRED_LT = 3,			/*!< column < value */
+
+	IB_PRED_LE = 4,			/*!< column <= value */
+
+	IB_PRED_GT = 5,			/*!< column > value */
+
+	IB_PRED_GE = 6			/*!< column >= value */
+} ib_pred_op_t;
+
+/** @enum ib_aggr_op_t Aggregate functions of ib_cursor_aggregate() */
+typedef enum {
+	IB_AGGR_COUNT = 1,		/*!< COUNT(*), the number of rows */
+
+	IB_AGGR_SUM = 2,		/*!< SUM(column) */
+
+	IB_AGGR_MIN = 3,		/*!< MIN(column) */
+
+	IB_AGGR_MAX = 4			/*!< MAX(column) */
+} ib_aggr_op_t;
+
+/** @struct ib_aggr_t An aggregate computed by ib_cursor_aggregate().
+IB_AGGR_SUM, IB_AGGR_MIN and IB_AGGR_MAX take an IB_INT, IB_FLOAT or
+IB_DOUBLE column and ignore the rows where it is SQL NULL. Their result
+is in i64 for a signed IB_INT column, in u64 for an unsigned one and in
+dbl for IB_FLOAT and IB_DOUBLE; it is SQL NULL if n_values is 0. A SUM
+that overflows wraps around. */
+typedef struct {
+	ib_aggr_op_t	op;		/*!< in: aggregate function */
+
+	ib_ulint_t	col_no;		/*!< in: column number of the table,
+					as in the tuples of
+					ib_clust_read_tuple_create();
+					ignored by IB_AGGR_COUNT */
+
+	ib_u64_t	n_values;	/*!< out: number of rows for
+					IB_AGGR_COUNT, else number of rows
+					where the column is not SQL NULL */
+
+	ib_i64_t	i64;		/*!< out: result on a signed
+					IB_INT column */
+
+	ib_u64_t	u64;		/*!< out: result on an unsigned
+					IB_INT column */
+
+	double		dbl;		/*!< out: result on an IB_FLOAT or
+					IB_DOUBLE column */
+} ib_aggr_t;
+
 /** @struct ib_col_meta_t InnoDB column meta data. */
 typedef struct {
 	ib_col_type_t	type;		/*!< Type of the column */
@@ -495,6 +552,40 @@ typedef struct {
 					/*!< For travesing index column info */
 } ib_schema_visitor_t;
 
+/** Contention counters of the mutexes or rw-locks created at one source
+line, see ib_status_latch_iterate(). The counters are not updated
+atomically, so that they may be inexact. */
+typedef struct {
+	const char*	file;		/*!< Source file that creates the
+					latches */
+	ib_ulint_t	line;		/*!< Line in the source file */
+	ib_bool_t	rw_lock;	/*!< IB_TRUE if the latches are
+					rw-locks, IB_FALSE if mutexes */
+	ib_ulint_t	n_latches;	/*!< Number of the latches that
+					currently exist */
+	ib_u64_t	n_acquired;	/*!< Number of times the latches
+					were acquired */
+	ib_u64_t	n_spin_waits;	/*!< Number of times a thread had
+					to spin waiting for a latch */
+	ib_u64_t	n_spin_rounds;	/*!< Number of spin rounds */
+	ib_u64_t	n_os_yields;	/*!< Number of times a spinning
+					thread yielded the CPU */
+	ib_u64_t	n_os_waits;	/*!< Number of times a thread
+					suspended itself */
+	ib_u64_t	wait_time;	/*!< Microseconds that the threads
+					waited after yielding or suspending
+					themselves */
+} ib_latch_stats_t;
+
+/** Latch contention visitor */
+typedef int (*ib_status_latch_visitor_t) (
+					/*!< return 0 on success, nonzero
+					on failure (abort traversal) */
+	void*		arg,		/*!< User callback arg */
+	const ib_latch_stats_t*
+			stats);		/*!< Counters of the latches
+					created at one source line */
+
 /*************************************************************//**
 This function is used to compare two data fields for which the data type
 is such that we must use the client code to compare them. */
@@ -717,6 +808,25 @@ ib_trx_begin(
 /*=========*/
 	ib_trx_level_t	ib_trx_level) UNIV_NO_IGNORE;
 
+/*****************************************************************//**
+Begin a read-only transaction. This will allocate a new transaction
+handle and put the transaction in the active state. A read-only
+transaction is not assigned a transaction id or a rollback segment and
+is not visible to the read views of other transactions. It can only do
+consistent (non-locking) reads: an attempt to modify a table, to lock
+a table or a row, or to latch the data dictionary in exclusive mode
+returns DB_READONLY. The handle stays read-only when it is restarted
+with ib_trx_start().
+
+@ingroup trx
+@param ib_trx_level is the transaction isolation level
+@return	innobase txn handle */
+
+ib_trx_t
+ib_trx_begin_read_only(
+/*===================*/
+	ib_trx_level_t	ib_trx_level) UNIV_NO_IGNORE;
+
 /*****************************************************************//**
 Query the transaction's state. This function can be used to check for
 the state of the transaction in case it has been rolled back by the
@@ -1109,13 +1219,15 @@ ib_cursor_insert_row(
 	const ib_tpl_t	ib_tpl) UNIV_NO_IGNORE;
 
 /*****************************************************************//**
-Update a row in a table.
+Update a row in a table. This is not allowed while the cursor reads
+only some of the columns, see ib_cursor_set_columns().
 
 @ingroup dml
 @param ib_crsr is the cursor instance
 @param ib_old_tpl is the old tuple in the table
 @param ib_new_tpl is the new tuple with the updated values
-@return	DB_SUCCESS or err code */
+@return	DB_SUCCESS, DB_INVALID_INPUT if ib_cursor_set_columns() has
+	restricted the columns of the cursor, or err code */
 
 ib_err_t
 ib_cursor_update_row(
@@ -1801,6 +1913,130 @@ ib_cursor_set_cluster_access(
 /*=========================*/
 	ib_crsr_t	ib_crsr);
 
+/*****************************************************************//**
+Set whether ib_cursor_read_row() may point the column values of the
+tuple to the cursor's copy of the current row instead of copying them.
+The values returned by ib_col_get_value() are then valid only until the
+cursor is moved or closed. Externally stored columns are always copied.
+
+@ingroup dml
+@param ib_crsr is the cursor instance for which we want to set the flag
+@param zero_copy is IB_TRUE to enable and IB_FALSE to disable the mode */
+
+void
+ib_cursor_set_zero_copy(
+/*====================*/
+	ib_crsr_t	ib_crsr,
+	ib_bool_t	zero_copy);
+
+/*****************************************************************//**
+Set the columns that ib_cursor_read_row() reads. The other columns are
+read as SQL NULL, and externally stored columns that are not read are
+never fetched. A tuple read this way must not be passed to
+ib_cursor_update_row(). If the cursor is on a secondary index that stores
+all the columns in full, a tuple created with ib_clust_read_tuple_create()
+is read from the secondary index record, without a clustered index lookup
+even if ib_cursor_set_cluster_access() was called. This must be called
+before the cursor is positioned.
+
+@ingroup dml
+@param ib_crsr is the cursor instance
+@param cols are the column numbers of the table, as in the tuples
+	created by ib_clust_read_tuple_create()
+@param n_cols is the number of columns in cols, or 0 to read all columns
+@return	DB_SUCCESS or err code */
+
+ib_err_t
+ib_cursor_set_columns(
+/*==================*/
+	ib_crsr_t		ib_crsr,
+	const ib_ulint_t*	cols,
+	ib_ulint_t		n_cols) UNIV_NO_IGNORE;
+
+/*****************************************************************//**
+Check whether the secondary index of a cursor stores all the columns set
+by ib_cursor_set_columns(), so that rows are read from it without
+clustered index lookups.
+
+@ingroup dml
+@param ib_crsr is the cursor instance
+@return	IB_TRUE if the index covers the columns */
+
+ib_bool_t
+ib_cursor_is_covering(
+/*==================*/
+	ib_crsr_t	ib_crsr);
+
+/*****************************************************************//**
+Add a predicate of the form "column op value" to a cursor. The cursor then
+returns only the rows that satisfy all its predicates: the others are
+skipped inside the engine, before they are copied and, on a secondary
+index, before the clustered index record is looked up if the index stores
+the column. The value is in the format of ib_col_set_value(). A column
+that is SQL NULL satisfies no predicate other than IS NULL and IS NOT
+NULL. The predicates are kept until ib_cursor_clear_predicates() is
+called or the cursor is closed. This must be called before the cursor is
+positioned.
+
+@ingroup dml
+@param ib_crsr is the cursor instance
+@param col_no is the column number of the table, as in the tuples
+	created by ib_clust_read_tuple_create()
+@param op is the comparison operator
+@param src is the value to compare with
+@param len is the length of src, or IB_SQL_NULL
+@return	DB_SUCCESS or err code */
+
+ib_err_t
+ib_cursor_add_predicate(
+/*====================*/
+	ib_crsr_t	ib_crsr,
+	ib_ulint_t	col_no,
+	ib_pred_op_t	op,
+	const void*	src,
+	ib_ulint_t	len) UNIV_NO_IGNORE;
+
+/*****************************************************************//**
+Remove all the predicates of a cursor.
+
+@ingroup dml
+@param ib_crsr is the cursor instance */
+
+void
+ib_cursor_clear_predicates(
+/*=======================*/
+	ib_crsr_t	ib_crsr);
+
+/*****************************************************************//**
+Compute aggregates over a range of the index of a cursor inside the
+engine. The records are read where they are in the buffer pool and are
+not returned through the cursor. The range starts at the record that
+ib_cursor_moveto() would find with ib_tpl and ib_srch_mode, or at the
+start of the index if ib_tpl is NULL. It ends at the end of the index,
+at the end of the key prefix with the IB_EXACT_PREFIX match mode, or at
+the first record that fails a predicate added with
+ib_cursor_add_predicate() on the first column of the index of the form
+column =, < or <= value (=, > or >= value if the scan moves down). Rows
+that fail the other predicates are skipped. The cursor has no current
+row afterwards.
+
+@ingroup dml
+@param ib_crsr is the cursor instance
+@param ib_tpl is NULL, or the key where the range starts
+@param ib_srch_mode is the search mode of ib_tpl
+@param aggrs are the aggregates to compute
+@param n_aggrs is the number of aggregates
+@return	DB_SUCCESS or err code */
+
+ib_err_t
+ib_cursor_aggregate(
+/*================*/
+	ib_crsr_t	ib_crsr,
+	ib_tpl_t	ib_tpl,
+	ib_srch_mode_t	ib_srch_mode,
+	ib_aggr_t*	aggrs,
+	ib_ulint_t	n_aggrs) UNIV_NO_IGNORE;
+
 /*****************************************************************//**
 Read a table's schema using the visitor pattern. It will make the
 following sequence of calls:
@@ -2227,6 +2463,39 @@ ib_status_get_i64(
 	const char*	name,
 	ib_i64_t*	dst) UNIV_NO_IGNORE;
 
+/*******************************************************************//**
+Report the contention on the mutexes and rw-locks by the source line
+that creates them. It will call the function:
+
+	visitor(arg, const ib_latch_stats_t* stats);
+
+for each source line, adding up the counters of the latches that exist
+and of those that have been freed since the counters were reset. It will
+stop if visitor() returns non-zero.
+
+@ingroup misc
+@param visitor is the visitor function
+@param arg argument passed to the visitor function
+@return	DB_SUCCESS */
+
+ib_err_t
+ib_status_latch_iterate(
+/*====================*/
+	ib_status_latch_visitor_t
+			visitor,
+	void*		arg);
+
+/*******************************************************************//**
+Reset the contention counters of all mutexes and rw-locks, which are
+reported by ib_status_latch_iterate(). The counters of the latches that
+are being acquired at the same time may not be reset.
+
+@ingroup misc */
+
+void
+ib_status_latch_reset(void);
+/*=======================*/
+
 /* API_END_INCLUDE */
 #include <stdarg.h>
 
@@ -2238,7 +2507,8 @@ below, outside of API_BEGIN_INCLUDE/API_END_INCLUDE.
 /*********************************************************************//**
 Execute arbitrary SQL using InnoDB's internal parser. The statement
 is executed in a new transaction. Table name parameters must be prefixed
-with a '$' symbol and variables with ':'
+with a '$' symbol and variables with ':'. The query graph is cached by
+the SQL text and reused when the statement is executed again.
 @return	DB_SUCCESS or error code */
 
 ib_err_t
@@ -2251,7 +2521,8 @@ ib_exec_sql(
 /*********************************************************************//**
 Execute arbitrary SQL using InnoDB's internal parser. The statement
 is executed in a background transaction. It will lock the data
-dictionary lock for the duration of the query.
+dictionary lock for the duration of the query. The query graph is cached
+by the SQL text and reused when the statement is executed again.
 @return	DB_SUCCESS or error code */
 
 ib_err_t
@@ -2261,6 +2532,63 @@ ib_exec_ddl_sql(
 	ib_ulint_t	n_args,		/*!< in: no. of args */
 	...);
 
+/** A statement of InnoDB's internal parser, see ib_sql_prepare() */
+typedef struct ib_sql_stmt_struct	ib_sql_stmt_t;
+
+/*********************************************************************//**
+Prepare a statement of InnoDB's internal parser for repeated execution
+with ib_exec_prepared_sql() or ib_exec_prepared_ddl_sql(). The statement
+is parsed when it is first executed and parsed again only if the data
+dictionary or the bound table names have changed.
+@return	DB_SUCCESS or error code */
+
+ib_err_t
+ib_sql_prepare(
+/*===========*/
+	const char*	sql,		/*!< in: sql to prepare */
+	ib_sql_stmt_t**	stmt);		/*!< out: prepared statement */
+
+/*********************************************************************//**
+Execute a prepared statement of InnoDB's internal parser in a new
+transaction. The arguments are given as for ib_exec_sql().
+@return	DB_SUCCESS or error code */
+
+ib_err_t
+ib_exec_prepared_sql(
+/*=================*/
+	ib_sql_stmt_t*	stmt,		/*!< in/out: prepared statement */
+	ib_ulint_t	n_args,		/*!< in: no. of args */
+	...);
+
+/*********************************************************************//**
+Execute a prepared statement of InnoDB's internal parser in a background
+transaction, holding the data dictionary lock for the duration of the
+query. The arguments are given as for ib_exec_ddl_sql().
+@return	DB_SUCCESS or error code */
+
+ib_err_t
+ib_exec_prepared_ddl_sql(
+/*=====================*/
+	ib_sql_stmt_t*	stmt,		/*!< in/out: prepared statement */
+	ib_ulint_t	n_args,		/*!< in: no. of args */
+	...);
+
+/*********************************************************************//**
+Free a statement prepared with ib_sql_prepare(). */
+
+void
+ib_sql_free(
+/*========*/
+	ib_sql_stmt_t*	stmt);		/*!< in, own: prepared statement */
+
+/*********************************************************************//**
+Free the statements cached by ib_exec_sql() and ib_exec_ddl_sql(). Must
+be called before the data dictionary is shut down. */
+
+void
+ib_sql_cache_close(void);
+/*====================*/
+
 /*********************************************************************//**
 Initialize the config system.
 @return	DB_SUCCESS or error code */
@@ -29,6 +29,7 @@ Created 11/5/1995 Heikki Tuuri
 #include "univ.i"
 #include "ut0byte.h"
 #include "buf0types.h"
+#include "dict0types.h"
 
 /** The return type of buf_LRU_free_block() */
 enum buf_lru_free_block_status {
@@ -84,6 +85,18 @@ void
 buf_LRU_invalidate_tablespace(
 /*==========================*/
 	ulint	id);	/*!< in: space id */
+/******************************************************************//**
+Drops the adaptive hash index entries that point to the pages of an
+index, before the index is evicted from the dictionary cache. This is a
+'best effort' attempt: the caller must check
+btr_search_info_get_ref_count() afterwards. The caller need not hold any
+dictionary latch. */
+UNIV_INTERN
+void
+buf_LRU_drop_page_hash_for_index(
+/*=============================*/
+	ulint			space,	/*!< in: index->space */
+	const dict_index_t*	index);	/*!< in: index, possibly freed */
 /********************************************************************//**
 Insert a compressed block into buf_pool->zip_clean in the LRU order. */
 UNIV_INTERN
@@ -362,6 +362,56 @@ dict_table_get_using_id(
 	ib_recovery_t	recovery,/*!< in: recovery flag */
 	dulint	table_id,	/*!< in: table id */
 	ibool	ref_count);	/*!< in: increment open handle count if TRUE */
+/**********************************************************************//**
+Looks up a completely loaded table by name in the dictionary cache without
+reserving dict_sys->mutex, and optionally increments its open handle count.
+The lookup fails while dict_operation_lock is reserved in exclusive mode.
+@return	table, NULL if the caller must look the table up with dict_sys->mutex */
+UNIV_INTERN
+dict_table_t*
+dict_table_get_nolock(
+/*==================*/
+	const char*	table_name,	/*!< in: table name */
+	ibool		ref_count);	/*!< in: whether to increment the open
+					handle count on the table */
+/**********************************************************************//**
+Looks up a completely loaded table by id in the dictionary cache without
+reserving dict_sys->mutex, and optionally increments its open handle count.
+The lookup fails while dict_operation_lock is reserved in exclusive mode.
+@return	table, NULL if the caller must look the table up with dict_sys->mutex */
+UNIV_INTERN
+dict_table_t*
+dict_table_get_on_id_nolock(
+/*========================*/
+	dulint		table_id,	/*!< in: table id */
+	ibool		ref_count);	/*!< in: whether to increment the open
+					handle count on the table */
+/**********************************************************************//**
+Evicts unused tables from the end of dict_sys->table_LRU until the
+dictionary cache holds at most srv_dict_cache_max_tables tables. Tables
+that are open, locked, referenced by foreign keys or that the adaptive
+hash index still points to after an attempt to drop its entries are
+skipped. The candidates are picked and their adaptive hash index entries
+are dropped before dict_operation_lock is reserved in exclusive mode for
+the eviction itself. The work done by one call is bounded.
+@return	number of tables evicted */
+UNIV_INTERN
+ulint
+dict_make_room_in_cache(void);
+/*=========================*/
+/**********************************************************************//**
+Gets the counters of the dictionary cache. The counters are read without
+a latch. */
+UNIV_INTERN
+void
+dict_get_cache_stats(
+/*=================*/
+	ulint*	n_tables,	/*!< out: number of cached tables */
+	ulint*	n_hits,		/*!< out: number of lookups that found
+				the table in the cache */
+	ulint*	n_misses,	/*!< out: number of lookups that had to
+				load the table */
+	ulint*	n_evicted);	/*!< out: number of evicted tables */
 /**************************************************************************
 Returns a index object, based on table and index id, and memoryfixes it.
 @return	index, NULL if does not exist */
@@ -552,6 +602,17 @@ dict_index_is_sec_or_ibuf(
 /*======================*/
 	const dict_index_t*	index)	/*!< in: index */
 	__attribute__((pure));
+/********************************************************************//**
+Check whether the index is being created while the table can be modified.
+DML must not modify the tree of such an index but log the change with
+row_merge_log_op().
+@return	TRUE if the index is not complete */
+UNIV_INLINE
+ibool
+dict_index_is_online(
+/*=================*/
+	const dict_index_t*	index)	/*!< in: index */
+	__attribute__((pure));
 
 /********************************************************************//**
 Gets the number of user-defined columns in a table in the dictionary
@@ -1129,6 +1190,20 @@ extern dict_sys_t*	dict_sys;
 /** the data dictionary rw-latch protecting dict_sys */
 extern rw_lock_t	dict_operation_lock;
 
+/** Counter of the lookups that found a table while holding one hash
+mutex, padded so that the counters of different mutexes do not share
+a cache line */
+typedef struct dict_hit_counter_struct	dict_hit_counter_t;
+
+/** Counter of the lookups that found a table while holding one hash
+mutex */
+struct dict_hit_counter_struct{
+	ulint		n;	/*!< number of lookups; protected by the
+				hash mutex */
+	byte		pad[64 - sizeof(ulint)];
+				/*!< padding to a cache line */
+};
+
 /* Dictionary system struct */
 struct dict_sys_struct{
 	mutex_t		mutex;		/*!< mutex protecting the data
@@ -1145,14 +1220,35 @@ struct dict_sys_struct{
 					recovery this must be derived from
 					the log records */
 	hash_table_t*	table_hash;	/*!< hash table of the tables, based
-					on name */
+					on name; modified only while holding
+					both the mutex above and the hash
+					mutex of the cell, so that
+					dict_table_get_nolock() can search
+					it holding only the latter */
 	hash_table_t*	table_id_hash;	/*!< hash table of the tables, based
-					on id */
+					on id; protected like table_hash */
 	UT_LIST_BASE_NODE_T(dict_table_t)
 			table_LRU;	/*!< LRU list of tables */
 	ulint		size;		/*!< varying space in bytes occupied
 					by the data dictionary table and
 					index objects */
+	ulint		version;	/*!< the last value assigned to
+					dict_table_t::version */
+	ulint		n_hits;		/*!< number of lookups that found
+					the table in the cache while holding
+					the mutex above */
+	ulint		n_misses;	/*!< number of lookups that had to
+					load the table; protected by the
+					mutex above */
+	ulint		n_evicted;	/*!< number of tables evicted by
+					dict_make_room_in_cache(); protected
+					by the mutex above */
+	dict_hit_counter_t*
+			nolock_hits;	/*!< lookups that found the table
+					without the mutex above, indexed by
+					the table_hash mutex number and then
+					by DICT_HASH_N_MUTEXES plus the
+					table_id_hash mutex number */
 	dict_table_t*	sys_tables;	/*!< SYS_TABLES table */
 	dict_table_t*	sys_columns;	/*!< SYS_COLUMNS table */
 	dict_table_t*	sys_indexes;	/*!< SYS_INDEXES table */
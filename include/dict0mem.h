@@ -43,6 +43,7 @@ Created 1/8/1996 Heikki Tuuri
 #include "ut0byte.h"
 #include "hash0hash.h"
 #include "trx0types.h"
+#include "row0types.h"
 
 /** Type flags of an index: OR'ing of the flags is allowed to define a
 combination of types */
@@ -228,6 +229,18 @@ struct dict_field_struct{
 					DICT_MAX_INDEX_COL_LEN */
 };
 
+/** The status of an index that is being created while the table
+can be modified */
+enum online_index_status {
+	ONLINE_INDEX_COMPLETE = 0,	/*!< the index is complete and
+					modified directly */
+	ONLINE_INDEX_CREATION,		/*!< the index is being created:
+					changes are logged in online_log */
+	ONLINE_INDEX_ABORTED		/*!< the creation was aborted and
+					the index will be dropped: changes
+					are ignored */
+};
+
 /** Data structure for an index.  Most fields will be
 initialized to 0, NULL or FALSE in dict_mem_index_create(). */
 struct dict_index_struct{
@@ -263,6 +276,8 @@ struct dict_index_struct{
 				/*!< TRUE if this index is marked to be
 				dropped in ha_innobase::prepare_drop_index(),
 				otherwise FALSE */
+	unsigned	online_status:2;
+				/*!< enum online_index_status */
 	dict_field_t*	fields;	/*!< array of field descriptions */
 #ifndef UNIV_HOTBACKUP
 	UT_LIST_NODE_T(dict_index_t)
@@ -294,6 +309,10 @@ struct dict_index_struct{
 	ib_uint64_t	trx_id; /* id of the transaction that created this
 				index, or 0 if the index existed
 				when InnoDB was started up */
+	row_merge_log_t*online_log;
+				/*!< changes made to the table while the
+				index is being created, or NULL; see
+				online_status */
 	/* @} */
 #endif /* !UNIV_HOTBACKUP */
 #ifdef UNIV_DEBUG
@@ -408,7 +427,26 @@ struct dict_table_struct{
 	ulint		n_handles_opened;
 				/*!< count of how many handles the user has
 				opened to this table; dropping of the table is
-				NOT allowed until this count gets to zero */
+				NOT allowed until this count gets to zero;
+				updated with atomic operations if
+				HAVE_ATOMIC_BUILTINS is defined */
+	ibool		loaded;	/*!< TRUE once dict_table_get() or
+				dict_table_get_using_id() has returned the
+				table, that is, once it has been completely
+				loaded; only then may dict_table_get_nolock()
+				return it; protected by dict_sys->mutex and
+				the hash mutexes of the table */
+	ibool		accessed;/*!< TRUE if the table has been looked up
+				since dict_make_room_in_cache() last moved
+				it to the start of dict_sys->table_LRU;
+				set without holding any latch */
+	ulint		version;/*!< dict_sys->version when the table was
+				added to the cache, renamed, or an index
+				was added to or removed from it; no other
+				table object ever has the same version, so
+				that cached query graphs and cursors that
+				point to the table can be validated; protected
+				by dict_sys->mutex */
 	ulint		n_foreign_key_checks_running;
 				/*!< count of how many foreign key check
 				operations are currently being performed
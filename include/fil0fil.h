@@ -270,6 +270,15 @@ fil_init(
 /*=====*/
 	ulint	hash_size,	/*!< in: hash table size */
 	ulint	max_n_open);	/*!< in: max number of open files */
+/****************************************************************//**
+Changes the maximum number of open files of the tablespace memory cache,
+and closes the files that exceed the new limit if they have no pending
+i/o's or unflushed writes. Does nothing if the cache does not exist. */
+UNIV_INTERN
+void
+fil_set_max_n_open(
+/*===============*/
+	ulint	max_n_open);	/*!< in: max number of open files */
 /******************************************************************//**
 Deinitializes the tablespace memory cache. */
 UNIV_INTERN
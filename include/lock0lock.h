@@ -44,6 +44,35 @@ extern ibool	lock_print_waits;
 /* Buffer for storing information about the most recent deadlock error */
 extern ib_stream_t	lock_latest_err_stream;
 
+/* Deadlock detection statistics, protected by the kernel mutex */
+extern ulint		lock_deadlock_n_checks;	/*!< number of waits-for
+						graph searches */
+extern ulint		lock_deadlock_n_found;	/*!< number of deadlocks
+						found */
+extern ulint		lock_deadlock_n_too_long;/*!< number of searches
+						that exceeded the cost
+						budget */
+extern ib_uint64_t	lock_deadlock_check_time;/*!< total time spent
+						in searches, in us */
+extern ib_uint64_t	lock_deadlock_check_max_time;/*!< longest search,
+						in us */
+
+/*********************************************************************//**
+Gets the record lock hash chain statistics, summed over the partitions of
+lock_sys->rec_hash. The counters are read without a latch. */
+UNIV_INTERN
+void
+lock_rec_hash_get_stats(
+/*====================*/
+	ulint*	n_searches,	/*!< out: number of lookups of the first
+				lock on a page */
+	ulint*	n_steps,	/*!< out: number of locks on other pages
+				skipped over in those lookups */
+	ulint*	max_steps,	/*!< out: most locks skipped over in one
+				lookup */
+	ulint*	n_nolock);	/*!< out: number of insert and secondary
+				index modify checks that found no lock
+				without reserving the kernel mutex */
 /*********************************************************************//**
 Gets the size of a lock struct.
 @return	size in bytes */
@@ -572,6 +601,17 @@ lock_is_table_exclusive(
 	dict_table_t*	table,	/*!< in: table */
 	trx_t*		trx);	/*!< in: transaction */
 /*********************************************************************//**
+Checks if a transaction holds a granted lock on a table in the given
+mode or stronger.
+@return	TRUE if the transaction holds such a lock */
+UNIV_INTERN
+ibool
+lock_trx_has_table_lock(
+/*====================*/
+	trx_t*		trx,	/*!< in: transaction */
+	dict_table_t*	table,	/*!< in: table */
+	enum lock_mode	mode);	/*!< in: lock mode */
+/*********************************************************************//**
 Checks if a lock request lock1 has to wait for request lock2.
 @return	TRUE if lock1 has to wait for lock2 to be removed */
 UNIV_INTERN
@@ -810,9 +850,36 @@ struct lock_op_struct{
 	enum lock_mode	mode;	/*!< lock mode */
 };
 
+/** Record lock hash chain statistics of one lock_sys->rec_hash partition.
+Lookups may hold only the kernel mutex or only the partition mutex, so
+that the counts may be inexact. */
+typedef struct lock_rec_hash_stats_struct	lock_rec_hash_stats_t;
+/** Record lock hash chain statistics of one partition */
+struct lock_rec_hash_stats_struct{
+	ulint		n_searches;	/*!< number of lookups of the first
+					lock on a page */
+	ulint		n_steps;	/*!< number of locks on other pages
+					skipped over in those lookups */
+	ulint		max_steps;	/*!< most locks skipped over in one
+					lookup */
+	ulint		n_nolock;	/*!< number of insert and secondary
+					index modify checks that found no
+					lock without reserving the kernel
+					mutex */
+	byte		pad[64 - 4 * sizeof(ulint)];
+					/*!< padding to a cache line */
+};
+
 /** The lock system struct */
 struct lock_sys_struct{
-	hash_table_t*	rec_hash;	/*!< hash table of the record locks */
+	hash_table_t*	rec_hash;	/*!< hash table of the record locks,
+					partitioned by the page fold; a
+					lock is inserted or removed while
+					holding both the kernel mutex and
+					the mutex of its partition */
+	lock_rec_hash_stats_t*
+			rec_hash_stats;	/*!< hash chain statistics, indexed
+					by the rec_hash mutex number */
 };
 
 /** The lock system */
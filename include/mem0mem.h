@@ -75,6 +75,17 @@ allocations of small buffers. */
 is the maximum size for a single allocated buffer: */
 #define MEM_MAX_ALLOC_IN_BUF		(UNIV_PAGE_SIZE - 200)
 
+/******************************************************************//**
+Gets the statistics of the block caches, summed over the threads. The
+counters of the running threads are read without a latch. */
+UNIV_INTERN
+void
+mem_block_cache_get_stats(
+/*======================*/
+	ulint*	n_hits,		/*!< out: number of blocks taken from
+				a cache */
+	ulint*	n_misses);	/*!< out: number of blocks of a cached
+				size that were allocated with malloc() */
 /******************************************************************//**
 Initializes the memory system. */
 UNIV_INTERN
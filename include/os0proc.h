@@ -38,9 +38,21 @@ Created 9/30/1995 Heikki Tuuri
 typedef void*			os_process_t;
 typedef unsigned long int	os_process_id_t;
 
+/* NUMA memory policies of the buffer pool, see os_mem_set_numa_policy() */
+enum os_numa_policy_enum {
+	OS_NUMA_DEFAULT = 0,		/* allocate each page on the node of
+					the thread that first touches it */
+	OS_NUMA_INTERLEAVE,		/* interleave pages across all the
+					nodes the process may use */
+	OS_NUMA_LOCAL			/* bind pages to the node of the
+					thread that creates the buffer pool */
+};
+
 extern ibool os_use_large_pages;
 /* Large page size. This may be a boot-time option on some platforms */
 extern ulint os_large_page_size;
+/* NUMA memory policy of the buffer pool (enum os_numa_policy_enum) */
+extern ulint os_numa_policy;
 
 /****************************************************************//**
 Converts the current process id to a number. It is not guaranteed that the
@@ -70,6 +82,18 @@ os_mem_free_large(
 					os_mem_alloc_large() */
 	ulint	size);			/*!< in: size returned by
 					os_mem_alloc_large() */
+/****************************************************************//**
+Applies the NUMA memory policy os_numa_policy to a block of memory
+returned by os_mem_alloc_large(). Pages that have already been touched
+are migrated. This is a no-op on systems without mbind(2). */
+UNIV_INTERN
+void
+os_mem_set_numa_policy(
+/*===================*/
+	void*	ptr,			/*!< in: pointer returned by
+					os_mem_alloc_large() */
+	ulint	size);			/*!< in: size returned by
+					os_mem_alloc_large() */
 /******************************************************************//**
 Reset the variables. */
 UNIV_INTERN
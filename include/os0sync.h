@@ -452,6 +452,57 @@ clobbered */
 	"Mutexes and rw_locks use InnoDB's own implementation"
 #endif
 
+/* On Linux, a thread that has to wait for a mutex or an rw-lock sleeps
+on a futex embedded in the latch instead of on an os_event_t. The sync
+wait array is then only used for reporting long waits. UNIV_SYNC_DEBUG
+builds keep waiting in the wait array, because its deadlock detection
+needs to see every waiting thread. */
+#if defined(UNIV_LINUX) && defined(os_atomic_increment) \
+    && !defined(UNIV_SYNC_DEBUG)
+# include <sys/syscall.h>
+# ifdef SYS_futex
+#  define INNODB_SYNC_USE_FUTEX
+# endif /* SYS_futex */
+#endif /* UNIV_LINUX && os_atomic_increment && !UNIV_SYNC_DEBUG */
+
+#ifdef INNODB_SYNC_USE_FUTEX
+/** A futex: a counter that is incremented each time the futex is
+signalled, and on which threads can sleep until it changes */
+typedef volatile ib_uint32_t	os_futex_t;
+
+/**********************************************************//**
+Returns the current signal count of a futex. It must be passed to
+os_futex_wait_time(), so that the thread does not sleep if the futex
+has been signalled in between.
+@return	current signal count */
+UNIV_INLINE
+ib_uint32_t
+os_futex_reset(
+/*===========*/
+	os_futex_t*	futex);	/*!< in: futex */
+/**********************************************************//**
+Signals a futex and wakes up all the threads sleeping on it. */
+UNIV_INTERN
+void
+os_futex_set(
+/*=========*/
+	os_futex_t*	futex);	/*!< in/out: futex */
+/**********************************************************//**
+Sleeps on a futex until it is signalled or a timeout is exceeded. Returns
+at once if the futex has been signalled since os_futex_reset() returned
+sig_count. The thread may also wake up spuriously.
+@return	0 if woken up, OS_SYNC_TIME_EXCEEDED if timeout was exceeded */
+UNIV_INTERN
+ulint
+os_futex_wait_time(
+/*===============*/
+	os_futex_t*	futex,		/*!< in: futex to sleep on */
+	ib_uint32_t	sig_count,	/*!< in: value returned by
+					os_futex_reset() */
+	ulint		time);		/*!< in: timeout in microseconds, or
+					OS_SYNC_INFINITE_TIME */
+#endif /* INNODB_SYNC_USE_FUTEX */
+
 #ifndef UNIV_NONINL
 #include "os0sync.ic"
 #endif
@@ -600,6 +600,35 @@ pars_info_get_bound_id(
 	pars_info_t*		info,	/*!< in: info struct */
 	const char*		name);	/*!< in: bound id name to find */
 
+/****************************************************************//**
+Checks that the tables that a query graph returned by pars_sql() was
+parsed against are still in the data dictionary cache and have not been
+renamed or had indexes added or removed since. The caller must own
+dict_sys->mutex.
+@return	TRUE if the graph can be run again, FALSE if it must be parsed
+again */
+UNIV_INTERN
+ibool
+pars_graph_tables_valid(
+/*====================*/
+	que_t*	graph);	/*!< in: query graph */
+/****************************************************************//**
+Binds a query graph returned by pars_sql() to the values of another info
+struct, so that the graph can be run again without parsing the SQL. The
+bound literals are pointed to, not copied: info must not be freed before
+the graph has been run. The user functions are copied.
+@return	TRUE on success, FALSE if info does not match the info that the
+graph was parsed with, in which case the graph must be parsed again */
+UNIV_INTERN
+ibool
+pars_info_rebind(
+/*=============*/
+	que_t*			graph,	/*!< in/out: query graph */
+	pars_info_t*		info);	/*!< in: info struct with the same
+					bound ids, the same user functions
+					and bound literals of the same
+					types as the graph's own info */
+
 /**********************************************************************
 Release any resources used by the parser and lexer. */
 UNIV_INTERN
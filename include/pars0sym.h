@@ -193,6 +193,10 @@ struct sym_node_struct{
 	dict_table_t*			table;		/*!< table definition
 							if a table id or a
 							column id */
+	ulint				table_version;	/*!< table->version
+							when a table id was
+							resolved, see
+							pars_graph_tables_valid() */
 	ulint				col_no;		/*!< column number if a
 							column */
 	sel_buf_t*			prefetch_buf;	/*!< NULL, or a buffer
@@ -322,6 +322,16 @@ que_node_print_info(
 /*================*/
 	que_node_t*	node);	/*!< in: query graph node */
 /*********************************************************************//**
+Runs a query graph returned by pars_sql(). The graph is not freed and
+can be run again, after binding new values with pars_info_rebind().
+@return	error code or DB_SUCCESS */
+UNIV_INTERN
+ulint
+que_eval_graph(
+/*===========*/
+	que_t*		graph,	/*!< in/out: query graph */
+	trx_t*		trx);	/*!< in: trx */
+/*********************************************************************//**
 Evaluate the given SQL
 @return	error code or DB_SUCCESS */
 UNIV_INTERN
@@ -90,6 +90,31 @@ cmp_dfield_dfield(
 	const dfield_t*	dfield1,/*!< in: data field; must have type field set */
 	const dfield_t*	dfield2);/*!< in: data field */
 /*************************************************************//**
+Determines if cmp_data_data() compares the fields of a data type byte
+by byte, so that cmp_data_sort_key() can be used for the type.
+@return	TRUE if the fields of the type have binary-comparable sort keys */
+UNIV_INTERN
+ibool
+cmp_type_has_sort_key(
+/*==================*/
+	ulint		mtype,	/*!< in: main type */
+	ulint		prtype);/*!< in: precise type */
+/*************************************************************//**
+Computes a binary-comparable sort key from the first bytes of a data
+field.  If the sort keys of two fields of the same type differ, the
+fields compare in the same order in cmp_data_data(); if the sort keys
+are equal, the fields must be compared with cmp_data_data().  The type
+must satisfy cmp_type_has_sort_key().
+@return	sort key */
+UNIV_INTERN
+ib_uint64_t
+cmp_data_sort_key(
+/*==============*/
+	ulint		mtype,	/*!< in: main type */
+	ulint		prtype,	/*!< in: precise type */
+	const byte*	data,	/*!< in: data field */
+	ulint		len);	/*!< in: data field length or UNIV_SQL_NULL */
+/*************************************************************//**
 This function is used to compare a data tuple to a physical record.
 Only dtuple->n_fields_cmp first fields are taken into account for
 the data tuple! If we denote by n = n_fields_cmp, then rec must
@@ -193,7 +193,61 @@ row_merge_build_indexes(
 					unless creating a PRIMARY KEY */
 	dict_index_t**	indexes,	/*!< in: indexes to be created */
 	ulint		n_indexes,	/*!< in: size of indexes[] */
-	table_handle_t	table);		/*!< in/out: table, for
+	table_handle_t	table,		/*!< in/out: table, for
 					reporting erroneous key value
 					if applicable */
+	read_view_t*	view);		/*!< in: consistent read view for
+					scanning old_table while it is
+					being modified, or NULL to read
+					the latest version of each row */
+
+/** Operations on an index that is being created online */
+enum row_merge_log_op_type {
+	ROW_MERGE_LOG_INSERT,		/*!< insert an index entry */
+	ROW_MERGE_LOG_DELETE		/*!< remove an index entry */
+};
+
+/*********************************************************************//**
+Starts logging the changes to an index that has been created but whose
+entries are yet to be built by row_merge_build_indexes() from a read
+view.  Until row_merge_log_free() is called, DML logs its changes to
+the index instead of modifying the index tree.  The caller must prevent
+concurrent modifications of the table while calling this function. */
+UNIV_INTERN
+void
+row_merge_log_create(
+/*=================*/
+	dict_index_t*	index);		/*!< in/out: index */
+/*********************************************************************//**
+Logs an operation on an index that is being created online. */
+UNIV_INTERN
+void
+row_merge_log_op(
+/*=============*/
+	dict_index_t*		index,	/*!< in/out: index being created */
+	const dtuple_t*		entry,	/*!< in: index entry */
+	enum row_merge_log_op_type op);	/*!< in: operation */
+/*********************************************************************//**
+Applies the operations logged for an index that is being created online.
+This can be called while the table is being modified, in which case
+the operations logged meanwhile will be applied as well; to apply all
+of them, the caller must prevent concurrent modifications of the table.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+ulint
+row_merge_log_apply(
+/*================*/
+	trx_t*		trx,		/*!< in: transaction */
+	dict_index_t*	index);		/*!< in/out: index being created */
+/*********************************************************************//**
+Stops logging the changes to an index that was being created online.
+The caller must prevent concurrent modifications of the table. */
+UNIV_INTERN
+void
+row_merge_log_free(
+/*===============*/
+	dict_index_t*	index,		/*!< in/out: index */
+	ibool		aborted);	/*!< in: TRUE if the index will
+					be dropped, FALSE if all logged
+					operations have been applied */
 #endif /* row0merge.h */
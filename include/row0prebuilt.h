@@ -27,6 +27,7 @@ Created 02/03/2009 Sunny Bains
 
 #include "lock0types.h"
 #include "row0sel.h"
+#include "data0data.h"
 
 /************************************************************************
 Create a prebuilt struct for a user table handle.
@@ -54,6 +55,32 @@ row_prebuilt_reset(
 /*===============*/
 	row_prebuilt_t*	prebuilt);	/*!< in/out: prebuilt struct */
 
+/************************************************************************
+Add a predicate of the form "column op constant" to the predicates that
+row_search_for_client() evaluates on the records of a table handle. A row
+is returned only if it satisfies all the predicates. */
+UNIV_INTERN
+void
+row_prebuilt_add_pred(
+/*==================*/
+	row_prebuilt_t*		prebuilt,	/*!< in/out: prebuilt struct;
+						prebuilt->index must be set */
+	ulint			col_no,		/*!< in: column number in the
+						table */
+	enum row_sel_pred_op	op,		/*!< in: comparison operator */
+	const dfield_t*		val);		/*!< in: constant, of the type
+						of the column; SQL NULL only
+						with ROW_SEL_PRED_EQ and
+						ROW_SEL_PRED_NE */
+
+/************************************************************************
+Remove all the predicates of a table handle. */
+UNIV_INTERN
+void
+row_prebuilt_clear_preds(
+/*=====================*/
+	row_prebuilt_t*	prebuilt);	/*!< in/out: prebuilt struct */
+
 /*************************************************************************
 Updates the transaction pointers in query graphs stored in the prebuilt
 struct. */
@@ -77,6 +104,42 @@ row_prebuilt_update_trx(
 
 #define ROW_PREBUILT_FETCH_MAGIC_N	465765687
 
+/** A predicate pushed down to row_search_for_client(). */
+typedef struct row_sel_pred_struct {
+	enum row_sel_pred_op
+			op;		/* comparison operator */
+	ulint		clust_pos;	/* position of the column in the
+					clustered index */
+	ulint		sec_pos;	/* position of the column in
+					prebuilt->index if that is a
+					secondary index storing the column in
+					full, else ULINT_UNDEFINED */
+	dfield_t	val;		/* constant to compare with */
+} row_sel_pred_t;
+
+/** An aggregate computed by row_search_aggregate(). */
+struct row_sel_aggr_struct {
+	enum row_sel_aggr_op
+			op;		/* in: aggregate function */
+	ulint		col_no;		/* in: column number in the table;
+					ignored by ROW_SEL_AGGR_COUNT */
+	ulint		pos;		/* position of the column in the
+					records that are aggregated */
+	ulint		mtype;		/* main type of the column:
+					DATA_INT, DATA_FLOAT or DATA_DOUBLE */
+	ibool		usign;		/* TRUE if the column is an
+					unsigned DATA_INT */
+	ib_uint64_t	n_vals;		/* out: number of rows for
+					ROW_SEL_AGGR_COUNT, else number of
+					values that are not SQL NULL */
+	ib_int64_t	i64;		/* out: result on a signed
+					DATA_INT column */
+	ib_uint64_t	u64;		/* out: result on an unsigned
+					DATA_INT column */
+	double		dbl;		/* out: result on a DATA_FLOAT or
+					DATA_DOUBLE column */
+};
+
 /* An InnoDB cached row. */
 typedef struct ib_cached_row_struct {
 	ulint		max_len;	/* max len of rec if not NULL */
@@ -181,6 +244,24 @@ struct row_prebuilt_struct {
 
 	int		result;		/* Result of the last compare in
 					row_search_for_client(). */
+	row_sel_pred_t*	preds;		/* predicates that the rows returned
+					by row_search_for_client() must
+					satisfy, see row_prebuilt_add_pred() */
+	ulint		n_preds;	/* number of predicates in preds */
+	ulint		max_preds;	/* number of predicates that fit
+					in preds */
+	ibool		preds_need_clust;/* TRUE if a predicate is on a
+					column that prebuilt->index, a
+					secondary index, does not store in
+					full: the clustered index record
+					is then looked up to evaluate it */
+	mem_heap_t*	pred_heap;	/* NULL, or the memory heap of
+					preds and of their constants */
+	row_sel_aggr_t*	aggrs;		/* aggregates that
+					row_search_for_client() computes
+					instead of returning rows, only set
+					inside row_search_aggregate() */
+	ulint		n_aggrs;	/* number of aggregates in aggrs */
 	ulint		magic_n2;	/* this should be the same as
 					magic_n */
 };
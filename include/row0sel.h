@@ -166,6 +166,31 @@ row_search_for_client(
 				       	In opening of a cursor 'direction'
 				       	should be ROW_SEL_MOVETO */
 
+/********************************************************************//**
+Computes aggregates over the records that a search with
+row_search_for_client() would return, without copying them to the fetch
+cache. The scan starts like a ROW_SEL_MOVETO search and ends at the end
+of the range defined by match_mode, at the end of the index or, when the
+index moves up (down), at the first record whose first ordering column
+fails a predicate of the handle of the form column <, <= or = (>, >= or
+=) constant. The cursor is left without a current row.
+@return	DB_SUCCESS, DB_DEADLOCK, DB_LOCK_TABLE_FULL, DB_CORRUPTION or
+other error code */
+UNIV_INTERN
+enum db_err
+row_search_aggregate(
+/*=================*/
+	ib_recovery_t	recovery,	/*!< in: recovery flag */
+	ib_srch_mode_t	mode,		/*!< in: search mode */
+	row_prebuilt_t*	prebuilt,	/*!< in: prebuilt struct for the
+					table handle, see
+					row_search_for_client() */
+	ib_match_t	match_mode,	/*!< in: mode for matching the key */
+	row_sel_aggr_t*	aggrs,		/*!< in/out: aggregates; op and
+					col_no must be set, the results are
+					written by this function */
+	ulint		n_aggrs);	/*!< in: number of aggregates */
+
 /**********************************************************************//**
 Reads the current row from the fetch cache.
 @return current row from the row cache. */
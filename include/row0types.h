@@ -53,10 +53,37 @@ typedef	struct purge_node_struct purge_node_t;
 
 typedef struct row_ext_struct row_ext_t;
 
+typedef struct row_merge_log_struct row_merge_log_t;
+
 typedef void* table_handle_t;
 
 typedef struct row_prebuilt_struct row_prebuilt_t;
 
+/* Comparison operators of the predicates evaluated in
+row_search_for_client(). With an SQL NULL constant, ROW_SEL_PRED_EQ means
+IS NULL and ROW_SEL_PRED_NE means IS NOT NULL; otherwise a column that is
+SQL NULL never satisfies a predicate. */
+enum row_sel_pred_op {
+	ROW_SEL_PRED_EQ = 1,		/* column = constant */
+	ROW_SEL_PRED_NE,		/* column <> constant */
+	ROW_SEL_PRED_LT,		/* column < constant */
+	ROW_SEL_PRED_LE,		/* column <= constant */
+	ROW_SEL_PRED_GT,		/* column > constant */
+	ROW_SEL_PRED_GE			/* column >= constant */
+};
+
+/* Aggregate functions computed by row_search_for_client() when
+prebuilt->n_aggrs > 0. SQL NULL values are ignored by all but
+ROW_SEL_AGGR_COUNT, which counts rows. */
+enum row_sel_aggr_op {
+	ROW_SEL_AGGR_COUNT = 1,		/* COUNT(*) */
+	ROW_SEL_AGGR_SUM,		/* SUM(column) */
+	ROW_SEL_AGGR_MIN,		/* MIN(column) */
+	ROW_SEL_AGGR_MAX		/* MAX(column) */
+};
+
+typedef struct row_sel_aggr_struct row_sel_aggr_t;
+
 /* Insert node types */
 typedef enum ib_ins_mode_enum {
 					/* The first two modes are only
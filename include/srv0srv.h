@@ -104,9 +104,17 @@ extern ulint	srv_log_file_size;
 extern ulint	srv_log_buffer_size;
 extern ulong	srv_flush_log_at_trx_commit;
 extern ibool	srv_adaptive_flushing;
+extern ibool	srv_deadlock_detect;
 
 extern ibool	srv_use_sys_malloc;
 
+extern ulint	srv_rollback_segments;
+
+extern ulint	srv_sort_buf_size;
+extern ulint	srv_sort_threads;
+extern ulint	srv_online_log_max_size;
+extern ulint	srv_dict_cache_max_tables;
+
 extern ulint	srv_buf_pool_size;	/*!< requested size in bytes */
 extern ulint	srv_buf_pool_old_size;	/*!< previously requested size */
 extern ulint	srv_buf_pool_curr_size;	/*!< current size in bytes */
@@ -167,6 +175,10 @@ extern ulint	srv_n_rows_updated;
 extern ulint	srv_n_rows_deleted;
 extern ulint	srv_n_rows_read;
 
+extern ulint	srv_n_cursor_cache_hits;
+extern ulint	srv_n_cursor_cache_misses;
+extern ulint	srv_n_cursor_cache_evictions;
+
 extern ibool	srv_print_innodb_monitor;
 extern ibool	srv_print_innodb_lock_monitor;
 extern ibool	srv_print_innodb_tablespace_monitor;
@@ -564,6 +576,44 @@ struct export_var_struct{
 						/ srv_n_lock_wait_count */
 	ulint innodb_row_lock_time_max;		/*!< srv_n_lock_max_wait_time
 						/ 1000 */
+	ulint innodb_deadlock_checks;		/*!< lock_deadlock_n_checks */
+	ulint innodb_deadlocks;			/*!< lock_deadlock_n_found */
+	ulint innodb_deadlock_too_long;		/*!< lock_deadlock_n_too_long */
+	ib_int64_t innodb_deadlock_check_time;	/*!< lock_deadlock_check_time */
+	ib_int64_t innodb_deadlock_check_time_max;/*!< lock_deadlock_check_max_time */
+	ulint innodb_lock_rec_hash_cells;	/*!< cells in lock_sys->rec_hash */
+	ulint innodb_lock_rec_hash_searches;	/*!< sum over
+						lock_sys->rec_hash_stats */
+	ulint innodb_lock_rec_hash_steps;	/*!< sum over
+						lock_sys->rec_hash_stats */
+	ulint innodb_lock_rec_hash_max_steps;	/*!< max over
+						lock_sys->rec_hash_stats */
+	ulint innodb_lock_rec_hash_nolock;	/*!< sum over
+						lock_sys->rec_hash_stats */
+	ulint innodb_mem_block_cache_hits;	/*!< sum over the
+						mem_block_cache_t */
+	ulint innodb_mem_block_cache_misses;	/*!< sum over the
+						mem_block_cache_t */
+	ulint innodb_dict_cache_tables;		/*!< UT_LIST_GET_LEN(
+						dict_sys->table_LRU) */
+	ulint innodb_dict_cache_hits;		/*!< dict_sys->n_hits */
+	ulint innodb_dict_cache_misses;		/*!< dict_sys->n_misses */
+	ulint innodb_dict_cache_evictions;	/*!< dict_sys->n_evicted */
+	ulint innodb_cursor_cache_hits;		/*!< srv_n_cursor_cache_hits */
+	ulint innodb_cursor_cache_misses;	/*!< srv_n_cursor_cache_misses */
+	ulint innodb_cursor_cache_evictions;	/*!< srv_n_cursor_cache_evictions */
+	ib_int64_t innodb_mutex_spin_waits;	/*!< mutex_spin_wait_count */
+	ib_int64_t innodb_mutex_spin_rounds;	/*!< mutex_spin_round_count */
+	ib_int64_t innodb_mutex_os_waits;	/*!< mutex_os_wait_count */
+	ib_int64_t innodb_mutex_os_yields;	/*!< mutex_os_yield_count */
+	ib_int64_t innodb_rw_s_spin_waits;	/*!< rw_s_spin_wait_count */
+	ib_int64_t innodb_rw_s_spin_rounds;	/*!< rw_s_spin_round_count */
+	ib_int64_t innodb_rw_s_os_waits;	/*!< rw_s_os_wait_count */
+	ib_int64_t innodb_rw_s_os_yields;	/*!< rw_s_os_yield_count */
+	ib_int64_t innodb_rw_x_spin_waits;	/*!< rw_x_spin_wait_count */
+	ib_int64_t innodb_rw_x_spin_rounds;	/*!< rw_x_spin_round_count */
+	ib_int64_t innodb_rw_x_os_waits;	/*!< rw_x_os_wait_count */
+	ib_int64_t innodb_rw_x_os_yields;	/*!< rw_x_os_yield_count */
 	ulint innodb_rows_read;			/*!< srv_n_rows_read */
 	ulint innodb_rows_inserted;		/*!< srv_n_rows_inserted */
 	ulint innodb_rows_updated;		/*!< srv_n_rows_updated */
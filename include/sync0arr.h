@@ -41,6 +41,16 @@ typedef struct sync_array_struct	sync_array_t;
 #define SYNC_ARRAY_MUTEX	2	/*!< protected by mutex_t */
 /* @} */
 
+/** Number of shards in sync_wait_array. A waiting thread reserves a
+cell in the shard chosen by its thread id, so that threads waiting for
+latches do not all serialize on one wait array mutex. Deadlock detection
+needs to see all waiting threads in one array. */
+#ifdef UNIV_SYNC_DEBUG
+# define SYNC_WAIT_ARRAY_SIZE	1
+#else /* UNIV_SYNC_DEBUG */
+# define SYNC_WAIT_ARRAY_SIZE	32
+#endif /* UNIV_SYNC_DEBUG */
+
 /*******************************************************************//**
 Creates a synchronization wait array. It is protected by a mutex
 which is automatically reserved when the functions operating on it
@@ -63,10 +73,26 @@ sync_array_free(
 /*============*/
 	sync_array_t*	arr);	/*!< in, own: sync wait array */
 /******************************************************************//**
-Reserves a wait array cell for waiting for an object.
-The event of the cell is reset to nonsignalled state. */
+Creates the shards of sync_wait_array. The cells for OS_THREAD_MAX_N
+threads are divided evenly between the shards. */
 UNIV_INTERN
 void
+sync_array_init(
+/*============*/
+	ulint	n_threads);	/*!< in: maximum number of threads that
+				can wait at the same time */
+/******************************************************************//**
+Frees the shards of sync_wait_array. */
+UNIV_INTERN
+void
+sync_array_close(void);
+/*==================*/
+/******************************************************************//**
+Reserves a wait array cell for waiting for an object.
+The event of the cell is reset to nonsignalled state.
+@return	TRUE if a cell was reserved, FALSE if the array is full */
+UNIV_INTERN
+ibool
 sync_array_reserve_cell(
 /*====================*/
 	sync_array_t*	arr,	/*!< in: wait array */
@@ -76,6 +102,43 @@ sync_array_reserve_cell(
 	ulint		line,	/*!< in: line where requested */
 	ulint*		index); /*!< out: index of the reserved cell */
 /******************************************************************//**
+Reserves a cell in the shard of sync_wait_array of the calling thread,
+or in the next shard that has a free cell if that one is full.
+@return	the shard where the cell was reserved */
+UNIV_INTERN
+sync_array_t*
+sync_array_get_and_reserve_cell(
+/*============================*/
+	void*		object, /*!< in: pointer to the object to wait for */
+	ulint		type,	/*!< in: lock request type */
+	const char*	file,	/*!< in: file where requested */
+	ulint		line,	/*!< in: line where requested */
+	ulint*		index); /*!< out: index of the reserved cell */
+#ifdef INNODB_SYNC_USE_FUTEX
+/** How long a thread sleeps on the futex of a latch before it checks
+if it missed the release of the latch, in microseconds */
+#define SYNC_FUTEX_WAIT_USEC	1000000
+
+/******************************************************************//**
+Sleeps on the futex of a mutex or an rw-lock until the futex is signalled.
+The wait array is not used unless the thread sleeps longer than
+SYNC_FUTEX_WAIT_USEC: then a cell is reserved, so that the wait is
+reported by sync_array_print_long_waits() and the monitor output. The
+thread also stops waiting if it finds the latch free when it wakes up
+on the timeout, in case the signal was missed (see mutex_exit()). */
+UNIV_INTERN
+void
+sync_array_wait_futex(
+/*==================*/
+	void*		object,	/*!< in: pointer to the object to wait for */
+	ulint		type,	/*!< in: lock request type */
+	const char*	file,	/*!< in: file where requested */
+	ulint		line,	/*!< in: line where requested */
+	os_futex_t*	futex,	/*!< in: futex of the object to sleep on */
+	ib_uint32_t	sig_count);/*!< in: value returned by os_futex_reset()
+				before the thread set the waiters flag */
+#else /* INNODB_SYNC_USE_FUTEX */
+/******************************************************************//**
 This function should be called when a thread starts to wait on
 a wait array cell. In the debug version this function checks
 if the wait for a semaphore will result in a deadlock, in which
@@ -86,6 +149,7 @@ sync_array_wait_event(
 /*==================*/
 	sync_array_t*	arr,	/*!< in: wait array */
 	ulint		index);	 /*!< in: index of the reserved cell */
+#endif /* INNODB_SYNC_USE_FUTEX */
 /******************************************************************//**
 Frees the cell. NOTE! sync_array_wait_event frees the cell
 automatically! */
@@ -99,9 +163,8 @@ sync_array_free_cell(
 Note that one of the wait objects was signalled. */
 UNIV_INTERN
 void
-sync_array_object_signalled(
-/*========================*/
-	sync_array_t*	arr);	/*!< in: wait array */
+sync_array_object_signalled(void);
+/*=============================*/
 /**********************************************************************//**
 If the wakeup algorithm does not work perfectly at semaphore relases,
 this function will do the waking (see the comment in mutex_exit). This
@@ -126,13 +189,12 @@ sync_array_validate(
 /*================*/
 	sync_array_t*	arr);	/*!< in: sync wait array */
 /**********************************************************************//**
-Prints info of the wait array. */
+Prints info of all the shards of sync_wait_array. */
 UNIV_INTERN
 void
 sync_array_print_info(
 /*==================*/
-	ib_stream_t	ib_stream,	/*!< in: stream where to print */
-	sync_array_t*	arr);		/*!< in: wait array */
+	ib_stream_t	ib_stream);	/*!< in: stream where to print */
 
 
 #ifndef UNIV_NONINL
@@ -88,6 +88,9 @@ extern	ib_int64_t	rw_s_exit_count;
 /** number of OS waits on rw-latches,
 resulted during shared (read) locks */
 extern	ib_int64_t	rw_s_os_wait_count;
+/** number of os_thread_yield() calls in spin waits on rw-latches,
+resulted during shared (read) locks */
+extern	ib_int64_t	rw_s_os_yield_count;
 /** number of spin waits on rw-latches,
 resulted during shared (read) locks */
 extern	ib_int64_t	rw_x_spin_wait_count;
@@ -97,6 +100,9 @@ extern	ib_int64_t	rw_x_spin_round_count;
 /** number of OS waits on rw-latches,
 resulted during exclusive (write) locks */
 extern	ib_int64_t	rw_x_os_wait_count;
+/** number of os_thread_yield() calls in spin waits on rw-latches,
+resulted during exclusive (write) locks */
+extern	ib_int64_t	rw_x_os_yield_count;
 /** number of unlocks (that unlock exclusive locks),
 set only when UNIV_SYNC_PERF_STAT is defined */
 extern	ib_int64_t	rw_x_exit_count;
@@ -524,10 +530,21 @@ struct rw_lock_struct {
 				/*!< Thread id of writer thread. Is only
 				guaranteed to have sane and non-stale
 				value iff recursive flag is set. */
+	sync_latch_stats_t stats;/*!< Contention counters. May not be
+				accurate. They are near lock_word, which
+				the lockers modify anyway. */
+#ifdef INNODB_SYNC_USE_FUTEX
+	os_futex_t	futex;	/*!< Threads waiting for an s-lock or an
+				x-lock sleep on this futex */
+	os_futex_t	wait_ex_futex;
+				/*!< Futex for next-writer to sleep on. A thread
+				must decrement lock_word before sleeping. */
+#else /* INNODB_SYNC_USE_FUTEX */
 	os_event_t	event;	/*!< Used by sync0arr.c for thread queueing */
 	os_event_t	wait_ex_event;
 				/*!< Event for next-writer to wait on. A thread
 				must decrement lock_word before waiting. */
+#endif /* INNODB_SYNC_USE_FUTEX */
 #ifndef INNODB_RW_LOCKS_USE_ATOMICS
 	mutex_t	mutex;		/*!< The mutex protecting rw_lock_struct */
 #endif /* INNODB_RW_LOCKS_USE_ATOMICS */
@@ -541,7 +558,9 @@ struct rw_lock_struct {
 				info list of the lock */
 	ulint	level;		/*!< Level in the global latching order. */
 #endif /* UNIV_SYNC_DEBUG */
-	ulint count_os_wait;	/*!< Count of os_waits. May not be accurate */
+	ulint spin_rounds;	/*!< Adaptive spin count, see
+				sync_spin_rounds_update() */
+	sync_site_t*	site;	/*!< Creation site */
 	const char*	cfile_name;/*!< File name where lock created */
         /* last s-lock file/line is not guaranteed to be correct */
 	const char*	last_s_file_name;/*!< File name where last s-locked */
@@ -48,6 +48,14 @@ typedef LONG lock_word_t;	/*!< On Windows, InterlockedExchange operates
 typedef byte lock_word_t;
 #endif
 
+/** Contention counters of a latch, or of the latches created at one
+source line */
+typedef struct sync_latch_stats_struct	sync_latch_stats_t;
+/** The latches created at one source line, see sync_site_get() */
+typedef struct sync_site_struct		sync_site_t;
+/** Contention profile of the latches created at one source line */
+typedef struct sync_site_stats_struct	sync_site_stats_t;
+
 /******************************************************************//**
 Initializes the synchronization data structures. */
 UNIV_INTERN
@@ -293,6 +301,74 @@ mutex_get_waiters(
 /*==============*/
 	const mutex_t*	mutex);	/*!< in: mutex */
 #endif /* UNIV_SYNC_DEBUG */
+/******************************************************************//**
+Gets the number of rounds that a thread spins waiting for a latch before
+it suspends itself, from the adaptive spin count of the latch.
+@return	number of spin rounds, between SYNC_SPIN_ROUNDS_MIN and
+SYNC_SPIN_ROUNDS_MAX */
+UNIV_INTERN
+ulint
+sync_spin_rounds_get(
+/*=================*/
+	ulint	spin_rounds);	/*!< in: adaptive spin count of the latch */
+/******************************************************************//**
+Updates the adaptive spin count of a latch with the outcome of a spin
+wait. A latch that is usually acquired by spinning is given about twice
+the rounds it took, while a latch whose waiters have to suspend
+themselves anyway is given fewer rounds each time. */
+UNIV_INTERN
+void
+sync_spin_rounds_update(
+/*====================*/
+	ulint*	spin_rounds,	/*!< in/out: adaptive spin count of
+				the latch */
+	ulint	rounds,		/*!< in: rounds that the thread spun */
+	ibool	acquired);	/*!< in: TRUE if the latch was acquired
+				by spinning, FALSE if the thread had to
+				suspend itself */
+/******************************************************************//**
+Looks up the creation site of a latch, registering it if this is the
+first latch created there. The caller must hold mutex_list_mutex or
+rw_lock_list_mutex, depending on the type of the latch.
+@return	creation site, or NULL if SYNC_SITE_MAX sites exist */
+UNIV_INTERN
+sync_site_t*
+sync_site_get(
+/*==========*/
+	const char*	cfile_name,	/*!< in: file name where created */
+	ulint		cline,		/*!< in: line where created */
+	ibool		rw_lock);	/*!< in: TRUE for an rw-lock,
+					FALSE for a mutex */
+/******************************************************************//**
+Adds the counters of a latch that is being freed to its creation site.
+The caller must hold mutex_list_mutex or rw_lock_list_mutex, depending
+on the type of the latch. */
+UNIV_INTERN
+void
+sync_site_add_freed(
+/*================*/
+	sync_site_t*			site,	/*!< in/out: creation site,
+						or NULL */
+	const sync_latch_stats_t*	stats);	/*!< in: counters of the
+						latch */
+/******************************************************************//**
+Collects the contention counters of the existing and freed latches
+by their creation site.
+@return	array of *n_sites elements, to be freed with ut_free(),
+or NULL if no latch has been created */
+UNIV_INTERN
+sync_site_stats_t*
+sync_site_stats_collect(
+/*====================*/
+	ulint*	n_sites);	/*!< out: number of creation sites */
+/******************************************************************//**
+Resets the contention counters of all latches and creation sites. The
+latches may be in use: an update that is concurrent with the reset may
+be lost or may survive it. */
+UNIV_INTERN
+void
+sync_site_stats_reset(void);
+/*=======================*/
 /**********************************************************************
 Reset variables. */
 UNIV_INTERN
@@ -489,7 +565,10 @@ or row lock! */
 #define	SYNC_BUF_POOL		150
 #define	SYNC_BUF_BLOCK		149
 #define SYNC_DOUBLEWRITE	140
+#define SYNC_DICT_NAME_HASH	137	/* dict_sys->table_hash mutexes */
+#define SYNC_DICT_ID_HASH	136	/* dict_sys->table_id_hash mutexes */
 #define	SYNC_ANY_LATCH		135
+#define SYNC_FIL_SPACE_HASH	134	/* fil_system->spaces mutexes */
 #define SYNC_THR_LOCAL		133
 #define	SYNC_MEM_HASH		131
 #define	SYNC_MEM_POOL		130
@@ -502,13 +581,63 @@ or row lock! */
 #define RW_LOCK_WAIT_EX		353
 #define SYNC_MUTEX		354
 
+/** Contention counters of a latch, or of the latches created at one
+source line. The counters of a latch are not updated atomically, so that
+they may be inexact. */
+struct sync_latch_stats_struct {
+	ib_uint64_t	n_acquired;	/*!< number of times acquired */
+	ib_uint64_t	n_spin_waits;	/*!< number of times a thread had to
+					spin waiting for the latch */
+	ib_uint64_t	n_spin_rounds;	/*!< number of spin rounds */
+	ib_uint64_t	n_os_yields;	/*!< number of os_thread_yield()
+					calls while spinning */
+	ib_uint64_t	n_os_waits;	/*!< number of times a thread
+					suspended itself */
+	ib_uint64_t	wait_time;	/*!< microseconds that threads waited
+					after yielding or suspending */
+};
+
+/** Maximum number of latch creation sites; the latches created at
+further sites are not profiled */
+#define SYNC_SITE_MAX		1024
+
+/** The latches created at one source line */
+struct sync_site_struct {
+	const char*	cfile_name;	/*!< file name where created */
+	ulint		cline;		/*!< line where created */
+	ibool		rw_lock;	/*!< TRUE for rw-locks,
+					FALSE for mutexes */
+	ulint		no;		/*!< ordinal number of the site */
+	sync_latch_stats_t stats;	/*!< counters of the latches that have
+					been freed; protected by
+					mutex_list_mutex or rw_lock_list_mutex,
+					depending on rw_lock */
+	sync_site_t*	hash;		/*!< next site in the hash chain */
+};
+
+/** Contention profile of the latches created at one source line */
+struct sync_site_stats_struct {
+	const char*	cfile_name;	/*!< file name where created */
+	ulint		cline;		/*!< line where created */
+	ibool		rw_lock;	/*!< TRUE for rw-locks,
+					FALSE for mutexes */
+	ulint		n_latches;	/*!< number of existing latches */
+	sync_latch_stats_t stats;	/*!< counters of the existing and
+					the freed latches */
+};
+
 /* NOTE! The structure appears here only for the compiler to know its size.
 Do not use its fields directly! The structure used in the spin lock
 implementation of a mutual exclusion semaphore. */
 
 /** InnoDB mutex */
 struct mutex_struct {
+#ifdef INNODB_SYNC_USE_FUTEX
+	os_futex_t	futex;	/*!< Threads waiting for the mutex sleep
+				on this futex */
+#else /* INNODB_SYNC_USE_FUTEX */
 	os_event_t	event;	/*!< Used by sync0arr.c for the wait queue */
+#endif /* INNODB_SYNC_USE_FUTEX */
 	volatile lock_word_t	lock_word;	/*!< lock_word is the target
 				of the atomic test-and-set instruction when
 				atomic operations are enabled. */
@@ -522,6 +651,12 @@ struct mutex_struct {
 				may be) threads waiting in the global wait
 				array for this mutex to be released.
 				Otherwise, this is 0. */
+	ulint	spin_rounds;	/*!< Adaptive spin count, see
+				sync_spin_rounds_update() */
+	sync_latch_stats_t stats;/*!< Contention counters; n_acquired
+				is only updated by the holder */
+	sync_site_t*	site;	/*!< Creation site, or NULL if the
+				mutex is not in mutex_list */
 	UT_LIST_NODE_T(mutex_t)	list; /*!< All allocated mutexes are put into
 				a list.	Pointers to the next and prev. */
 #ifdef UNIV_SYNC_DEBUG
@@ -538,23 +673,18 @@ struct mutex_struct {
 /** Value of mutex_struct::magic_n */
 # define MUTEX_MAGIC_N	(ulint)979585
 #endif /* UNIV_DEBUG */
-	ulong		count_os_wait;	/*!< count of os_wait */
 #ifdef UNIV_DEBUG
-	ulong		count_using;	/*!< count of times mutex used */
-	ulong		count_spin_loop; /*!< count of spin loops */
-	ulong		count_spin_rounds;/*!< count of spin rounds */
-	ulong		count_os_yield;	/*!< count of os_wait */
-	ib_uint64_t	lspent_time;	/*!< mutex os_wait timer msec */
-	ib_uint64_t	lmax_spent_time;/*!< mutex os_wait timer msec */
 	const char*	cmutex_name;	/*!< mutex name */
 	ulint		mutex_type;	/*!< 0=usual mutex, 1=rw_lock mutex */
 #endif /* UNIV_DEBUG */
 };
 
-/** The global array of wait cells for implementation of the databases own
-mutexes and read-write locks. */
-extern sync_array_t*	sync_primary_wait_array;/* Appears here for
-						debugging purposes only! */
+/** The global arrays of wait cells for implementation of the databases own
+mutexes and read-write locks, SYNC_WAIT_ARRAY_SIZE shards of them. */
+extern sync_array_t**	sync_wait_array;/* Appears here for
+					debugging purposes only! */
+/** Number of shards in sync_wait_array */
+extern ulint		sync_wait_array_size;
 
 /** Constant determining how long spin wait is continued before suspending
 the thread. A value 600 rounds on a 1995 100 MHz Pentium seems to correspond
@@ -562,6 +692,26 @@ to 20 microseconds. */
 
 #define	SYNC_SPIN_ROUNDS	srv_n_spin_wait_rounds
 
+/** Bounds of the adaptive spin count of a latch: the number of rounds
+that a thread spins on a latch before suspending itself is adjusted
+between these, starting from SYNC_SPIN_ROUNDS. @{ */
+#define	SYNC_SPIN_ROUNDS_MIN	((SYNC_SPIN_ROUNDS + 7) / 8)
+#define	SYNC_SPIN_ROUNDS_MAX	(SYNC_SPIN_ROUNDS * 4)
+/* @} */
+
+/** The adaptive spin count of a latch is kept scaled up by
+1 << SYNC_SPIN_ROUNDS_SHIFT, so that it can be averaged in integers */
+#define	SYNC_SPIN_ROUNDS_SHIFT	3
+
+/** Mutex spin wait statistics, intended for performance monitoring.
+The updates are not thread safe, so that the counts may be inexact. @{ */
+extern	ib_int64_t	mutex_spin_wait_count;	/*!< calls to mutex_spin_wait() */
+extern	ib_int64_t	mutex_spin_round_count;	/*!< mutex spin rounds */
+extern	ib_int64_t	mutex_os_wait_count;	/*!< mutex OS waits */
+extern	ib_int64_t	mutex_os_yield_count;	/*!< os_thread_yield() calls
+						in mutex_spin_wait() */
+/* @} */
+
 /** The number of mutex_exit calls. Intended for performance monitoring. */
 extern	ib_int64_t	mutex_exit_count;
 
@@ -106,6 +106,15 @@ trx_rseg_header_create(
 	ulint*	slot_no,	/*!< out: rseg id == slot number in trx sys */
 	mtr_t*	mtr);		/*!< in: mtr */
 /*********************************************************************//**
+Creates a rollback segment in the system tablespace, in the first free
+slot of the trx system header, together with its memory object.
+@return	rollback segment, or NULL if there is no free slot or no
+space left */
+UNIV_INTERN
+trx_rseg_t*
+trx_rseg_create(void);
+/*=================*/
+/*********************************************************************//**
 Creates the memory copies for rollback segments and initializes the
 rseg list and array in trx_sys at a database startup. */
 UNIV_INTERN
@@ -115,6 +115,16 @@ void
 trx_sys_create(
 /*===========*/
 	ib_recovery_t	recovery);	/*!< in: recovery flag */
+/*****************************************************************//**
+Creates the rollback segments that do not exist yet, up to n_rsegs in
+total. This is called at every startup, so that data files created with
+fewer rollback segments get the missing ones.
+@return	number of rollback segments that exist */
+UNIV_INTERN
+ulint
+trx_sys_create_rsegs(
+/*=================*/
+	ulint	n_rsegs);	/*!< in: number of rollback segments wanted */
 /****************************************************************//**
 Looks for a free slot for a rollback segment in the trx system file copy.
 @return	slot index or ULINT_UNDEFINED if not found */
@@ -433,6 +443,11 @@ id must fit in one byte, therefore 256; each slot is currently 8 bytes
 in size */
 #define	TRX_SYS_N_RSEGS		256
 
+/** Maximum number of rollback segments that can be in use: the rollback
+segment id is stored in 7 bits of a roll pointer, see
+trx_undo_build_roll_ptr() */
+#define	TRX_SYS_MAX_RSEGS	128
+
 #if UNIV_PAGE_SIZE < 4096
 # error "UNIV_PAGE_SIZE < 4096"
 #endif
@@ -535,6 +550,10 @@ struct trx_sys_struct{
 	UT_LIST_BASE_NODE_T(trx_t) client_trx_list;
 					/*!< List of transactions created
 					for users */
+	UT_LIST_BASE_NODE_T(trx_t) trx_pool;
+					/*!< Transaction objects released
+					by users, kept for reuse; linked
+					through trx_t::client_trx_list */
 	UT_LIST_BASE_NODE_T(trx_rseg_t) rseg_list;
 					/*!< List of rollback segment
 					objects */
@@ -410,12 +410,19 @@ trx_commit(
 /*=======*/
 	trx_t*	trx);		/*!< in: trx handle */
 /************************************************************************
-Frees a transaction object for client. */
+Frees a transaction object for client. The object is kept in the trx pool
+for reuse by trx_allocate_for_client() if the pool is not full. */
 UNIV_INTERN
 void
 trx_free_for_client(
 /*================*/
 	trx_t*	trx);		/*!< in, own: trx object */
+/********************************************************************//**
+Frees the transaction objects in the trx pool at shutdown. */
+UNIV_INTERN
+void
+trx_pool_close(void);
+/*================*/
 /* Maximum length of a string that can be returned by
 trx_get_que_state_str(). */
 #define TRX_QUE_STATE_STR_MAX_LEN	12 /* "ROLLING BACK" */
@@ -527,6 +534,11 @@ struct trx_struct{
 	/* All the next fields are protected by the kernel mutex, except the
 	undo logs which are protected by undo_mutex */
 	ulint		is_purge;	/*!< 0=user transaction, 1=purge */
+	ibool		read_only;	/*!< TRUE if the transaction was
+					started read-only: it is not given
+					an id or a rollback segment, is not
+					in trx_sys->trx_list and may not
+					modify data or take locks */
 	ulint		is_recovered;	/*!< 0=normal transaction,
 					1=recovered, must be rolled back */
 	ulint		que_state;	/*!< valid when conc_state
@@ -33,11 +33,9 @@ Created 5/30/1994 Heikki Tuuri
 
 /** The total amount of memory currently allocated from the operating
 system with os_mem_alloc_large() or malloc().  Does not count malloc()
-if srv_use_sys_malloc is set.  Protected by ut_list_mutex. */
+if srv_use_sys_malloc is set.  Updated with ut_total_allocated_memory_add()
+and ut_total_allocated_memory_sub(). */
 extern ulint		ut_total_allocated_memory;
-
-/** Mutex protecting ut_total_allocated_memory and ut_mem_block_list */
-extern os_fast_mutex_t	ut_list_mutex;
 #endif /* !UNIV_HOTBACKUP */
 
 /** Wrapper for memcpy(3).  Copy memory area when the source and
@@ -77,6 +75,23 @@ void
 ut_mem_init(void);
 /*=============*/
 
+#ifndef UNIV_HOTBACKUP
+/**********************************************************************//**
+Adds to the count of memory allocated from the operating system. */
+UNIV_INTERN
+void
+ut_total_allocated_memory_add(
+/*==========================*/
+	ulint	n);	/*!< in: number of bytes allocated */
+/**********************************************************************//**
+Subtracts from the count of memory allocated from the operating system. */
+UNIV_INTERN
+void
+ut_total_allocated_memory_sub(
+/*==========================*/
+	ulint	n);	/*!< in: number of bytes freed */
+#endif /* !UNIV_HOTBACKUP */
+
 /**********************************************************************//**
 Allocates memory. Sets it also to zero if UNIV_SET_MEM_TO_ZERO is
 defined and set_to_zero is TRUE.
@@ -373,11 +373,48 @@ Monitor will then fetch it and print */
 UNIV_INTERN ibool	lock_deadlock_found = FALSE;
 UNIV_INTERN ib_stream_t	lock_latest_err_stream;
 
-/* Flags for recursive deadlock search */
+/* Deadlock detection statistics */
+UNIV_INTERN ulint	lock_deadlock_n_checks = 0;
+UNIV_INTERN ulint	lock_deadlock_n_found = 0;
+UNIV_INTERN ulint	lock_deadlock_n_too_long = 0;
+UNIV_INTERN ib_uint64_t	lock_deadlock_check_time = 0;
+UNIV_INTERN ib_uint64_t	lock_deadlock_check_max_time = 0;
+
+/** Number of partitions of lock_sys->rec_hash, each protected by its own
+mutex; must be a power of 2 */
+#define LOCK_REC_HASH_N_MUTEXES	64
+
+/* Flags for deadlock search */
 #define LOCK_VICTIM_IS_START	1
 #define LOCK_VICTIM_IS_OTHER	2
 #define LOCK_EXCEED_MAX_DEPTH	3
 
+/** A frame of the explicit stack used by the deadlock search: one
+transaction in the waits-for path from the starting transaction */
+typedef struct lock_deadlock_frame_struct {
+	trx_t*		trx;		/*!< a transaction waiting for
+					wait_lock */
+	lock_t*		wait_lock;	/*!< lock that trx is waiting for */
+	lock_t*		lock;		/*!< current position in the queue of
+					locks ahead of wait_lock */
+	ulint		heap_no;	/*!< heap number of the record that
+					wait_lock is waiting for, or
+					ULINT_UNDEFINED for a table lock */
+} lock_deadlock_frame_t;
+
+/* The search stack; a frame is pushed for every level that the
+recursive search would have descended, so the depth limit bounds it.
+Protected by the kernel mutex. */
+UNIV_STATIC lock_deadlock_frame_t
+	lock_deadlock_stack[LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK + 2];
+
+/* Generation number of the current deadlock search. A transaction whose
+trx_t::deadlock_mark equals this has had its subtree of the waits-for graph
+exhaustively searched during the current search. Bumping it invalidates all
+marks at once, so we do not need to visit every active transaction before
+each search. Protected by the kernel mutex. */
+UNIV_STATIC ulint	lock_deadlock_mark = 0;
+
 /********************************************************************//**
 Checks if a lock request results in a deadlock.
 @return TRUE if a deadlock was detected and we chose trx as a victim;
@@ -390,7 +427,7 @@ lock_deadlock_occurs(
 	lock_t*	lock,	/*!< in: lock the transaction is requesting */
 	trx_t*	trx);	/*!< in: transaction */
 /********************************************************************//**
-Looks recursively for a deadlock.
+Looks for a deadlock by a depth-first search of the waits-for graph.
 @return 0 if no deadlock found, LOCK_VICTIM_IS_START if there was a
 deadlock and we chose 'start' as the victim, LOCK_VICTIM_IS_OTHER if a
 deadlock was found and we chose some other trx as a victim: we must do
@@ -399,17 +436,13 @@ deadlock!
 LOCK_EXCEED_MAX_DEPTH if the lock search exceeds max steps or max depth. */
 UNIV_STATIC
 ulint
-lock_deadlock_recursive(
-/*====================*/
-	trx_t*	start,		/*!< in: recursion starting point */
-	trx_t*	trx,		/*!< in: a transaction waiting for a lock */
-	lock_t*	wait_lock,	/*!< in:  lock that is waiting to be granted */
-	ulint*	cost,		/*!< in/out: number of calculation steps thus
+lock_deadlock_search(
+/*=================*/
+	trx_t*	start,		/*!< in: search starting point */
+	lock_t*	wait_lock,	/*!< in: lock that start is waiting for */
+	ulint*	cost);		/*!< in/out: number of calculation steps thus
 				far: if this exceeds LOCK_MAX_N_STEPS_...
 				we return LOCK_EXCEED_MAX_DEPTH */
-	ulint	depth);		/*!< in: recursion depth: if this exceeds
-				LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK, we
-				return LOCK_EXCEED_MAX_DEPTH */
 
 /*********************************************************************//**
 Reset the lock variables. */
@@ -424,6 +457,12 @@ lock_var_init(void)
 	lock_sys = NULL;
 	lock_deadlock_found = FALSE;
 	lock_latest_err_stream = NULL;
+	lock_deadlock_mark = 0;
+	lock_deadlock_n_checks = 0;
+	lock_deadlock_n_found = 0;
+	lock_deadlock_n_too_long = 0;
+	lock_deadlock_check_time = 0;
+	lock_deadlock_check_max_time = 0;
 }
 
 /*************************************************************************
@@ -588,7 +627,16 @@ lock_sys_create(
 
 	lock_sys->rec_hash = hash_create(n_cells);
 
-	/* hash_create_mutexes(lock_sys->rec_hash, 2, SYNC_REC_LOCK); */
+	/* The record locks of a page are inserted to and removed from
+	rec_hash while holding both the kernel mutex and the mutex of the
+	partition of the page. Either one protects a lookup. */
+	hash_create_mutexes(lock_sys->rec_hash, LOCK_REC_HASH_N_MUTEXES,
+			    SYNC_REC_LOCK);
+
+	lock_sys->rec_hash_stats = mem_alloc(LOCK_REC_HASH_N_MUTEXES
+					     * sizeof(lock_rec_hash_stats_t));
+	memset(lock_sys->rec_hash_stats, 0x0,
+	       LOCK_REC_HASH_N_MUTEXES * sizeof(lock_rec_hash_stats_t));
 
 	lock_latest_err_stream = os_file_create_tmpfile();
 	ut_a(lock_latest_err_stream);
@@ -606,9 +654,11 @@ lock_sys_close(void)
 		return;
 	}
 
-	/* hash_free_mutexes(lock_sys->rec_hash); */
+	hash_free_mutexes(lock_sys->rec_hash);
 	hash_table_free(lock_sys->rec_hash);
 	lock_sys->rec_hash = NULL;
+	mem_free(lock_sys->rec_hash_stats);
+	lock_sys->rec_hash_stats = NULL;
 
 	if (lock_latest_err_stream != NULL) {
 		fclose(lock_latest_err_stream);
@@ -1120,6 +1170,90 @@ lock_rec_reset_nth_bit(
 	((byte*) &lock[1])[byte_index] &= ~(1 << bit_index);
 }
 
+/*********************************************************************//**
+Gets the mutex of the lock_sys->rec_hash partition that a hash cell
+belongs to.
+@return	mutex */
+UNIV_INLINE
+mutex_t*
+lock_rec_hash_get_mutex(
+/*====================*/
+	ulint	hash)	/*!< in: cell, lock_rec_hash(space, page_no) */
+{
+	return(hash_get_nth_mutex(lock_sys->rec_hash,
+				  ut_2pow_remainder(
+					  hash, lock_sys->rec_hash->n_mutexes)));
+}
+
+/*********************************************************************//**
+Gets the hash chain statistics of the lock_sys->rec_hash partition of a
+hash cell.
+@return	statistics of the partition */
+UNIV_INLINE
+lock_rec_hash_stats_t*
+lock_rec_hash_get_stats_of(
+/*=======================*/
+	ulint	hash)	/*!< in: cell, lock_rec_hash(space, page_no) */
+{
+	return(lock_sys->rec_hash_stats
+	       + ut_2pow_remainder(hash, lock_sys->rec_hash->n_mutexes));
+}
+
+/*********************************************************************//**
+Gets the record lock hash chain statistics, summed over the partitions of
+lock_sys->rec_hash. The counters are read without a latch. */
+UNIV_INTERN
+void
+lock_rec_hash_get_stats(
+/*====================*/
+	ulint*	n_searches,	/*!< out: number of lookups of the first
+				lock on a page */
+	ulint*	n_steps,	/*!< out: number of locks on other pages
+				skipped over in those lookups */
+	ulint*	max_steps,	/*!< out: most locks skipped over in one
+				lookup */
+	ulint*	n_nolock)	/*!< out: number of insert and secondary
+				index modify checks that found no lock
+				without reserving the kernel mutex */
+{
+	ulint	i;
+
+	*n_searches = 0;
+	*n_steps = 0;
+	*max_steps = 0;
+	*n_nolock = 0;
+
+	for (i = 0; i < LOCK_REC_HASH_N_MUTEXES; i++) {
+		const lock_rec_hash_stats_t*	stats
+			= &lock_sys->rec_hash_stats[i];
+
+		*n_searches += stats->n_searches;
+		*n_steps += stats->n_steps;
+		*n_nolock += stats->n_nolock;
+
+		if (stats->max_steps > *max_steps) {
+			*max_steps = stats->max_steps;
+		}
+	}
+}
+
+#ifdef UNIV_DEBUG
+/*********************************************************************//**
+Checks if the thread owns the kernel mutex or the mutex of the
+lock_sys->rec_hash partition of a hash cell. Either one protects the
+record locks of a page from being inserted or removed.
+@return	TRUE if owns */
+UNIV_STATIC
+ibool
+lock_rec_hash_own(
+/*==============*/
+	ulint	hash)	/*!< in: cell, lock_rec_hash(space, page_no) */
+{
+	return(mutex_own(&kernel_mutex)
+	       || mutex_own(lock_rec_hash_get_mutex(hash)));
+}
+#endif /* UNIV_DEBUG */
+
 /*********************************************************************//**
 Gets the first or next record lock on a page.
 @return	next lock, NULL if none exists */
@@ -1132,12 +1266,13 @@ lock_rec_get_next_on_page(
 	ulint	space;
 	ulint	page_no;
 
-	ut_ad(mutex_own(&kernel_mutex));
 	ut_ad(lock_get_type_low(lock) == LOCK_REC);
 
 	space = lock->un_member.rec_lock.space;
 	page_no = lock->un_member.rec_lock.page_no;
 
+	ut_ad(lock_rec_hash_own(lock_rec_hash(space, page_no)));
+
 	for (;;) {
 		lock = HASH_GET_NEXT(hash, lock);
 
@@ -1157,22 +1292,25 @@ lock_rec_get_next_on_page(
 }
 
 /*********************************************************************//**
-Gets the first record lock on a page, where the page is identified by its
-file address.
+Looks up the first record lock on a page in the record lock hash table and
+updates the hash chain statistics.
 @return	first lock, NULL if none exists */
 UNIV_INLINE
 lock_t*
-lock_rec_get_first_on_page_addr(
-/*============================*/
+lock_rec_hash_search(
+/*=================*/
 	ulint	space,	/*!< in: space */
-	ulint	page_no)/*!< in: page number */
+	ulint	page_no,/*!< in: page number */
+	ulint	hash)	/*!< in: lock_rec_hash(space, page_no) */
 {
-	lock_t*	lock;
+	lock_t*			lock;
+	lock_rec_hash_stats_t*	stats;
+	ulint			n_steps	= 0;
 
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(lock_rec_hash_own(hash));
+
+	lock = HASH_GET_FIRST(lock_sys->rec_hash, hash);
 
-	lock = HASH_GET_FIRST(lock_sys->rec_hash,
-			      lock_rec_hash(space, page_no));
 	while (lock) {
 		if ((lock->un_member.rec_lock.space == space)
 		    && (lock->un_member.rec_lock.page_no == page_no)) {
@@ -1180,12 +1318,38 @@ lock_rec_get_first_on_page_addr(
 			break;
 		}
 
+		++n_steps;
+
 		lock = HASH_GET_NEXT(hash, lock);
 	}
 
+	stats = lock_rec_hash_get_stats_of(hash);
+
+	++stats->n_searches;
+	stats->n_steps += n_steps;
+
+	if (n_steps > stats->max_steps) {
+		stats->max_steps = n_steps;
+	}
+
 	return(lock);
 }
 
+/*********************************************************************//**
+Gets the first record lock on a page, where the page is identified by its
+file address.
+@return	first lock, NULL if none exists */
+UNIV_INLINE
+lock_t*
+lock_rec_get_first_on_page_addr(
+/*============================*/
+	ulint	space,	/*!< in: space */
+	ulint	page_no)/*!< in: page number */
+{
+	return(lock_rec_hash_search(
+		       space, page_no, lock_rec_hash(space, page_no)));
+}
+
 /*********************************************************************//**
 Returns TRUE if there are explicit record locks on a page.
 @return	TRUE if there are explicit record locks on the page */
@@ -1221,28 +1385,11 @@ lock_rec_get_first_on_page(
 /*=======================*/
 	const buf_block_t*	block)	/*!< in: buffer block */
 {
-	ulint	hash;
-	lock_t*	lock;
-	ulint	space	= buf_block_get_space(block);
-	ulint	page_no	= buf_block_get_page_no(block);
-
 	ut_ad(mutex_own(&kernel_mutex));
 
-	hash = buf_block_get_lock_hash_val(block);
-
-	lock = HASH_GET_FIRST(lock_sys->rec_hash, hash);
-
-	while (lock) {
-		if ((lock->un_member.rec_lock.space == space)
-		    && (lock->un_member.rec_lock.page_no == page_no)) {
-
-			break;
-		}
-
-		lock = HASH_GET_NEXT(hash, lock);
-	}
-
-	return(lock);
+	return(lock_rec_hash_search(buf_block_get_space(block),
+				    buf_block_get_page_no(block),
+				    buf_block_get_lock_hash_val(block)));
 }
 
 /*********************************************************************//**
@@ -1289,6 +1436,47 @@ lock_rec_get_first(
 	return(lock);
 }
 
+/*********************************************************************//**
+Checks if there are explicit lock requests on a record without reserving
+the kernel mutex. Only the mutex of the lock_sys->rec_hash partition of
+the page is reserved. The locks on the page can be released meanwhile,
+but none can be created, because the caller holds an x-latch on the page.
+@return	TRUE if a lock request may exist on the record */
+UNIV_STATIC
+ibool
+lock_rec_exists_nolock(
+/*===================*/
+	const buf_block_t*	block,	/*!< in: block containing the record */
+	ulint			heap_no,/*!< in: heap number of the record */
+	mtr_t*			mtr)	/*!< in: mini-transaction holding
+					an x-latch on block */
+{
+	lock_t*		lock;
+	mutex_t*	mutex;
+	ulint		hash	= buf_block_get_lock_hash_val(block);
+
+	ut_ad(mtr_memo_contains(mtr, block, MTR_MEMO_PAGE_X_FIX));
+	UT_NOT_USED(mtr);
+
+	mutex = lock_rec_hash_get_mutex(hash);
+
+	mutex_enter(mutex);
+
+	for (lock = lock_rec_hash_search(buf_block_get_space(block),
+					 buf_block_get_page_no(block), hash);
+	     lock != NULL && !lock_rec_get_nth_bit(lock, heap_no);
+	     lock = lock_rec_get_next_on_page(lock)) {
+	}
+
+	if (lock == NULL) {
+		++lock_rec_hash_get_stats_of(hash)->n_nolock;
+	}
+
+	mutex_exit(mutex);
+
+	return(lock != NULL);
+}
+
 /*********************************************************************//**
 Resets the record lock bitmap to zero. NOTE: does not touch the wait_lock
 pointer in the transaction! This function is used in lock object creation
@@ -1412,6 +1600,29 @@ lock_table_has(
 	return(NULL);
 }
 
+/*********************************************************************//**
+Checks if a transaction holds a granted lock on a table in the given
+mode or stronger.
+@return	TRUE if the transaction holds such a lock */
+UNIV_INTERN
+ibool
+lock_trx_has_table_lock(
+/*====================*/
+	trx_t*		trx,	/*!< in: transaction */
+	dict_table_t*	table,	/*!< in: table */
+	enum lock_mode	mode)	/*!< in: lock mode */
+{
+	ibool	has;
+
+	lock_mutex_enter_kernel();
+
+	has = lock_table_has(trx, table, mode) != NULL;
+
+	lock_mutex_exit_kernel();
+
+	return(has);
+}
+
 /*============= FUNCTIONS FOR ANALYZING RECORD LOCK QUEUE ================*/
 
 /*********************************************************************//**
@@ -1732,8 +1943,10 @@ lock_rec_create_low(
 	/* Set the bit corresponding to rec */
 	lock_rec_set_nth_bit(lock, heap_no);
 
+	hash_mutex_enter(lock_sys->rec_hash, lock_rec_fold(space, page_no));
 	HASH_INSERT(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), lock);
+	hash_mutex_exit(lock_sys->rec_hash, lock_rec_fold(space, page_no));
 	if (UNIV_UNLIKELY(type_mode & LOCK_WAIT)) {
 
 		lock_set_lock_and_trx_wait(lock, trx);
@@ -2285,8 +2498,10 @@ lock_rec_dequeue_from_page(
 	space = in_lock->un_member.rec_lock.space;
 	page_no = in_lock->un_member.rec_lock.page_no;
 
+	hash_mutex_enter(lock_sys->rec_hash, lock_rec_fold(space, page_no));
 	HASH_DELETE(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), in_lock);
+	hash_mutex_exit(lock_sys->rec_hash, lock_rec_fold(space, page_no));
 
 	UT_LIST_REMOVE(trx_locks, trx->trx_locks, in_lock);
 
@@ -2328,8 +2543,10 @@ lock_rec_discard(
 	space = in_lock->un_member.rec_lock.space;
 	page_no = in_lock->un_member.rec_lock.page_no;
 
+	hash_mutex_enter(lock_sys->rec_hash, lock_rec_fold(space, page_no));
 	HASH_DELETE(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), in_lock);
+	hash_mutex_exit(lock_sys->rec_hash, lock_rec_fold(space, page_no));
 
 	UT_LIST_REMOVE(trx_locks, trx->trx_locks, in_lock);
 }
@@ -3294,37 +3511,61 @@ lock_deadlock_occurs(
 	lock_t*	lock,	/*!< in: lock the transaction is requesting */
 	trx_t*	trx)	/*!< in: transaction */
 {
-	trx_t*		mark_trx;
 	ulint		ret;
 	ulint		cost	= 0;
+	ib_uint64_t	start_time;
+	ib_uint64_t	elapsed;
 
 	ut_ad(trx);
 	ut_ad(lock);
 	ut_ad(mutex_own(&kernel_mutex));
+
+	if (!srv_deadlock_detect) {
+		/* The user has chosen to rely on lock_wait_timeout
+		to resolve deadlocks. */
+
+		return(FALSE);
+	}
+
+	start_time = ut_time_us(NULL);
 retry:
+	++lock_deadlock_n_checks;
+
 	/* We check that adding this trx to the waits-for graph
-	does not produce a cycle. First mark all active transactions
-	with 0: */
+	does not produce a cycle. Start a new search generation: this
+	invalidates the marks left by previous searches. */
 
-	mark_trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
+	if (UNIV_UNLIKELY(++lock_deadlock_mark == 0)) {
+		trx_t*	mark_trx;
+
+		/* The generation counter wrapped around: reset the
+		marks so that no stale mark can match. */
+
+		for (mark_trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
+		     mark_trx != NULL;
+		     mark_trx = UT_LIST_GET_NEXT(trx_list, mark_trx)) {
+
+			mark_trx->deadlock_mark = 0;
+		}
 
-	while (mark_trx) {
-		mark_trx->deadlock_mark = 0;
-		mark_trx = UT_LIST_GET_NEXT(trx_list, mark_trx);
+		lock_deadlock_mark = 1;
 	}
 
-	ret = lock_deadlock_recursive(trx, trx, lock, &cost, 0);
+	ret = lock_deadlock_search(trx, lock, &cost);
 
 	switch (ret) {
 	case LOCK_VICTIM_IS_OTHER:
 		/* We chose some other trx as a victim: retry if there still
 		is a deadlock */
+		++lock_deadlock_n_found;
 		goto retry;
 
 	case LOCK_EXCEED_MAX_DEPTH:
 		/* If the lock search exceeds the max step
 		or the max depth, the current trx will be
 		the victim. Print its information. */
+		++lock_deadlock_n_too_long;
+
 		ut_print_timestamp(ib_stream);
 
 		ib_logger(ib_stream,
@@ -3346,12 +3587,27 @@ retry:
 		break;
 
 	case LOCK_VICTIM_IS_START:
+		++lock_deadlock_n_found;
+
 		ib_logger(ib_stream,
 			"*** WE ROLL BACK TRANSACTION (2)\n");
 		break;
 
 	default:
 		/* No deadlock detected*/
+		break;
+	}
+
+	elapsed = ut_time_us(NULL) - start_time;
+
+	lock_deadlock_check_time += elapsed;
+
+	if (elapsed > lock_deadlock_check_max_time) {
+		lock_deadlock_check_max_time = elapsed;
+	}
+
+	if (ret == 0) {
+
 		return(FALSE);
 	}
 
@@ -3361,57 +3617,35 @@ retry:
 }
 
 /********************************************************************//**
-Looks recursively for a deadlock.
-@return 0 if no deadlock found, LOCK_VICTIM_IS_START if there was a
-deadlock and we chose 'start' as the victim, LOCK_VICTIM_IS_OTHER if a
-deadlock was found and we chose some other trx as a victim: we must do
-the search again in this last case because there may be another
-deadlock!
-LOCK_EXCEED_MAX_DEPTH if the lock search exceeds max steps or max depth. */
+Positions a deadlock search frame on the first lock ahead of its wait lock
+in the lock queue. */
 UNIV_STATIC
-ulint
-lock_deadlock_recursive(
-/*====================*/
-	trx_t*	start,		/*!< in: recursion starting point */
-	trx_t*	trx,		/*!< in: a transaction waiting for a lock */
-	lock_t*	wait_lock,	/*!< in: lock that is waiting to be granted */
-	ulint*	cost,		/*!< in/out: number of calculation steps thus
-				far: if this exceeds LOCK_MAX_N_STEPS_...
-				we return LOCK_EXCEED_MAX_DEPTH */
-	ulint	depth)		/*!< in: recursion depth: if this exceeds
-				LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK, we
-				return LOCK_EXCEED_MAX_DEPTH */
+void
+lock_deadlock_frame_init(
+/*=====================*/
+	lock_deadlock_frame_t*	frame,		/*!< out: search frame */
+	trx_t*			trx,		/*!< in: transaction waiting
+						for wait_lock */
+	lock_t*			wait_lock)	/*!< in: lock that is waiting
+						to be granted */
 {
-	ulint	ret;
 	lock_t*	lock;
-	trx_t*	lock_trx;
-	ulint	heap_no		= ULINT_UNDEFINED;
 
 	ut_a(trx);
-	ut_a(start);
 	ut_a(wait_lock);
-	ut_ad(mutex_own(&kernel_mutex));
-
-	if (trx->deadlock_mark == 1) {
-		/* We have already exhaustively searched the subtree starting
-		from this trx */
 
-		return(0);
-	}
-
-	*cost = *cost + 1;
+	frame->trx = trx;
+	frame->wait_lock = wait_lock;
 
 	if (lock_get_type_low(wait_lock) == LOCK_REC) {
-		ulint		space;
-		ulint		page_no;
+		ulint	heap_no;
 
 		heap_no = lock_rec_find_set_bit(wait_lock);
 		ut_a(heap_no != ULINT_UNDEFINED);
 
-		space = wait_lock->un_member.rec_lock.space;
-		page_no = wait_lock->un_member.rec_lock.page_no;
-
-		lock = lock_rec_get_first_on_page_addr(space, page_no);
+		lock = lock_rec_get_first_on_page_addr(
+			wait_lock->un_member.rec_lock.space,
+			wait_lock->un_member.rec_lock.page_no);
 
 		/* Position the iterator on the first matching record lock. */
 		while (lock != NULL
@@ -3427,175 +3661,240 @@ lock_deadlock_recursive(
 
 		ut_ad(lock == NULL || lock_rec_get_nth_bit(lock, heap_no));
 
+		frame->heap_no = heap_no;
 	} else {
-		lock = wait_lock;
+		/* Table locks ahead of wait_lock precede it in the
+		queue of the table. */
+		lock = UT_LIST_GET_PREV(un_member.tab_lock.locks, wait_lock);
+
+		frame->heap_no = ULINT_UNDEFINED;
 	}
 
-	/* Look at the locks ahead of wait_lock in the lock queue */
+	frame->lock = lock;
+}
 
-	for (;;) {
-		/* Get previous table lock. */
-		if (heap_no == ULINT_UNDEFINED) {
+/********************************************************************//**
+Advances a deadlock search frame to the next lock ahead of its wait lock
+in the lock queue. */
+UNIV_STATIC
+void
+lock_deadlock_frame_next(
+/*=====================*/
+	lock_deadlock_frame_t*	frame)	/*!< in/out: search frame */
+{
+	lock_t*	lock	= frame->lock;
 
-			lock = UT_LIST_GET_PREV(
-				un_member.tab_lock.locks, lock);
-		}
+	ut_a(lock != NULL);
 
-		if (lock == NULL) {
-			/* We can mark this subtree as searched */
-			trx->deadlock_mark = 1;
+	if (frame->heap_no == ULINT_UNDEFINED) {
 
-			return(FALSE);
+		lock = UT_LIST_GET_PREV(un_member.tab_lock.locks, lock);
+	} else {
+		do {
+			lock = lock_rec_get_next_on_page(lock);
+		} while (lock != NULL
+			 && lock != frame->wait_lock
+			 && !lock_rec_get_nth_bit(lock, frame->heap_no));
+
+		if (lock == frame->wait_lock) {
+			lock = NULL;
 		}
+	}
 
-		if (lock_has_to_wait(wait_lock, lock)) {
+	frame->lock = lock;
+}
 
-			ibool	too_far
-				= depth > LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK
-				|| *cost > LOCK_MAX_N_STEPS_IN_DEADLOCK_CHECK;
+/********************************************************************//**
+Prints the two transactions of a detected deadlock cycle to the latest
+deadlock error stream. */
+UNIV_STATIC
+void
+lock_deadlock_print(
+/*================*/
+	const trx_t*	start,		/*!< in: search starting point */
+	const lock_t*	wait_lock,	/*!< in: lock that is waiting */
+	const lock_t*	lock)		/*!< in: lock of start that
+					wait_lock has to wait for */
+{
+	ib_stream_t	ib_stream;
 
-			lock_trx = lock->trx;
+	ib_stream = lock_latest_err_stream;
 
-			if (lock_trx == start) {
+	ut_print_timestamp(ib_stream);
 
-				/* We came back to the recursion starting
-				point: a deadlock detected; or we have
-				searched the waits-for graph too long */
+	ib_logger(ib_stream, "\n*** (1) TRANSACTION:\n");
 
-				ib_stream_t	ib_stream;
+	trx_print(ib_stream, wait_lock->trx, 3000);
 
-				ib_stream = lock_latest_err_stream;
+	ib_logger(ib_stream,
+		  "*** (1) WAITING FOR THIS LOCK TO BE GRANTED:\n");
 
-				ut_print_timestamp(ib_stream);
+	if (lock_get_type_low(wait_lock) == LOCK_REC) {
+		lock_rec_print(ib_stream, wait_lock);
+	} else {
+		lock_table_print(ib_stream, wait_lock);
+	}
 
-				ib_logger(ib_stream,
-					"\n*** (1) TRANSACTION:\n");
+	ib_logger(ib_stream, "*** (2) TRANSACTION:\n");
 
-				trx_print(ib_stream, wait_lock->trx, 3000);
+	trx_print(ib_stream, lock->trx, 3000);
 
-				ib_logger(ib_stream,
-					"*** (1) WAITING FOR THIS LOCK"
-					" TO BE GRANTED:\n");
+	ib_logger(ib_stream, "*** (2) HOLDS THE LOCK(S):\n");
 
-				if (lock_get_type_low(wait_lock) == LOCK_REC) {
-					lock_rec_print(ib_stream, wait_lock);
-				} else {
-					lock_table_print(ib_stream, wait_lock);
-				}
+	if (lock_get_type_low(lock) == LOCK_REC) {
+		lock_rec_print(ib_stream, lock);
+	} else {
+		lock_table_print(ib_stream, lock);
+	}
 
-				ib_logger(ib_stream, "*** (2) TRANSACTION:\n");
+	ib_logger(ib_stream,
+		  "*** (2) WAITING FOR THIS LOCK TO BE GRANTED:\n");
 
-				trx_print(ib_stream, lock->trx, 3000);
+	if (lock_get_type_low(start->wait_lock) == LOCK_REC) {
+		lock_rec_print(ib_stream, start->wait_lock);
+	} else {
+		lock_table_print(ib_stream, start->wait_lock);
+	}
+#ifdef UNIV_DEBUG
+	if (lock_print_waits) {
+		ib_logger(ib_stream, "Deadlock detected\n");
+	}
+#endif /* UNIV_DEBUG */
+}
 
-				ib_logger(ib_stream,
-					"*** (2) HOLDS THE LOCK(S):\n");
+/********************************************************************//**
+Looks for a deadlock by a depth-first search of the waits-for graph.
+The search keeps its path in lock_deadlock_stack[] instead of recursing,
+so that a long chain of waiters cannot exhaust the thread stack.
+@return 0 if no deadlock found, LOCK_VICTIM_IS_START if there was a
+deadlock and we chose 'start' as the victim, LOCK_VICTIM_IS_OTHER if a
+deadlock was found and we chose some other trx as a victim: we must do
+the search again in this last case because there may be another
+deadlock!
+LOCK_EXCEED_MAX_DEPTH if the lock search exceeds max steps or max depth. */
+UNIV_STATIC
+ulint
+lock_deadlock_search(
+/*=================*/
+	trx_t*	start,		/*!< in: search starting point */
+	lock_t*	wait_lock,	/*!< in: lock that start is waiting for */
+	ulint*	cost)		/*!< in/out: number of calculation steps thus
+				far: if this exceeds LOCK_MAX_N_STEPS_...
+				we return LOCK_EXCEED_MAX_DEPTH */
+{
+	lock_deadlock_frame_t*	frame;
+	ulint			depth	= 0;
 
-				if (lock_get_type_low(lock) == LOCK_REC) {
-					lock_rec_print(ib_stream, lock);
-				} else {
-					lock_table_print(ib_stream, lock);
-				}
+	ut_a(start);
+	ut_ad(mutex_own(&kernel_mutex));
 
-				ib_logger(ib_stream,
-					"*** (2) WAITING FOR THIS LOCK"
-					" TO BE GRANTED:\n");
+	*cost = *cost + 1;
 
-				if (lock_get_type_low(start->wait_lock)
-				    == LOCK_REC) {
-					lock_rec_print(
-						ib_stream, start->wait_lock);
-				} else {
-					lock_table_print(
-						ib_stream, start->wait_lock);
-				}
-#ifdef UNIV_DEBUG
-				if (lock_print_waits) {
-					ib_logger(ib_stream,
-						"Deadlock detected\n");
-				}
-#endif /* UNIV_DEBUG */
+	frame = &lock_deadlock_stack[0];
+	lock_deadlock_frame_init(frame, start, wait_lock);
 
-				if (trx_weight_cmp(wait_lock->trx,
-						   start) >= 0) {
-					/* Our recursion starting point
-					transaction is 'smaller', let us
-					choose 'start' as the victim and roll
-					back it */
+	for (;;) {
+		lock_t*	lock	= frame->lock;
+		trx_t*	lock_trx;
 
-					return(LOCK_VICTIM_IS_START);
-				}
+		if (lock == NULL) {
+			/* We can mark this subtree as searched */
+			frame->trx->deadlock_mark = lock_deadlock_mark;
 
-				lock_deadlock_found = TRUE;
+			if (depth == 0) {
 
-				/* Let us choose the transaction of wait_lock
-				as a victim to try to avoid deadlocking our
-				recursion starting point transaction */
+				return(0);
+			}
 
-				ib_logger(ib_stream,
-					"*** WE ROLL BACK TRANSACTION (1)\n");
+			/* Return to the waiter whose lock queue led us
+			here and continue with the next lock ahead of it. */
+			frame = &lock_deadlock_stack[--depth];
+			lock_deadlock_frame_next(frame);
 
-				wait_lock->trx->was_chosen_as_deadlock_victim
-					= TRUE;
+			continue;
+		}
 
-				lock_cancel_waiting_and_release(wait_lock);
+		if (!lock_has_to_wait(frame->wait_lock, lock)) {
 
-				/* Since trx and wait_lock are no longer
-				in the waits-for graph, we can return FALSE;
-				note that our selective algorithm can choose
-				several transactions as victims, but still
-				we may end up rolling back also the recursion
-				starting point transaction! */
+			lock_deadlock_frame_next(frame);
 
-				return(LOCK_VICTIM_IS_OTHER);
-			}
+			continue;
+		}
 
-			if (too_far) {
+		lock_trx = lock->trx;
 
-#ifdef UNIV_DEBUG
-				if (lock_print_waits) {
-					ib_logger(ib_stream,
-						  "Deadlock search exceeds"
-						  " max steps or depth.\n");
-				}
-#endif /* UNIV_DEBUG */
-				/* The information about transaction/lock
-				to be rolled back is available in the top
-				level. Do not print anything here. */
-				return(LOCK_EXCEED_MAX_DEPTH);
+		if (lock_trx == start) {
+
+			/* We came back to the search starting point:
+			a deadlock detected */
+
+			lock_deadlock_print(start, frame->wait_lock, lock);
+
+			if (trx_weight_cmp(frame->wait_lock->trx, start) >= 0) {
+				/* Our search starting point transaction is
+				'smaller', let us choose 'start' as the victim
+				and roll back it */
+
+				return(LOCK_VICTIM_IS_START);
 			}
 
-			if (lock_trx->que_state == TRX_QUE_LOCK_WAIT) {
+			lock_deadlock_found = TRUE;
 
-				/* Another trx ahead has requested lock	in an
-				incompatible mode, and is itself waiting for
-				a lock */
+			/* Let us choose the transaction of wait_lock as a
+			victim to try to avoid deadlocking our search
+			starting point transaction */
 
-				ret = lock_deadlock_recursive(
-					start, lock_trx,
-					lock_trx->wait_lock, cost, depth + 1);
+			ib_logger(lock_latest_err_stream,
+				  "*** WE ROLL BACK TRANSACTION (1)\n");
 
-				if (ret != 0) {
+			frame->wait_lock->trx->was_chosen_as_deadlock_victim
+				= TRUE;
 
-					return(ret);
-				}
+			lock_cancel_waiting_and_release(frame->wait_lock);
+
+			/* Since trx and wait_lock are no longer in the
+			waits-for graph, we can return; note that our
+			selective algorithm can choose several transactions
+			as victims, but still we may end up rolling back
+			also the search starting point transaction! */
+
+			return(LOCK_VICTIM_IS_OTHER);
+		}
+
+		if (depth > LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK
+		    || *cost > LOCK_MAX_N_STEPS_IN_DEADLOCK_CHECK) {
+
+#ifdef UNIV_DEBUG
+			if (lock_print_waits) {
+				ib_logger(ib_stream,
+					  "Deadlock search exceeds"
+					  " max steps or depth.\n");
 			}
+#endif /* UNIV_DEBUG */
+			/* The information about transaction/lock
+			to be rolled back is available in the top
+			level. Do not print anything here. */
+			return(LOCK_EXCEED_MAX_DEPTH);
 		}
-		/* Get the next record lock to check. */
-		if (heap_no != ULINT_UNDEFINED) {
 
-			ut_a(lock != NULL);
+		if (lock_trx->que_state == TRX_QUE_LOCK_WAIT
+		    && lock_trx->deadlock_mark != lock_deadlock_mark) {
 
-			do {
-				lock = lock_rec_get_next_on_page(lock);
-			} while (lock != NULL
-				&& lock != wait_lock
-				&& !lock_rec_get_nth_bit(lock, heap_no));
+			/* Another trx ahead has requested lock in an
+			incompatible mode, and is itself waiting for
+			a lock: descend into its lock queue */
 
-			if (lock == wait_lock) {
-				lock = NULL;
-			}
+			*cost = *cost + 1;
+
+			frame = &lock_deadlock_stack[++depth];
+			lock_deadlock_frame_init(
+				frame, lock_trx, lock_trx->wait_lock);
+
+			continue;
 		}
-	}/* end of the 'for (;;)'-loop */
+
+		lock_deadlock_frame_next(frame);
+	}
 }
 
 /*========================= TABLE LOCKS ==============================*/
@@ -3807,6 +4106,14 @@ lock_table(
 
 	trx = thr_get_trx(thr);
 
+	if (UNIV_UNLIKELY(trx->read_only)) {
+		/* Every modification and every locking read starts by
+		locking the table: refuse them for a read-only
+		transaction, which is not in the waits-for graph. */
+
+		return(DB_READONLY);
+	}
+
 	lock_mutex_enter_kernel();
 
 	/* Look for stronger locks the same trx already has on the table */
@@ -4983,14 +5290,35 @@ lock_rec_insert_check_and_lock(
 	next_rec = page_rec_get_next_const(rec);
 	next_rec_heap_no = page_rec_get_heap_no(next_rec);
 
+	/* Since we hold an x-latch on the page, no lock can be created on
+	the successor meanwhile: if there is none, we do not need the kernel
+	mutex. */
+
+	if (UNIV_LIKELY(!lock_rec_exists_nolock(block, next_rec_heap_no,
+						mtr))) {
+		if (!dict_index_is_clust(index)) {
+			/* Update the page max trx id field */
+			page_update_max_trx_id(block,
+					       buf_block_get_page_zip(block),
+					       trx->id, mtr);
+		}
+
+		*inherit = FALSE;
+
+		return(DB_SUCCESS);
+	}
+
 	lock_mutex_enter_kernel();
 
 	/* When inserting a record into an index, the table must be at
 	least IX-locked or we must be building an index, in which case
-	the table must be at least S-locked. */
+	the table must be at least S-locked, or IS-locked if the index
+	is being built while the table is modified. */
 	ut_ad(lock_table_has(trx, index->table, LOCK_IX)
 	      || (*index->name == TEMP_INDEX_PREFIX
-		  && lock_table_has(trx, index->table, LOCK_S)));
+		  && lock_table_has(trx, index->table,
+				    dict_index_is_online(index)
+				    ? LOCK_IS : LOCK_S)));
 
 	lock = lock_rec_get_first(block, next_rec_heap_no);
 
@@ -5200,16 +5528,26 @@ lock_sec_rec_modify_check_and_lock(
 	/* Another transaction cannot have an implicit lock on the record,
 	because when we come here, we already have modified the clustered
 	index record, and this would not have been possible if another active
-	transaction had modified this secondary index record. */
+	transaction had modified this secondary index record.
 
-	lock_mutex_enter_kernel();
+	If there is no explicit lock request on the record either,
+	lock_rec_lock() would not set any lock, and we can skip the kernel
+	mutex. */
 
-	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
+	if (UNIV_LIKELY(!lock_rec_exists_nolock(block, heap_no, mtr))) {
 
-	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
-			    block, heap_no, index, thr);
+		err = DB_SUCCESS;
+	} else {
+		lock_mutex_enter_kernel();
 
-	lock_mutex_exit_kernel();
+		ut_ad(lock_table_has(thr_get_trx(thr), index->table,
+				     LOCK_IX));
+
+		err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
+				    block, heap_no, index, thr);
+
+		lock_mutex_exit_kernel();
+	}
 
 #ifdef UNIV_DEBUG
 	{
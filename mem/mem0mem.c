@@ -32,6 +32,12 @@ Created 6/9/1994 Heikki Tuuri
 #include "srv0srv.h"
 #include <stdarg.h>
 
+#if !defined UNIV_HOTBACKUP && !defined __WIN__
+/* Cache freed heap blocks in the threads, see mem_block_cache_t */
+# define MEM_BLOCK_CACHE
+# include <pthread.h>
+#endif /* !UNIV_HOTBACKUP && !__WIN__ */
+
 /*
 			THE MEMORY MANAGEMENT
 			=====================
@@ -284,6 +290,282 @@ mem_heap_printf(
 	return(str);
 }
 
+#ifdef MEM_BLOCK_CACHE
+/* Each thread keeps up to MEM_BLOCK_CACHE_DEPTH freed MEM_HEAP_DYNAMIC
+blocks of each size class, so that heaps that are created and freed for
+every row do not call malloc() and free(). The payload of size class i is
+MEM_BLOCK_CACHE_MIN_SIZE << i bytes, capped at MEM_BLOCK_STANDARD_SIZE,
+and the length of the blocks that fit in a class is rounded up to it. */
+
+#define MEM_BLOCK_CACHE_MIN_SIZE	128
+#define MEM_BLOCK_CACHE_N_CLASSES	7
+#define MEM_BLOCK_CACHE_DEPTH		4
+
+/** The freed heap blocks of a thread */
+typedef struct mem_block_cache_struct	mem_block_cache_t;
+/** The freed heap blocks of a thread */
+struct mem_block_cache_struct {
+	ulint		n_blocks[MEM_BLOCK_CACHE_N_CLASSES];
+					/*!< number of blocks of each
+					size class in blocks */
+	mem_block_t*	blocks[MEM_BLOCK_CACHE_N_CLASSES]
+			[MEM_BLOCK_CACHE_DEPTH];
+					/*!< the free blocks */
+	ulint		n_hits;		/*!< number of blocks taken from
+					blocks; written only by the
+					thread */
+	ulint		n_misses;	/*!< number of blocks of a cached
+					size that had to be allocated with
+					malloc(); written only by the
+					thread */
+	UT_LIST_NODE_T(mem_block_cache_t)
+			list;		/*!< list of the caches of the
+					threads; protected by
+					mem_block_cache_mutex */
+};
+
+/** The key of the mem_block_cache_t of a thread */
+UNIV_STATIC pthread_key_t	mem_block_cache_key;
+
+/** Creates mem_block_cache_key once */
+UNIV_STATIC pthread_once_t	mem_block_cache_once = PTHREAD_ONCE_INIT;
+
+/** Protects mem_block_cache_list and the counters of the exited threads
+below. This is not an InnoDB mutex, because the caches are created and
+freed outside the lifetime of the sync system. */
+UNIV_STATIC pthread_mutex_t	mem_block_cache_mutex
+	= PTHREAD_MUTEX_INITIALIZER;
+
+/** The block caches of the running threads */
+UNIV_STATIC UT_LIST_BASE_NODE_T(mem_block_cache_t)	mem_block_cache_list;
+
+/** Sums of mem_block_cache_t::n_hits and n_misses of the threads that
+have exited */
+UNIV_STATIC ulint	mem_block_cache_exited_hits	= 0;
+UNIV_STATIC ulint	mem_block_cache_exited_misses	= 0;
+
+/******************************************************************//**
+Gets the length of the blocks of a size class of the block cache.
+@return	block length, including the header */
+UNIV_INLINE
+ulint
+mem_block_cache_class_len(
+/*======================*/
+	ulint	i)	/*!< in: size class */
+{
+	return(MEM_BLOCK_HEADER_SIZE
+	       + ut_min(MEM_BLOCK_CACHE_MIN_SIZE << i,
+			MEM_BLOCK_STANDARD_SIZE));
+}
+
+/******************************************************************//**
+Gets the smallest size class of the block cache that a block fits in.
+@return	size class, or ULINT_UNDEFINED if the block is too big */
+UNIV_INLINE
+ulint
+mem_block_cache_get_class(
+/*======================*/
+	ulint	len)	/*!< in: block length, including the header */
+{
+	ulint	i;
+
+	for (i = 0; i < MEM_BLOCK_CACHE_N_CLASSES; ++i) {
+		if (len <= mem_block_cache_class_len(i)) {
+			return(i);
+		}
+	}
+
+	return(ULINT_UNDEFINED);
+}
+
+/******************************************************************//**
+Frees the block cache of a thread when the thread exits. */
+UNIV_STATIC
+void
+mem_block_cache_free(
+/*=================*/
+	void*	arg)	/*!< in, own: mem_block_cache_t of the thread */
+{
+	ulint			i;
+	mem_block_cache_t*	cache = arg;
+
+	pthread_mutex_lock(&mem_block_cache_mutex);
+	mem_block_cache_exited_hits += cache->n_hits;
+	mem_block_cache_exited_misses += cache->n_misses;
+	UT_LIST_REMOVE(list, mem_block_cache_list, cache);
+	pthread_mutex_unlock(&mem_block_cache_mutex);
+
+	for (i = 0; i < MEM_BLOCK_CACHE_N_CLASSES; ++i) {
+		while (cache->n_blocks[i] > 0) {
+			free(cache->blocks[i][--cache->n_blocks[i]]);
+		}
+	}
+
+	free(cache);
+}
+
+/******************************************************************//**
+Creates the key of the block caches of the threads. */
+UNIV_STATIC
+void
+mem_block_cache_create_key(void)
+/*============================*/
+{
+	ut_a(pthread_key_create(
+		&mem_block_cache_key, mem_block_cache_free) == 0);
+}
+
+/******************************************************************//**
+Gets the block cache of the calling thread, creating it if needed.
+@return	block cache, or NULL if out of memory */
+UNIV_STATIC
+mem_block_cache_t*
+mem_block_cache_get(void)
+/*=====================*/
+{
+	mem_block_cache_t*	cache;
+
+	pthread_once(&mem_block_cache_once, mem_block_cache_create_key);
+
+	cache = pthread_getspecific(mem_block_cache_key);
+
+	if (UNIV_UNLIKELY(cache == NULL)) {
+		cache = calloc(1, sizeof(*cache));
+
+		if (cache == NULL) {
+
+			return(NULL);
+		}
+
+		if (pthread_setspecific(mem_block_cache_key, cache)) {
+
+			free(cache);
+
+			return(NULL);
+		}
+
+		pthread_mutex_lock(&mem_block_cache_mutex);
+		UT_LIST_ADD_FIRST(list, mem_block_cache_list, cache);
+		pthread_mutex_unlock(&mem_block_cache_mutex);
+	}
+
+	return(cache);
+}
+
+/******************************************************************//**
+Takes a free block from the block cache of the calling thread.
+@return	block, or NULL if the caller must allocate a block of *len bytes */
+UNIV_STATIC
+mem_block_t*
+mem_block_cache_alloc(
+/*==================*/
+	ulint*	len)	/*!< in: bytes needed, including the header;
+			out: length of the block */
+{
+	ulint			i;
+	mem_block_cache_t*	cache;
+
+	i = mem_block_cache_get_class(*len);
+
+	if (i == ULINT_UNDEFINED) {
+
+		return(NULL);
+	}
+
+	*len = mem_block_cache_class_len(i);
+
+	cache = mem_block_cache_get();
+
+	if (cache != NULL && cache->n_blocks[i] > 0) {
+		mem_block_t*	block;
+
+		cache->n_hits++;
+
+		block = cache->blocks[i][--cache->n_blocks[i]];
+
+		UNIV_MEM_ALLOC(block, *len);
+
+		return(block);
+	}
+
+	if (cache != NULL) {
+		cache->n_misses++;
+	}
+
+	return(NULL);
+}
+
+/******************************************************************//**
+Puts a freed block into the block cache of the calling thread.
+@return	TRUE if the block was cached, FALSE if the caller must free it */
+UNIV_STATIC
+ibool
+mem_block_cache_put(
+/*================*/
+	mem_block_t*	block,	/*!< in, own: freed MEM_HEAP_DYNAMIC block */
+	ulint		len)	/*!< in: length of the block */
+{
+	ulint			i;
+	mem_block_cache_t*	cache;
+
+	i = mem_block_cache_get_class(len);
+
+	/* Only blocks that mem_block_cache_alloc() rounded up have the
+	exact length of their class. */
+
+	if (i == ULINT_UNDEFINED || len != mem_block_cache_class_len(i)) {
+
+		return(FALSE);
+	}
+
+	cache = mem_block_cache_get();
+
+	if (cache == NULL || cache->n_blocks[i] == MEM_BLOCK_CACHE_DEPTH) {
+
+		return(FALSE);
+	}
+
+	cache->blocks[i][cache->n_blocks[i]++] = block;
+
+	return(TRUE);
+}
+#endif /* MEM_BLOCK_CACHE */
+
+/******************************************************************//**
+Gets the statistics of the block caches, summed over the threads. The
+counters of the running threads are read without a latch. */
+UNIV_INTERN
+void
+mem_block_cache_get_stats(
+/*======================*/
+	ulint*	n_hits,		/*!< out: number of blocks taken from
+				a cache */
+	ulint*	n_misses)	/*!< out: number of blocks of a cached
+				size that were allocated with malloc() */
+{
+#ifdef MEM_BLOCK_CACHE
+	const mem_block_cache_t*	cache;
+
+	pthread_mutex_lock(&mem_block_cache_mutex);
+
+	*n_hits = mem_block_cache_exited_hits;
+	*n_misses = mem_block_cache_exited_misses;
+
+	for (cache = UT_LIST_GET_FIRST(mem_block_cache_list);
+	     cache != NULL;
+	     cache = UT_LIST_GET_NEXT(list, cache)) {
+
+		*n_hits += cache->n_hits;
+		*n_misses += cache->n_misses;
+	}
+
+	pthread_mutex_unlock(&mem_block_cache_mutex);
+#else /* MEM_BLOCK_CACHE */
+	*n_hits = 0;
+	*n_misses = 0;
+#endif /* MEM_BLOCK_CACHE */
+}
+
 /***************************************************************//**
 Creates a memory heap block where data can be allocated.
 @return own: memory heap block, NULL if did not succeed (only possible
@@ -322,7 +604,19 @@ mem_heap_create_block(
 
 		ut_a(type == MEM_HEAP_DYNAMIC || n <= MEM_MAX_ALLOC_IN_BUF);
 
+#ifdef MEM_BLOCK_CACHE
+		if (type == MEM_HEAP_DYNAMIC) {
+			block = mem_block_cache_alloc(&len);
+		} else {
+			block = NULL;
+		}
+
+		if (block == NULL) {
+			block = (mem_block_t*) malloc(len);
+		}
+#else /* MEM_BLOCK_CACHE */
 		block = (mem_block_t*) malloc(len);
+#endif /* MEM_BLOCK_CACHE */
 	} else {
 
 		len = UNIV_PAGE_SIZE;
@@ -481,6 +775,13 @@ mem_heap_block_free(
 	}
 	if (type == MEM_HEAP_DYNAMIC || len < UNIV_PAGE_SIZE / 2) {
 
+#ifdef MEM_BLOCK_CACHE
+		if (type == MEM_HEAP_DYNAMIC
+		    && mem_block_cache_put(block, len)) {
+
+			return;
+		}
+#endif /* MEM_BLOCK_CACHE */
 		free(block);
 	} else {
 		buf_block_free(buf_block);
@@ -34,6 +34,11 @@ Created 9/30/1995 Heikki Tuuri
 #endif
 #endif
 
+#ifdef UNIV_LINUX
+#include <stdio.h>
+#include <sys/syscall.h>
+#endif
+
 #include "os0proc.h"
 #ifdef UNIV_NONINL
 #include "os0proc.ic"
@@ -53,6 +58,21 @@ MAP_ANON but MAP_ANON is marked as deprecated */
 UNIV_INTERN ibool os_use_large_pages;
 /* Large page size. This may be a boot-time option on some platforms */
 UNIV_INTERN ulint os_large_page_size;
+/* NUMA memory policy of the buffer pool (enum os_numa_policy_enum) */
+UNIV_INTERN ulint os_numa_policy;
+
+#if defined UNIV_LINUX && defined SYS_mbind && defined SYS_get_mempolicy \
+    && defined SYS_getcpu
+/* The NUMA memory policy is set with the mbind(2) system call. We do not
+depend on libnuma; these are the values from <linux/mempolicy.h>. */
+# define OS_NUMA_MBIND
+# define OS_MPOL_BIND		2	/* MPOL_BIND */
+# define OS_MPOL_INTERLEAVE	3	/* MPOL_INTERLEAVE */
+# define OS_MPOL_F_MEMS_ALLOWED	4	/* MPOL_F_MEMS_ALLOWED */
+# define OS_MPOL_MF_MOVE	2	/* MPOL_MF_MOVE */
+/* Maximum number of NUMA nodes, the largest value of MAX_NUMNODES */
+# define OS_NUMA_MAX_NODES	1024
+#endif
 
 /****************************************************************//**
 Reset the variables. */
@@ -63,8 +83,53 @@ os_proc_var_init(void)
 {
 	os_use_large_pages = 0;
 	os_large_page_size = 0;
+	os_numa_policy = OS_NUMA_DEFAULT;
 }
 
+#ifdef UNIV_LINUX
+/****************************************************************//**
+Determines the huge page size of the system from /proc/meminfo, unless
+os_large_page_size has already been set.
+@return	os_large_page_size, or 0 if it is not known */
+UNIV_STATIC
+ulint
+os_mem_get_large_page_size(void)
+/*============================*/
+{
+	FILE*		file;
+	char		line[256];
+	unsigned long	kb;
+
+	if (os_large_page_size != 0) {
+
+		return(os_large_page_size);
+	}
+
+	file = fopen("/proc/meminfo", "r");
+
+	if (file == NULL) {
+
+		return(0);
+	}
+
+	while (fgets(line, sizeof(line), file) != NULL) {
+
+		if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1) {
+
+			if (ut_is_2pow(kb)) {
+				os_large_page_size = (ulint) kb * 1024;
+			}
+
+			break;
+		}
+	}
+
+	fclose(file);
+
+	return(os_large_page_size);
+}
+#endif /* UNIV_LINUX */
+
 /********************************************************************
 Converts the current process id to a number. It is not guaranteed that the
 number is unique. In Linux returns the 'process number' of the current
@@ -94,7 +159,34 @@ os_mem_alloc_large(
 {
 	void*	ptr;
 	ulint	size;
-#if defined HAVE_LARGE_PAGES && defined UNIV_LINUX
+#if defined UNIV_LINUX && defined MAP_HUGETLB && defined OS_MAP_ANON
+	if (os_use_large_pages && os_mem_get_large_page_size()) {
+
+		/* Align block size to os_large_page_size */
+		ut_ad(ut_is_2pow(os_large_page_size));
+		size = ut_2pow_round(*n + (os_large_page_size - 1),
+				     os_large_page_size);
+
+		ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+			   MAP_PRIVATE | OS_MAP_ANON | MAP_HUGETLB, -1, 0);
+
+		if (ptr != (void*) -1) {
+			*n = size;
+			ut_total_allocated_memory_add(size);
+# ifdef UNIV_SET_MEM_TO_ZERO
+			memset(ptr, '\0', size);
+# endif
+			UNIV_MEM_ALLOC(ptr, size);
+			return(ptr);
+		}
+
+		ib_logger(ib_stream,
+			"InnoDB: HugeTLB: Warning: Failed to allocate"
+			" %lu bytes. errno %d\n", (ulong) size, errno);
+		ib_logger(ib_stream, "InnoDB HugeTLB: Warning: Using"
+			" conventional memory pool\n");
+	}
+#elif defined HAVE_LARGE_PAGES && defined UNIV_LINUX
 	int shmid;
 	struct shmid_ds buf;
 
@@ -131,9 +223,7 @@ os_mem_alloc_large(
 
 	if (ptr) {
 		*n = size;
-		os_fast_mutex_lock(&ut_list_mutex);
-		ut_total_allocated_memory += size;
-		os_fast_mutex_unlock(&ut_list_mutex);
+		ut_total_allocated_memory_add(size);
 # ifdef UNIV_SET_MEM_TO_ZERO
 		memset(ptr, '\0', size);
 # endif
@@ -163,9 +253,7 @@ skip:
 			" Windows error %lu\n",
 			(ulong) size, (ulong) GetLastError());
 	} else {
-		os_fast_mutex_lock(&ut_list_mutex);
-		ut_total_allocated_memory += size;
-		os_fast_mutex_unlock(&ut_list_mutex);
+		ut_total_allocated_memory_add(size);
 		UNIV_MEM_ALLOC(ptr, size);
 	}
 #elif defined __NETWARE__ || !defined OS_MAP_ANON
@@ -188,9 +276,14 @@ skip:
 			(ulong) size, (ulong) errno);
 		ptr = NULL;
 	} else {
-		os_fast_mutex_lock(&ut_list_mutex);
-		ut_total_allocated_memory += size;
-		os_fast_mutex_unlock(&ut_list_mutex);
+# if defined UNIV_LINUX && defined MADV_HUGEPAGE
+		/* Let the kernel back the block with transparent huge
+		pages if none could be reserved above. */
+		if (os_use_large_pages) {
+			madvise(ptr, size, MADV_HUGEPAGE);
+		}
+# endif
+		ut_total_allocated_memory_add(size);
 		UNIV_MEM_ALLOC(ptr, size);
 	}
 #endif
@@ -208,16 +301,11 @@ os_mem_free_large(
 	ulint	size)			/*!< in: size returned by
 					os_mem_alloc_large() */
 {
-	os_fast_mutex_lock(&ut_list_mutex);
 	ut_a(ut_total_allocated_memory >= size);
-	os_fast_mutex_unlock(&ut_list_mutex);
 
-#if defined HAVE_LARGE_PAGES && defined UNIV_LINUX
+#if defined HAVE_LARGE_PAGES && defined UNIV_LINUX && !defined MAP_HUGETLB
 	if (os_use_large_pages && os_large_page_size && !shmdt(ptr)) {
-		os_fast_mutex_lock(&ut_list_mutex);
-		ut_a(ut_total_allocated_memory >= size);
-		ut_total_allocated_memory -= size;
-		os_fast_mutex_unlock(&ut_list_mutex);
+		ut_total_allocated_memory_sub(size);
 		UNIV_MEM_FREE(ptr, size);
 		return;
 	}
@@ -230,10 +318,7 @@ os_mem_free_large(
 			" Windows error %lu\n",
 			ptr, (ulong) size, (ulong) GetLastError());
 	} else {
-		os_fast_mutex_lock(&ut_list_mutex);
-		ut_a(ut_total_allocated_memory >= size);
-		ut_total_allocated_memory -= size;
-		os_fast_mutex_unlock(&ut_list_mutex);
+		ut_total_allocated_memory_sub(size);
 		UNIV_MEM_FREE(ptr, size);
 	}
 #elif defined __NETWARE__ || !defined OS_MAP_ANON
@@ -244,11 +329,82 @@ os_mem_free_large(
 			" errno %lu\n",
 			ptr, (ulong) size, (ulong) errno);
 	} else {
-		os_fast_mutex_lock(&ut_list_mutex);
-		ut_a(ut_total_allocated_memory >= size);
-		ut_total_allocated_memory -= size;
-		os_fast_mutex_unlock(&ut_list_mutex);
+		ut_total_allocated_memory_sub(size);
 		UNIV_MEM_FREE(ptr, size);
 	}
 #endif
 }
+
+/****************************************************************//**
+Applies the NUMA memory policy os_numa_policy to a block of memory
+returned by os_mem_alloc_large(). Pages that have already been touched
+are migrated. This is a no-op on systems without mbind(2). */
+UNIV_INTERN
+void
+os_mem_set_numa_policy(
+/*===================*/
+	void*	ptr,			/*!< in: pointer returned by
+					os_mem_alloc_large() */
+	ulint	size)			/*!< in: size returned by
+					os_mem_alloc_large() */
+{
+#ifdef OS_NUMA_MBIND
+	unsigned long	nodemask[OS_NUMA_MAX_NODES / (8 * sizeof(long))];
+	int		mode;
+
+	memset(nodemask, 0x0, sizeof(nodemask));
+
+	switch (os_numa_policy) {
+	case OS_NUMA_DEFAULT:
+		return;
+
+	case OS_NUMA_INTERLEAVE:
+		/* Interleave across the nodes that we may allocate from. */
+		if (syscall(SYS_get_mempolicy, &mode, nodemask,
+			    (unsigned long) OS_NUMA_MAX_NODES, NULL,
+			    (unsigned long) OS_MPOL_F_MEMS_ALLOWED)) {
+
+			ib_logger(ib_stream, "InnoDB: NUMA: Warning:"
+				" get_mempolicy() failed; errno %d\n",
+				errno);
+			return;
+		}
+
+		mode = OS_MPOL_INTERLEAVE;
+		break;
+
+	case OS_NUMA_LOCAL: {
+		unsigned	cpu;
+		unsigned	node;
+
+		if (syscall(SYS_getcpu, &cpu, &node, NULL)
+		    || node >= OS_NUMA_MAX_NODES) {
+
+			ib_logger(ib_stream, "InnoDB: NUMA: Warning:"
+				" getcpu() failed; errno %d\n", errno);
+			return;
+		}
+
+		nodemask[node / (8 * sizeof(long))]
+			|= 1UL << (node % (8 * sizeof(long)));
+
+		mode = OS_MPOL_BIND;
+		break;
+	}
+
+	default:
+		ut_error;
+	}
+
+	if (syscall(SYS_mbind, ptr, (unsigned long) size, mode, nodemask,
+		    (unsigned long) OS_NUMA_MAX_NODES,
+		    (unsigned) OS_MPOL_MF_MOVE)) {
+
+		ib_logger(ib_stream, "InnoDB: NUMA: Warning: mbind(%p, %lu)"
+			" failed; errno %d\n", ptr, (ulong) size, errno);
+	}
+#else /* OS_NUMA_MBIND */
+	UT_NOT_USED(ptr);
+	UT_NOT_USED(size);
+#endif /* OS_NUMA_MBIND */
+}
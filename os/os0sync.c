@@ -32,6 +32,14 @@ Created 9/6/1995 Heikki Tuuri
 #include "ut0mem.h"
 #include "srv0start.h"
 
+#ifdef INNODB_SYNC_USE_FUTEX
+# include <errno.h>
+# include <limits.h>
+# include <time.h>
+# include <unistd.h>
+# include <linux/futex.h>
+#endif /* INNODB_SYNC_USE_FUTEX */
+
 /* Type definition for an operating system mutex struct */
 struct os_mutex_struct{
 	os_event_t	event;	/*!< Used by sync0arr.c for queing threads */
@@ -695,3 +703,58 @@ os_fast_mutex_free(
 		os_mutex_exit(os_sync_mutex);
 	}
 }
+
+#ifdef INNODB_SYNC_USE_FUTEX
+/**********************************************************//**
+Signals a futex and wakes up all the threads sleeping on it. */
+UNIV_INTERN
+void
+os_futex_set(
+/*=========*/
+	os_futex_t*	futex)	/*!< in/out: futex */
+{
+	(void) os_atomic_increment(futex, 1);
+
+	syscall(SYS_futex, futex, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+/**********************************************************//**
+Sleeps on a futex until it is signalled or a timeout is exceeded. Returns
+at once if the futex has been signalled since os_futex_reset() returned
+sig_count. The thread may also wake up spuriously.
+@return	0 if woken up, OS_SYNC_TIME_EXCEEDED if timeout was exceeded */
+UNIV_INTERN
+ulint
+os_futex_wait_time(
+/*===============*/
+	os_futex_t*	futex,		/*!< in: futex to sleep on */
+	ib_uint32_t	sig_count,	/*!< in: value returned by
+					os_futex_reset() */
+	ulint		time)		/*!< in: timeout in microseconds, or
+					OS_SYNC_INFINITE_TIME */
+{
+	struct timespec	reltime;
+	struct timespec*	timeout = NULL;
+
+	if (time != OS_SYNC_INFINITE_TIME) {
+		/* FUTEX_WAIT takes a relative timeout. */
+		reltime.tv_sec = time / 1000000;
+		reltime.tv_nsec = (time % 1000000) * 1000;
+		timeout = &reltime;
+	}
+
+	if (syscall(SYS_futex, futex, FUTEX_WAIT_PRIVATE, sig_count,
+		    timeout, NULL, 0) != 0
+	    && errno == ETIMEDOUT) {
+
+		return(OS_SYNC_TIME_EXCEEDED);
+	}
+
+	if (srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS) {
+
+		os_thread_exit(NULL);
+	}
+
+	return(0);
+}
+#endif /* INNODB_SYNC_USE_FUTEX */
@@ -623,6 +623,8 @@ pars_retrieve_table_def(
 	sym_node->table = dict_table_get_low(table_name);
 
 	ut_a(sym_node->table);
+
+	sym_node->table_version = sym_node->table->version;
 }
 
 /*********************************************************************//**
@@ -2269,3 +2271,163 @@ pars_info_get_bound_id(
 
 	return(NULL);
 }
+
+/****************************************************************//**
+Checks that the tables that a query graph returned by pars_sql() was
+parsed against are still in the data dictionary cache and have not been
+renamed or had indexes added or removed since. The table pointers of the
+graph are compared but not dereferenced, because the tables may have been
+evicted from the cache. The tables are marked as accessed. The caller
+must own dict_sys->mutex.
+@return	TRUE if the graph can be run again, FALSE if it must be parsed
+again */
+UNIV_INTERN
+ibool
+pars_graph_tables_valid(
+/*====================*/
+	que_t*	graph)	/*!< in: query graph */
+{
+	sym_node_t*	sym_node;
+
+	ut_ad(mutex_own(&dict_sys->mutex));
+
+	for (sym_node = UT_LIST_GET_FIRST(graph->sym_tab->sym_list);
+	     sym_node != NULL;
+	     sym_node = UT_LIST_GET_NEXT(sym_list, sym_node)) {
+
+		dict_table_t*	table;
+
+		if (sym_node->token_type != SYM_TABLE
+		    || sym_node->table == NULL) {
+
+			continue;
+		}
+
+		table = dict_table_check_if_in_cache_low(sym_node->name);
+
+		if (table != sym_node->table
+		    || table->version != sym_node->table_version) {
+
+			return(FALSE);
+		}
+
+		/* Keep dict_make_room_in_cache() from evicting the
+		tables of a statement that is being run repeatedly. */
+		table->accessed = TRUE;
+	}
+
+	return(TRUE);
+}
+
+/****************************************************************//**
+Binds a query graph returned by pars_sql() to the values of another info
+struct, so that the graph can be run again without parsing the SQL. The
+bound literals are pointed to, not copied: info must not be freed before
+the graph has been run. The user functions are copied.
+@return	TRUE on success, FALSE if info does not match the info that the
+graph was parsed with, in which case the graph must be parsed again */
+UNIV_INTERN
+ibool
+pars_info_rebind(
+/*=============*/
+	que_t*			graph,	/*!< in/out: query graph */
+	pars_info_t*		info)	/*!< in: info struct with the same
+					bound ids, the same user functions
+					and bound literals of the same
+					types as the graph's own info */
+{
+	ulint		i;
+	sym_node_t*	sym_node;
+	pars_info_t*	own	= graph->info;
+
+	if (own == NULL) {
+
+		return(TRUE);
+	}
+
+	/* The bound ids were substituted when parsing: they must not
+	have changed. */
+
+	for (i = 0; own->bound_ids && i < ib_vector_size(own->bound_ids);
+	     i++) {
+		pars_bound_id_t*	bid = ib_vector_get(own->bound_ids, i);
+		pars_bound_id_t*	new_bid;
+
+		new_bid = pars_info_get_bound_id(info, bid->name);
+
+		if (!new_bid || strcmp(bid->id, new_bid->id)) {
+
+			return(FALSE);
+		}
+	}
+
+	/* Check the literals before modifying the graph. */
+
+	for (sym_node = UT_LIST_GET_FIRST(graph->sym_tab->sym_list);
+	     sym_node != NULL;
+	     sym_node = UT_LIST_GET_NEXT(sym_list, sym_node)) {
+
+		pars_bound_lit_t*	blit;
+		const dtype_t*		type;
+
+		if (sym_node->token_type != SYM_LIT
+		    || sym_node->name == NULL) {
+
+			continue;
+		}
+
+		blit = pars_info_get_bound_lit(info, sym_node->name);
+		type = dfield_get_type(&sym_node->common.val);
+
+		if (!blit
+		    || blit->type != dtype_get_mtype(type)
+		    || blit->prtype != dtype_get_prtype(type)
+		    || (dtype_get_len(type)
+			&& blit->length != dtype_get_len(type))) {
+
+			return(FALSE);
+		}
+	}
+
+	for (i = 0; own->funcs && i < ib_vector_size(own->funcs); i++) {
+		pars_user_func_t*	puf = ib_vector_get(own->funcs, i);
+
+		if (!pars_info_get_user_func(info, puf->name)) {
+
+			return(FALSE);
+		}
+	}
+
+	/* The graph points to the user function structs of its own
+	info: update them in place. */
+
+	for (i = 0; own->funcs && i < ib_vector_size(own->funcs); i++) {
+		pars_user_func_t*	puf = ib_vector_get(own->funcs, i);
+		pars_user_func_t*	new_puf;
+
+		new_puf = pars_info_get_user_func(info, puf->name);
+
+		puf->func = new_puf->func;
+		puf->arg = new_puf->arg;
+	}
+
+	for (sym_node = UT_LIST_GET_FIRST(graph->sym_tab->sym_list);
+	     sym_node != NULL;
+	     sym_node = UT_LIST_GET_NEXT(sym_list, sym_node)) {
+
+		pars_bound_lit_t*	blit;
+
+		if (sym_node->token_type != SYM_LIT
+		    || sym_node->name == NULL) {
+
+			continue;
+		}
+
+		blit = pars_info_get_bound_lit(info, sym_node->name);
+
+		dfield_set_data(&sym_node->common.val,
+				blit->address, blit->length);
+	}
+
+	return(TRUE);
+}
@@ -118,6 +118,7 @@ sym_tab_add_int_lit(
 	node->token_type = SYM_LIT;
 
 	node->indirection = NULL;
+	node->name = NULL;
 
 	dtype_set(dfield_get_type(&node->common.val), DATA_INT, 0, 4);
 
@@ -160,6 +161,7 @@ sym_tab_add_str_lit(
 	node->token_type = SYM_LIT;
 
 	node->indirection = NULL;
+	node->name = NULL;
 
 	dtype_set(dfield_get_type(&node->common.val),
 		  DATA_VARCHAR, DATA_ENGLISH, 0);
@@ -211,6 +213,10 @@ sym_tab_add_bound_lit(
 
 	node->indirection = NULL;
 
+	/* The name identifies the literal in pars_info_rebind(). */
+	node->name = mem_heap_strdup(sym_tab->heap, name);
+	node->name_len = strlen(name);
+
 	switch (blit->type) {
 	case DATA_FIXBINARY:
 		len = blit->length;
@@ -279,6 +285,7 @@ sym_tab_add_null_lit(
 	node->token_type = SYM_LIT;
 
 	node->indirection = NULL;
+	node->name = NULL;
 
 	dfield_get_type(&node->common.val)->mtype = DATA_ERROR;
 
@@ -325,6 +332,7 @@ sym_tab_add_id(
 	node->common.val_buf_size = 0;
 	node->prefetch_buf = NULL;
 	node->cursor_def = NULL;
+	node->table = NULL;
 
 	node->sym_table = sym_tab;
 
@@ -364,6 +372,7 @@ sym_tab_add_bound_id(
 	node->common.val_buf_size = 0;
 	node->prefetch_buf = NULL;
 	node->cursor_def = NULL;
+	node->table = NULL;
 
 	node->sym_table = sym_tab;
 
@@ -1382,6 +1382,33 @@ loop:
 	mutex_exit(&kernel_mutex);
 }
 
+/*********************************************************************//**
+Runs a query graph returned by pars_sql(). The graph is not freed and
+can be run again, after binding new values with pars_info_rebind().
+@return	error code or DB_SUCCESS */
+UNIV_INTERN
+ulint
+que_eval_graph(
+/*===========*/
+	que_t*		graph,	/*!< in/out: query graph */
+	trx_t*		trx)	/*!< in: trx */
+{
+	que_thr_t*	thr;
+
+	ut_a(trx->error_state == DB_SUCCESS);
+
+	graph->trx = trx;
+	trx->graph = NULL;
+
+	graph->fork_type = QUE_FORK_USER_INTERFACE;
+
+	ut_a(thr = que_fork_start_command(graph));
+
+	que_run_threads(thr);
+
+	return(trx->error_state);
+}
+
 /*********************************************************************//**
 Evaluate the given SQL.
 @return	error code or DB_SUCCESS */
@@ -1396,7 +1423,6 @@ que_eval_sql(
 				dict_sys->mutex around call to pars_sql. */
 	trx_t*		trx)	/*!< in: trx */
 {
-	que_thr_t*	thr;
 	que_t*		graph;
 
 	ut_a(trx->error_state == DB_SUCCESS);
@@ -1413,14 +1439,7 @@ que_eval_sql(
 
 	ut_a(graph);
 
-	graph->trx = trx;
-	trx->graph = NULL;
-
-	graph->fork_type = QUE_FORK_USER_INTERFACE;
-
-	ut_a(thr = que_fork_start_command(graph));
-
-	que_run_threads(thr);
+	que_eval_graph(graph, trx);
 
 	que_graph_free(graph);
 
@@ -417,6 +417,93 @@ next_byte:
 	return(0);		/* Not reached */
 }
 
+/*************************************************************//**
+Determines if cmp_data_data() compares the fields of a data type byte
+by byte, so that cmp_data_sort_key() can be used for the type.
+@return	TRUE if the fields of the type have binary-comparable sort keys */
+UNIV_INTERN
+ibool
+cmp_type_has_sort_key(
+/*==================*/
+	ulint		mtype,	/*!< in: main type */
+	ulint		prtype)	/*!< in: precise type */
+{
+	/* This must match the choice of cmp_whole_field() in
+	cmp_data_data_slow(). */
+
+	return(mtype < DATA_FLOAT
+	       && (mtype != DATA_BLOB
+		   || (prtype & DATA_BINARY_TYPE)
+		   || dtype_get_charset_coll(prtype)
+		   == DATA_CLIENT_LATIN1_SWEDISH_CHARSET_COLL));
+}
+
+/*************************************************************//**
+Computes a binary-comparable sort key from the first bytes of a data
+field.  If the sort keys of two fields of the same type differ, the
+fields compare in the same order in cmp_data_data(); if the sort keys
+are equal, the fields must be compared with cmp_data_data().  The type
+must satisfy cmp_type_has_sort_key().
+@return	sort key */
+UNIV_INTERN
+ib_uint64_t
+cmp_data_sort_key(
+/*==============*/
+	ulint		mtype,	/*!< in: main type */
+	ulint		prtype,	/*!< in: precise type */
+	const byte*	data,	/*!< in: data field */
+	ulint		len)	/*!< in: data field length or UNIV_SQL_NULL */
+{
+	ib_uint64_t	key;
+	ulint		pad;
+	ibool		collate;
+	ulint		i;
+
+	ut_ad(cmp_type_has_sort_key(mtype, prtype));
+
+	if (len == UNIV_SQL_NULL) {
+		/* The SQL null is the smallest value; it is the only
+		one whose most significant byte is 0. */
+
+		return(0);
+	}
+
+	/* The bytes past the end of a shorter field compare as the
+	padding character.  Without padding, the shorter field is the
+	smaller one: make the missing bytes 0, which can only compare
+	equal, never greater. */
+
+	collate = mtype <= DATA_CHAR
+		|| (mtype == DATA_BLOB && !(prtype & DATA_BINARY_TYPE));
+
+	pad = dtype_get_pad_char(mtype, prtype);
+
+	if (pad == ULINT_UNDEFINED) {
+		pad = 0;
+	} else if (collate) {
+		pad = cmp_collate(pad);
+	}
+
+	key = 1;
+
+	for (i = 0; i < 7; i++) {
+		ulint	code;
+
+		if (i >= len) {
+			/* The pad was collated above. */
+			code = pad;
+		} else if (collate) {
+			code = cmp_collate(data[i]);
+		} else {
+			code = data[i];
+		}
+
+		key = (key << 8) | code;
+	}
+
+	return(key);
+}
+
 /*************************************************************//**
 This function is used to compare a data tuple to a physical record.
 Only dtuple->n_fields_cmp first fields are taken into account for
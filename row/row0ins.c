@@ -47,6 +47,7 @@ Created 4/20/1996 Heikki Tuuri
 #include "usr0sess.h"
 #include "buf0lru.h"
 #include "api0misc.h"
+#include "row0merge.h"
 
 #define	ROW_INS_PREV	1
 #define	ROW_INS_NEXT	2
@@ -2269,6 +2270,15 @@ row_ins_index_entry_step(
 
 	ut_ad(dtuple_check_typed(node->entry));
 
+	if (UNIV_UNLIKELY(dict_index_is_online(node->index))) {
+		/* The index is being created: the entry will be
+		inserted when the log is applied. */
+		row_merge_log_op(node->index, node->entry,
+				 ROW_MERGE_LOG_INSERT);
+
+		return(DB_SUCCESS);
+	}
+
 	err = row_ins_index_entry(node->index, node->entry, 0, TRUE, thr);
 
 	return(err);
@@ -2468,9 +2478,12 @@ row_ins_step(
 	if (node->state == INS_NODE_SET_IX_LOCK) {
 
 		/* It may be that the current session has not yet started
-		its transaction, or it has been committed: */
+		its transaction, or it has been committed. A read-only
+		transaction has no id of its own: let lock_table() refuse
+		it. */
 
-		if (UT_DULINT_EQ(trx->id, node->trx_id)) {
+		if (UT_DULINT_EQ(trx->id, node->trx_id)
+		    && !trx->read_only) {
 			/* No need to do IX-locking */
 
 			goto same_trx;
@@ -46,6 +46,7 @@ Completed by Sunny Bains and Marko Makela
 #include "api0misc.h"
 #include "rem0cmp.h"
 #include "read0read.h"
+#include "row0vers.h"
 #include "os0file.h"
 #include "lock0lock.h"
 #include "data0data.h"
@@ -55,6 +56,9 @@ Completed by Sunny Bains and Marko Makela
 #include "log0log.h"
 #include "ut0sort.h"
 #include "ddl0ddl.h"
+#include "srv0srv.h"
+#include "os0sync.h"
+#include "os0thread.h"
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -83,22 +87,22 @@ UNIV_STATIC ibool	row_merge_print_block_write;
 /* @} */
 #endif /* UNIV_DEBUG */
 
-/** @brief Block size for I/O operations in merge sort.
+/** @brief Block for I/O operations in merge sort.
 
-The minimum is UNIV_PAGE_SIZE, or page_get_free_space_of_empty()
-rounded to a power of 2.
+The block size is srv_sort_buf_size bytes.  The minimum is
+UNIV_PAGE_SIZE, or page_get_free_space_of_empty() rounded to a power
+of 2.
 
 When not creating a PRIMARY KEY that contains column prefixes, this
 can be set as small as UNIV_PAGE_SIZE / 2.  See the comment above
-ut_ad(data_size < sizeof(row_merge_block_t)). */
-typedef byte	row_merge_block_t[1048576];
+ut_ad(data_size < srv_sort_buf_size). */
+typedef byte	row_merge_block_t;
 
 /** @brief Secondary buffer for I/O operations of merge records.
 
 This buffer is used for writing or reading a record that spans two
-row_merge_block_t.  Thus, it must be able to hold one merge record,
-whose maximum size is the same as the minimum size of
-row_merge_block_t. */
+blocks.  Thus, it must be able to hold one merge record, whose maximum
+size is the same as the minimum block size. */
 typedef byte	mrec_buf_t[UNIV_PAGE_SIZE];
 
 /** @brief Merge record in row_merge_block_t.
@@ -134,6 +138,62 @@ struct merge_file_struct {
 /** Information about temporary files used in merge sort */
 typedef struct merge_file_struct merge_file_t;
 
+/** Kinds of work done by the sort threads */
+enum row_merge_job_type {
+	ROW_MERGE_JOB_RUN,		/*!< sort a buffer and write it
+					to a block of a merge file */
+	ROW_MERGE_JOB_MERGE		/*!< merge sort a merge file */
+};
+
+/** Work item for the sort threads */
+typedef struct row_merge_job_struct row_merge_job_t;
+
+/** Work item for the sort threads */
+struct row_merge_job_struct {
+	enum row_merge_job_type	type;	/*!< kind of work */
+	ulint		index_no;	/*!< position of the index in the
+					array of indexes being created */
+	row_merge_buf_t*buf;		/*!< ROW_MERGE_JOB_RUN: buffer to
+					sort; freed by the sort thread */
+	ulint		offset;		/*!< ROW_MERGE_JOB_RUN: block number
+					to write the sorted buffer to */
+	UT_LIST_NODE_T(row_merge_job_t)
+			jobs;		/*!< list of queued jobs */
+};
+
+/** Pool of threads that sort and merge index entries while the
+clustered index is being scanned by the thread creating the indexes */
+struct row_merge_sorter_struct {
+	os_fast_mutex_t	mutex;		/*!< mutex protecting the fields
+					below, except the constant ones */
+	os_event_t	job_event;	/*!< set when a job is queued or
+					when the threads must exit */
+	os_event_t	done_event;	/*!< set when a job is completed
+					or when a thread exits */
+	UT_LIST_BASE_NODE_T(row_merge_job_t)
+			queue;		/*!< jobs waiting for a thread */
+	ulint		n_pending;	/*!< number of queued or running
+					jobs */
+	ulint		n_threads;	/*!< number of running threads */
+	ibool		shutdown;	/*!< TRUE if the threads must exit
+					once the queue is empty */
+	ulint		error;		/*!< DB_SUCCESS or the first error
+					reported by a job */
+	ulint		error_index;	/*!< index number of the job that
+					reported the error */
+	trx_t*		trx;		/*!< transaction creating the
+					indexes; constant */
+	table_handle_t	table;		/*!< client table, for reporting
+					duplicates; constant */
+	dict_index_t**	indexes;	/*!< indexes being created;
+					constant */
+	merge_file_t*	files;		/*!< merge files of the indexes;
+					constant */
+};
+
+/** Pool of sort threads */
+typedef struct row_merge_sorter_struct row_merge_sorter_t;
+
 #ifdef UNIV_DEBUG
 /******************************************************//**
 Display a merge tuple. */
@@ -186,7 +246,7 @@ row_merge_buf_create_low(
 	row_merge_buf_t*	buf;
 
 	ut_ad(max_tuples > 0);
-	ut_ad(max_tuples <= sizeof(row_merge_block_t));
+	ut_ad(max_tuples <= srv_sort_buf_size);
 	ut_ad(max_tuples < buf_size);
 
 	buf = mem_heap_zalloc(heap, buf_size);
@@ -214,12 +274,12 @@ row_merge_buf_create(
 	ulint			buf_size;
 	mem_heap_t*		heap;
 
-	max_tuples = sizeof(row_merge_block_t)
+	max_tuples = srv_sort_buf_size
 		/ ut_max(1, dict_index_get_min_size(index));
 
 	buf_size = (sizeof *buf) + (max_tuples - 1) * sizeof *buf->tuples;
 
-	heap = mem_heap_create(buf_size + sizeof(row_merge_block_t));
+	heap = mem_heap_create(buf_size + srv_sort_buf_size);
 
 	buf = row_merge_buf_create_low(heap, index, max_tuples, buf_size);
 
@@ -380,22 +440,22 @@ row_merge_buf_add(
 	}
 #endif /* UNIV_DEBUG */
 
-	/* Add to the total size of the record in row_merge_block_t
+	/* Add to the total size of the record in the merge block
 	the encoded length of extra_size and the extra bytes (extra_size).
 	See row_merge_buf_write() for the variable-length encoding
 	of extra_size. */
 	data_size += (extra_size + 1) + ((extra_size + 1) >= 0x80);
 
-	/* The following assertion may fail if row_merge_block_t is
-	declared very small and a PRIMARY KEY is being created with
+	/* The following assertion may fail if srv_sort_buf_size is
+	very small and a PRIMARY KEY is being created with
 	many prefix columns.  In that case, the record may exceed the
 	page_zip_rec_needs_ext() limit.  However, no further columns
 	will be moved to external storage until the record is inserted
 	to the clustered index B-tree. */
-	ut_ad(data_size < sizeof(row_merge_block_t));
+	ut_ad(data_size < srv_sort_buf_size);
 
-	/* Reserve one byte for the end marker of row_merge_block_t. */
-	if (buf->total_size + data_size >= sizeof(row_merge_block_t) - 1) {
+	/* Reserve one byte for the end marker of the merge block. */
+	if (buf->total_size + data_size >= srv_sort_buf_size - 1) {
 		return(FALSE);
 	}
 
@@ -544,6 +604,121 @@ row_merge_tuple_sort(
 			      tuples, aux, low, high, row_merge_tuple_cmp_ctx);
 }
 
+/** Minimum number of tuples for sorting a buffer by the sort keys
+of the first field; smaller buffers are merge sorted directly */
+#define ROW_MERGE_KEY_SORT_MIN	64
+
+/** Tuple and the sort key of its first field */
+struct row_merge_key_struct {
+	ib_uint64_t	key;	/*!< cmp_data_sort_key() of the
+				first field */
+	const dfield_t*	tuple;	/*!< fields of the tuple */
+};
+
+/** Tuple and the sort key of its first field */
+typedef struct row_merge_key_struct row_merge_key_t;
+
+/**********************************************************************//**
+Sort tuples by the sort key of their first field.  A least significant
+digit radix sort is done on the sort keys, which are stored next to the
+tuple pointers, so that the tuple data is not accessed.  Runs of tuples
+with equal sort keys are then merge sorted on all fields. */
+UNIV_STATIC
+void
+row_merge_key_sort(
+/*===============*/
+	row_merge_buf_t*	buf,	/*!< in/out: sort buffer */
+	ulint			n_field,/*!< in: number of fields to compare */
+	row_merge_dup_t*	dup)	/*!< in/out: for reporting duplicates */
+{
+	ulint			count[8][256];
+	row_merge_key_t*	keys;
+	row_merge_key_t*	aux;
+	const dtype_t*		type;
+	ulint			n	= buf->n_tuples;
+	ulint			low;
+	ulint			i;
+	ulint			j;
+
+	keys = mem_alloc(2 * n * sizeof *keys);
+	aux = keys + n;
+
+	type = dfield_get_type(&buf->tuples[0][0]);
+
+	memset(count, 0, sizeof count);
+
+	for (i = 0; i < n; i++) {
+		const dfield_t*	field	= buf->tuples[i];
+		ib_uint64_t	key;
+
+		key = cmp_data_sort_key(type->mtype, type->prtype,
+					dfield_get_data(field),
+					dfield_get_len(field));
+		keys[i].key = key;
+		keys[i].tuple = field;
+
+		for (j = 0; j < 8; j++) {
+			count[j][(key >> (8 * j)) & 0xff]++;
+		}
+	}
+
+	for (j = 0; j < 8; j++) {
+		ulint			pos;
+		ulint			total	= 0;
+		row_merge_key_t*	tmp;
+
+		if (count[j][(keys[0].key >> (8 * j)) & 0xff] == n) {
+			/* All keys have the same byte: skip the pass. */
+			continue;
+		}
+
+		for (pos = 0; pos < 256; pos++) {
+			ulint	c = count[j][pos];
+			count[j][pos] = total;
+			total += c;
+		}
+
+		for (i = 0; i < n; i++) {
+			aux[count[j][(keys[i].key >> (8 * j)) & 0xff]++]
+				= keys[i];
+		}
+
+		tmp = keys;
+		keys = aux;
+		aux = tmp;
+	}
+
+	for (i = 0; i < n; i++) {
+		buf->tuples[i] = keys[i].tuple;
+	}
+
+	/* Duplicates have equal sort keys, so that they end up in
+	the same run and are compared there. */
+
+	for (low = 0; low < n; low = i) {
+		for (i = low + 1; i < n && keys[i].key == keys[low].key; i++) {
+		}
+
+		if (i - low > 1) {
+			row_merge_tuple_sort(
+				buf->index->cmp_ctx, n_field, dup,
+				buf->tuples, buf->tmp_tuples, low, i);
+		}
+	}
+
+#ifdef UNIV_DEBUG
+	/* The tuples are inserted into the index by searching, so that
+	a wrong sort key would only be noticed here. */
+	for (i = 1; i < n; i++) {
+		ut_ad(row_merge_tuple_cmp(buf->index->cmp_ctx, n_field,
+					  buf->tuples[i - 1], buf->tuples[i],
+					  NULL) <= 0);
+	}
+#endif /* UNIV_DEBUG */
+
+	mem_free(keys < aux ? keys : aux);
+}
+
 /******************************************************//**
 Sort a buffer. */
 UNIV_STATIC
@@ -553,9 +728,20 @@ row_merge_buf_sort(
 	row_merge_buf_t*	buf,	/*!< in/out: sort buffer */
 	row_merge_dup_t*	dup)	/*!< in/out: for reporting duplicates */
 {
+	ulint		n_field	= dict_index_get_n_unique(buf->index);
+	const dtype_t*	type;
+
+	if (buf->n_tuples >= ROW_MERGE_KEY_SORT_MIN) {
+		type = dfield_get_type(&buf->tuples[0][0]);
+
+		if (cmp_type_has_sort_key(type->mtype, type->prtype)) {
+			row_merge_key_sort(buf, n_field, dup);
+			return;
+		}
+	}
+
 	row_merge_tuple_sort(
-		buf->index->cmp_ctx,
-		dict_index_get_n_unique(buf->index), dup,
+		buf->index->cmp_ctx, n_field, dup,
 		buf->tuples, buf->tmp_tuples, 0, buf->n_tuples);
 }
 
@@ -576,7 +762,7 @@ row_merge_buf_write(
 {
 	const dict_index_t*	index	= buf->index;
 	ulint			n_fields= dict_index_get_n_fields(index);
-	byte*			b	= &(*block)[0];
+	byte*			b	= block;
 
 	ulint		i;
 
@@ -603,7 +789,7 @@ row_merge_buf_write(
 			*b++ = (byte) (extra_size + 1);
 		}
 
-		ut_ad(b + size < block[1]);
+		ut_ad(b + size < &block[srv_sort_buf_size]);
 
 		rec_convert_dtuple_to_rec_comp(b + extra_size, 0, index,
 					       REC_STATUS_ORDINARY,
@@ -623,13 +809,13 @@ row_merge_buf_write(
 	}
 
 	/* Write an "end-of-chunk" marker. */
-	ut_a(b < block[1]);
-	ut_a(b == block[0] + buf->total_size);
+	ut_a(b < &block[srv_sort_buf_size]);
+	ut_a(b == &block[0] + buf->total_size);
 	*b++ = 0;
 #ifdef UNIV_DEBUG_VALGRIND
 	/* The rest of the block is uninitialized.  Initialize it
 	to avoid bogus warnings. */
-	memset(b, 0xff, block[1] - b);
+	memset(b, 0xff, &block[srv_sort_buf_size] - b);
 #endif /* UNIV_DEBUG_VALGRIND */
 #ifdef UNIV_DEBUG
 	if (row_merge_print_write) {
@@ -703,7 +889,7 @@ row_merge_read(
 	ulint			offset,	/*!< in: offset where to read */
 	row_merge_block_t*	buf)	/*!< out: data */
 {
-	ib_uint64_t	ofs = ((ib_uint64_t) offset) * sizeof *buf;
+	ib_uint64_t	ofs = ((ib_uint64_t) offset) * srv_sort_buf_size;
 	ibool		success;
 
 #ifdef UNIV_DEBUG
@@ -716,7 +902,7 @@ row_merge_read(
 	success = os_file_read_no_error_handling(OS_FILE_FROM_FD(fd), buf,
 						 (ulint) (ofs & 0xFFFFFFFF),
 						 (ulint) (ofs >> 32),
-						 sizeof *buf);
+						 srv_sort_buf_size);
 	if (UNIV_UNLIKELY(!success)) {
 		ut_print_timestamp(ib_stream);
 		ib_logger(ib_stream,
@@ -738,7 +924,7 @@ row_merge_write(
 	const void*	buf)	/*!< in: data */
 {
 	ib_uint64_t	ofs = ((ib_uint64_t) offset)
-		* sizeof(row_merge_block_t);
+		* srv_sort_buf_size;
 
 #ifdef UNIV_DEBUG
 	if (row_merge_print_block_write) {
@@ -750,7 +936,7 @@ row_merge_write(
 	return(UNIV_LIKELY(os_file_write("(merge)", OS_FILE_FROM_FD(fd), buf,
 					 (ulint) (ofs & 0xFFFFFFFF),
 					 (ulint) (ofs >> 32),
-					 sizeof(row_merge_block_t))));
+					 srv_sort_buf_size)));
 }
 
 /********************************************************************//**
@@ -777,8 +963,8 @@ row_merge_read_rec(
 
 	ut_ad(block);
 	ut_ad(buf);
-	ut_ad(b >= block[0]);
-	ut_ad(b < block[1]);
+	ut_ad(b >= &block[0]);
+	ut_ad(b < &block[srv_sort_buf_size]);
 	ut_ad(index);
 	ut_ad(foffs);
 	ut_ad(mrec);
@@ -806,7 +992,7 @@ row_merge_read_rec(
 	if (extra_size >= 0x80) {
 		/* Read another byte of extra_size. */
 
-		if (UNIV_UNLIKELY(b >= block[1])) {
+		if (UNIV_UNLIKELY(b >= &block[srv_sort_buf_size])) {
 			if (!row_merge_read(fd, ++(*foffs), block)) {
 err_exit:
 				/* Signal I/O error. */
@@ -815,7 +1001,7 @@ err_exit:
 			}
 
 			/* Wrap around to the beginning of the buffer. */
-			b = block[0];
+			b = &block[0];
 		}
 
 		extra_size = (extra_size & 0x7f) << 8;
@@ -827,12 +1013,12 @@ err_exit:
 
 	/* Read the extra bytes. */
 
-	if (UNIV_UNLIKELY(b + extra_size >= block[1])) {
+	if (UNIV_UNLIKELY(b + extra_size >= &block[srv_sort_buf_size])) {
 		/* The record spans two blocks.  Copy the entire record
 		to the auxiliary buffer and handle this as a special
 		case. */
 
-		avail_size = block[1] - b;
+		avail_size = &block[srv_sort_buf_size] - b;
 
 		memcpy(*buf, b, avail_size);
 
@@ -842,7 +1028,7 @@ err_exit:
 		}
 
 		/* Wrap around to the beginning of the buffer. */
-		b = block[0];
+		b = &block[0];
 
 		/* Copy the record. */
 		memcpy(*buf + avail_size, b, extra_size - avail_size);
@@ -858,7 +1044,7 @@ err_exit:
 		records are much smaller than either buffer, and
 		the record starts near the beginning of each buffer. */
 		ut_a(extra_size + data_size < sizeof *buf);
-		ut_a(b + data_size < block[1]);
+		ut_a(b + data_size < &block[srv_sort_buf_size]);
 
 		/* Copy the data bytes. */
 		memcpy(*buf + extra_size, b, data_size);
@@ -876,7 +1062,7 @@ err_exit:
 
 	b += extra_size + data_size;
 
-	if (UNIV_LIKELY(b < block[1])) {
+	if (UNIV_LIKELY(b < &block[srv_sort_buf_size])) {
 		/* The record fits entirely in the block.
 		This is the normal case. */
 		goto func_exit;
@@ -885,7 +1071,7 @@ err_exit:
 	/* The record spans two blocks.  Copy it to buf. */
 
 	b -= extra_size + data_size;
-	avail_size = block[1] - b;
+	avail_size = &block[srv_sort_buf_size] - b;
 	memcpy(*buf, b, avail_size);
 	*mrec = *buf + extra_size;
 #ifdef UNIV_DEBUG
@@ -903,7 +1089,7 @@ err_exit:
 	}
 
 	/* Wrap around to the beginning of the buffer. */
-	b = block[0];
+	b = &block[0];
 
 	/* Copy the rest of the record. */
 	memcpy(*buf + avail_size, b, extra_size + data_size - avail_size);
@@ -987,11 +1173,11 @@ row_merge_write_rec(
 
 	ut_ad(block);
 	ut_ad(buf);
-	ut_ad(b >= block[0]);
-	ut_ad(b < block[1]);
+	ut_ad(b >= &block[0]);
+	ut_ad(b < &block[srv_sort_buf_size]);
 	ut_ad(mrec);
 	ut_ad(foffs);
-	ut_ad(mrec < block[0] || mrec > block[1]);
+	ut_ad(mrec < &block[0] || mrec > &block[srv_sort_buf_size]);
 	ut_ad(mrec < buf[0] || mrec > buf[1]);
 
 	/* Normalize extra_size.  Value 0 signals "end of list". */
@@ -1000,10 +1186,10 @@ row_merge_write_rec(
 	size = extra_size + (extra_size >= 0x80)
 		+ rec_offs_data_size(offsets);
 
-	if (UNIV_UNLIKELY(b + size >= block[1])) {
+	if (UNIV_UNLIKELY(b + size >= &block[srv_sort_buf_size])) {
 		/* The record spans two blocks.
 		Copy it to the temporary buffer first. */
-		avail_size = block[1] - b;
+		avail_size = &block[srv_sort_buf_size] - b;
 
 		row_merge_write_rec_low(buf[0],
 					extra_size, size, fd, *foffs,
@@ -1018,10 +1204,10 @@ row_merge_write_rec(
 			return(NULL);
 		}
 
-		UNIV_MEM_INVALID(block[0], sizeof block[0]);
+		UNIV_MEM_INVALID(&block[0], srv_sort_buf_size);
 
 		/* Copy the rest. */
-		b = block[0];
+		b = &block[0];
 		memcpy(b, buf[0] + avail_size, size - avail_size);
 		b += size - avail_size;
 	} else {
@@ -1046,8 +1232,8 @@ row_merge_write_eof(
 	ulint*			foffs)	/*!< in/out: file offset */
 {
 	ut_ad(block);
-	ut_ad(b >= block[0]);
-	ut_ad(b < block[1]);
+	ut_ad(b >= &block[0]);
+	ut_ad(b < &block[srv_sort_buf_size]);
 	ut_ad(foffs);
 #ifdef UNIV_DEBUG
 	if (row_merge_print_write) {
@@ -1057,20 +1243,20 @@ row_merge_write_eof(
 #endif /* UNIV_DEBUG */
 
 	*b++ = 0;
-	UNIV_MEM_ASSERT_RW(block[0], b - block[0]);
-	UNIV_MEM_ASSERT_W(block[0], sizeof block[0]);
+	UNIV_MEM_ASSERT_RW(&block[0], b - &block[0]);
+	UNIV_MEM_ASSERT_W(&block[0], srv_sort_buf_size);
 #ifdef UNIV_DEBUG_VALGRIND
 	/* The rest of the block is uninitialized.  Initialize it
 	to avoid bogus warnings. */
-	memset(b, 0xff, block[1] - b);
+	memset(b, 0xff, &block[srv_sort_buf_size] - b);
 #endif /* UNIV_DEBUG_VALGRIND */
 
 	if (!row_merge_write(fd, (*foffs)++, block)) {
 		return(NULL);
 	}
 
-	UNIV_MEM_INVALID(block[0], sizeof block[0]);
-	return(block[0]);
+	UNIV_MEM_INVALID(&block[0], srv_sort_buf_size);
+	return(&block[0]);
 }
 
 /*************************************************************//**
@@ -1105,11 +1291,116 @@ row_merge_cmp(
 	return(cmp);
 }
 
+/******************************************************//**
+Sort a buffer and write it to a block of a merge file.
+@return	DB_SUCCESS, DB_DUPLICATE_KEY or DB_OUT_OF_FILE_SPACE */
+UNIV_STATIC
+ulint
+row_merge_buf_flush(
+/*================*/
+	row_merge_buf_t*	buf,	/*!< in/out: sort buffer */
+	table_handle_t		table,	/*!< in/out: Client table object,
+					for reporting duplicates */
+	const merge_file_t*	file,	/*!< in: file to write to */
+	ulint			offset,	/*!< in: block number to write */
+	row_merge_block_t*	block)	/*!< out: file buffer */
+{
+	if (buf->n_tuples) {
+		if (dict_index_is_unique(buf->index)) {
+			row_merge_dup_t	dup;
+			dup.index = buf->index;
+			dup.table = table;
+			dup.n_dup = 0;
+
+			row_merge_buf_sort(buf, &dup);
+
+			if (dup.n_dup) {
+				return(DB_DUPLICATE_KEY);
+			}
+		} else {
+			row_merge_buf_sort(buf, NULL);
+		}
+	}
+
+	row_merge_buf_write(buf, file, block);
+
+	if (!row_merge_write(file->fd, offset, block)) {
+		return(DB_OUT_OF_FILE_SPACE);
+	}
+
+	UNIV_MEM_INVALID(&block[0], srv_sort_buf_size);
+
+	return(DB_SUCCESS);
+}
+
+/******************************************************//**
+Queue a job for the sort threads.  Waits while the queue is full, so
+that the memory held by the sort buffers of queued jobs stays bounded.
+@return	DB_SUCCESS, or the first error reported by the sort threads,
+in which case the job is discarded */
+UNIV_STATIC
+ulint
+row_merge_sorter_add(
+/*=================*/
+	row_merge_sorter_t*	sorter,	/*!< in/out: sort threads */
+	enum row_merge_job_type	type,	/*!< in: kind of work */
+	ulint			index_no,/*!< in: index number */
+	row_merge_buf_t*	buf,	/*!< in,own: ROW_MERGE_JOB_RUN:
+					buffer to sort, or NULL */
+	ulint			offset)	/*!< in: ROW_MERGE_JOB_RUN: block
+					number to write the buffer to */
+{
+	row_merge_job_t*	job;
+	ulint			err;
+
+	job = mem_alloc(sizeof *job);
+	job->type = type;
+	job->index_no = index_no;
+	job->buf = buf;
+	job->offset = offset;
+
+	os_fast_mutex_lock(&sorter->mutex);
+
+	while (sorter->error == DB_SUCCESS
+	       && sorter->n_pending >= 2 * sorter->n_threads) {
+		ib_int64_t	sig_count;
+
+		sig_count = os_event_reset(sorter->done_event);
+		os_fast_mutex_unlock(&sorter->mutex);
+		os_event_wait_low(sorter->done_event, sig_count);
+		os_fast_mutex_lock(&sorter->mutex);
+	}
+
+	err = sorter->error;
+
+	if (err == DB_SUCCESS) {
+		UT_LIST_ADD_LAST(jobs, sorter->queue, job);
+		sorter->n_pending++;
+		os_event_set(sorter->job_event);
+	}
+
+	os_fast_mutex_unlock(&sorter->mutex);
+
+	if (err != DB_SUCCESS) {
+		if (buf != NULL) {
+			row_merge_buf_free(buf);
+		}
+
+		mem_free(job);
+	}
+
+	return(err);
+}
+
 /********************************************************************//**
 Reads clustered index of the table and create temporary files
-containing the index entries for the indexes to be built.
+containing the index entries for the indexes to be built.  When sort
+threads are given, full sort buffers are handed over to them and the
+scan continues into a fresh buffer.  When a read view is given, the
+rows are read as of that view, so that the table can be modified
+during the scan.
 @return	DB_SUCCESS or error */
-UNIV_STATIC __attribute__((nonnull))
+UNIV_STATIC __attribute__((nonnull(1,3,4,5,6,8)))
 ulint
 row_merge_read_clustered_index(
 /*===========================*/
@@ -1124,7 +1415,12 @@ row_merge_read_clustered_index(
 	dict_index_t**		index,	/*!< in: indexes to be created */
 	merge_file_t*		files,	/*!< in: temporary files */
 	ulint			n_index,/*!< in: number of indexes to create */
-	row_merge_block_t*	block)	/*!< in/out: file buffer */
+	row_merge_block_t*	block,	/*!< in/out: file buffer */
+	row_merge_sorter_t*	sorter,	/*!< in/out: sort threads, or NULL
+					to sort in this thread */
+	read_view_t*		view)	/*!< in: consistent read view, or
+					NULL to read the latest version
+					of each row */
 {
 	dict_index_t*		clust_index;	/* Clustered index */
 	mem_heap_t*		row_heap;	/* Heap memory to create
@@ -1233,6 +1529,34 @@ row_merge_read_clustered_index(
 			offsets = rec_get_offsets(rec, clust_index, NULL,
 						  ULINT_UNDEFINED, &row_heap);
 
+			if (view != NULL
+			    && !lock_clust_rec_cons_read_sees(
+				    rec, clust_index, offsets, view)) {
+				rec_t*	old_vers;
+
+				/* The changes that are not visible in
+				the read view are in the row log of the
+				indexes: build the version that is. */
+
+				err = row_vers_build_for_consistent_read(
+					rec, &mtr, clust_index, &offsets,
+					view, &row_heap, row_heap, &old_vers);
+
+				if (UNIV_UNLIKELY(err != DB_SUCCESS)) {
+					i = 0;
+					goto err_exit;
+				}
+
+				if (old_vers == NULL) {
+					/* The row was inserted after
+					the read view was created. */
+					mem_heap_empty(row_heap);
+					continue;
+				}
+
+				rec = old_vers;
+			}
+
 			/* Skip delete marked records. */
 			if (rec_get_deleted_flag(
 				    rec, dict_table_is_comp(old_table))) {
@@ -1274,7 +1598,6 @@ row_merge_read_clustered_index(
 		for (i = 0; i < n_index; i++) {
 			row_merge_buf_t*	buf	= merge_buf[i];
 			merge_file_t*		file	= &files[i];
-			const dict_index_t*	index	= buf->index;
 
 			if (UNIV_LIKELY
 			    (row && row_merge_buf_add(buf, row, ext))) {
@@ -1289,36 +1612,34 @@ row_merge_read_clustered_index(
 			/* We have enough data tuples to form a block.
 			Sort them and write to disk. */
 
-			if (buf->n_tuples) {
-				if (dict_index_is_unique(index)) {
-					row_merge_dup_t	dup;
-					dup.index = buf->index;
-					dup.table = table;
-					dup.n_dup = 0;
+			if (sorter != NULL) {
+				/* Let a sort thread do it while we go on
+				scanning into a new buffer. */
+				merge_buf[i] = row_merge_buf_create(buf->index);
 
-					row_merge_buf_sort(buf, &dup);
+				err = row_merge_sorter_add(
+					sorter, ROW_MERGE_JOB_RUN, i,
+					buf, file->offset++);
 
-					if (dup.n_dup) {
-						err = DB_DUPLICATE_KEY;
-err_exit:
-						trx->error_key_num = i;
-						goto func_exit;
-					}
-				} else {
-					row_merge_buf_sort(buf, NULL);
+				if (err != DB_SUCCESS) {
+					i = sorter->error_index;
+					goto err_exit;
 				}
-			}
+			} else {
+				err = row_merge_buf_flush(
+					buf, table, file, file->offset++,
+					block);
 
-			row_merge_buf_write(buf, file, block);
+				if (err != DB_SUCCESS) {
+err_exit:
+					trx->error_key_num = i;
+					goto func_exit;
+				}
 
-			if (!row_merge_write(file->fd, file->offset++,
-					     block)) {
-				err = DB_OUT_OF_FILE_SPACE;
-				goto err_exit;
+				merge_buf[i] = row_merge_buf_empty(buf);
 			}
 
-			UNIV_MEM_INVALID(block[0], sizeof block[0]);
-			merge_buf[i] = row_merge_buf_empty(buf);
+			buf = merge_buf[i];
 
 			if (UNIV_LIKELY(row != NULL)) {
 				/* Try writing the record again, now
@@ -1368,14 +1689,15 @@ func_exit:
 @param AT_END	statement to execute at end of input */
 #define ROW_MERGE_WRITE_GET_NEXT(N, AT_END)				\
 	do {								\
-		b2 = row_merge_write_rec(&block[2], &buf[2], b2,	\
+		b2 = row_merge_write_rec(&block[2 * srv_sort_buf_size],	\
+					 &buf[2], b2,			\
 					 of->fd, &of->offset,		\
 					 mrec##N, offsets##N);		\
 		if (UNIV_UNLIKELY(!b2 || ++of->n_rec > file->n_rec)) {	\
 			goto corrupt;					\
 		}							\
-		b##N = row_merge_read_rec(&block[N], &buf[N],		\
-					  b##N, index,			\
+		b##N = row_merge_read_rec(&block[(N) * srv_sort_buf_size],\
+					  &buf[N], b##N, index,		\
 					  file->fd, foffs##N,		\
 					  &mrec##N, offsets##N);	\
 		if (UNIV_UNLIKELY(!b##N)) {				\
@@ -1434,20 +1756,20 @@ row_merge_blocks(
 	file in two halves, which can be merged on the following pass. */
 
 	if (!row_merge_read(file->fd, *foffs0, &block[0])
-	    || !row_merge_read(file->fd, *foffs1, &block[1])) {
+	    || !row_merge_read(file->fd, *foffs1, &block[srv_sort_buf_size])) {
 corrupt:
 		mem_heap_free(heap);
 		return(DB_CORRUPTION);
 	}
 
-	b0 = block[0];
-	b1 = block[1];
-	b2 = block[2];
+	b0 = &block[0];
+	b1 = &block[srv_sort_buf_size];
+	b2 = &block[2 * srv_sort_buf_size];
 
 	b0 = row_merge_read_rec(&block[0], &buf[0], b0, index, file->fd,
 				foffs0, &mrec0, offsets0);
-	b1 = row_merge_read_rec(&block[1], &buf[1], b1, index, file->fd,
-				foffs1, &mrec1, offsets1);
+	b1 = row_merge_read_rec(&block[srv_sort_buf_size], &buf[1], b1,
+				index, file->fd, foffs1, &mrec1, offsets1);
 	if (UNIV_UNLIKELY(!b0 && mrec0)
 	    || UNIV_UNLIKELY(!b1 && mrec1)) {
 
@@ -1493,7 +1815,8 @@ done0:
 done1:
 
 	mem_heap_free(heap);
-	b2 = row_merge_write_eof(&block[2], b2, of->fd, &of->offset);
+	b2 = row_merge_write_eof(&block[2 * srv_sort_buf_size], b2,
+				 of->fd, &of->offset);
 	return(b2 ? DB_SUCCESS : DB_CORRUPTION);
 }
 
@@ -1541,8 +1864,8 @@ corrupt:
 		return(FALSE);
 	}
 
-	b0 = block[0];
-	b2 = block[2];
+	b0 = &block[0];
+	b2 = &block[2 * srv_sort_buf_size];
 
 	b0 = row_merge_read_rec(&block[0], &buf[0], b0, index, file->fd,
 				foffs0, &mrec0, offsets0);
@@ -1564,7 +1887,8 @@ done0:
 	(*foffs0)++;
 
 	mem_heap_free(heap);
-	return(row_merge_write_eof(&block[2], b2, of->fd, &of->offset)
+	return(row_merge_write_eof(&block[2 * srv_sort_buf_size], b2,
+				   of->fd, &of->offset)
 	       != NULL);
 }
 
@@ -1594,7 +1918,7 @@ row_merge(
 				/*!< half the input file */
 	ulint		ohalf;	/*!< half the output file */
 
-	UNIV_MEM_ASSERT_W(block[0], 3 * sizeof block[0]);
+	UNIV_MEM_ASSERT_W(&block[0], 3 * srv_sort_buf_size);
 	ut_ad(ihalf < file->offset);
 
 	of.fd = *tmpfd;
@@ -1672,7 +1996,7 @@ row_merge(
 	*file = of;
 	*half = ohalf;
 
-	UNIV_MEM_INVALID(block[0], 3 * sizeof block[0]);
+	UNIV_MEM_INVALID(&block[0], 3 * srv_sort_buf_size);
 
 	return(DB_SUCCESS);
 }
@@ -1718,6 +2042,234 @@ row_merge_sort(
 	return(DB_SUCCESS);
 }
 
+/*************************************************************//**
+Execute a job of the sort threads.
+@return	DB_SUCCESS or error code */
+UNIV_STATIC
+ulint
+row_merge_sorter_run(
+/*=================*/
+	row_merge_sorter_t*	sorter,	/*!< in: sort threads */
+	row_merge_job_t*	job,	/*!< in/out: job to execute */
+	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
+	int*			tmpfd)	/*!< in/out: temporary file handle
+					of this thread, or -1 */
+{
+	merge_file_t*	file	= &sorter->files[job->index_no];
+	ulint		err;
+
+	switch (job->type) {
+	case ROW_MERGE_JOB_RUN:
+		/* The thread scanning the clustered index has reserved
+		the block, so that several runs of the same index can be
+		written concurrently. */
+		err = row_merge_buf_flush(job->buf, sorter->table, file,
+					  job->offset, block);
+		row_merge_buf_free(job->buf);
+		job->buf = NULL;
+		return(err);
+
+	case ROW_MERGE_JOB_MERGE:
+		if (*tmpfd < 0) {
+			*tmpfd = ib_create_tempfile("mrg");
+		}
+
+		return(row_merge_sort(sorter->trx,
+				      sorter->indexes[job->index_no],
+				      file, block, tmpfd, sorter->table));
+	}
+
+	ut_error;
+	return(DB_ERROR);
+}
+
+/*************************************************************//**
+Sort thread: executes jobs until the queue is empty and the sort
+threads are shut down.
+@return	a dummy parameter */
+UNIV_STATIC
+os_thread_ret_t
+row_merge_sorter_thread(
+/*====================*/
+	void*	arg)	/*!< in: sort threads (row_merge_sorter_t*) */
+{
+	row_merge_sorter_t*	sorter	= arg;
+	row_merge_block_t*	block;
+	ulint			block_size;
+	int			tmpfd	= -1;
+
+	block_size = 3 * srv_sort_buf_size;
+	block = os_mem_alloc_large(&block_size);
+
+	os_fast_mutex_lock(&sorter->mutex);
+
+	for (;;) {
+		row_merge_job_t*	job;
+		ulint			err	= DB_SUCCESS;
+
+		job = UT_LIST_GET_FIRST(sorter->queue);
+
+		if (job == NULL) {
+			ib_int64_t	sig_count;
+
+			if (sorter->shutdown) {
+				break;
+			}
+
+			sig_count = os_event_reset(sorter->job_event);
+			os_fast_mutex_unlock(&sorter->mutex);
+			os_event_wait_low(sorter->job_event, sig_count);
+			os_fast_mutex_lock(&sorter->mutex);
+			continue;
+		}
+
+		UT_LIST_REMOVE(jobs, sorter->queue, job);
+
+		if (sorter->error == DB_SUCCESS) {
+			os_fast_mutex_unlock(&sorter->mutex);
+			err = row_merge_sorter_run(sorter, job, block, &tmpfd);
+			os_fast_mutex_lock(&sorter->mutex);
+		} else if (job->buf != NULL) {
+			/* The index creation will be rolled back:
+			discard the remaining work. */
+			row_merge_buf_free(job->buf);
+		}
+
+		if (err != DB_SUCCESS && sorter->error == DB_SUCCESS) {
+			sorter->error = err;
+			sorter->error_index = job->index_no;
+		}
+
+		mem_free(job);
+
+		sorter->n_pending--;
+		os_event_set(sorter->done_event);
+	}
+
+	/* The sorter may be freed as soon as we release the mutex. */
+	sorter->n_threads--;
+	os_event_set(sorter->done_event);
+	os_fast_mutex_unlock(&sorter->mutex);
+
+	if (tmpfd >= 0) {
+#ifdef __WIN__
+		_close(tmpfd);
+#else
+		close(tmpfd);
+#endif
+	}
+
+	os_mem_free_large(block, block_size);
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*************************************************************//**
+Start the sort threads.
+@return	own: sort threads */
+UNIV_STATIC
+row_merge_sorter_t*
+row_merge_sorter_create(
+/*====================*/
+	trx_t*		trx,		/*!< in: transaction */
+	table_handle_t	table,		/*!< in/out: Client table, for
+					reporting duplicates */
+	dict_index_t**	indexes,	/*!< in: indexes to be created */
+	merge_file_t*	files,		/*!< in/out: merge files */
+	ulint		n_threads)	/*!< in: number of threads */
+{
+	row_merge_sorter_t*	sorter;
+	ulint			i;
+
+	ut_ad(n_threads > 0);
+
+	sorter = mem_zalloc(sizeof *sorter);
+
+	os_fast_mutex_init(&sorter->mutex);
+	sorter->job_event = os_event_create(NULL);
+	sorter->done_event = os_event_create(NULL);
+	UT_LIST_INIT(sorter->queue);
+
+	sorter->error = DB_SUCCESS;
+	sorter->trx = trx;
+	sorter->table = table;
+	sorter->indexes = indexes;
+	sorter->files = files;
+	sorter->n_threads = n_threads;
+
+	for (i = 0; i < n_threads; i++) {
+		os_thread_create(row_merge_sorter_thread, sorter, NULL);
+	}
+
+	return(sorter);
+}
+
+/*************************************************************//**
+Wait until the sort threads have completed all queued jobs.
+@return	DB_SUCCESS or the first error reported by a job */
+UNIV_STATIC
+ulint
+row_merge_sorter_wait(
+/*==================*/
+	row_merge_sorter_t*	sorter)	/*!< in/out: sort threads */
+{
+	ulint	err;
+
+	os_fast_mutex_lock(&sorter->mutex);
+
+	while (sorter->n_pending > 0) {
+		ib_int64_t	sig_count;
+
+		sig_count = os_event_reset(sorter->done_event);
+		os_fast_mutex_unlock(&sorter->mutex);
+		os_event_wait_low(sorter->done_event, sig_count);
+		os_fast_mutex_lock(&sorter->mutex);
+	}
+
+	err = sorter->error;
+
+	os_fast_mutex_unlock(&sorter->mutex);
+
+	return(err);
+}
+
+/*************************************************************//**
+Stop the sort threads, after they have completed the queued jobs,
+and free the sorter. */
+UNIV_STATIC
+void
+row_merge_sorter_free(
+/*==================*/
+	row_merge_sorter_t*	sorter)	/*!< in,own: sort threads */
+{
+	os_fast_mutex_lock(&sorter->mutex);
+
+	sorter->shutdown = TRUE;
+	os_event_set(sorter->job_event);
+
+	while (sorter->n_threads > 0) {
+		ib_int64_t	sig_count;
+
+		sig_count = os_event_reset(sorter->done_event);
+		os_fast_mutex_unlock(&sorter->mutex);
+		os_event_wait_low(sorter->done_event, sig_count);
+		os_fast_mutex_lock(&sorter->mutex);
+	}
+
+	ut_ad(sorter->n_pending == 0);
+	ut_ad(UT_LIST_GET_LEN(sorter->queue) == 0);
+
+	os_fast_mutex_unlock(&sorter->mutex);
+
+	os_event_free(sorter->job_event);
+	os_event_free(sorter->done_event);
+	os_fast_mutex_free(&sorter->mutex);
+
+	mem_free(sorter);
+}
+
 /*************************************************************//**
 Copy externally stored columns to the data tuple. */
 UNIV_STATIC
@@ -1808,7 +2360,7 @@ row_merge_insert_index_tuples(
 		offsets[1] = dict_index_get_n_fields(index);
 	}
 
-	b = *block;
+	b = block;
 
 	if (!row_merge_read(fd, foffs, block)) {
 		err = DB_CORRUPTION;
@@ -2267,9 +2819,13 @@ row_merge_build_indexes(
 					unless creating a PRIMARY KEY */
 	dict_index_t**	indexes,	/*!< in: indexes to be created */
 	ulint		n_indexes,	/*!< in: size of indexes[] */
-	table_handle_t	table)		/*!< in/out: Client table, for
+	table_handle_t	table,		/*!< in/out: Client table, for
 					reporting erroneous key value
 					if applicable */
+	read_view_t*	view)		/*!< in: consistent read view for
+					scanning old_table while it is
+					being modified, or NULL to read
+					the latest version of each row */
 {
 	merge_file_t*		merge_files;
 	row_merge_block_t*	block;
@@ -2277,6 +2833,7 @@ row_merge_build_indexes(
 	ulint			i;
 	ulint			error;
 	int			tmpfd;
+	row_merge_sorter_t*	sorter	= NULL;
 
 	ut_ad(trx);
 	ut_ad(old_table);
@@ -2290,7 +2847,7 @@ row_merge_build_indexes(
 	fields */
 
 	merge_files = mem_alloc(n_indexes * sizeof *merge_files);
-	block_size = 3 * sizeof *block;
+	block_size = 3 * srv_sort_buf_size;
 	block = os_mem_alloc_large(&block_size);
 
 	for (i = 0; i < n_indexes; i++) {
@@ -2300,24 +2857,63 @@ row_merge_build_indexes(
 
 	tmpfd = ib_create_tempfile("mrg");
 
+	if (srv_sort_threads > 1) {
+		sorter = row_merge_sorter_create(
+			trx, table, indexes, merge_files, srv_sort_threads);
+	}
+
 	/* Read clustered index of the table and create files for
 	secondary index entries for merge sort */
 
 	error = row_merge_read_clustered_index(
 		trx, table, old_table, new_table, indexes,
-		merge_files, n_indexes, block);
+		merge_files, n_indexes, block, sorter, view);
+
+	if (sorter != NULL) {
+		ulint	sort_error;
+
+		/* Wait for the last runs to be written. */
+		sort_error = row_merge_sorter_wait(sorter);
+
+		if (error == DB_SUCCESS && sort_error != DB_SUCCESS) {
+			error = sort_error;
+			trx->error_key_num = sorter->error_index;
+		}
+	}
 
 	if (error != DB_SUCCESS) {
 
 		goto func_exit;
 	}
 
+	if (sorter != NULL) {
+		/* Merge sort the files of all indexes in parallel.
+		The inserts below must be done by this thread. */
+
+		for (i = 0; i < n_indexes; i++) {
+			if (row_merge_sorter_add(sorter, ROW_MERGE_JOB_MERGE,
+						 i, NULL, 0) != DB_SUCCESS) {
+				break;
+			}
+		}
+
+		error = row_merge_sorter_wait(sorter);
+
+		if (error != DB_SUCCESS) {
+			trx->error_key_num = sorter->error_index;
+			goto func_exit;
+		}
+	}
+
 	/* Now we have files containing index entries ready for
 	sorting and inserting. */
 
 	for (i = 0; i < n_indexes; i++) {
-		error = row_merge_sort(trx, indexes[i], &merge_files[i],
-				       block, &tmpfd, table);
+		if (sorter == NULL) {
+			error = row_merge_sort(trx, indexes[i],
+					       &merge_files[i],
+					       block, &tmpfd, table);
+		}
 
 		if (error == DB_SUCCESS) {
 			error = row_merge_insert_index_tuples(
@@ -2336,6 +2932,10 @@ row_merge_build_indexes(
 	}
 
 func_exit:
+	if (sorter != NULL) {
+		row_merge_sorter_free(sorter);
+	}
+
 #ifdef __WIN__
 	_close(tmpfd);
 #else
@@ -2351,3 +2951,315 @@ func_exit:
 
 	return(error);
 }
+
+/** An operation logged for an index that is being created online */
+typedef struct row_merge_log_rec_struct row_merge_log_rec_t;
+
+/** An operation logged for an index that is being created online */
+struct row_merge_log_rec_struct {
+	enum row_merge_log_op_type	op;	/*!< operation */
+	dtuple_t*			entry;	/*!< index entry */
+	UT_LIST_NODE_T(row_merge_log_rec_t)
+					recs;	/*!< list of logged
+						operations */
+};
+
+/** Log of the changes made to an index while it is being created */
+struct row_merge_log_struct {
+	os_fast_mutex_t	mutex;		/*!< protects the fields below */
+	mem_heap_t*	heap;		/*!< memory heap for recs */
+	UT_LIST_BASE_NODE_T(row_merge_log_rec_t)
+			recs;		/*!< operations in the order they
+					were logged */
+	ibool		overflow;	/*!< TRUE if more than
+					srv_online_log_max_size bytes
+					were logged; the index creation
+					will fail */
+};
+
+/*********************************************************************//**
+Starts logging the changes to an index that has been created but whose
+entries are yet to be built by row_merge_build_indexes() from a read
+view.  Until row_merge_log_free() is called, DML logs its changes to
+the index instead of modifying the index tree.  The caller must prevent
+concurrent modifications of the table while calling this function. */
+UNIV_INTERN
+void
+row_merge_log_create(
+/*=================*/
+	dict_index_t*	index)		/*!< in/out: index */
+{
+	row_merge_log_t*	log;
+
+	ut_ad(!dict_index_is_clust(index));
+	ut_ad(index->online_log == NULL);
+
+	log = mem_alloc(sizeof *log);
+
+	os_fast_mutex_init(&log->mutex);
+	log->heap = mem_heap_create(1024);
+	UT_LIST_INIT(log->recs);
+	log->overflow = FALSE;
+
+	index->online_log = log;
+	index->online_status = ONLINE_INDEX_CREATION;
+}
+
+/*********************************************************************//**
+Logs an operation on an index that is being created online. */
+UNIV_INTERN
+void
+row_merge_log_op(
+/*=============*/
+	dict_index_t*		index,	/*!< in/out: index being created */
+	const dtuple_t*		entry,	/*!< in: index entry */
+	enum row_merge_log_op_type op)	/*!< in: operation */
+{
+	row_merge_log_t*	log	= index->online_log;
+	row_merge_log_rec_t*	rec;
+	ulint			i;
+
+	ut_ad(dict_index_is_online(index));
+	ut_ad(dtuple_check_typed(entry));
+
+	if (log == NULL || index->online_status == ONLINE_INDEX_ABORTED) {
+
+		return;
+	}
+
+	os_fast_mutex_lock(&log->mutex);
+
+	if (UNIV_UNLIKELY(log->overflow)) {
+
+		goto func_exit;
+	}
+
+	if (UNIV_UNLIKELY(mem_heap_get_size(log->heap)
+			  > srv_online_log_max_size)) {
+
+		/* The logged operations will not be applied:
+		release the memory right away. */
+		log->overflow = TRUE;
+		mem_heap_empty(log->heap);
+		UT_LIST_INIT(log->recs);
+
+		goto func_exit;
+	}
+
+	rec = mem_heap_alloc(log->heap, sizeof *rec);
+	rec->op = op;
+	rec->entry = dtuple_copy(entry, log->heap);
+
+	for (i = 0; i < dtuple_get_n_fields(entry); i++) {
+		dfield_dup(dtuple_get_nth_field(rec->entry, i), log->heap);
+	}
+
+	UT_LIST_ADD_LAST(recs, log->recs, rec);
+
+func_exit:
+	os_fast_mutex_unlock(&log->mutex);
+}
+
+/*********************************************************************//**
+Removes an entry from an index that is being created online.
+@return	DB_SUCCESS, DB_FAIL or error code */
+UNIV_STATIC
+ulint
+row_merge_log_apply_delete(
+/*=======================*/
+	ulint		mode,	/*!< in: BTR_MODIFY_LEAF or BTR_MODIFY_TREE,
+				depending on whether we wish optimistic or
+				pessimistic descent down the index tree */
+	dict_index_t*	index,	/*!< in/out: index */
+	dtuple_t*	entry)	/*!< in: index entry to remove */
+{
+	btr_pcur_t	pcur;
+	btr_cur_t*	btr_cur;
+	ulint		err	= DB_SUCCESS;
+	mtr_t		mtr;
+
+	log_free_check();
+	mtr_start(&mtr);
+
+	/* The entry is missing if the row was inserted and deleted
+	after the read view of the table scan was created. */
+
+	if (row_search_index_entry(index, entry, mode, &pcur, &mtr)) {
+		btr_cur = btr_pcur_get_btr_cur(&pcur);
+
+		if (mode == BTR_MODIFY_LEAF) {
+			if (!btr_cur_optimistic_delete(btr_cur, &mtr)) {
+				err = DB_FAIL;
+			}
+		} else {
+			ut_ad(mode == BTR_MODIFY_TREE);
+			btr_cur_pessimistic_delete(&err, FALSE, btr_cur,
+						   RB_NONE, &mtr);
+		}
+	}
+
+	btr_pcur_close(&pcur);
+	mtr_commit(&mtr);
+
+	return(err);
+}
+
+/*********************************************************************//**
+Applies the operations logged for an index that is being created online.
+This can be called while the table is being modified, in which case
+the operations logged meanwhile will be applied as well; to apply all
+of them, the caller must prevent concurrent modifications of the table.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+ulint
+row_merge_log_apply(
+/*================*/
+	trx_t*		trx,		/*!< in: transaction */
+	dict_index_t*	index)		/*!< in/out: index being created */
+{
+	row_merge_log_t*	log	= index->online_log;
+	que_thr_t*		thr;
+	ins_node_t*		node;
+	mem_heap_t*		graph_heap;
+	enum db_err		err	= DB_SUCCESS;
+
+	ut_ad(dict_index_is_online(index));
+	ut_a(log != NULL);
+
+	/* We use the insert query graph as the dummy graph
+	needed in the row module call */
+
+	trx->op_info = "applying the row log";
+
+	graph_heap = mem_heap_create(500);
+	node = row_ins_node_create(INS_DIRECT, index->table, graph_heap);
+
+	thr = pars_complete_graph_for_exec(node, trx, graph_heap);
+
+	que_thr_move_to_run_state(thr);
+
+	for (;;) {
+		mem_heap_t*		heap;
+		row_merge_log_rec_t*	rec;
+
+		/* Detach the logged operations, so that DML can go on
+		logging while we apply them. */
+
+		os_fast_mutex_lock(&log->mutex);
+
+		if (UNIV_UNLIKELY(log->overflow)) {
+			os_fast_mutex_unlock(&log->mutex);
+
+			ut_print_timestamp(ib_stream);
+			ib_logger(ib_stream,
+				  "  InnoDB: the changes made to the table"
+				  " during the creation of index ");
+			ut_print_name(ib_stream, trx, FALSE, index->name + 1);
+			ib_logger(ib_stream,
+				  " exceeded online_log_max_size\n");
+
+			err = DB_OUT_OF_MEMORY;
+			goto func_exit;
+		}
+
+		rec = UT_LIST_GET_FIRST(log->recs);
+
+		if (rec == NULL) {
+			os_fast_mutex_unlock(&log->mutex);
+			break;
+		}
+
+		heap = log->heap;
+		log->heap = mem_heap_create(1024);
+		UT_LIST_INIT(log->recs);
+
+		os_fast_mutex_unlock(&log->mutex);
+
+		for (; rec != NULL; rec = UT_LIST_GET_NEXT(recs, rec)) {
+
+			if (rec->op == ROW_MERGE_LOG_DELETE) {
+				err = row_merge_log_apply_delete(
+					BTR_MODIFY_LEAF, index, rec->entry);
+
+				if (err == DB_FAIL) {
+					err = row_merge_log_apply_delete(
+						BTR_MODIFY_TREE, index,
+						rec->entry);
+				}
+
+				if (err != DB_SUCCESS) {
+					mem_heap_free(heap);
+					goto func_exit;
+				}
+
+				continue;
+			}
+
+			ut_ad(rec->op == ROW_MERGE_LOG_INSERT);
+
+			node->row = rec->entry;
+			node->trx_id = trx->id;
+
+			do {
+				thr->run_node = thr;
+				thr->prev_node = thr->common.parent;
+
+				err = row_ins_index_entry(index, rec->entry,
+							  0, FALSE, thr);
+
+				if (UNIV_LIKELY(err == DB_SUCCESS)) {
+
+					goto next_rec;
+				}
+
+				thr->lock_state = QUE_THR_LOCK_ROW;
+				trx->error_state = err;
+				que_thr_stop_client(thr);
+				thr->lock_state = QUE_THR_LOCK_NOLOCK;
+			} while (ib_handle_errors(&err, trx, thr, NULL));
+
+			mem_heap_free(heap);
+			goto err_exit;
+next_rec:
+			;
+		}
+
+		mem_heap_free(heap);
+	}
+
+func_exit:
+	que_thr_stop_for_client_no_error(thr, trx);
+err_exit:
+	que_graph_free(thr->graph);
+
+	trx->op_info = "";
+
+	return(err);
+}
+
+/*********************************************************************//**
+Stops logging the changes to an index that was being created online.
+The caller must prevent concurrent modifications of the table. */
+UNIV_INTERN
+void
+row_merge_log_free(
+/*===============*/
+	dict_index_t*	index,		/*!< in/out: index */
+	ibool		aborted)	/*!< in: TRUE if the index will
+					be dropped, FALSE if all logged
+					operations have been applied */
+{
+	row_merge_log_t*	log	= index->online_log;
+
+	ut_ad(dict_index_is_online(index));
+	ut_a(log != NULL);
+	ut_ad(aborted || UT_LIST_GET_LEN(log->recs) == 0);
+
+	index->online_status = aborted
+		? ONLINE_INDEX_ABORTED : ONLINE_INDEX_COMPLETE;
+	index->online_log = NULL;
+
+	mem_heap_free(log->heap);
+	os_fast_mutex_free(&log->mutex);
+	mem_free(log);
+}
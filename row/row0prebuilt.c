@@ -153,6 +153,10 @@ row_prebuilt_free(
 
 	mem_heap_free(row_cache->heap);
 
+	if (prebuilt->pred_heap != NULL) {
+		mem_heap_free(prebuilt->pred_heap);
+	}
+
 	if (prebuilt->table != NULL) {
 		dict_table_decrement_handle_count(prebuilt->table, dict_locked);
 	}
@@ -192,6 +196,100 @@ row_prebuilt_reset(
 	}
 }
 
+/************************************************************************
+Add a predicate of the form "column op constant" to the predicates that
+row_search_for_client() evaluates on the records of a table handle. A row
+is returned only if it satisfies all the predicates. */
+UNIV_INTERN
+void
+row_prebuilt_add_pred(
+/*==================*/
+	row_prebuilt_t*		prebuilt,	/*!< in/out: prebuilt struct;
+						prebuilt->index must be set */
+	ulint			col_no,		/*!< in: column number in the
+						table */
+	enum row_sel_pred_op	op,		/*!< in: comparison operator */
+	const dfield_t*		val)		/*!< in: constant, of the type
+						of the column; SQL NULL only
+						with ROW_SEL_PRED_EQ and
+						ROW_SEL_PRED_NE */
+{
+	row_sel_pred_t*		pred;
+	const dict_col_t*	col;
+	dict_index_t*		index = prebuilt->index;
+
+	ut_ad(index != NULL);
+	ut_ad(col_no < dict_table_get_n_cols(prebuilt->table));
+	ut_ad(!dfield_is_null(val)
+	      || op == ROW_SEL_PRED_EQ || op == ROW_SEL_PRED_NE);
+
+	if (prebuilt->pred_heap == NULL) {
+		prebuilt->pred_heap = mem_heap_create(
+			8 * sizeof(row_sel_pred_t));
+	}
+
+	/* The array only grows until row_prebuilt_clear_preds() empties
+	the heap, so the old copies are not freed. */
+	if (prebuilt->n_preds == prebuilt->max_preds) {
+		row_sel_pred_t*	preds;
+
+		prebuilt->max_preds = 2 * prebuilt->max_preds + 4;
+
+		preds = mem_heap_alloc(
+			prebuilt->pred_heap,
+			prebuilt->max_preds * sizeof(*preds));
+
+		if (prebuilt->n_preds > 0) {
+			memcpy(preds, prebuilt->preds,
+			       prebuilt->n_preds * sizeof(*preds));
+		}
+
+		prebuilt->preds = preds;
+	}
+
+	pred = &prebuilt->preds[prebuilt->n_preds++];
+
+	col = dict_table_get_nth_col(prebuilt->table, col_no);
+
+	pred->op = op;
+	pred->clust_pos = dict_col_get_clust_pos(
+		col, dict_table_get_first_index(prebuilt->table));
+
+	if (dict_index_is_clust(index)) {
+		pred->sec_pos = ULINT_UNDEFINED;
+	} else {
+		pred->sec_pos = dict_index_get_nth_col_pos(index, col_no);
+
+		if (pred->sec_pos == ULINT_UNDEFINED) {
+			prebuilt->preds_need_clust = TRUE;
+		}
+	}
+
+	dfield_copy(&pred->val, val);
+
+	if (!dfield_is_null(val)) {
+		dfield_dup(&pred->val, prebuilt->pred_heap);
+	}
+}
+
+/************************************************************************
+Remove all the predicates of a table handle. */
+UNIV_INTERN
+void
+row_prebuilt_clear_preds(
+/*=====================*/
+	row_prebuilt_t*	prebuilt)	/*!< in/out: prebuilt struct */
+{
+	prebuilt->preds = NULL;
+	prebuilt->n_preds = 0;
+	prebuilt->max_preds = 0;
+	prebuilt->preds_need_clust = FALSE;
+
+	if (prebuilt->pred_heap != NULL) {
+		mem_heap_empty(prebuilt->pred_heap);
+	}
+}
+
 /*************************************************************************
 Updates the transaction pointers in query graphs stored in the prebuilt
 struct. */
@@ -314,6 +314,13 @@ row_purge_remove_sec_if_poss(
 
 	/* ib_logger(ib_stream, "Purge: Removing secondary record\n"); */
 
+	if (UNIV_UNLIKELY(dict_index_is_online(index))) {
+		/* The index is being created: the row log removes
+		the entries of deleted rows. */
+
+		return;
+	}
+
 	success = row_purge_remove_sec_if_poss_low(node, index, entry,
 						   BTR_MODIFY_LEAF);
 	if (success) {
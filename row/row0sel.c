@@ -70,6 +70,10 @@ to que_run_threads: this is to allow canceling runaway queries */
 
 #define SEL_COST_LIMIT	100
 
+/* An aggregate scan commits and restarts its mini-transaction after
+visiting this many records */
+#define ROW_SEL_AGGR_RECS_PER_MTR	1024
+
 /* Flags for search shortcut */
 #define SEL_FOUND	0
 #define	SEL_EXHAUSTED	1
@@ -1122,6 +1126,317 @@ plan_reset_cursor(
 	plan->n_rows_prefetched = 0;
 }
 
+/*********************************************************************//**
+Checks whether a column value satisfies a predicate.
+@return	TRUE if the value satisfies the predicate */
+UNIV_INLINE
+ibool
+row_sel_pred_is_true(
+/*=================*/
+	const row_sel_pred_t*	pred,	/*!< in: predicate */
+	void*			cmp_ctx,/*!< in: client compare context */
+	const byte*		data,	/*!< in: column value */
+	ulint			len)	/*!< in: length of data or
+					UNIV_SQL_NULL */
+{
+	int		cmp;
+	const dtype_t*	type = dfield_get_type(&pred->val);
+
+	if (dfield_is_null(&pred->val)) {
+		return((len == UNIV_SQL_NULL) == (pred->op == ROW_SEL_PRED_EQ));
+	} else if (len == UNIV_SQL_NULL) {
+		return(FALSE);
+	}
+
+	cmp = cmp_data_data(cmp_ctx, type->mtype, type->prtype, data, len,
+			    dfield_get_data(&pred->val),
+			    dfield_get_len(&pred->val));
+
+	switch (pred->op) {
+	case ROW_SEL_PRED_EQ:
+		return(cmp == 0);
+	case ROW_SEL_PRED_NE:
+		return(cmp != 0);
+	case ROW_SEL_PRED_LT:
+		return(cmp < 0);
+	case ROW_SEL_PRED_LE:
+		return(cmp <= 0);
+	case ROW_SEL_PRED_GT:
+		return(cmp > 0);
+	case ROW_SEL_PRED_GE:
+		return(cmp >= 0);
+	}
+
+	ut_error;
+	return(FALSE);
+}
+
+/*********************************************************************//**
+Evaluates the predicates of a table handle on a record, before the record
+is copied to the fetch cache. On a secondary index record only the
+predicates on the columns that the index stores in full are evaluated.
+@return	TRUE if the record satisfies the predicates */
+UNIV_STATIC
+ibool
+row_sel_eval_preds(
+/*===============*/
+	const row_prebuilt_t*	prebuilt,/*!< in: prebuilt struct */
+	const dict_index_t*	index,	/*!< in: index of rec */
+	const rec_t*		rec,	/*!< in: record; must be protected
+					by a page latch */
+	const ulint*		offsets)/*!< in: rec_get_offsets(rec, index) */
+{
+	ulint		i;
+	mem_heap_t*	heap = NULL;
+	ibool		is_clust = dict_index_is_clust(index);
+	ibool		ret = TRUE;
+
+	ut_ad(rec_offs_validate(rec, index, offsets));
+
+	for (i = 0; ret && i < prebuilt->n_preds; ++i) {
+		const byte*		data;
+		ulint			len;
+		ulint			pos;
+		const row_sel_pred_t*	pred = &prebuilt->preds[i];
+
+		pos = is_clust ? pred->clust_pos : pred->sec_pos;
+
+		if (pos == ULINT_UNDEFINED) {
+			/* Evaluated on the clustered index record. */
+			continue;
+		} else if (UNIV_UNLIKELY(rec_offs_nth_extern(offsets, pos))) {
+
+			if (heap == NULL) {
+				heap = mem_heap_create(UNIV_PAGE_SIZE);
+			}
+
+			data = btr_rec_copy_externally_stored_field(
+				rec, offsets,
+				dict_table_zip_size(index->table),
+				pos, &len, heap);
+		} else {
+			data = rec_get_nth_field(rec, offsets, pos, &len);
+		}
+
+		ret = row_sel_pred_is_true(pred, index->cmp_ctx, data, len);
+	}
+
+	if (heap != NULL) {
+		mem_heap_free(heap);
+	}
+
+	return(ret);
+}
+
+/*********************************************************************//**
+Checks whether an aggregate scan can stop at a record: the first ordering
+column of the index fails a predicate that no later record in the
+direction of the scan can satisfy either. SQL NULL values sort first and
+never end a scan.
+@return	TRUE if rec and the records after it are not in the range */
+UNIV_STATIC
+ibool
+row_sel_preds_end_scan(
+/*===================*/
+	const row_prebuilt_t*	prebuilt,/*!< in: prebuilt struct */
+	const dict_index_t*	index,	/*!< in: index of rec */
+	const rec_t*		rec,	/*!< in: record of index */
+	const ulint*		offsets,/*!< in: rec_get_offsets(rec, index) */
+	ibool			moves_up)/*!< in: TRUE if the scan moves
+					up in the index */
+{
+	ulint		i;
+	ibool		is_clust = dict_index_is_clust(index);
+
+	ut_ad(rec_offs_validate(rec, index, offsets));
+
+	for (i = 0; i < prebuilt->n_preds; ++i) {
+		int			cmp;
+		ibool			bounds;
+		const byte*		data;
+		ulint			len;
+		const dtype_t*		type;
+		const row_sel_pred_t*	pred = &prebuilt->preds[i];
+
+		if ((is_clust ? pred->clust_pos : pred->sec_pos) != 0
+		    || dfield_is_null(&pred->val)) {
+
+			continue;
+		}
+
+		switch (pred->op) {
+		case ROW_SEL_PRED_EQ:
+			bounds = TRUE;
+			break;
+		case ROW_SEL_PRED_LT:
+		case ROW_SEL_PRED_LE:
+			bounds = moves_up;
+			break;
+		case ROW_SEL_PRED_GT:
+		case ROW_SEL_PRED_GE:
+			bounds = !moves_up;
+			break;
+		default:
+			bounds = FALSE;
+		}
+
+		if (!bounds) {
+			continue;
+		}
+
+		data = rec_get_nth_field(rec, offsets, 0, &len);
+
+		if (len == UNIV_SQL_NULL) {
+			continue;
+		}
+
+		type = dfield_get_type(&pred->val);
+
+		cmp = cmp_data_data(index->cmp_ctx, type->mtype, type->prtype,
+				    data, len, dfield_get_data(&pred->val),
+				    dfield_get_len(&pred->val));
+
+		if ((moves_up ? cmp >= 0 : cmp <= 0)
+		    && !row_sel_pred_is_true(pred, index->cmp_ctx, data, len)) {
+
+			return(TRUE);
+		}
+	}
+
+	return(FALSE);
+}
+
+/* Fold a value into the result field of an aggregate. */
+#define ROW_SEL_AGGR_FOLD(aggr, field, v)				\
+	do {								\
+		if ((aggr)->n_vals == 0) {				\
+			(aggr)->field = (v);				\
+		} else if ((aggr)->op == ROW_SEL_AGGR_SUM) {		\
+			(aggr)->field += (v);				\
+		} else if ((aggr)->op == ROW_SEL_AGGR_MIN		\
+			   ? (v) < (aggr)->field			\
+			   : (v) > (aggr)->field) {			\
+			(aggr)->field = (v);				\
+		}							\
+	} while (0)
+
+/*********************************************************************//**
+Folds a record into the aggregates of a table handle. The record is read
+in place: it is not copied to the fetch cache. */
+UNIV_STATIC
+void
+row_sel_aggr_add_rec(
+/*=================*/
+	row_prebuilt_t*	prebuilt,	/*!< in/out: prebuilt struct */
+	const rec_t*	rec,		/*!< in: record; must be protected
+					by a page latch */
+	const ulint*	offsets)	/*!< in: rec_get_offsets(rec) */
+{
+	ulint		i;
+
+	for (i = 0; i < prebuilt->n_aggrs; ++i) {
+		const byte*	data;
+		ulint		len;
+		row_sel_aggr_t*	aggr = &prebuilt->aggrs[i];
+
+		if (aggr->op == ROW_SEL_AGGR_COUNT) {
+			++aggr->n_vals;
+			continue;
+		}
+
+		ut_ad(!rec_offs_nth_extern(offsets, aggr->pos));
+
+		data = rec_get_nth_field(rec, offsets, aggr->pos, &len);
+
+		if (len == UNIV_SQL_NULL) {
+			continue;
+		}
+
+		switch (aggr->mtype) {
+		case DATA_INT: {
+			byte	buf[8];
+
+			ut_a(len <= sizeof(buf));
+
+			/* Convert to the host byte order the way
+			ib_col_copy_value() does. */
+			mach_read_int_type(buf, data, len, aggr->usign);
+
+			if (aggr->usign) {
+				ib_uint64_t	u;
+				ib_uint16_t	u16;
+				ib_uint32_t	u32;
+
+				switch (len) {
+				case 1:
+					u = buf[0];
+					break;
+				case 2:
+					memcpy(&u16, buf, sizeof(u16));
+					u = u16;
+					break;
+				case 4:
+					memcpy(&u32, buf, sizeof(u32));
+					u = u32;
+					break;
+				default:
+					ut_a(len == sizeof(u));
+					memcpy(&u, buf, sizeof(u));
+				}
+
+				ROW_SEL_AGGR_FOLD(aggr, u64, u);
+			} else {
+				ib_int64_t	i64;
+				ib_int16_t	i16;
+				ib_int32_t	i32;
+
+				switch (len) {
+				case 1:
+					i64 = (signed char) buf[0];
+					break;
+				case 2:
+					memcpy(&i16, buf, sizeof(i16));
+					i64 = i16;
+					break;
+				case 4:
+					memcpy(&i32, buf, sizeof(i32));
+					i64 = i32;
+					break;
+				default:
+					ut_a(len == sizeof(i64));
+					memcpy(&i64, buf, sizeof(i64));
+				}
+
+				ROW_SEL_AGGR_FOLD(aggr, i64, i64);
+			}
+			break;
+		}
+		case DATA_FLOAT: {
+			double	d;
+
+			ut_a(len == sizeof(float));
+			d = mach_float_read(data);
+
+			ROW_SEL_AGGR_FOLD(aggr, dbl, d);
+			break;
+		}
+		case DATA_DOUBLE: {
+			double	d;
+
+			ut_a(len == sizeof(double));
+			d = mach_double_read(data);
+
+			ROW_SEL_AGGR_FOLD(aggr, dbl, d);
+			break;
+		}
+		default:
+			ut_error;
+		}
+
+		++aggr->n_vals;
+	}
+}
+
 /*********************************************************************//**
 Tries to do a shortcut to fetch a clustered index record with a unique key,
 using the hash index if possible (not always).
@@ -2876,6 +3191,7 @@ row_search_for_client(
 	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
 	ulint*		offsets				= offsets_;
 	void*		cmp_ctx				= index->cmp_ctx;
+	ulint		n_aggr_recs			= 0;
 
 	rec_offs_init(offsets_);
 
@@ -3066,7 +3382,9 @@ row_search_for_client(
 		if (trx->client_n_tables_locked == 0
 		    && prebuilt->select_lock_type == LOCK_NONE
 		    && trx->isolation_level > TRX_ISO_READ_UNCOMMITTED
-		    && trx->read_view) {
+		    && trx->read_view
+		    && prebuilt->n_preds == 0
+		    && prebuilt->n_aggrs == 0) {
 
 			/* This is a SELECT query done as a consistent read,
 			and the read view has already been allocated:
@@ -3078,7 +3396,9 @@ row_search_for_client(
 			CREATE TABLE ... SELECT ... . Our algorithm is
 			NOT prepared to inserts interleaved with the SELECT,
 			and if we try that, we can deadlock on the adaptive
-			hash index semaphore! */
+			hash index semaphore! The shortcut does not evaluate
+			the predicates of the handle nor compute its
+			aggregates. */
 
 #ifndef UNIV_SEARCH_DEBUG
 			if (!trx->has_search_latch) {
@@ -3483,6 +3803,16 @@ not_found:
 		}
 	}
 
+	/* An aggregate scan ends where a predicate of the handle bounds
+	the first ordering column of the index. */
+
+	if (UNIV_UNLIKELY(prebuilt->n_aggrs > 0)
+	    && prebuilt->n_preds > 0
+	    && row_sel_preds_end_scan(prebuilt, index, rec, offsets, moves_up)) {
+
+		goto not_found;
+	}
+
 	/* We are ready to look at a possible new index entry in the result
 	set: the cursor is now placed on a user record */
 
@@ -3651,10 +3981,21 @@ no_gap_lock:
 			cmp_ctx, search_tuple, rec, offsets);
 	}
 
+	/* Skip the rows that do not satisfy the predicates of the handle
+	before the clustered index lookup and the copy to the cache. */
+
+	if (prebuilt->n_preds > 0
+	    && !row_sel_eval_preds(prebuilt, index, rec, offsets)) {
+
+		goto filtered_rec;
+	}
+
 	/* Get the clustered index record if needed, if we did not do the
 	search using the clustered index. */
 
-	if (index != clust_index && prebuilt->need_to_access_clustered) {
+	if (index != clust_index
+	    && (prebuilt->need_to_access_clustered
+		|| prebuilt->preds_need_clust)) {
 
 requires_clust_rec:
 		/* We use a 'goto' to the preceding label if a consistent
@@ -3713,6 +4054,16 @@ requires_clust_rec:
 			goto next_rec;
 		}
 
+		/* The secondary index record may not be the version in
+		the read view, so evaluate all the predicates again. */
+
+		if (prebuilt->n_preds > 0
+		    && !row_sel_eval_preds(
+			    prebuilt, clust_index, clust_rec, offsets)) {
+
+			goto filtered_rec;
+		}
+
 		if (row_sel_row_cache_is_empty(prebuilt)) {
 			prebuilt->result = cmp_dtuple_rec(
 				cmp_ctx, search_tuple, clust_rec, offsets);
@@ -3751,6 +4102,23 @@ requires_clust_rec:
 	by a page latch that was acquired when pcur was positioned.
 	The latch will not be released until mtr_commit(&mtr). */
 
+	if (UNIV_UNLIKELY(prebuilt->n_aggrs > 0)) {
+
+		/* Fold the row into the aggregates instead of copying
+		it to the fetch cache, and go on to the end of the range. */
+
+		row_sel_aggr_add_rec(prebuilt, result_rec, offsets);
+
+		if (unique_search) {
+
+			goto got_row;
+		}
+
+		srv_n_rows_read++;
+
+		goto next_rec;
+	}
+
 	if ((match_mode == ROW_SEL_EXACT
 	     || prebuilt->row_cache.n_cached >= prebuilt->row_cache.n_size - 1)
 	    && prebuilt->select_lock_type == LOCK_NONE
@@ -3800,17 +4168,34 @@ got_row:
 
 	goto normal_return;
 
+filtered_rec:
+	/* The record does not satisfy the predicates: we skip it */
+
+	if (trx->isolation_level == TRX_ISO_READ_COMMITTED
+	    && prebuilt->select_lock_type != LOCK_NONE) {
+
+		/* No need to keep a lock on a skipped record if we do
+		not want to use next-key locking. */
+
+		row_unlock_for_client(prebuilt, TRUE);
+	}
+
 next_rec:
 	prebuilt->new_rec_locks = 0;
 
 	/*-------------------------------------------------------------*/
 	/* PHASE 5: Move the cursor to the next index record */
 
-	if (UNIV_UNLIKELY(mtr_has_extra_clust_latch)) {
+	if (UNIV_UNLIKELY(mtr_has_extra_clust_latch)
+	    || (UNIV_UNLIKELY(prebuilt->n_aggrs > 0)
+		&& ++n_aggr_recs % ROW_SEL_AGGR_RECS_PER_MTR == 0)) {
 		/* We must commit mtr if we are moving to the next
 		non-clustered index record, because we could break the
 		latching order if we would access a different clustered
-		index page right away without releasing the previous. */
+		index page right away without releasing the previous.
+		An aggregate scan does not return before the end of its
+		range: it also restarts the mtr now and then so that the
+		memo does not grow with every page that it visits. */
 
 		btr_pcur_store_position(pcur, &mtr);
 
@@ -3940,3 +4325,111 @@ func_exit:
 
 	return(err);
 }
+
+/********************************************************************//**
+Computes aggregates over the records that a search with
+row_search_for_client() would return, without copying them to the fetch
+cache. The scan starts like a ROW_SEL_MOVETO search and ends at the end
+of the range defined by match_mode, at the end of the index or, when the
+index moves up (down), at the first record whose first ordering column
+fails a predicate of the handle of the form column <, <= or = (>, >= or
+=) constant. The cursor is left without a current row.
+@return	DB_SUCCESS, DB_DEADLOCK, DB_LOCK_TABLE_FULL, DB_CORRUPTION or
+other error code */
+UNIV_INTERN
+enum db_err
+row_search_aggregate(
+/*=================*/
+	ib_recovery_t	recovery,	/*!< in: recovery flag */
+	ib_srch_mode_t	mode,		/*!< in: search mode */
+	row_prebuilt_t*	prebuilt,	/*!< in: prebuilt struct for the
+					table handle, see
+					row_search_for_client() */
+	ib_match_t	match_mode,	/*!< in: mode for matching the key */
+	row_sel_aggr_t*	aggrs,		/*!< in/out: aggregates; op and
+					col_no must be set, the results are
+					written by this function */
+	ulint		n_aggrs)	/*!< in: number of aggregates */
+{
+	ulint		i;
+	enum db_err	err;
+	ibool		use_clust;
+	dict_index_t*	index = prebuilt->index;
+	dict_table_t*	table = prebuilt->table;
+	ibool		need_to_access_clustered
+		= prebuilt->need_to_access_clustered;
+
+	ut_ad(n_aggrs > 0);
+	ut_ad(prebuilt->n_aggrs == 0);
+
+	/* Read the columns from the secondary index records if the
+	index stores all of them in full. */
+
+	use_clust = dict_index_is_clust(index) || need_to_access_clustered;
+
+	for (i = 0; !use_clust && i < n_aggrs; ++i) {
+
+		if (aggrs[i].op != ROW_SEL_AGGR_COUNT
+		    && dict_index_get_nth_col_pos(index, aggrs[i].col_no)
+		    == ULINT_UNDEFINED) {
+
+			use_clust = TRUE;
+		}
+	}
+
+	for (i = 0; i < n_aggrs; ++i) {
+		row_sel_aggr_t*	aggr = &aggrs[i];
+
+		aggr->n_vals = 0;
+		aggr->i64 = 0;
+		aggr->u64 = 0;
+		aggr->dbl = 0.0;
+
+		if (aggr->op != ROW_SEL_AGGR_COUNT) {
+			const dict_col_t*	col;
+
+			col = dict_table_get_nth_col(table, aggr->col_no);
+
+			ut_ad(col->mtype == DATA_INT
+			      || col->mtype == DATA_FLOAT
+			      || col->mtype == DATA_DOUBLE);
+
+			aggr->mtype = col->mtype;
+			aggr->usign = (col->prtype & DATA_UNSIGNED) != 0;
+
+			aggr->pos = use_clust
+				? dict_col_get_clust_pos(
+					col, dict_table_get_first_index(table))
+				: dict_index_get_nth_col_pos(
+					index, aggr->col_no);
+
+			ut_ad(aggr->pos != ULINT_UNDEFINED);
+		}
+	}
+
+	if (!dict_index_is_clust(index)) {
+		prebuilt->need_to_access_clustered = use_clust;
+	}
+
+	prebuilt->aggrs = aggrs;
+	prebuilt->n_aggrs = n_aggrs;
+
+	err = row_search_for_client(
+		recovery, mode, prebuilt, match_mode, ROW_SEL_MOVETO);
+
+	prebuilt->aggrs = NULL;
+	prebuilt->n_aggrs = 0;
+	prebuilt->need_to_access_clustered = need_to_access_clustered;
+
+	switch (err) {
+	case DB_RECORD_NOT_FOUND:
+	case DB_END_OF_INDEX:
+		/* The scan reached the end of its range. */
+		err = DB_SUCCESS;
+		break;
+	default:
+		break;
+	}
+
+	return(err);
+}
@@ -45,6 +45,7 @@ Created 2/25/1997 Heikki Tuuri
 #include "que0que.h"
 #include "ibuf0ibuf.h"
 #include "log0log.h"
+#include "row0merge.h"
 
 /***************************************************************//**
 Removes a clustered index record. The pcur in node was positioned on the
@@ -209,6 +210,12 @@ row_undo_ins_remove_sec(
 	ulint	err;
 	ulint	n_tries	= 0;
 
+	if (UNIV_UNLIKELY(dict_index_is_online(index))) {
+		row_merge_log_op(index, entry, ROW_MERGE_LOG_DELETE);
+
+		return(DB_SUCCESS);
+	}
+
 	/* Try first optimistic descent to the B-tree */
 
 	err = row_undo_ins_remove_sec_low(BTR_MODIFY_LEAF, index, entry);
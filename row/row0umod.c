@@ -43,6 +43,7 @@ Created 2/27/1997 Heikki Tuuri
 #include "row0upd.h"
 #include "que0que.h"
 #include "log0log.h"
+#include "row0merge.h"
 
 /* Considerations on undoing a modify operation.
 (1) Undoing a delete marking: all index records should be found. Some of
@@ -420,6 +421,12 @@ row_undo_mod_del_mark_or_remove_sec(
 {
 	ulint	err;
 
+	if (UNIV_UNLIKELY(dict_index_is_online(index))) {
+		row_merge_log_op(index, entry, ROW_MERGE_LOG_DELETE);
+
+		return(DB_SUCCESS);
+	}
+
 	err = row_undo_mod_del_mark_or_remove_sec_low(node, thr, index,
 						      entry, BTR_MODIFY_LEAF);
 	if (err == DB_SUCCESS) {
@@ -456,6 +463,12 @@ row_undo_mod_del_unmark_sec_and_undo_update(
 	mtr_t		mtr;
 	trx_t*		trx		= thr_get_trx(thr);
 
+	if (UNIV_UNLIKELY(dict_index_is_online(index))) {
+		row_merge_log_op(index, entry, ROW_MERGE_LOG_INSERT);
+
+		return(DB_SUCCESS);
+	}
+
 	/* Ignore indexes that are being created. */
 	if (UNIV_UNLIKELY(*index->name == TEMP_INDEX_PREFIX)) {
 
@@ -49,6 +49,7 @@ Created 12/27/1996 Heikki Tuuri
 #include "pars0sym.h"
 #include "eval0eval.h"
 #include "buf0lru.h"
+#include "row0merge.h"
 
 
 /* What kind of latch and lock can we assume when the control comes to
@@ -1461,6 +1462,22 @@ row_upd_sec_index_entry(
 	entry = row_build_index_entry(node->row, node->ext, index, heap);
 	ut_a(entry);
 
+	if (UNIV_UNLIKELY(dict_index_is_online(index))) {
+		/* The index is being created: log the change instead
+		of delete-marking the old entry and inserting the new. */
+		row_merge_log_op(index, entry, ROW_MERGE_LOG_DELETE);
+
+		if (!node->is_delete) {
+			entry = row_build_index_entry(
+				node->upd_row, node->upd_ext, index, heap);
+			ut_a(entry);
+
+			row_merge_log_op(index, entry, ROW_MERGE_LOG_INSERT);
+		}
+
+		goto func_exit;
+	}
+
 	log_free_check();
 	mtr_start(&mtr);
 
@@ -80,6 +80,7 @@ Created 10/8/1995 Heikki Tuuri
 #include "buf0lru.h"
 #include "btr0sea.h"
 #include "btr0cur.h"
+#include "dict0dict.h"
 #include "dict0load.h"
 #include "dict0boot.h"
 #include "srv0start.h"
@@ -173,9 +174,32 @@ UNIV_INTERN ulong	srv_flush_log_at_trx_commit = 1;
 the checkpoints. */
 UNIV_INTERN ibool	srv_adaptive_flushing	= TRUE;
 
+/** Search the waits-for graph for a cycle on every lock wait. If this is
+FALSE, deadlocks are resolved only by the lock wait timeout. */
+UNIV_INTERN ibool	srv_deadlock_detect	= TRUE;
+
 /** Use os/external memory allocator */
 UNIV_INTERN ibool	srv_use_sys_malloc      = FALSE;
 
+/** Number of rollback segments to create and to assign transactions to */
+UNIV_INTERN ulint	srv_rollback_segments	= TRX_SYS_MAX_RSEGS;
+
+/** Size of a merge sort block and of the in-memory sort buffer of each
+index being created, in bytes */
+UNIV_INTERN ulint	srv_sort_buf_size	= 1048576;
+
+/** Number of threads that sort and merge index entries while creating
+indexes; 1 means that the creating thread does all the sorting */
+UNIV_INTERN ulint	srv_sort_threads	= 4;
+
+/** Maximum size of the changes logged for an index that is being
+created while the table is modified, in bytes */
+UNIV_INTERN ulint	srv_online_log_max_size	= 128 * 1024 * 1024;
+
+/** Maximum number of tables in the dictionary cache before the master
+thread starts evicting unused tables; 0 means no limit */
+UNIV_INTERN ulint	srv_dict_cache_max_tables = 0;
+
 /** Maximum number of times allowed to conditionally acquire
 mutex before switching to blocking wait on the mutex */
 #define MAX_MUTEX_NOWAIT	20
@@ -348,6 +372,12 @@ UNIV_INTERN ulint	srv_n_rows_updated		= 0;
 UNIV_INTERN ulint	srv_n_rows_deleted		= 0;
 UNIV_INTERN ulint	srv_n_rows_read			= 0;
 
+/* Counters of the closed cursor cache of the API, updated while holding
+its mutex */
+UNIV_INTERN ulint	srv_n_cursor_cache_hits		= 0;
+UNIV_INTERN ulint	srv_n_cursor_cache_misses	= 0;
+UNIV_INTERN ulint	srv_n_cursor_cache_evictions	= 0;
+
 UNIV_STATIC ulint		srv_n_rows_inserted_old		= 0;
 UNIV_STATIC ulint		srv_n_rows_updated_old		= 0;
 UNIV_STATIC ulint		srv_n_rows_deleted_old		= 0;
@@ -668,8 +698,17 @@ srv_var_init(void)
 
 	srv_adaptive_flushing = TRUE;
 
+	srv_deadlock_detect = TRUE;
+
 	srv_use_sys_malloc = FALSE;
 
+	srv_rollback_segments = TRX_SYS_MAX_RSEGS;
+
+	srv_sort_buf_size = 1048576;
+	srv_sort_threads = 4;
+	srv_online_log_max_size = 128 * 1024 * 1024;
+	srv_dict_cache_max_tables = 0;
+
 #ifdef UNIV_LOG_ARCHIVE
 	srv_arch_dir	= NULL;
 #endif /* UNIV_LOG_ARCHIVE */
@@ -1787,6 +1826,40 @@ srv_export_innodb_status(void)
 	}
 	export_vars.innodb_row_lock_time_max
 		= srv_n_lock_max_wait_time / 1000;
+	export_vars.innodb_deadlock_checks = lock_deadlock_n_checks;
+	export_vars.innodb_deadlocks = lock_deadlock_n_found;
+	export_vars.innodb_deadlock_too_long = lock_deadlock_n_too_long;
+	export_vars.innodb_deadlock_check_time = lock_deadlock_check_time;
+	export_vars.innodb_deadlock_check_time_max
+		= lock_deadlock_check_max_time;
+	export_vars.innodb_lock_rec_hash_cells
+		= hash_get_n_cells(lock_sys->rec_hash);
+	lock_rec_hash_get_stats(&export_vars.innodb_lock_rec_hash_searches,
+				&export_vars.innodb_lock_rec_hash_steps,
+				&export_vars.innodb_lock_rec_hash_max_steps,
+				&export_vars.innodb_lock_rec_hash_nolock);
+	mem_block_cache_get_stats(&export_vars.innodb_mem_block_cache_hits,
+				  &export_vars.innodb_mem_block_cache_misses);
+	dict_get_cache_stats(&export_vars.innodb_dict_cache_tables,
+			     &export_vars.innodb_dict_cache_hits,
+			     &export_vars.innodb_dict_cache_misses,
+			     &export_vars.innodb_dict_cache_evictions);
+	export_vars.innodb_cursor_cache_hits = srv_n_cursor_cache_hits;
+	export_vars.innodb_cursor_cache_misses = srv_n_cursor_cache_misses;
+	export_vars.innodb_cursor_cache_evictions
+		= srv_n_cursor_cache_evictions;
+	export_vars.innodb_mutex_spin_waits = mutex_spin_wait_count;
+	export_vars.innodb_mutex_spin_rounds = mutex_spin_round_count;
+	export_vars.innodb_mutex_os_waits = mutex_os_wait_count;
+	export_vars.innodb_mutex_os_yields = mutex_os_yield_count;
+	export_vars.innodb_rw_s_spin_waits = rw_s_spin_wait_count;
+	export_vars.innodb_rw_s_spin_rounds = rw_s_spin_round_count;
+	export_vars.innodb_rw_s_os_waits = rw_s_os_wait_count;
+	export_vars.innodb_rw_s_os_yields = rw_s_os_yield_count;
+	export_vars.innodb_rw_x_spin_waits = rw_x_spin_wait_count;
+	export_vars.innodb_rw_x_spin_rounds = rw_x_spin_round_count;
+	export_vars.innodb_rw_x_os_waits = rw_x_os_wait_count;
+	export_vars.innodb_rw_x_os_yields = rw_x_os_yield_count;
 	export_vars.innodb_rows_read = srv_n_rows_read;
 	export_vars.innodb_rows_inserted = srv_n_rows_inserted;
 	export_vars.innodb_rows_updated = srv_n_rows_updated;
@@ -2302,6 +2375,13 @@ loop:
 
 		ddl_drop_tables_in_background();
 
+		if (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+			srv_main_thread_op_info = "evicting tables from"
+				" the dictionary cache";
+
+			dict_make_room_in_cache();
+		}
+
 		srv_main_thread_op_info = "";
 
 		if (srv_fast_shutdown != IB_SHUTDOWN_NORMAL
@@ -2501,6 +2581,13 @@ background_loop:
 		os_thread_sleep(100000);
 	}
 
+	if (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+		srv_main_thread_op_info = "evicting tables from"
+			" the dictionary cache";
+
+		dict_make_room_in_cache();
+	}
+
 	srv_main_thread_op_info = "purging";
 
 	/* Run a full purge */
@@ -1278,6 +1278,9 @@ innobase_start_or_create(void)
 
 	ib_logger(ib_stream,
 		  "InnoDB: " IB_ATOMICS_STARTUP_MSG
+#ifdef INNODB_SYNC_USE_FUTEX
+		  "\nInnoDB: Threads wait for mutexes and rw_locks on futexes"
+#endif /* INNODB_SYNC_USE_FUTEX */
 #ifdef HAVE_ZIP
 		  "\nInnoDB: Compressed tables use zlib " ZLIB_VERSION
 # ifdef UNIV_ZIP_DEBUG
@@ -1771,6 +1774,15 @@ innobase_start_or_create(void)
 		return(DB_ERROR);
 	}
 
+	/* Create the rollback segments that are missing, also in data
+	files created with fewer of them. This must come after the
+	doublewrite buffer, which needs the first free extents of the
+	system tablespace. */
+
+	if (srv_force_recovery < IB_RECOVERY_NO_TRX_UNDO) {
+		trx_sys_create_rsegs(srv_rollback_segments);
+	}
+
 	/* Create the master thread which does purge and other utility
 	operations */
 
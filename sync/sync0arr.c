@@ -154,6 +154,14 @@ sync_array_detect_deadlock(
 	ulint		depth);	/*!< in: recursion depth */
 #endif /* UNIV_SYNC_DEBUG */
 
+/******************************************************************//**
+Determines if we can wake up the thread waiting for a sempahore. */
+UNIV_STATIC
+ibool
+sync_arr_cell_can_wake_up(
+/*======================*/
+	sync_cell_t*	cell);	/*!< in: cell to search */
+
 /*****************************************************************//**
 Gets the nth cell in array.
 @return	cell */
@@ -285,6 +293,53 @@ sync_array_free(
 	ut_free(arr);
 }
 
+/******************************************************************//**
+Creates the shards of sync_wait_array. The cells for OS_THREAD_MAX_N
+threads are divided evenly between the shards. */
+UNIV_INTERN
+void
+sync_array_init(
+/*============*/
+	ulint	n_threads)	/*!< in: maximum number of threads that
+				can wait at the same time */
+{
+	ulint	n_cells;
+	ulint	i;
+
+	ut_a(sync_wait_array == NULL);
+
+	sync_wait_array_size = ut_min(SYNC_WAIT_ARRAY_SIZE, n_threads);
+
+	sync_wait_array = ut_malloc(
+		sync_wait_array_size * sizeof(*sync_wait_array));
+
+	n_cells = 1 + (n_threads - 1) / sync_wait_array_size;
+
+	for (i = 0; i < sync_wait_array_size; i++) {
+		sync_wait_array[i] = sync_array_create(n_cells,
+						       SYNC_ARRAY_OS_MUTEX);
+	}
+}
+
+/******************************************************************//**
+Frees the shards of sync_wait_array. */
+UNIV_INTERN
+void
+sync_array_close(void)
+/*==================*/
+{
+	ulint	i;
+
+	for (i = 0; i < sync_wait_array_size; i++) {
+		sync_array_free(sync_wait_array[i]);
+	}
+
+	ut_free(sync_wait_array);
+
+	sync_wait_array = NULL;
+	sync_wait_array_size = 0;
+}
+
 /********************************************************************//**
 Validates the integrity of the wait array. Checks
 that the number of reserved cells equals the count variable. */
@@ -312,6 +367,26 @@ sync_array_validate(
 	sync_array_exit(arr);
 }
 
+#ifdef INNODB_SYNC_USE_FUTEX
+/*******************************************************************//**
+Returns the futex that the thread owning the cell sleeps on. */
+UNIV_STATIC
+os_futex_t*
+sync_cell_get_futex(
+/*================*/
+	sync_cell_t*	cell) /*!< in: non-empty sync array cell */
+{
+	ulint type = cell->request_type;
+
+	if (type == SYNC_MUTEX) {
+		return(&((mutex_t *) cell->wait_object)->futex);
+	} else if (type == RW_LOCK_WAIT_EX) {
+		return(&((rw_lock_t *) cell->wait_object)->wait_ex_futex);
+	} else { /* RW_LOCK_SHARED and RW_LOCK_EX wait on the same futex */
+		return(&((rw_lock_t *) cell->wait_object)->futex);
+	}
+}
+#else /* INNODB_SYNC_USE_FUTEX */
 /*******************************************************************//**
 Returns the event that the thread owning the cell waits for. */
 UNIV_STATIC
@@ -330,12 +405,14 @@ sync_cell_get_event(
 		return(((rw_lock_t *) cell->wait_object)->event);
 	}
 }
+#endif /* INNODB_SYNC_USE_FUTEX */
 
 /******************************************************************//**
 Reserves a wait array cell for waiting for an object.
-The event of the cell is reset to nonsignalled state. */
+The event of the cell is reset to nonsignalled state.
+@return	TRUE if a cell was reserved, FALSE if the array is full */
 UNIV_INTERN
-void
+ibool
 sync_array_reserve_cell(
 /*====================*/
 	sync_array_t*	arr,	/*!< in: wait array */
@@ -346,7 +423,9 @@ sync_array_reserve_cell(
 	ulint*		index)	/*!< out: index of the reserved cell */
 {
 	sync_cell_t*	cell;
+#ifndef INNODB_SYNC_USE_FUTEX
 	os_event_t      event;
+#endif /* !INNODB_SYNC_USE_FUTEX */
 	ulint		i;
 
 	ut_a(object);
@@ -354,6 +433,12 @@ sync_array_reserve_cell(
 
 	sync_array_enter(arr);
 
+	if (arr->n_reserved == arr->n_cells) {
+		sync_array_exit(arr);
+
+		return(FALSE);
+	}
+
 	arr->res_count++;
 
 	/* Reserve a new cell. */
@@ -382,25 +467,137 @@ sync_array_reserve_cell(
 
 			sync_array_exit(arr);
 
+#ifndef INNODB_SYNC_USE_FUTEX
 			/* Make sure the event is reset and also store
 			the value of signal_count at which the event
 			was reset. */
                         event = sync_cell_get_event(cell);
 			cell->signal_count = os_event_reset(event);
+#endif /* !INNODB_SYNC_USE_FUTEX */
 
 			cell->reservation_time = time(NULL);
 
 			cell->thread = os_thread_get_curr_id();
 
-			return;
+			return(TRUE);
+		}
+	}
+
+	ut_error; /* n_reserved is wrong */
+
+	return(FALSE);
+}
+
+/******************************************************************//**
+Gets the number of the shard of sync_wait_array of the calling thread.
+@return	shard number */
+UNIV_STATIC
+ulint
+sync_array_get_shard_no(void)
+/*=========================*/
+{
+	ulint	id = os_thread_pf(os_thread_get_curr_id());
+
+	/* Thread ids are often addresses of page aligned thread control
+	blocks, so that the low bits of them are all equal. */
+
+	return(((id >> 4) ^ (id >> 12) ^ (id >> 20)) % sync_wait_array_size);
+}
+
+/******************************************************************//**
+Reserves a cell in the shard of sync_wait_array of the calling thread,
+or in the next shard that has a free cell if that one is full.
+@return	the shard where the cell was reserved */
+UNIV_INTERN
+sync_array_t*
+sync_array_get_and_reserve_cell(
+/*============================*/
+	void*		object, /*!< in: pointer to the object to wait for */
+	ulint		type,	/*!< in: lock request type */
+	const char*	file,	/*!< in: file where requested */
+	ulint		line,	/*!< in: line where requested */
+	ulint*		index)	/*!< out: index of the reserved cell */
+{
+	ulint		i;
+	ulint		shard_no;
+	sync_array_t*	arr;
+
+	shard_no = sync_array_get_shard_no();
+
+	/* The shards have room for OS_THREAD_MAX_N waiting threads in
+	total, so that one of them must have a free cell. */
+
+	for (i = 0; i < sync_wait_array_size; i++) {
+		arr = sync_wait_array[(shard_no + i) % sync_wait_array_size];
+
+		if (sync_array_reserve_cell(arr, object, type,
+					    file, line, index)) {
+
+			return(arr);
 		}
 	}
 
 	ut_error; /* No free cell found */
 
-	return;
+	return(NULL);
 }
 
+#ifdef INNODB_SYNC_USE_FUTEX
+/******************************************************************//**
+Sleeps on the futex of a mutex or an rw-lock until the futex is signalled.
+The wait array is not used unless the thread sleeps longer than
+SYNC_FUTEX_WAIT_USEC: then a cell is reserved, so that the wait is
+reported by sync_array_print_long_waits() and the monitor output. The
+thread also stops waiting if it finds the latch free when it wakes up
+on the timeout, in case the signal was missed (see mutex_exit()). */
+UNIV_INTERN
+void
+sync_array_wait_futex(
+/*==================*/
+	void*		object,	/*!< in: pointer to the object to wait for */
+	ulint		type,	/*!< in: lock request type */
+	const char*	file,	/*!< in: file where requested */
+	ulint		line,	/*!< in: line where requested */
+	os_futex_t*	futex,	/*!< in: futex of the object to sleep on */
+	ib_uint32_t	sig_count)/*!< in: value returned by os_futex_reset()
+				before the thread set the waiters flag */
+{
+	sync_cell_t	probe;
+	sync_cell_t*	cell;
+	sync_array_t*	arr = NULL;
+	ulint		index = ULINT_UNDEFINED;
+
+	ut_a(object);
+
+	probe.wait_object = object;
+	probe.request_type = type;
+
+	while (os_futex_wait_time(futex, sig_count, SYNC_FUTEX_WAIT_USEC)
+	       == OS_SYNC_TIME_EXCEEDED
+	       && !sync_arr_cell_can_wake_up(&probe)) {
+
+		if (index == ULINT_UNDEFINED) {
+			arr = sync_array_get_and_reserve_cell(
+				object, type, file, line, &index);
+
+			sync_array_enter(arr);
+
+			cell = sync_array_get_nth_cell(arr, index);
+
+			/* Count the time that we already slept. */
+			cell->reservation_time -= SYNC_FUTEX_WAIT_USEC
+				/ 1000000;
+			cell->waiting = TRUE;
+
+			sync_array_exit(arr);
+		}
+	}
+
+	if (index != ULINT_UNDEFINED) {
+		sync_array_free_cell(arr, index);
+	}
+}
+#else /* INNODB_SYNC_USE_FUTEX */
 /******************************************************************//**
 This function should be called when a thread starts to wait on
 a wait array cell. In the debug version this function checks
@@ -453,6 +650,7 @@ sync_array_wait_event(
 
 	sync_array_free_cell(arr, index);
 }
+#endif /* INNODB_SYNC_USE_FUTEX */
 
 /******************************************************************//**
 Reports info of a wait array cell. */
@@ -848,13 +1046,16 @@ sync_array_free_cell(
 }
 
 /**********************************************************************//**
-Increments the signalled count. */
+Increments the signalled count. The count is kept in the shard of
+sync_wait_array of the calling thread, so that threads releasing latches
+do not all update the same counter. */
 UNIV_INTERN
 void
-sync_array_object_signalled(
-/*========================*/
-	sync_array_t*	arr)	/*!< in: wait array */
+sync_array_object_signalled(void)
+/*=============================*/
 {
+	sync_array_t*	arr = sync_wait_array[sync_array_get_shard_no()];
+
 #ifdef HAVE_ATOMIC_BUILTINS
 	(void) os_atomic_increment_ulint(&arr->sg_count, 1);
 #else
@@ -867,23 +1068,20 @@ sync_array_object_signalled(
 }
 
 /**********************************************************************//**
-If the wakeup algorithm does not work perfectly at semaphore relases,
-this function will do the waking (see the comment in mutex_exit). This
-function should be called about every 1 second in the server.
-
-Note that there's a race condition between this thread and mutex_exit
-changing the lock_word and calling signal_object, so sometimes this finds
-threads to wake up even when nothing has gone wrong. */
-UNIV_INTERN
+Wakes up the threads waiting in a shard of sync_wait_array for semaphores
+that are free. See sync_arr_wake_threads_if_sema_free(). */
+UNIV_STATIC
 void
-sync_arr_wake_threads_if_sema_free(void)
-/*====================================*/
+sync_array_wake_threads_if_sema_free_low(
+/*=====================================*/
+	sync_array_t*	arr)	/*!< in: wait array */
 {
-	sync_array_t*	arr	= sync_primary_wait_array;
 	sync_cell_t*	cell;
 	ulint		count;
 	ulint		i;
+#ifndef INNODB_SYNC_USE_FUTEX
 	os_event_t      event;
+#endif /* !INNODB_SYNC_USE_FUTEX */
 
 	sync_array_enter(arr);
 
@@ -902,9 +1100,13 @@ sync_arr_wake_threads_if_sema_free(void)
 
 			if (sync_arr_cell_can_wake_up(cell)) {
 
+#ifdef INNODB_SYNC_USE_FUTEX
+			os_futex_set(sync_cell_get_futex(cell));
+#else /* INNODB_SYNC_USE_FUTEX */
 			event = sync_cell_get_event(cell);
 
 			os_event_set(event);
+#endif /* INNODB_SYNC_USE_FUTEX */
 		}
 
 	}
@@ -912,6 +1114,26 @@ sync_arr_wake_threads_if_sema_free(void)
 	sync_array_exit(arr);
 }
 
+/**********************************************************************//**
+If the wakeup algorithm does not work perfectly at semaphore relases,
+this function will do the waking (see the comment in mutex_exit). This
+function should be called about every 1 second in the server.
+
+Note that there's a race condition between this thread and mutex_exit
+changing the lock_word and calling signal_object, so sometimes this finds
+threads to wake up even when nothing has gone wrong. */
+UNIV_INTERN
+void
+sync_arr_wake_threads_if_sema_free(void)
+/*====================================*/
+{
+	ulint		i;
+
+	for (i = 0; i < sync_wait_array_size; i++) {
+		sync_array_wake_threads_if_sema_free_low(sync_wait_array[i]);
+	}
+}
+
 /**********************************************************************//**
 Prints warnings of long semaphore waits to ib_stream.
 @return	TRUE if fatal semaphore wait threshold was exceeded */
@@ -927,22 +1149,29 @@ sync_array_print_long_waits(void)
 	ulint		fatal_timeout = srv_fatal_semaphore_wait_threshold;
 	ibool		fatal = FALSE;
 
-	for (i = 0; i < sync_primary_wait_array->n_cells; i++) {
+	for (i = 0; i < sync_wait_array_size; i++) {
+		sync_array_t*	arr = sync_wait_array[i];
+		ulint		j;
 
-		cell = sync_array_get_nth_cell(sync_primary_wait_array, i);
+		for (j = 0; j < arr->n_cells; j++) {
 
-		if (cell->wait_object != NULL && cell->waiting
-		    && difftime(time(NULL), cell->reservation_time) > 240) {
-			ib_logger(ib_stream,
-				"InnoDB: Warning: a long semaphore wait:\n");
-			sync_array_cell_print(ib_stream, cell);
-			noticed = TRUE;
-		}
+			cell = sync_array_get_nth_cell(arr, j);
+
+			if (cell->wait_object != NULL && cell->waiting
+			    && difftime(time(NULL), cell->reservation_time)
+			    > 240) {
+				ib_logger(ib_stream,
+					"InnoDB: Warning: a long"
+					" semaphore wait:\n");
+				sync_array_cell_print(ib_stream, cell);
+				noticed = TRUE;
+			}
 
-		if (cell->wait_object != NULL && cell->waiting
-		    && difftime(time(NULL), cell->reservation_time)
-		    > fatal_timeout) {
-			fatal = TRUE;
+			if (cell->wait_object != NULL && cell->waiting
+			    && difftime(time(NULL), cell->reservation_time)
+			    > fatal_timeout) {
+				fatal = TRUE;
+			}
 		}
 	}
 
@@ -978,7 +1207,7 @@ sync_array_print_long_waits(void)
 }
 
 /**********************************************************************//**
-Prints info of the wait array. */
+Prints the reserved cells of a wait array. */
 UNIV_STATIC
 void
 sync_array_output_info(
@@ -991,9 +1220,6 @@ sync_array_output_info(
 	ulint		count;
 	ulint		i;
 
-	ib_logger(ib_stream,
-		"OS WAIT ARRAY INFO: reservation count %ld, signal count %ld\n",
-		(long) arr->res_count, (long) arr->sg_count);
 	i = 0;
 	count = 0;
 
@@ -1011,17 +1237,33 @@ sync_array_output_info(
 }
 
 /**********************************************************************//**
-Prints info of the wait array. */
+Prints info of all the shards of sync_wait_array. */
 UNIV_INTERN
 void
 sync_array_print_info(
 /*==================*/
-	ib_stream_t	ib_stream,	/*!< in: file where to print */
-	sync_array_t*	arr)		/*!< in: wait array */
+	ib_stream_t	ib_stream)	/*!< in: file where to print */
 {
-	sync_array_enter(arr);
+	ulint	res_count = 0;
+	ulint	sg_count = 0;
+	ulint	i;
 
-	sync_array_output_info(ib_stream, arr);
+	for (i = 0; i < sync_wait_array_size; i++) {
+		res_count += sync_wait_array[i]->res_count;
+		sg_count += sync_wait_array[i]->sg_count;
+	}
 
-	sync_array_exit(arr);
+	ib_logger(ib_stream,
+		"OS WAIT ARRAY INFO: reservation count %ld, signal count %ld\n",
+		(long) res_count, (long) sg_count);
+
+	for (i = 0; i < sync_wait_array_size; i++) {
+		sync_array_t*	arr = sync_wait_array[i];
+
+		sync_array_enter(arr);
+
+		sync_array_output_info(ib_stream, arr);
+
+		sync_array_exit(arr);
+	}
 }
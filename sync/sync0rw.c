@@ -145,6 +145,10 @@ UNIV_INTERN ib_int64_t	rw_s_spin_round_count	= 0;
 resulted during shared (read) locks */
 UNIV_INTERN ib_int64_t	rw_s_os_wait_count	= 0;
 
+/** number of os_thread_yield() calls in spin waits on rw-latches,
+resulted during shared (read) locks */
+UNIV_INTERN ib_int64_t	rw_s_os_yield_count	= 0;
+
 /** number of unlocks (that unlock shared locks),
 set only when UNIV_SYNC_PERF_STAT is defined */
 UNIV_INTERN ib_int64_t	rw_s_exit_count		= 0;
@@ -160,6 +164,10 @@ UNIV_INTERN ib_int64_t	rw_x_spin_round_count	= 0;
 resulted during exclusive (write) locks */
 UNIV_INTERN ib_int64_t	rw_x_os_wait_count	= 0;
 
+/** number of os_thread_yield() calls in spin waits on rw-latches,
+resulted during exclusive (write) locks */
+UNIV_INTERN ib_int64_t	rw_x_os_yield_count	= 0;
+
 /** number of unlocks (that unlock exclusive locks),
 set only when UNIV_SYNC_PERF_STAT is defined */
 UNIV_INTERN ib_int64_t	rw_x_exit_count		= 0;
@@ -225,10 +233,14 @@ rw_lock_var_init(void)
 /*==================*/
 {
 	rw_s_spin_wait_count	= 0;
+	rw_s_spin_round_count	= 0;
 	rw_s_os_wait_count	= 0;
+	rw_s_os_yield_count	= 0;
 	rw_s_exit_count		= 0;
 	rw_x_spin_wait_count	= 0;
+	rw_x_spin_round_count	= 0;
 	rw_x_os_wait_count	= 0;
+	rw_x_os_yield_count	= 0;
 	rw_x_exit_count		= 0;
 
 	memset(&rw_lock_list, 0x0, sizeof(rw_lock_list));
@@ -296,13 +308,19 @@ rw_lock_create_func(
 	lock->cfile_name = cfile_name;
 	lock->cline = (unsigned int) cline;
 
-	lock->count_os_wait = 0;
+	memset(&lock->stats, 0x0, sizeof(lock->stats));
+	lock->spin_rounds = SYNC_SPIN_ROUNDS << SYNC_SPIN_ROUNDS_SHIFT;
 	lock->last_s_file_name = "not yet reserved";
 	lock->last_x_file_name = "not yet reserved";
 	lock->last_s_line = 0;
 	lock->last_x_line = 0;
+#ifdef INNODB_SYNC_USE_FUTEX
+	lock->futex = 0;
+	lock->wait_ex_futex = 0;
+#else /* INNODB_SYNC_USE_FUTEX */
 	lock->event = os_event_create(NULL);
 	lock->wait_ex_event = os_event_create(NULL);
+#endif /* INNODB_SYNC_USE_FUTEX */
 
 	mutex_enter(&rw_lock_list_mutex);
 
@@ -311,6 +329,8 @@ rw_lock_create_func(
 		     == RW_LOCK_MAGIC_N);
 	}
 
+	lock->site = sync_site_get(cfile_name, cline, TRUE);
+
 	UT_LIST_ADD_FIRST(list, rw_lock_list, lock);
 
 	mutex_exit(&rw_lock_list_mutex);
@@ -336,9 +356,11 @@ rw_lock_free(
 #endif /* INNODB_RW_LOCKS_USE_ATOMICS */
 
 	mutex_enter(&rw_lock_list_mutex);
+#ifndef INNODB_SYNC_USE_FUTEX
 	os_event_free(lock->event);
 
 	os_event_free(lock->wait_ex_event);
+#endif /* !INNODB_SYNC_USE_FUTEX */
 
 	if (UT_LIST_GET_PREV(list, lock)) {
 		ut_a(UT_LIST_GET_PREV(list, lock)->magic_n == RW_LOCK_MAGIC_N);
@@ -349,6 +371,8 @@ rw_lock_free(
 
 	UT_LIST_REMOVE(list, rw_lock_list, lock);
 
+	sync_site_add_freed(lock->site, &lock->stats);
+
 	mutex_exit(&rw_lock_list_mutex);
 }
 
@@ -379,8 +403,9 @@ rw_lock_validate(
 /******************************************************************//**
 Lock an rw-lock in shared mode for the current thread. If the rw-lock is
 locked in exclusive mode, or there is an exclusive lock request waiting,
-the function spins a preset time (controlled by SYNC_SPIN_ROUNDS), waiting
-for the lock, before suspending the thread. */
+the function spins a time that is adapted to the lock (between
+SYNC_SPIN_ROUNDS_MIN and SYNC_SPIN_ROUNDS_MAX), waiting for the lock,
+before suspending the thread. */
 UNIV_INTERN
 void
 rw_lock_s_lock_spin(
@@ -391,16 +416,27 @@ rw_lock_s_lock_spin(
 	const char*	file_name, /*!< in: file name where lock requested */
 	ulint		line)	/*!< in: line where requested */
 {
+#ifdef INNODB_SYNC_USE_FUTEX
+	ib_uint32_t sig_count; /* signal count of the futex */
+#else /* INNODB_SYNC_USE_FUTEX */
 	ulint	 index;	/* index of the reserved wait cell */
+	sync_array_t* sync_arr; /* wait array shard of the cell */
+#endif /* INNODB_SYNC_USE_FUTEX */
 	ulint	 i = 0;	/* spin round count */
+	ulint	 n_spin;	/* number of rounds to spin */
+	ib_uint64_t wait_start = 0; /* when the thread first yielded
+				    or suspended itself, or 0 */
 
 	ut_ad(rw_lock_validate(lock));
 
 	rw_s_spin_wait_count++;	/*!< Count calls to this function */
+	lock->stats.n_spin_waits++;
+
+	n_spin = sync_spin_rounds_get(lock->spin_rounds);
 lock_loop:
 
 	/* Spin waiting for the writer field to become free */
-	while (i < SYNC_SPIN_ROUNDS && lock->lock_word <= 0) {
+	while (i < n_spin && lock->lock_word <= 0) {
 		if (srv_spin_wait_delay) {
 			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
 		}
@@ -408,7 +444,14 @@ lock_loop:
 		i++;
 	}
 
-	if (i == SYNC_SPIN_ROUNDS) {
+	if (i == n_spin) {
+		rw_s_os_yield_count++;
+		lock->stats.n_os_yields++;
+
+		if (wait_start == 0) {
+			wait_start = ut_time_us(NULL);
+		}
+
 		os_thread_yield();
 	}
 
@@ -424,28 +467,40 @@ lock_loop:
 	/* We try once again to obtain the lock */
 	if (TRUE == rw_lock_s_lock_low(lock, pass, file_name, line)) {
 		rw_s_spin_round_count += i;
+		lock->stats.n_spin_rounds += i;
 
-		return; /* Success */
+		sync_spin_rounds_update(&lock->spin_rounds, i, TRUE);
+
+		goto func_exit; /* Success */
 	} else {
 
-		if (i < SYNC_SPIN_ROUNDS) {
+		if (i < n_spin) {
 			goto lock_loop;
 		}
 
 		rw_s_spin_round_count += i;
+		lock->stats.n_spin_rounds += i;
 
-		sync_array_reserve_cell(sync_primary_wait_array,
+#ifdef INNODB_SYNC_USE_FUTEX
+		sig_count = os_futex_reset(&lock->futex);
+#else /* INNODB_SYNC_USE_FUTEX */
+		sync_arr = sync_array_get_and_reserve_cell(
 					lock, RW_LOCK_SHARED,
 					file_name, line,
 					&index);
+#endif /* INNODB_SYNC_USE_FUTEX */
 
 		/* Set waiters before checking lock_word to ensure wake-up
                 signal is sent. This may lead to some unnecessary signals. */
 		rw_lock_set_waiter_flag(lock);
 
 		if (TRUE == rw_lock_s_lock_low(lock, pass, file_name, line)) {
-			sync_array_free_cell(sync_primary_wait_array, index);
-			return; /* Success */
+#ifndef INNODB_SYNC_USE_FUTEX
+			sync_array_free_cell(sync_arr, index);
+#endif /* !INNODB_SYNC_USE_FUTEX */
+			sync_spin_rounds_update(&lock->spin_rounds,
+						n_spin, TRUE);
+			goto func_exit; /* Success */
 		}
 
 		if (srv_print_latch_waits) {
@@ -458,14 +513,32 @@ lock_loop:
 		}
 
 		/* these stats may not be accurate */
-		lock->count_os_wait++;
+		lock->stats.n_os_waits++;
 		rw_s_os_wait_count++;
 
-		sync_array_wait_event(sync_primary_wait_array, index);
+		sync_spin_rounds_update(&lock->spin_rounds, n_spin, FALSE);
+
+		if (wait_start == 0) {
+			wait_start = ut_time_us(NULL);
+		}
+
+#ifdef INNODB_SYNC_USE_FUTEX
+		sync_array_wait_futex(lock, RW_LOCK_SHARED,
+				      file_name, line,
+				      &lock->futex, sig_count);
+#else /* INNODB_SYNC_USE_FUTEX */
+		sync_array_wait_event(sync_arr, index);
+#endif /* INNODB_SYNC_USE_FUTEX */
 
 		i = 0;
+		n_spin = sync_spin_rounds_get(lock->spin_rounds);
 		goto lock_loop;
 	}
+
+func_exit:
+	if (wait_start != 0) {
+		lock->stats.wait_time += ut_time_us(NULL) - wait_start;
+	}
 }
 
 /******************************************************************//**
@@ -501,37 +574,59 @@ rw_lock_x_lock_wait(
 				be passed to another thread to unlock */
 #endif
 	const char*	file_name,/*!< in: file name where lock requested */
-	ulint		line)	/*!< in: line where requested */
+	ulint		line,	/*!< in: line where requested */
+	ib_uint64_t*	wait_start)/*!< in/out: when the thread first
+				yielded or suspended itself, or 0 */
 {
+#ifdef INNODB_SYNC_USE_FUTEX
+	ib_uint32_t sig_count;
+#else /* INNODB_SYNC_USE_FUTEX */
 	ulint index;
+	sync_array_t* sync_arr;
+#endif /* INNODB_SYNC_USE_FUTEX */
 	ulint i = 0;
+	ulint n_spin;
 
 	ut_ad(lock->lock_word <= 0);
 
+	n_spin = sync_spin_rounds_get(lock->spin_rounds);
+
 	while (lock->lock_word < 0) {
 		if (srv_spin_wait_delay) {
 			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
 		}
-		if(i < SYNC_SPIN_ROUNDS) {
+		if(i < n_spin) {
 			i++;
 			continue;
 		}
 
 		/* If there is still a reader, then go to sleep.*/
 		rw_x_spin_round_count += i;
+		lock->stats.n_spin_rounds += i;
 		i = 0;
-		sync_array_reserve_cell(sync_primary_wait_array,
+#ifdef INNODB_SYNC_USE_FUTEX
+		sig_count = os_futex_reset(&lock->wait_ex_futex);
+#else /* INNODB_SYNC_USE_FUTEX */
+		sync_arr = sync_array_get_and_reserve_cell(
 					lock,
 					RW_LOCK_WAIT_EX,
 					file_name, line,
 					&index);
+#endif /* INNODB_SYNC_USE_FUTEX */
 		/* Check lock_word to ensure wake-up isn't missed.*/
 		if(lock->lock_word < 0) {
 
 			/* these stats may not be accurate */
-			lock->count_os_wait++;
+			lock->stats.n_os_waits++;
 			rw_x_os_wait_count++;
 
+			sync_spin_rounds_update(&lock->spin_rounds,
+						n_spin, FALSE);
+
+			if (*wait_start == 0) {
+				*wait_start = ut_time_us(NULL);
+			}
+
                         /* Add debug info as it is needed to detect possible
                         deadlock. We must add info for WAIT_EX thread for
                         deadlock detection to work properly. */
@@ -540,20 +635,36 @@ rw_lock_x_lock_wait(
 					       file_name, line);
 #endif
 
-			sync_array_wait_event(sync_primary_wait_array,
-					      index);
+#ifdef INNODB_SYNC_USE_FUTEX
+			sync_array_wait_futex(lock, RW_LOCK_WAIT_EX,
+					      file_name, line,
+					      &lock->wait_ex_futex,
+					      sig_count);
+#else /* INNODB_SYNC_USE_FUTEX */
+			sync_array_wait_event(sync_arr, index);
+#endif /* INNODB_SYNC_USE_FUTEX */
 #ifdef UNIV_SYNC_DEBUG
 			rw_lock_remove_debug_info(lock, pass,
 					       RW_LOCK_WAIT_EX);
 #endif
                         /* It is possible to wake when lock_word < 0.
                         We must pass the while-loop check to proceed.*/
-		} else {
-			sync_array_free_cell(sync_primary_wait_array,
-					     index);
 		}
+#ifndef INNODB_SYNC_USE_FUTEX
+		else {
+			sync_array_free_cell(sync_arr, index);
+		}
+#endif /* !INNODB_SYNC_USE_FUTEX */
+
+		n_spin = sync_spin_rounds_get(lock->spin_rounds);
 	}
 	rw_x_spin_round_count += i;
+	lock->stats.n_spin_rounds += i;
+
+	if (i > 0) {
+		/* The readers left while we were spinning */
+		sync_spin_rounds_update(&lock->spin_rounds, i, TRUE);
+	}
 }
 
 /******************************************************************//**
@@ -567,7 +678,9 @@ rw_lock_x_lock_low(
 	ulint		pass,	/*!< in: pass value; != 0, if the lock will
 				be passed to another thread to unlock */
 	const char*	file_name,/*!< in: file name where lock requested */
-	ulint		line)	/*!< in: line where requested */
+	ulint		line,	/*!< in: line where requested */
+	ib_uint64_t*	wait_start)/*!< in/out: when the thread first
+				yielded or suspended itself, or 0 */
 {
 	os_thread_id_t	curr_thread	= os_thread_get_curr_id();
 
@@ -587,7 +700,7 @@ rw_lock_x_lock_low(
 #ifdef UNIV_SYNC_DEBUG
 				    pass,
 #endif
-                                    file_name, line);
+				    file_name, line, wait_start);
 
 	} else {
 		/* Decrement failed: relock or failed lock */
@@ -606,6 +719,7 @@ rw_lock_x_lock_low(
 #endif
 	lock->last_x_file_name = file_name;
 	lock->last_x_line = (unsigned int) line;
+	lock->stats.n_acquired++;
 
 	return(TRUE);
 }
@@ -614,8 +728,9 @@ rw_lock_x_lock_low(
 NOTE! Use the corresponding macro, not directly this function! Lock an
 rw-lock in exclusive mode for the current thread. If the rw-lock is locked
 in shared or exclusive mode, or there is an exclusive lock request waiting,
-the function spins a preset time (controlled by SYNC_SPIN_ROUNDS), waiting
-for the lock before suspending the thread. If the same thread has an x-lock
+the function spins a time that is adapted to the lock (between
+SYNC_SPIN_ROUNDS_MIN and SYNC_SPIN_ROUNDS_MAX), waiting for the lock
+before suspending the thread. If the same thread has an x-lock
 on the rw-lock, locking succeed, with the following exception: if pass != 0,
 only a single x-lock may be taken on the lock. NOTE: If the same thread has
 an s-lock, locking does not succeed! */
@@ -629,9 +744,17 @@ rw_lock_x_lock_func(
 	const char*	file_name,/*!< in: file name where lock requested */
 	ulint		line)	/*!< in: line where requested */
 {
+#ifdef INNODB_SYNC_USE_FUTEX
+	ib_uint32_t sig_count; /*!< signal count of the futex */
+#else /* INNODB_SYNC_USE_FUTEX */
 	ulint	index;	/*!< index of the reserved wait cell */
+	sync_array_t*	sync_arr;/*!< wait array shard of the cell */
+#endif /* INNODB_SYNC_USE_FUTEX */
 	ulint	i;	/*!< spin round count */
+	ulint	n_spin = 0;/*!< number of rounds to spin */
 	ibool   spinning = FALSE;
+	ib_uint64_t wait_start = 0;/*!< when the thread first yielded or
+				suspended itself, or 0 */
 
 	ut_ad(rw_lock_validate(lock));
 
@@ -639,20 +762,27 @@ rw_lock_x_lock_func(
 
 lock_loop:
 
-	if (rw_lock_x_lock_low(lock, pass, file_name, line)) {
+	if (rw_lock_x_lock_low(lock, pass, file_name, line, &wait_start)) {
 		rw_x_spin_round_count += i;
+		lock->stats.n_spin_rounds += i;
+
+		if (spinning) {
+			sync_spin_rounds_update(&lock->spin_rounds, i, TRUE);
+		}
 
-		return;	/* Locking succeeded */
+		goto func_exit;	/* Locking succeeded */
 
 	} else {
 
                 if (!spinning) {
                         spinning = TRUE;
                         rw_x_spin_wait_count++;
+			lock->stats.n_spin_waits++;
+			n_spin = sync_spin_rounds_get(lock->spin_rounds);
 		}
 
 		/* Spin waiting for the lock_word to become free */
-		while (i < SYNC_SPIN_ROUNDS
+		while (i < n_spin
 		       && lock->lock_word <= 0) {
 			if (srv_spin_wait_delay) {
 				ut_delay(ut_rnd_interval(0,
@@ -661,7 +791,14 @@ lock_loop:
 
 			i++;
 		}
-		if (i == SYNC_SPIN_ROUNDS) {
+		if (i == n_spin) {
+			rw_x_os_yield_count++;
+			lock->stats.n_os_yields++;
+
+			if (wait_start == 0) {
+				wait_start = ut_time_us(NULL);
+			}
+
 			os_thread_yield();
 		} else {
 			goto lock_loop;
@@ -669,6 +806,7 @@ lock_loop:
 	}
 
 	rw_x_spin_round_count += i;
+	lock->stats.n_spin_rounds += i;
 
 	if (srv_print_latch_waits) {
 		ib_logger(ib_stream,
@@ -678,19 +816,26 @@ lock_loop:
 			lock->cfile_name, (ulong) lock->cline, (ulong) i);
 	}
 
-	sync_array_reserve_cell(sync_primary_wait_array,
+#ifdef INNODB_SYNC_USE_FUTEX
+	sig_count = os_futex_reset(&lock->futex);
+#else /* INNODB_SYNC_USE_FUTEX */
+	sync_arr = sync_array_get_and_reserve_cell(
 				lock,
 				RW_LOCK_EX,
 				file_name, line,
 				&index);
+#endif /* INNODB_SYNC_USE_FUTEX */
 
 	/* Waiters must be set before checking lock_word, to ensure signal
 	is sent. This could lead to a few unnecessary wake-up signals. */
 	rw_lock_set_waiter_flag(lock);
 
-	if (rw_lock_x_lock_low(lock, pass, file_name, line)) {
-		sync_array_free_cell(sync_primary_wait_array, index);
-		return; /* Locking succeeded */
+	if (rw_lock_x_lock_low(lock, pass, file_name, line, &wait_start)) {
+#ifndef INNODB_SYNC_USE_FUTEX
+		sync_array_free_cell(sync_arr, index);
+#endif /* !INNODB_SYNC_USE_FUTEX */
+		sync_spin_rounds_update(&lock->spin_rounds, n_spin, TRUE);
+		goto func_exit; /* Locking succeeded */
 	}
 
 	if (srv_print_latch_waits) {
@@ -702,13 +847,32 @@ lock_loop:
 	}
 
 	/* these stats may not be accurate */
-	lock->count_os_wait++;
+	lock->stats.n_os_waits++;
 	rw_x_os_wait_count++;
 
-	sync_array_wait_event(sync_primary_wait_array, index);
+	sync_spin_rounds_update(&lock->spin_rounds, n_spin, FALSE);
+
+	if (wait_start == 0) {
+		wait_start = ut_time_us(NULL);
+	}
+
+#ifdef INNODB_SYNC_USE_FUTEX
+	sync_array_wait_futex(lock, RW_LOCK_EX,
+			      file_name, line,
+			      &lock->futex, sig_count);
+#else /* INNODB_SYNC_USE_FUTEX */
+	sync_array_wait_event(sync_arr, index);
+#endif /* INNODB_SYNC_USE_FUTEX */
 
 	i = 0;
+	n_spin = sync_spin_rounds_get(lock->spin_rounds);
 	goto lock_loop;
+
+func_exit:
+	/* We own the x-lock: the counter can be updated safely. */
+	if (wait_start != 0) {
+		lock->stats.wait_time += ut_time_us(NULL) - wait_start;
+	}
 }
 
 #ifdef UNIV_SYNC_DEBUG
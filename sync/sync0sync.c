@@ -167,20 +167,27 @@ Q.E.D. */
 
 /** The number of iterations in the mutex_spin_wait() spin loop.
 Intended for performance monitoring. */
-UNIV_STATIC ib_int64_t	mutex_spin_round_count		= 0;
+UNIV_INTERN ib_int64_t	mutex_spin_round_count		= 0;
 /** The number of mutex_spin_wait() calls.  Intended for
 performance monitoring. */
-UNIV_STATIC ib_int64_t	mutex_spin_wait_count		= 0;
+UNIV_INTERN ib_int64_t	mutex_spin_wait_count		= 0;
 /** The number of OS waits in mutex_spin_wait().  Intended for
 performance monitoring. */
-UNIV_STATIC ib_int64_t	mutex_os_wait_count		= 0;
+UNIV_INTERN ib_int64_t	mutex_os_wait_count		= 0;
+/** The number of os_thread_yield() calls in mutex_spin_wait().
+Intended for performance monitoring. */
+UNIV_INTERN ib_int64_t	mutex_os_yield_count		= 0;
 /** The number of mutex_exit() calls. Intended for performance
 monitoring. */
 UNIV_INTERN ib_int64_t	mutex_exit_count		= 0;
 
-/** The global array of wait cells for implementation of the database's own
-mutexes and read-write locks */
-UNIV_INTERN sync_array_t*	sync_primary_wait_array;
+/** The global arrays of wait cells for implementation of the database's own
+mutexes and read-write locks; each thread waits in its own shard, see
+sync_array_get_and_reserve_cell() */
+UNIV_INTERN sync_array_t**	sync_wait_array;
+
+/** Number of shards in sync_wait_array */
+UNIV_INTERN ulint		sync_wait_array_size;
 
 /** This variable is set to TRUE when sync_init is called */
 UNIV_INTERN ibool	sync_initialized	= FALSE;
@@ -211,10 +218,22 @@ UNIV_INTERN mutex_t mutex_list_mutex;
 UNIV_INTERN ibool	sync_order_checks_on	= FALSE;
 #endif /* UNIV_SYNC_DEBUG */
 
-#ifdef UNIV_DEBUG
-/* FIXME: How is this used in MySQL code ? */
-UNIV_STATIC ibool	timed_mutexes;
-#endif /* UNIV_DEBUG */
+/** Size of sync_site_hash */
+#define SYNC_SITE_HASH_SIZE	256
+
+/** The creation sites of the latches, see sync_site_get() */
+UNIV_STATIC sync_site_t*	sync_sites[SYNC_SITE_MAX];
+
+/** Number of elements in sync_sites */
+UNIV_STATIC ulint		sync_n_sites;
+
+/** Hash table of sync_sites by creation line */
+UNIV_STATIC sync_site_t*	sync_site_hash[SYNC_SITE_HASH_SIZE];
+
+/** Mutex protecting sync_sites, sync_n_sites and sync_site_hash. This
+is an OS mutex, as it is acquired while holding mutex_list_mutex or
+rw_lock_list_mutex. */
+UNIV_STATIC os_fast_mutex_t	sync_site_mutex;
 
 struct sync_thread_struct{
 	os_thread_id_t	id;	/*!< OS thread id */
@@ -242,9 +261,14 @@ sync_var_init(void)
 	mutex_spin_round_count  = 0;
 	mutex_spin_wait_count = 0;
 	mutex_os_wait_count = 0;
+	mutex_os_yield_count = 0;
 	mutex_exit_count = 0;
-	sync_primary_wait_array = NULL;
+	sync_wait_array = NULL;
+	sync_wait_array_size = 0;
 	sync_initialized = FALSE;
+	memset(sync_sites, 0x0, sizeof(sync_sites));
+	sync_n_sites = 0;
+	memset(sync_site_hash, 0x0, sizeof(sync_site_hash));
 #ifdef UNIV_SYNC_DEBUG
 	sync_thread_level_arrays = NULL;
 	memset(&sync_thread_mutex, 0x0, sizeof(sync_thread_mutex));
@@ -282,7 +306,11 @@ mutex_create_func(
 	os_fast_mutex_init(&(mutex->os_fast_mutex));
 	mutex->lock_word = 0;
 #endif
+#ifdef INNODB_SYNC_USE_FUTEX
+	mutex->futex = 0;
+#else /* INNODB_SYNC_USE_FUTEX */
 	mutex->event = os_event_create(NULL);
+#endif /* INNODB_SYNC_USE_FUTEX */
 	mutex_set_waiters(mutex, 0);
 #ifdef UNIV_DEBUG
 	mutex->magic_n = MUTEX_MAGIC_N;
@@ -294,16 +322,12 @@ mutex_create_func(
 #endif /* UNIV_SYNC_DEBUG */
 	mutex->cfile_name = cfile_name;
 	mutex->cline = cline;
-	mutex->count_os_wait = 0;
+	mutex->spin_rounds = SYNC_SPIN_ROUNDS << SYNC_SPIN_ROUNDS_SHIFT;
+	memset(&mutex->stats, 0x0, sizeof(mutex->stats));
+	mutex->site = NULL;
 #ifdef UNIV_DEBUG
 	mutex->cmutex_name=	  cmutex_name;
-	mutex->count_using=	  0;
 	mutex->mutex_type=	  0;
-	mutex->lspent_time=	  0;
-	mutex->lmax_spent_time=     0;
-	mutex->count_spin_loop= 0;
-	mutex->count_spin_rounds=   0;
-	mutex->count_os_yield=  0;
 #endif /* UNIV_DEBUG */
 
 	/* Check that lock_word is aligned; this is important on Intel */
@@ -325,6 +349,8 @@ mutex_create_func(
 	ut_ad(UT_LIST_GET_LEN(mutex_list) == 0
 	      || UT_LIST_GET_FIRST(mutex_list)->magic_n == MUTEX_MAGIC_N);
 
+	mutex->site = sync_site_get(cfile_name, cline, FALSE);
+
 	UT_LIST_ADD_FIRST(list, mutex_list, mutex);
 
 	mutex_exit(&mutex_list_mutex);
@@ -370,10 +396,14 @@ mutex_free(
 
 		UT_LIST_REMOVE(list, mutex_list, mutex);
 
+		sync_site_add_freed(mutex->site, &mutex->stats);
+
 		mutex_exit(&mutex_list_mutex);
 	}
 
+#ifndef INNODB_SYNC_USE_FUTEX
 	os_event_free(mutex->event);
+#endif /* !INNODB_SYNC_USE_FUTEX */
 #ifdef UNIV_MEM_DEBUG
 func_exit:
 #endif /* UNIV_MEM_DEBUG */
@@ -408,6 +438,8 @@ mutex_enter_nowait_func(
 
 	if (!mutex_test_and_set(mutex)) {
 
+		mutex->stats.n_acquired++;
+
 		ut_d(mutex->thread_id = os_thread_get_curr_id());
 #ifdef UNIV_SYNC_DEBUG
 		mutex_set_debug_info(mutex, file_name, line);
@@ -471,10 +503,65 @@ mutex_set_waiters(
 				word in memory is atomic */
 }
 
+/******************************************************************//**
+Gets the number of rounds that a thread spins waiting for a latch before
+it suspends itself, from the adaptive spin count of the latch.
+@return	number of spin rounds, between SYNC_SPIN_ROUNDS_MIN and
+SYNC_SPIN_ROUNDS_MAX */
+UNIV_INTERN
+ulint
+sync_spin_rounds_get(
+/*=================*/
+	ulint	spin_rounds)	/*!< in: adaptive spin count of the latch */
+{
+	ulint	rounds = spin_rounds >> SYNC_SPIN_ROUNDS_SHIFT;
+
+	if (rounds < SYNC_SPIN_ROUNDS_MIN) {
+
+		return(SYNC_SPIN_ROUNDS_MIN);
+	} else if (rounds > SYNC_SPIN_ROUNDS_MAX) {
+
+		return(SYNC_SPIN_ROUNDS_MAX);
+	}
+
+	return(rounds);
+}
+
+/******************************************************************//**
+Updates the adaptive spin count of a latch with the outcome of a spin
+wait. A latch that is usually acquired by spinning is given about twice
+the rounds it took, while a latch whose waiters have to suspend
+themselves anyway is given fewer rounds each time. */
+UNIV_INTERN
+void
+sync_spin_rounds_update(
+/*====================*/
+	ulint*	spin_rounds,	/*!< in/out: adaptive spin count of
+				the latch */
+	ulint	rounds,		/*!< in: rounds that the thread spun */
+	ibool	acquired)	/*!< in: TRUE if the latch was acquired
+				by spinning, FALSE if the thread had to
+				suspend itself */
+{
+	volatile ulint*	ptr = spin_rounds;
+	ulint		old = *ptr;
+
+	/* Move the count by 1/8 of the way towards the target. As the
+	count is scaled up by 1 << SYNC_SPIN_ROUNDS_SHIFT == 8, 1/8 of the
+	scaled target is the target itself. Concurrent updates may be
+	lost, which does not matter for an estimate. */
+#if SYNC_SPIN_ROUNDS_SHIFT != 3
+# error "SYNC_SPIN_ROUNDS_SHIFT != 3"
+#endif
+
+	*ptr = old - (old >> 3) + (acquired ? 2 * (rounds + 1) : 0);
+}
+
 /******************************************************************//**
 Reserves a mutex for the current thread. If the mutex is reserved, the
-function spins a preset time (controlled by SYNC_SPIN_ROUNDS), waiting
-for the mutex before suspending the thread. */
+function spins a time that is adapted to the mutex (between
+SYNC_SPIN_ROUNDS_MIN and SYNC_SPIN_ROUNDS_MAX), waiting for the mutex
+before suspending the thread. */
 UNIV_INTERN
 void
 mutex_spin_wait(
@@ -484,15 +571,16 @@ mutex_spin_wait(
 					requested */
 	ulint		line)		/*!< in: line where requested */
 {
+#ifdef INNODB_SYNC_USE_FUTEX
+	ib_uint32_t sig_count; /* signal count of the futex */
+#else /* INNODB_SYNC_USE_FUTEX */
 	ulint	   index; /* index of the reserved wait cell */
+	sync_array_t* sync_arr; /* wait array shard of the cell */
+#endif /* INNODB_SYNC_USE_FUTEX */
 	ulint	   i;	  /* spin round count */
-#ifdef UNIV_DEBUG
-	ib_int64_t lstart_time = 0, lfinish_time; /* for timing os_wait */
-	ulint ltime_diff;
-	ulint sec;
-	ulint ms;
-	ulint timer_started = 0;
-#endif /* UNIV_DEBUG */
+	ulint	   n_spin; /* number of rounds to spin */
+	ib_uint64_t wait_start = 0; /* when the thread first yielded
+				    or suspended itself, or 0 */
 	ut_ad(mutex);
 
 	/* This update is not thread safe, but we don't mind if the count
@@ -500,10 +588,12 @@ mutex_spin_wait(
 	to sacrifice the cost of counting this as the data is valuable.
 	Count the number of calls to mutex_spin_wait. */
 	mutex_spin_wait_count++;
+	mutex->stats.n_spin_waits++;
 
 mutex_loop:
 
 	i = 0;
+	n_spin = sync_spin_rounds_get(mutex->spin_rounds);
 
 	/* Spin waiting for the lock word to become zero. Note that we do
 	not have to assume that the read access to the lock word is atomic,
@@ -512,9 +602,7 @@ mutex_loop:
 	a memory word. */
 
 spin_loop:
-	ut_d(mutex->count_spin_loop++);
-
-	while (mutex_get_lock_word(mutex) != 0 && i < SYNC_SPIN_ROUNDS) {
+	while (mutex_get_lock_word(mutex) != 0 && i < n_spin) {
 		if (srv_spin_wait_delay) {
 			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
 		}
@@ -522,17 +610,14 @@ spin_loop:
 		i++;
 	}
 
-	if (i == SYNC_SPIN_ROUNDS) {
-#ifdef UNIV_DEBUG
-		mutex->count_os_yield++;
-#ifndef UNIV_HOTBACKUP
-		if (timed_mutexes && timer_started == 0) {
-			ut_usectime(&sec, &ms);
-			lstart_time= (ib_int64_t)sec * 1000000 + ms;
-			timer_started = 1;
+	if (i == n_spin) {
+		mutex_os_yield_count++;
+		mutex->stats.n_os_yields++;
+
+		if (wait_start == 0) {
+			wait_start = ut_time_us(NULL);
 		}
-#endif /* UNIV_HOTBACKUP */
-#endif /* UNIV_DEBUG */
+
 		os_thread_yield();
 	}
 
@@ -545,12 +630,13 @@ spin_loop:
 #endif
 
 	mutex_spin_round_count += i;
-
-	ut_d(mutex->count_spin_rounds += i);
+	mutex->stats.n_spin_rounds += i;
 
 	if (mutex_test_and_set(mutex) == 0) {
 		/* Succeeded! */
 
+		sync_spin_rounds_update(&mutex->spin_rounds, i, TRUE);
+
 		ut_d(mutex->thread_id = os_thread_get_curr_id());
 #ifdef UNIV_SYNC_DEBUG
 		mutex_set_debug_info(mutex, file_name, line);
@@ -568,18 +654,23 @@ spin_loop:
 
 	i++;
 
-	if (i < SYNC_SPIN_ROUNDS) {
+	if (i < n_spin) {
 		goto spin_loop;
 	}
 
-	sync_array_reserve_cell(sync_primary_wait_array, mutex,
-				SYNC_MUTEX, file_name, line, &index);
+#ifdef INNODB_SYNC_USE_FUTEX
+	sig_count = os_futex_reset(&mutex->futex);
+#else /* INNODB_SYNC_USE_FUTEX */
+	sync_arr = sync_array_get_and_reserve_cell(mutex, SYNC_MUTEX,
+						   file_name, line, &index);
+#endif /* INNODB_SYNC_USE_FUTEX */
 
 	/* The memory order of the array reservation and the change in the
 	waiters field is important: when we suspend a thread, we first
 	reserve the cell and then set waiters field to 1. When threads are
 	released in mutex_exit, the waiters field is first set to zero and
-	then the event is set to the signaled state. */
+	then the event is set to the signaled state. With futexes, reading
+	the signal count of the futex takes the place of the reservation. */
 
 	mutex_set_waiters(mutex, 1);
 
@@ -587,8 +678,12 @@ spin_loop:
 	for (i = 0; i < 4; i++) {
 		if (mutex_test_and_set(mutex) == 0) {
 			/* Succeeded! Free the reserved wait cell */
+#ifndef INNODB_SYNC_USE_FUTEX
+			sync_array_free_cell(sync_arr, index);
+#endif /* !INNODB_SYNC_USE_FUTEX */
 
-			sync_array_free_cell(sync_primary_wait_array, index);
+			sync_spin_rounds_update(&mutex->spin_rounds,
+						n_spin, TRUE);
 
 			ut_d(mutex->thread_id = os_thread_get_curr_id());
 #ifdef UNIV_SYNC_DEBUG
@@ -623,37 +718,30 @@ spin_loop:
 #endif
 
 	mutex_os_wait_count++;
+	mutex->stats.n_os_waits++;
 
-	mutex->count_os_wait++;
-#ifdef UNIV_DEBUG
-	/* !!!!! Sometimes os_wait can be called without os_thread_yield */
-#ifndef UNIV_HOTBACKUP
-	if (timed_mutexes == 1 && timer_started == 0) {
-		ut_usectime(&sec, &ms);
-		lstart_time= (ib_int64_t)sec * 1000000 + ms;
-		timer_started = 1;
+	sync_spin_rounds_update(&mutex->spin_rounds, n_spin, FALSE);
+
+	/* Sometimes the thread suspends itself without having yielded */
+	if (wait_start == 0) {
+		wait_start = ut_time_us(NULL);
 	}
-#endif /* UNIV_HOTBACKUP */
-#endif /* UNIV_DEBUG */
 
-	sync_array_wait_event(sync_primary_wait_array, index);
+#ifdef INNODB_SYNC_USE_FUTEX
+	sync_array_wait_futex(mutex, SYNC_MUTEX, file_name, line,
+			      &mutex->futex, sig_count);
+#else /* INNODB_SYNC_USE_FUTEX */
+	sync_array_wait_event(sync_arr, index);
+#endif /* INNODB_SYNC_USE_FUTEX */
 	goto mutex_loop;
 
 finish_timing:
-#ifdef UNIV_DEBUG
-	if (timed_mutexes == 1 && timer_started==1) {
-		ut_usectime(&sec, &ms);
-		lfinish_time= (ib_int64_t)sec * 1000000 + ms;
-
-		ltime_diff= (ulint) (lfinish_time - lstart_time);
-		mutex->lspent_time += ltime_diff;
+	/* We own the mutex: the counters can be updated safely. */
+	mutex->stats.n_acquired++;
 
-		if (mutex->lmax_spent_time < ltime_diff) {
-			mutex->lmax_spent_time= ltime_diff;
-		}
+	if (wait_start != 0) {
+		mutex->stats.wait_time += ut_time_us(NULL) - wait_start;
 	}
-#endif /* UNIV_DEBUG */
-	return;
 }
 
 /******************************************************************//**
@@ -668,8 +756,12 @@ mutex_signal_object(
 
 	/* The memory order of resetting the waiters field and
 	signaling the object is important. See LEMMA 1 above. */
+#ifdef INNODB_SYNC_USE_FUTEX
+	os_futex_set(&mutex->futex);
+#else /* INNODB_SYNC_USE_FUTEX */
 	os_event_set(mutex->event);
-	sync_array_object_signalled(sync_primary_wait_array);
+#endif /* INNODB_SYNC_USE_FUTEX */
+	sync_array_object_signalled();
 }
 
 #ifdef UNIV_SYNC_DEBUG
@@ -1182,9 +1274,12 @@ sync_thread_add_level(
 	case SYNC_LOG:
 	case SYNC_THR_LOCAL:
 	case SYNC_ANY_LATCH:
+	case SYNC_FIL_SPACE_HASH:
 	case SYNC_TRX_SYS_HEADER:
 	case SYNC_FILE_FORMAT_TAG:
 	case SYNC_DOUBLEWRITE:
+	case SYNC_DICT_NAME_HASH:
+	case SYNC_DICT_ID_HASH:
 	case SYNC_BUF_POOL:
 	case SYNC_SEARCH_SYS:
 	case SYNC_SEARCH_SYS_CONF:
@@ -1410,11 +1505,12 @@ sync_init(void)
 
 	sync_initialized = TRUE;
 
-	/* Create the primary system wait array which is protected by an OS
-	mutex */
+	/* Create the shards of the system wait array, each protected by
+	an OS mutex */
+
+	sync_array_init(OS_THREAD_MAX_N);
 
-	sync_primary_wait_array = sync_array_create(OS_THREAD_MAX_N,
-						    SYNC_ARRAY_OS_MUTEX);
+	os_fast_mutex_init(&sync_site_mutex);
 #ifdef UNIV_SYNC_DEBUG
 	/* Create the thread latch level array where the latch levels
 	are stored for each OS thread */
@@ -1458,7 +1554,7 @@ sync_close(void)
 {
 	mutex_t*	mutex;
 
-	sync_array_free(sync_primary_wait_array);
+	sync_array_close();
 
 	mutex = UT_LIST_GET_FIRST(mutex_list);
 
@@ -1474,6 +1570,14 @@ sync_close(void)
 	}
 
 	mutex_free(&mutex_list_mutex);
+
+	while (sync_n_sites > 0) {
+		ut_free(sync_sites[--sync_n_sites]);
+		sync_sites[sync_n_sites] = NULL;
+	}
+
+	memset(sync_site_hash, 0x0, sizeof(sync_site_hash));
+	os_fast_mutex_free(&sync_site_mutex);
 #ifdef UNIV_SYNC_DEBUG
 	mutex_free(&sync_thread_mutex);
 	sync_order_checks_on = FALSE;
@@ -1484,6 +1588,280 @@ sync_close(void)
 	sync_initialized = FALSE;
 }
 
+/******************************************************************//**
+Looks up the creation site of a latch, registering it if this is the
+first latch created there. The caller must hold mutex_list_mutex or
+rw_lock_list_mutex, depending on the type of the latch.
+@return	creation site, or NULL if SYNC_SITE_MAX sites exist */
+UNIV_INTERN
+sync_site_t*
+sync_site_get(
+/*==========*/
+	const char*	cfile_name,	/*!< in: file name where created */
+	ulint		cline,		/*!< in: line where created */
+	ibool		rw_lock)	/*!< in: TRUE for an rw-lock,
+					FALSE for a mutex */
+{
+	sync_site_t*	site;
+	sync_site_t**	bucket;
+
+	bucket = &sync_site_hash[cline % SYNC_SITE_HASH_SIZE];
+
+	os_fast_mutex_lock(&sync_site_mutex);
+
+	/* The file name is compared by value, because a file name
+	literal in a header can have a different address in each
+	compilation unit. */
+
+	for (site = *bucket; site != NULL; site = site->hash) {
+		if (site->cline == cline
+		    && site->rw_lock == rw_lock
+		    && (site->cfile_name == cfile_name
+			|| !strcmp(site->cfile_name, cfile_name))) {
+
+			break;
+		}
+	}
+
+	if (site == NULL && sync_n_sites < SYNC_SITE_MAX) {
+		site = ut_malloc(sizeof(*site));
+
+		memset(site, 0x0, sizeof(*site));
+
+		site->cfile_name = cfile_name;
+		site->cline = cline;
+		site->rw_lock = rw_lock;
+		site->no = sync_n_sites;
+		site->hash = *bucket;
+
+		*bucket = site;
+		sync_sites[sync_n_sites++] = site;
+	}
+
+	os_fast_mutex_unlock(&sync_site_mutex);
+
+	return(site);
+}
+
+/******************************************************************//**
+Adds the counters of a latch that is being freed to its creation site.
+The caller must hold mutex_list_mutex or rw_lock_list_mutex, depending
+on the type of the latch. */
+UNIV_INTERN
+void
+sync_site_add_freed(
+/*================*/
+	sync_site_t*			site,	/*!< in/out: creation site,
+						or NULL */
+	const sync_latch_stats_t*	stats)	/*!< in: counters of the
+						latch */
+{
+	if (site != NULL) {
+		site->stats.n_acquired += stats->n_acquired;
+		site->stats.n_spin_waits += stats->n_spin_waits;
+		site->stats.n_spin_rounds += stats->n_spin_rounds;
+		site->stats.n_os_yields += stats->n_os_yields;
+		site->stats.n_os_waits += stats->n_os_waits;
+		site->stats.wait_time += stats->wait_time;
+	}
+}
+
+/******************************************************************//**
+Copies the counters of the freed latches of the creation sites of one
+type of latch to a profile. The caller must hold mutex_list_mutex or
+rw_lock_list_mutex, depending on rw_lock. */
+UNIV_STATIC
+void
+sync_site_stats_init(
+/*=================*/
+	sync_site_stats_t*	site_stats,	/*!< out: profile of
+						n_sites sites */
+	ulint			n_sites,	/*!< in: number of sites */
+	ibool			rw_lock)	/*!< in: TRUE for rw-locks,
+						FALSE for mutexes */
+{
+	ulint	i;
+
+	os_fast_mutex_lock(&sync_site_mutex);
+
+	for (i = 0; i < n_sites; i++) {
+		const sync_site_t*	site = sync_sites[i];
+
+		if (site->rw_lock == rw_lock) {
+			site_stats[i].cfile_name = site->cfile_name;
+			site_stats[i].cline = site->cline;
+			site_stats[i].rw_lock = rw_lock;
+			site_stats[i].n_latches = 0;
+			site_stats[i].stats = site->stats;
+		}
+	}
+
+	os_fast_mutex_unlock(&sync_site_mutex);
+}
+
+/******************************************************************//**
+Adds the counters of an existing latch to the profile of its creation
+site. */
+UNIV_STATIC
+void
+sync_site_stats_add(
+/*================*/
+	sync_site_stats_t*		site_stats,	/*!< in/out: profile of
+							n_sites sites */
+	ulint				n_sites,	/*!< in: number of
+							sites */
+	const sync_site_t*		site,		/*!< in: creation site
+							of the latch, or NULL */
+	const sync_latch_stats_t*	stats)		/*!< in: counters of
+							the latch */
+{
+	sync_site_stats_t*	ss;
+
+	/* Skip the latches that were created after the profile was
+	allocated, or at too many sites to be profiled. */
+
+	if (site == NULL || site->no >= n_sites) {
+
+		return;
+	}
+
+	ss = &site_stats[site->no];
+
+	ss->n_latches++;
+	ss->stats.n_acquired += stats->n_acquired;
+	ss->stats.n_spin_waits += stats->n_spin_waits;
+	ss->stats.n_spin_rounds += stats->n_spin_rounds;
+	ss->stats.n_os_yields += stats->n_os_yields;
+	ss->stats.n_os_waits += stats->n_os_waits;
+	ss->stats.wait_time += stats->wait_time;
+}
+
+/******************************************************************//**
+Collects the contention counters of the existing and freed latches
+by their creation site.
+@return	array of *n_sites elements, to be freed with ut_free(),
+or NULL if no latch has been created */
+UNIV_INTERN
+sync_site_stats_t*
+sync_site_stats_collect(
+/*====================*/
+	ulint*	n_sites)	/*!< out: number of creation sites */
+{
+	sync_site_stats_t*	site_stats;
+	const mutex_t*		mutex;
+	const rw_lock_t*	lock;
+
+	os_fast_mutex_lock(&sync_site_mutex);
+	*n_sites = sync_n_sites;
+	os_fast_mutex_unlock(&sync_site_mutex);
+
+	if (*n_sites == 0) {
+
+		return(NULL);
+	}
+
+	site_stats = ut_malloc(*n_sites * sizeof(*site_stats));
+
+	/* The counters of a latch are moved to its creation site when
+	the latch is freed, under the same mutex that protects the list
+	of the latches. Hold the mutex while reading both, so that no
+	latch is counted twice or missed. */
+
+	mutex_enter(&mutex_list_mutex);
+
+	sync_site_stats_init(site_stats, *n_sites, FALSE);
+
+	for (mutex = UT_LIST_GET_FIRST(mutex_list);
+	     mutex != NULL;
+	     mutex = UT_LIST_GET_NEXT(list, mutex)) {
+
+		sync_site_stats_add(site_stats, *n_sites,
+				    mutex->site, &mutex->stats);
+	}
+
+	mutex_exit(&mutex_list_mutex);
+
+	mutex_enter(&rw_lock_list_mutex);
+
+	sync_site_stats_init(site_stats, *n_sites, TRUE);
+
+	for (lock = UT_LIST_GET_FIRST(rw_lock_list);
+	     lock != NULL;
+	     lock = UT_LIST_GET_NEXT(list, lock)) {
+
+		sync_site_stats_add(site_stats, *n_sites,
+				    lock->site, &lock->stats);
+	}
+
+	mutex_exit(&rw_lock_list_mutex);
+
+	return(site_stats);
+}
+
+/******************************************************************//**
+Resets the counters of the freed latches of the creation sites of one
+type of latch. The caller must hold mutex_list_mutex or
+rw_lock_list_mutex, depending on rw_lock. */
+UNIV_STATIC
+void
+sync_site_stats_reset_low(
+/*======================*/
+	ibool	rw_lock)	/*!< in: TRUE for rw-locks, FALSE for mutexes */
+{
+	ulint	i;
+
+	os_fast_mutex_lock(&sync_site_mutex);
+
+	for (i = 0; i < sync_n_sites; i++) {
+		sync_site_t*	site = sync_sites[i];
+
+		if (site->rw_lock == rw_lock) {
+			memset(&site->stats, 0x0, sizeof(site->stats));
+		}
+	}
+
+	os_fast_mutex_unlock(&sync_site_mutex);
+}
+
+/******************************************************************//**
+Resets the contention counters of all latches and creation sites. The
+latches may be in use: an update that is concurrent with the reset may
+be lost or may survive it. */
+UNIV_INTERN
+void
+sync_site_stats_reset(void)
+/*=======================*/
+{
+	mutex_t*	mutex;
+	rw_lock_t*	lock;
+
+	mutex_enter(&mutex_list_mutex);
+
+	sync_site_stats_reset_low(FALSE);
+
+	for (mutex = UT_LIST_GET_FIRST(mutex_list);
+	     mutex != NULL;
+	     mutex = UT_LIST_GET_NEXT(list, mutex)) {
+
+		memset(&mutex->stats, 0x0, sizeof(mutex->stats));
+	}
+
+	mutex_exit(&mutex_list_mutex);
+
+	mutex_enter(&rw_lock_list_mutex);
+
+	sync_site_stats_reset_low(TRUE);
+
+	for (lock = UT_LIST_GET_FIRST(rw_lock_list);
+	     lock != NULL;
+	     lock = UT_LIST_GET_NEXT(list, lock)) {
+
+		memset(&lock->stats, 0x0, sizeof(lock->stats));
+	}
+
+	mutex_exit(&rw_lock_list_mutex);
+}
+
 /*******************************************************************//**
 Prints wait info of the sync system. */
 UNIV_INTERN
@@ -1519,6 +1897,12 @@ sync_print_wait_info(
 		(rw_s_spin_wait_count ? rw_s_spin_wait_count : 1),
 		(double) rw_x_spin_round_count /
 		(rw_x_spin_wait_count ? rw_x_spin_wait_count : 1));
+
+	ib_logger(ib_stream,
+		"Spin OS yields %llu mutex, %llu RW-shared, %llu RW-excl\n",
+		mutex_os_yield_count,
+		rw_s_os_yield_count,
+		rw_x_os_yield_count);
 }
 
 /*******************************************************************//**
@@ -1535,7 +1919,7 @@ sync_print(
 	rw_lock_list_print_info(ib_stream);
 #endif /* UNIV_SYNC_DEBUG */
 
-	sync_array_print_info(ib_stream, sync_primary_wait_array);
+	sync_array_print_info(ib_stream);
 
 	sync_print_wait_info(ib_stream);
 }
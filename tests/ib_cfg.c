@@ -32,9 +32,12 @@ get_all()
 		"additional_mem_pool_size",
 		"autoextend_increment",
 		"buffer_pool_size",
+		"buffer_pool_numa_policy",
 		"checksums",
 		"data_file_path",
 		"data_home_dir",
+		"deadlock_detect",
+		"dict_cache_max_tables",
 		"doublewrite",
 		"file_format",
 		"file_io_threads",
@@ -42,6 +45,7 @@ get_all()
 		"flush_log_at_trx_commit",
 		"flush_method",
 		"force_recovery",
+		"large_pages",
 		"lock_wait_timeout",
 		"log_buffer_size",
 		"log_file_size",
@@ -51,10 +55,14 @@ get_all()
 		"max_purge_lag",
 		"lru_old_blocks_pct",
 		"lru_block_access_recency",
+		"online_log_max_size",
 		"open_files",
 		"pre_rollback_hook",
 		"print_verbose_log",
 		"rollback_on_timeout",
+		"rollback_segments",
+		"sort_buffer_size",
+		"sort_threads",
 		"stats_sample_pages",
 		"status_file",
 		"sync_spin_loops",
@@ -170,6 +178,34 @@ main(int argc, char** argv)
 
 	err = ib_cfg_set("open_files", 123);
 	assert(err == DB_SUCCESS);
+	err = ib_cfg_get("open_files", &val);
+	assert(err == DB_SUCCESS);
+	assert(val == 123);
+
+	err = ib_cfg_set("open_files", 9);
+	assert(err == DB_INVALID_INPUT);
+
+	/* must be a multiple of the page size */
+	err = ib_cfg_set("sort_buffer_size", 100000);
+	assert(err == DB_INVALID_INPUT);
+
+	err = ib_cfg_set("sort_buffer_size", 5 * 16384);
+	assert(err == DB_SUCCESS);
+	err = ib_cfg_get("sort_buffer_size", &val);
+	assert(err == DB_SUCCESS);
+	assert(val == 5 * 16384);
+
+	err = ib_cfg_set("sort_buffer_size", 64 * 1024 * 1024 + 16384);
+	assert(err == DB_INVALID_INPUT);
+
+	err = ib_cfg_set("buffer_pool_numa_policy", "remote");
+	assert(err == DB_INVALID_INPUT);
+
+	err = ib_cfg_set("buffer_pool_numa_policy", "interleave");
+	assert(err == DB_SUCCESS);
+	err = ib_cfg_get("buffer_pool_numa_policy", &ptr);
+	assert(err == DB_SUCCESS);
+	assert(strcmp("interleave", ptr) == 0);
 
 	get_all();
 
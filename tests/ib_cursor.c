@@ -26,7 +26,27 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  SELECT * FROM T WHERE c1 > 5;
  SELECT * FROM T WHERE c1 < 5;
  SELECT * FROM T WHERE c1 >= 1 AND c1 < 5;
+ SELECT * FROM T WHERE c1 > 2 AND c1 <> 7; (pushed down)
+ SELECT COUNT(*), SUM(c1), MIN(c1), MAX(c1) FROM T
+  WHERE c1 >= 2 AND c1 <= 6 AND c1 <> 4; (aggregated in the engine)
  DROP TABLE T;
+ CREATE TABLE T2(c1 INT, c2 INT, c3 VARCHAR(32), c4 INT, c5 BLOB, PK(c1),
+  INDEX(c2, c3));
+ INSERT INTO T2 VALUES(0, 100, 'row0', 0, '...'); ...
+ SELECT c1, c3 FROM T2;
+ SELECT c1, c2, c3 FROM T2; (covered by INDEX(c2, c3))
+ SELECT c1, c2, c3 FROM T2 WHERE c2 >= 103 AND c4 <> 5; (using INDEX(c2, c3))
+ SELECT * FROM T2 WHERE c4 < 2; (using INDEX(c2, c3))
+ DROP TABLE T2;
+ CREATE TABLE T3(c1 INT, c2 INT UNSIGNED, c3 FLOAT, c4 DOUBLE, c5 INT,
+  PK(c1), INDEX(c5, c2));
+ INSERT INTO T3 VALUES(0, 4026531840, NULL, -0.0, 0); ...
+ SELECT COUNT(*), SUM(c2), MIN(c2), MAX(c2), SUM(c3), ... FROM T3;
+ SELECT COUNT(*), SUM(c2), MIN(c2), MAX(c2) FROM T3 WHERE c5 = 1;
+  (aggregated in the engine, covered by INDEX(c5, c2))
+ SELECT SUM(c4) FROM T3 WHERE c5 = 0; (using INDEX(c5, c2))
+ (the same, while another thread inserts rows)
+ DROP TABLE T3;
  
  The test will create all the relevant sub-directories in the current
  working directory. */
@@ -35,6 +55,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "test0aux.h"
 
@@ -44,6 +65,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #define DATABASE	"test"
 #define TABLE		"t"
+#define TABLE2		"t2"
+#define TABLE3		"t3"
+
+/* Number of rows of T3 that are inserted before the aggregates are
+computed; more than an aggregate scan reads in one mini-transaction */
+#define N_ROWS3		3000
+
+/* Value of c2 in the first row of T3; does not fit in a signed INT */
+#define C2_BASE3	0xF0000000UL
+
+/* Length of the BLOB column of T2; long enough to be stored externally */
+#define BLOB_LEN	10000
 
 /*********************************************************************
 Create an InnoDB database (sub-directory). */
@@ -122,6 +155,90 @@ create_table(
 	return(err);
 }
 
+/*********************************************************************
+CREATE TABLE T2(c1 INT, c2 INT, c3 VARCHAR(32), c4 INT, c5 BLOB, PK(c1),
+INDEX c2_c3(c2, c3)); */
+static
+ib_err_t
+create_table2(
+/*==========*/
+	const char*	dbname,			/*!< in: database name */
+	const char*	name)			/*!< in: table name */
+{
+	ib_trx_t	ib_trx;
+	ib_id_t		table_id = 0;
+	ib_err_t	err = DB_SUCCESS;
+	ib_tbl_sch_t	ib_tbl_sch = NULL;
+	ib_idx_sch_t	ib_idx_sch = NULL;
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+
+#ifdef __WIN__
+	sprintf(table_name, "%s/%s", dbname, name);
+#else
+	snprintf(table_name, sizeof(table_name), "%s/%s", dbname, name);
+#endif
+
+	/* Pass a table page size of 0, ie., use default page size. */
+	err = ib_table_schema_create(
+		table_name, &ib_tbl_sch, IB_TBL_COMPACT, 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c1", IB_INT, IB_COL_NONE, 0, sizeof(int));
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c2", IB_INT, IB_COL_NONE, 0, sizeof(int));
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c3", IB_VARCHAR, IB_COL_NONE, 0, 32);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c4", IB_INT, IB_COL_NONE, 0, sizeof(int));
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c5", IB_BLOB, IB_COL_NONE, 0, 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_index(ib_tbl_sch, "PRIMARY", &ib_idx_sch);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_add_col(ib_idx_sch, "c1", 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_set_clustered(ib_idx_sch);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_index(ib_tbl_sch, "c2_c3", &ib_idx_sch);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_add_col(ib_idx_sch, "c2", 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_add_col(ib_idx_sch, "c3", 0);
+	assert(err == DB_SUCCESS);
+
+	/* create table */
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	err = ib_schema_lock_exclusive(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_create(ib_trx, ib_tbl_sch, &table_id);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	if (ib_tbl_sch != NULL) {
+		ib_table_schema_delete(ib_tbl_sch);
+	}
+
+	return(err);
+}
+
 /*********************************************************************
 Open a table and return a cursor for the table. */
 static
@@ -286,113 +403,1151 @@ print_lt_5(
 	return(DB_END_OF_INDEX);
 }
 
-int main(int argc, char* argv[])
+static
+ib_err_t
+print_gt_2_ne_7(
+/*============*/
+	const ib_tpl_t	tpl,
+	void*		arg)
 {
-	int		ret;
+	int		c1;
 	ib_err_t	err;
-	ib_crsr_t	crsr;
-	ib_trx_t	ib_trx;
-	ib_tpl_t	tpl = NULL;
 
-        printf("Calling ib_init()\n");
-        err = ib_init();
-        assert(err == DB_SUCCESS);
+	err = ib_tuple_read_i32(tpl, 0, &c1);
+	assert(err == DB_SUCCESS);
 
-        test_configure();
+	/* The cursor must have skipped the other rows. */
+	assert(c1 > 2 && c1 != 7);
 
-        printf("Calling ib_startup()\n");
-        err = ib_startup("barracuda");
-        assert(err == DB_SUCCESS);
+	++*(int*) arg;
 
-        printf("Calling create_database()\n");
-        err = create_database(DATABASE);
-        assert(err == DB_SUCCESS);
+	print_tuple(stdout, tpl);
 
-        printf("Calling create_table()\n");
-        err = create_table(DATABASE, TABLE);
-        assert(err == DB_SUCCESS);
+	return(DB_SUCCESS);
+}
 
-        printf("Starting transaction\n");
-        ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
-        assert(ib_trx != NULL);
+/*********************************************************************
+Check that the rows are read in the order 0, 1, 2, ... */
+static
+ib_err_t
+check_seq(
+/*======*/
+	const ib_tpl_t	tpl,
+	void*		arg)
+{
+	int		c1;
+	ib_err_t	err;
 
-        printf("Opening table\n");
-        err = open_table(DATABASE, TABLE, ib_trx, &crsr);
-        assert(err == DB_SUCCESS);
+	err = ib_tuple_read_i32(tpl, 0, &c1);
+	assert(err == DB_SUCCESS);
 
-        printf("Locking cursor\n");
-        err = ib_cursor_lock(crsr, IB_LOCK_IX);
-        assert(err == DB_SUCCESS);
+	assert(c1 == *(int*) arg);
 
-        printf("Inserting rows\n");
-        err = insert_rows(crsr);
-        assert(err == DB_SUCCESS);
+	++*(int*) arg;
+
+	print_tuple(stdout, tpl);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************
+Check that a tuple read in zero-copy mode points to the cursor's copy of
+the row, and that its value stays valid until the cursor is moved. */
+static
+ib_err_t
+check_zero_copy(
+/*============*/
+	ib_crsr_t	crsr)		/*!< in: cursor in zero-copy mode */
+{
+	int		c1;
+	ib_err_t	err;
+	ib_tpl_t	tpl1;
+	ib_tpl_t	tpl2;
+	const void*	ptr;
+
+	tpl1 = ib_clust_read_tuple_create(crsr);
+	assert(tpl1 != NULL);
+
+	tpl2 = ib_clust_read_tuple_create(crsr);
+	assert(tpl2 != NULL);
 
-	/*==========================================*/
-	printf("SELECT * FROM T;\n");
 	err = ib_cursor_first(crsr);
 	assert(err == DB_SUCCESS);
 
-	err = iterate(crsr, NULL, print_all);
+	err = ib_cursor_next(crsr);
 	assert(err == DB_SUCCESS);
 
-	/*==========================================*/
-	printf("SELECT * FROM T WHERE c1 = 5;\n");
-	tpl = ib_clust_search_tuple_create(crsr);
-	assert(tpl != NULL);
-
-	err = ib_tuple_write_i32(tpl, 0, 5);
+	err = ib_cursor_read_row(crsr, tpl1);
 	assert(err == DB_SUCCESS);
 
-	err = ib_cursor_moveto(crsr, tpl, IB_CUR_GE, &ret);
-	assert(err == DB_SUCCESS);
-	assert(ret == 0);
+	ptr = ib_col_get_value(tpl1, 0);
+	assert(ptr != NULL);
 
-	err = iterate(crsr, NULL, print_eq_5);
+	/* Reading the same row again does not overwrite the values of
+	the first tuple, and both tuples point to the same copy. */
+	err = ib_cursor_read_row(crsr, tpl2);
 	assert(err == DB_SUCCESS);
 
-	/*==========================================*/
-	printf("SELECT * FROM T WHERE c1 > 5;\n");
+	assert(ib_col_get_value(tpl2, 0) == ptr);
 
-	err = ib_cursor_moveto(crsr, tpl, IB_CUR_G, &ret);
+	err = ib_tuple_read_i32(tpl1, 0, &c1);
 	assert(err == DB_SUCCESS);
-	assert(ret < 0);
+	assert(c1 == 1);
 
-	err = iterate(crsr, NULL, print_all);
+	err = ib_cursor_next(crsr);
 	assert(err == DB_SUCCESS);
 
-	/*==========================================*/
-	printf("SELECT * FROM T WHERE c1 < 5;\n");
-	err = ib_cursor_first(crsr);
+	tpl2 = ib_tuple_clear(tpl2);
+	assert(tpl2 != NULL);
+
+	err = ib_cursor_read_row(crsr, tpl2);
 	assert(err == DB_SUCCESS);
 
-	err = iterate(crsr, NULL, print_lt_5);
+	err = ib_tuple_read_i32(tpl2, 0, &c1);
 	assert(err == DB_SUCCESS);
+	assert(c1 == 2);
 
-	/*==========================================*/
-	printf("SELECT * FROM T WHERE c1 >= 1 AND c1 < 5;\n");
-	tpl = ib_clust_search_tuple_create(crsr);
+	ib_tuple_delete(tpl1);
+	ib_tuple_delete(tpl2);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************
+INSERT INTO T2 VALUES(i, 100 + i, 'row<i>', i, '<BLOB_LEN x <'a' + i>>');
+for i in 0 ... 9 */
+static
+ib_err_t
+insert_rows2(
+/*=========*/
+	ib_crsr_t	crsr)		/*!< in, out: cursor to use for write */
+{
+	int		i;
+	ib_err_t	err;
+	ib_tpl_t	tpl;
+	char		c3[32];
+	char*		blob;
+
+	blob = malloc(BLOB_LEN);
+	assert(blob != NULL);
+
+	tpl = ib_clust_read_tuple_create(crsr);
 	assert(tpl != NULL);
 
-	err = ib_tuple_write_i32(tpl, 0, 1);
-	assert(err == DB_SUCCESS);
+	for (i = 0; i < 10; ++i) {
+		snprintf(c3, sizeof(c3), "row%d", i);
+		memset(blob, 'a' + i, BLOB_LEN);
 
-	err = ib_cursor_moveto(crsr, tpl, IB_CUR_GE, &ret);
-	assert(err == DB_SUCCESS);
-	assert(ret == 0);
+		err = ib_tuple_write_i32(tpl, 0, i);
+		assert(err == DB_SUCCESS);
 
-	err = iterate(crsr, NULL, print_lt_5);
+		err = ib_tuple_write_i32(tpl, 1, 100 + i);
+		assert(err == DB_SUCCESS);
+
+		err = ib_col_set_value(tpl, 2, c3, strlen(c3));
+		assert(err == DB_SUCCESS);
+
+		err = ib_tuple_write_i32(tpl, 3, i);
+		assert(err == DB_SUCCESS);
+
+		err = ib_col_set_value(tpl, 4, blob, BLOB_LEN);
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_insert_row(crsr, tpl);
+		assert(err == DB_SUCCESS);
+
+		tpl = ib_tuple_clear(tpl);
+		assert(tpl != NULL);
+	}
+
+	ib_tuple_delete(tpl);
+	free(blob);
+
+	return(err);
+}
+
+/*********************************************************************
+Check the columns of a row of T2 that were read, and that the other
+columns were read as SQL NULL.
+@return	the value of c1 */
+static
+int
+check_row2(
+/*=======*/
+	ib_tpl_t	tpl,		/*!< in: row of T2 */
+	const int*	read)		/*!< in: nonzero for each column
+					that was read */
+{
+	int		c1;
+	int		val;
+	ib_err_t	err;
+	char		c3[32];
+
+	err = ib_tuple_read_i32(tpl, 0, &c1);
 	assert(err == DB_SUCCESS);
 
-	/*==========================================*/
-	err = ib_cursor_close(crsr);
+	if (read[1]) {
+		err = ib_tuple_read_i32(tpl, 1, &val);
+		assert(err == DB_SUCCESS);
+		assert(val == 100 + c1);
+	} else {
+		assert(ib_col_get_len(tpl, 1) == IB_SQL_NULL);
+	}
+
+	if (read[2]) {
+		snprintf(c3, sizeof(c3), "row%d", c1);
+		assert(ib_col_get_len(tpl, 2) == strlen(c3));
+		assert(memcmp(ib_col_get_value(tpl, 2), c3, strlen(c3)) == 0);
+	} else {
+		assert(ib_col_get_len(tpl, 2) == IB_SQL_NULL);
+	}
+
+	if (read[3]) {
+		err = ib_tuple_read_i32(tpl, 3, &val);
+		assert(err == DB_SUCCESS);
+		assert(val == c1);
+	} else {
+		assert(ib_col_get_len(tpl, 3) == IB_SQL_NULL);
+	}
+
+	if (read[4]) {
+		const char*	blob = ib_col_get_value(tpl, 4);
+
+		assert(ib_col_get_len(tpl, 4) == BLOB_LEN);
+		assert(blob[0] == 'a' + c1 && blob[BLOB_LEN - 1] == 'a' + c1);
+	} else {
+		assert(ib_col_get_len(tpl, 4) == IB_SQL_NULL);
+	}
+
+	return(c1);
+}
+
+/*********************************************************************
+SELECT c1, c3 FROM T2; Check that the other columns, including the
+BLOB, are read as SQL NULL and that such a row cannot be updated. */
+static
+ib_err_t
+test_projection(
+/*============*/
+	ib_crsr_t	crsr)		/*!< in: cursor on T2 */
+{
+	int		i;
+	ib_err_t	err;
+	ib_tpl_t	old_tpl;
+	ib_tpl_t	new_tpl;
+	ib_ulint_t	cols[] = { 0, 2 };
+	const int	read[] = { 1, 0, 1, 0, 0 };
+	const int	read_all[] = { 1, 1, 1, 1, 1 };
+
+	err = ib_cursor_set_columns(crsr, cols, 2);
 	assert(err == DB_SUCCESS);
-	crsr = NULL;
 
-	err = ib_trx_commit(ib_trx);
+	old_tpl = ib_clust_read_tuple_create(crsr);
+	assert(old_tpl != NULL);
+
+	new_tpl = ib_clust_read_tuple_create(crsr);
+	assert(new_tpl != NULL);
+
+	err = ib_cursor_first(crsr);
 	assert(err == DB_SUCCESS);
 
-	err = drop_table(DATABASE, TABLE);
+	for (i = 0; err == DB_SUCCESS; ++i) {
+		err = ib_cursor_read_row(crsr, old_tpl);
+		assert(err == DB_SUCCESS);
+
+		assert(check_row2(old_tpl, read) == i);
+
+		print_tuple(stdout, old_tpl);
+
+		err = ib_cursor_next(crsr);
+		assert(err == DB_SUCCESS || err == DB_END_OF_INDEX);
+
+		old_tpl = ib_tuple_clear(old_tpl);
+		assert(old_tpl != NULL);
+	}
+
+	assert(i == 10);
+
+	/* The columns that were not read would be written as NULL. */
+	err = ib_cursor_first(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_read_row(crsr, old_tpl);
+	assert(err == DB_SUCCESS);
+
+	err = ib_tuple_copy(new_tpl, old_tpl);
+	assert(err == DB_SUCCESS);
+
+	err = ib_tuple_write_i32(new_tpl, 1, -1);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_update_row(crsr, old_tpl, new_tpl);
+	assert(err == DB_INVALID_INPUT);
+
+	/* Read all the columns again; the row was not changed. */
+	err = ib_cursor_set_columns(crsr, NULL, 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_first(crsr);
+	assert(err == DB_SUCCESS);
+
+	old_tpl = ib_tuple_clear(old_tpl);
+	assert(old_tpl != NULL);
+
+	err = ib_cursor_read_row(crsr, old_tpl);
+	assert(err == DB_SUCCESS);
+
+	assert(check_row2(old_tpl, read_all) == 0);
+
+	ib_tuple_delete(old_tpl);
+	ib_tuple_delete(new_tpl);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************
+SELECT c1, c2, c3 FROM T2; The rows are read from the secondary index
+c2_c3, which stores the primary key c1. Check that the other columns
+are SQL NULL, even in a tuple that held a full row before. */
+static
+ib_err_t
+test_covering(
+/*==========*/
+	ib_crsr_t	crsr)		/*!< in: cursor on T2 */
+{
+	int		i;
+	ib_err_t	err;
+	ib_tpl_t	tpl;
+	ib_crsr_t	idx_crsr;
+	ib_ulint_t	cols[] = { 0, 1, 2 };
+	ib_ulint_t	uncovered_cols[] = { 0, 1, 3 };
+	const int	read[] = { 1, 1, 1, 0, 0 };
+	const int	read_all[] = { 1, 1, 1, 1, 1 };
+
+	tpl = ib_clust_read_tuple_create(crsr);
+	assert(tpl != NULL);
+
+	err = ib_cursor_first(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_read_row(crsr, tpl);
+	assert(err == DB_SUCCESS);
+
+	assert(check_row2(tpl, read_all) == 0);
+
+	err = ib_cursor_open_index_using_name(crsr, "c2_c3", &idx_crsr);
+	assert(err == DB_SUCCESS);
+
+	ib_cursor_set_cluster_access(idx_crsr);
+
+	err = ib_cursor_set_columns(idx_crsr, uncovered_cols, 3);
+	assert(err == DB_SUCCESS);
+	assert(!ib_cursor_is_covering(idx_crsr));
+
+	err = ib_cursor_set_columns(idx_crsr, cols, 3);
+	assert(err == DB_SUCCESS);
+	assert(ib_cursor_is_covering(idx_crsr));
+
+	err = ib_cursor_first(idx_crsr);
+	assert(err == DB_SUCCESS);
+
+	/* Do not clear the tuple between the rows. */
+	for (i = 0; err == DB_SUCCESS; ++i) {
+		err = ib_cursor_read_row(idx_crsr, tpl);
+		assert(err == DB_SUCCESS);
+
+		assert(check_row2(tpl, read) == i);
+
+		print_tuple(stdout, tpl);
+
+		err = ib_cursor_next(idx_crsr);
+		assert(err == DB_SUCCESS || err == DB_END_OF_INDEX);
+	}
+
+	assert(i == 10);
+
+	err = ib_cursor_close(idx_crsr);
+	assert(err == DB_SUCCESS);
+
+	ib_tuple_delete(tpl);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************
+Read the rows of T2 through a secondary index cursor with predicates on
+c2, which the index stores, and on c4, which it does not.
+@return	number of rows read */
+static
+int
+read_sec_with_preds(
+/*================*/
+	ib_crsr_t	idx_crsr,	/*!< in: cursor on c2_c3 */
+	const int*	read,		/*!< in: nonzero for each column
+					that is read */
+	const int*	expected)	/*!< in: values of c1, in order,
+					terminated by -1 */
+{
+	int		i;
+	int		c1;
+	ib_err_t	err;
+	ib_tpl_t	tpl;
+
+	tpl = ib_clust_read_tuple_create(idx_crsr);
+	assert(tpl != NULL);
+
+	err = ib_cursor_first(idx_crsr);
+
+	for (i = 0; err == DB_SUCCESS; ++i) {
+		err = ib_cursor_read_row(idx_crsr, tpl);
+		assert(err == DB_SUCCESS);
+
+		c1 = check_row2(tpl, read);
+		assert(c1 == expected[i]);
+
+		printf("%d|\n", c1);
+
+		err = ib_cursor_next(idx_crsr);
+		assert(err == DB_SUCCESS || err == DB_END_OF_INDEX);
+
+		tpl = ib_tuple_clear(tpl);
+		assert(tpl != NULL);
+	}
+
+	assert(err == DB_END_OF_INDEX || err == DB_RECORD_NOT_FOUND);
+	assert(expected[i] == -1);
+
+	ib_tuple_delete(tpl);
+
+	return(i);
+}
+
+/*********************************************************************
+Test the predicates of secondary index cursors. A predicate on a column
+that the index does not store is evaluated on the clustered index record,
+also when the other columns are covered by the index. */
+static
+ib_err_t
+test_sec_predicates(
+/*================*/
+	ib_crsr_t	crsr)		/*!< in: cursor on T2 */
+{
+	ib_err_t	err;
+	ib_crsr_t	idx_crsr;
+	ib_i32_t	ge = 103;
+	ib_i32_t	ne = 5;
+	ib_i32_t	lt = 2;
+	ib_ulint_t	cols[] = { 0, 1, 2 };
+	const int	read[] = { 1, 1, 1, 0, 0 };
+	const int	read_all[] = { 1, 1, 1, 1, 1 };
+	const int	ge_103_ne_5[] = { 3, 4, 6, 7, 8, 9, -1 };
+	const int	lt_2[] = { 0, 1, -1 };
+
+	printf("SELECT c1, c2, c3 FROM T2 WHERE c2 >= 103 AND c4 <> 5;\n");
+
+	err = ib_cursor_open_index_using_name(crsr, "c2_c3", &idx_crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_set_columns(idx_crsr, cols, 3);
+	assert(err == DB_SUCCESS);
+	assert(ib_cursor_is_covering(idx_crsr));
+
+	err = ib_cursor_add_predicate(
+		idx_crsr, 1, IB_PRED_GE, &ge, sizeof(ge));
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_add_predicate(
+		idx_crsr, 3, IB_PRED_NE, &ne, sizeof(ne));
+	assert(err == DB_SUCCESS);
+
+	assert(read_sec_with_preds(idx_crsr, read, ge_103_ne_5) == 6);
+
+	err = ib_cursor_close(idx_crsr);
+	assert(err == DB_SUCCESS);
+
+	printf("SELECT * FROM T2 WHERE c4 < 2;\n");
+
+	err = ib_cursor_open_index_using_name(crsr, "c2_c3", &idx_crsr);
+	assert(err == DB_SUCCESS);
+
+	ib_cursor_set_cluster_access(idx_crsr);
+
+	err = ib_cursor_add_predicate(
+		idx_crsr, 3, IB_PRED_LT, &lt, sizeof(lt));
+	assert(err == DB_SUCCESS);
+
+	assert(read_sec_with_preds(idx_crsr, read_all, lt_2) == 2);
+
+	err = ib_cursor_close(idx_crsr);
+	assert(err == DB_SUCCESS);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************
+Run the tests on T2. */
+static
+ib_err_t
+test_table2(void)
+/*=============*/
+{
+	ib_err_t	err;
+	ib_crsr_t	crsr;
+	ib_trx_t	ib_trx;
+
+	err = create_table2(DATABASE, TABLE2);
+	assert(err == DB_SUCCESS);
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = open_table(DATABASE, TABLE2, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_lock(crsr, IB_LOCK_IX);
+	assert(err == DB_SUCCESS);
+
+	err = insert_rows2(crsr);
+	assert(err == DB_SUCCESS);
+
+	/*==========================================*/
+	printf("SELECT c1, c3 FROM T2;\n");
+	err = test_projection(crsr);
+	assert(err == DB_SUCCESS);
+
+	/*==========================================*/
+	printf("SELECT c1, c2, c3 FROM T2; (covering index)\n");
+	err = test_covering(crsr);
+	assert(err == DB_SUCCESS);
+
+	/*==========================================*/
+	err = test_sec_predicates(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(drop_table(DATABASE, TABLE2));
+}
+
+/*********************************************************************
+CREATE TABLE T3(c1 INT, c2 INT UNSIGNED, c3 FLOAT, c4 DOUBLE, c5 INT,
+PK(c1), INDEX c5_c2(c5, c2)); */
+static
+ib_err_t
+create_table3(
+/*==========*/
+	const char*	dbname,			/*!< in: database name */
+	const char*	name)			/*!< in: table name */
+{
+	ib_trx_t	ib_trx;
+	ib_id_t		table_id = 0;
+	ib_err_t	err = DB_SUCCESS;
+	ib_tbl_sch_t	ib_tbl_sch = NULL;
+	ib_idx_sch_t	ib_idx_sch = NULL;
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+
+#ifdef __WIN__
+	sprintf(table_name, "%s/%s", dbname, name);
+#else
+	snprintf(table_name, sizeof(table_name), "%s/%s", dbname, name);
+#endif
+
+	err = ib_table_schema_create(
+		table_name, &ib_tbl_sch, IB_TBL_COMPACT, 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c1", IB_INT, IB_COL_NONE, 0, sizeof(int));
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c2", IB_INT, IB_COL_UNSIGNED, 0, sizeof(int));
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c3", IB_FLOAT, IB_COL_NONE, 0, sizeof(float));
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c4", IB_DOUBLE, IB_COL_NONE, 0, sizeof(double));
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c5", IB_INT, IB_COL_NONE, 0, sizeof(int));
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_index(ib_tbl_sch, "PRIMARY", &ib_idx_sch);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_add_col(ib_idx_sch, "c1", 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_set_clustered(ib_idx_sch);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_index(ib_tbl_sch, "c5_c2", &ib_idx_sch);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_add_col(ib_idx_sch, "c5", 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_add_col(ib_idx_sch, "c2", 0);
+	assert(err == DB_SUCCESS);
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	err = ib_schema_lock_exclusive(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_create(ib_trx, ib_tbl_sch, &table_id);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	if (ib_tbl_sch != NULL) {
+		ib_table_schema_delete(ib_tbl_sch);
+	}
+
+	return(err);
+}
+
+/*********************************************************************
+INSERT INTO T3 VALUES(2 * i + odd, C2_BASE3 + i, i / 2 or NULL, -i / 4,
+i % 2); for i in [0, N_ROWS3), committing every 10 rows. The even values
+of c1 are inserted first and the odd ones between them later.
+@return	DB_SUCCESS or error code */
+static
+ib_err_t
+insert_rows3(
+/*=========*/
+	int		odd)		/*!< in: 1 for the odd c1 */
+{
+	int		i;
+	ib_err_t	err = DB_SUCCESS;
+	ib_crsr_t	crsr = NULL;
+	ib_trx_t	ib_trx = NULL;
+	ib_tpl_t	tpl = NULL;
+
+	for (i = 0; i < N_ROWS3; ++i) {
+		if (i % 10 == 0) {
+			ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+			assert(ib_trx != NULL);
+
+			err = open_table(DATABASE, TABLE3, ib_trx, &crsr);
+			assert(err == DB_SUCCESS);
+
+			err = ib_cursor_lock(crsr, IB_LOCK_IX);
+			assert(err == DB_SUCCESS);
+
+			tpl = ib_clust_read_tuple_create(crsr);
+			assert(tpl != NULL);
+		}
+
+		err = ib_tuple_write_i32(tpl, 0, 2 * i + odd);
+		assert(err == DB_SUCCESS);
+
+		err = ib_tuple_write_u32(tpl, 1, C2_BASE3 + i);
+		assert(err == DB_SUCCESS);
+
+		/* Leave c3 SQL NULL in every tenth row. */
+		if (i % 10 != 0) {
+			err = ib_tuple_write_float(tpl, 2, (float) i / 2);
+			assert(err == DB_SUCCESS);
+		}
+
+		err = ib_tuple_write_double(tpl, 3, (double) -i / 4);
+		assert(err == DB_SUCCESS);
+
+		err = ib_tuple_write_i32(tpl, 4, i % 2);
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_insert_row(crsr, tpl);
+		assert(err == DB_SUCCESS);
+
+		tpl = ib_tuple_clear(tpl);
+		assert(tpl != NULL);
+
+		if (i % 10 == 9 || i == N_ROWS3 - 1) {
+			ib_tuple_delete(tpl);
+
+			err = ib_cursor_close(crsr);
+			assert(err == DB_SUCCESS);
+
+			err = ib_trx_commit(ib_trx);
+			assert(err == DB_SUCCESS);
+		}
+	}
+
+	return(err);
+}
+
+/*********************************************************************
+Insert the odd values of c1 into T3.
+@return	NULL */
+static
+void*
+insert_rows3_odd(
+/*=============*/
+	void*		arg)		/*!< in: unused */
+{
+	ib_err_t	err;
+
+	(void) arg;
+
+	err = insert_rows3(1);
+	assert(err == DB_SUCCESS);
+
+	return(NULL);
+}
+
+/*********************************************************************
+Compute the aggregates over T3 and check them against the rows that
+insert_rows3(0) inserted. The scans read more records than
+ROW_SEL_AGGR_RECS_PER_MTR, so that they restart their mini-transaction
+on the way. */
+static
+void
+check_aggregates3(
+/*==============*/
+	ib_crsr_t	crsr)		/*!< in: cursor on T3 */
+{
+	int		i;
+	ib_err_t	err;
+	ib_tpl_t	tpl;
+	ib_crsr_t	idx_crsr;
+	ib_aggr_t	aggrs[8];
+	ib_i32_t	c5;
+	ib_u64_t	n_c3 = 0;
+	double		sum_c3 = 0.0;
+	double		sum_c4 = 0.0;
+	double		sum_c4_even = 0.0;
+	ib_u64_t	sum_c2 = 0;
+	ib_u64_t	sum_c2_odd = 0;
+
+	for (i = 0; i < N_ROWS3; ++i) {
+		sum_c2 += C2_BASE3 + i;
+		sum_c4 += (double) -i / 4;
+
+		if (i % 2) {
+			sum_c2_odd += C2_BASE3 + i;
+		} else {
+			sum_c4_even += (double) -i / 4;
+		}
+
+		if (i % 10 != 0) {
+			++n_c3;
+			sum_c3 += (double) i / 2;
+		}
+	}
+
+	memset(aggrs, 0, sizeof(aggrs));
+
+	aggrs[0].op = IB_AGGR_COUNT;
+	aggrs[1].op = IB_AGGR_SUM;
+	aggrs[1].col_no = 1;
+	aggrs[2].op = IB_AGGR_MIN;
+	aggrs[2].col_no = 1;
+	aggrs[3].op = IB_AGGR_MAX;
+	aggrs[3].col_no = 1;
+	aggrs[4].op = IB_AGGR_SUM;
+	aggrs[4].col_no = 2;
+	aggrs[5].op = IB_AGGR_MAX;
+	aggrs[5].col_no = 2;
+	aggrs[6].op = IB_AGGR_SUM;
+	aggrs[6].col_no = 3;
+	aggrs[7].op = IB_AGGR_MIN;
+	aggrs[7].col_no = 3;
+
+	err = ib_cursor_aggregate(crsr, NULL, IB_CUR_G, aggrs, 8);
+	assert(err == DB_SUCCESS);
+
+	assert(aggrs[0].n_values == N_ROWS3);
+	assert(aggrs[1].n_values == N_ROWS3 && aggrs[1].u64 == sum_c2);
+	assert(aggrs[2].u64 == C2_BASE3);
+	assert(aggrs[3].u64 == C2_BASE3 + N_ROWS3 - 1);
+	assert(aggrs[4].n_values == n_c3 && aggrs[4].dbl == sum_c3);
+	assert(aggrs[5].dbl == (double) (N_ROWS3 - 1) / 2);
+	assert(aggrs[6].n_values == N_ROWS3 && aggrs[6].dbl == sum_c4);
+	assert(aggrs[7].dbl == (double) -(N_ROWS3 - 1) / 4);
+
+	/* SELECT COUNT(*), SUM(c2), MIN(c2), MAX(c2) FROM T3 WHERE c5 = 1;
+	The index c5_c2 stores c2, so that the clustered index records
+	are only read for the visibility of the rows. The range starts
+	at (1, NULL), before any c2, and ends at the first record where
+	c5 <> 1. */
+
+	err = ib_cursor_open_index_using_name(crsr, "c5_c2", &idx_crsr);
+	assert(err == DB_SUCCESS);
+
+	c5 = 1;
+	err = ib_cursor_add_predicate(
+		idx_crsr, 4, IB_PRED_EQ, &c5, sizeof(c5));
+	assert(err == DB_SUCCESS);
+
+	tpl = ib_sec_search_tuple_create(idx_crsr);
+	assert(tpl != NULL);
+
+	err = ib_tuple_write_i32(tpl, 0, c5);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_aggregate(idx_crsr, tpl, IB_CUR_GE, aggrs, 4);
+	assert(err == DB_SUCCESS);
+
+	assert(aggrs[0].n_values == N_ROWS3 / 2);
+	assert(aggrs[1].u64 == sum_c2_odd);
+	assert(aggrs[2].u64 == C2_BASE3 + 1);
+	assert(aggrs[3].u64 == C2_BASE3 + N_ROWS3 - 1);
+
+	/* SELECT SUM(c4) FROM T3 WHERE c5 = 0; The index does not store
+	c4. */
+
+	ib_cursor_clear_predicates(idx_crsr);
+
+	c5 = 0;
+	err = ib_cursor_add_predicate(
+		idx_crsr, 4, IB_PRED_EQ, &c5, sizeof(c5));
+	assert(err == DB_SUCCESS);
+
+	err = ib_tuple_write_i32(tpl, 0, c5);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_aggregate(idx_crsr, tpl, IB_CUR_GE, &aggrs[6], 1);
+	assert(err == DB_SUCCESS);
+
+	assert(aggrs[6].n_values == N_ROWS3 / 2);
+	assert(aggrs[6].dbl == sum_c4_even);
+
+	ib_tuple_delete(tpl);
+
+	err = ib_cursor_close(idx_crsr);
+	assert(err == DB_SUCCESS);
+}
+
+/*********************************************************************
+Test the aggregates over more rows than one mini-transaction of the scan
+reads, on unsigned, FLOAT and DOUBLE columns and through a secondary
+index, also while another thread inserts rows between the ones that the
+read view sees. */
+static
+ib_err_t
+test_aggregates(void)
+/*=================*/
+{
+	int		n_checks;
+	int		retval;
+	ib_err_t	err;
+	ib_crsr_t	crsr;
+	ib_trx_t	ib_trx;
+	pthread_t	insert_thread;
+	ib_aggr_t	count;
+
+	err = create_table3(DATABASE, TABLE3);
+	assert(err == DB_SUCCESS);
+
+	err = insert_rows3(0);
+	assert(err == DB_SUCCESS);
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = open_table(DATABASE, TABLE3, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	/* This opens the read view of ib_trx. */
+	check_aggregates3(crsr);
+
+	retval = pthread_create(&insert_thread, NULL, insert_rows3_odd, NULL);
+	assert(retval == 0);
+
+	/* The insert thread returns only after it has inserted all its
+	rows: use the number of rows in a new read view to see how far it
+	has come. */
+
+	memset(&count, 0, sizeof(count));
+	count.op = IB_AGGR_COUNT;
+
+	for (n_checks = 0; count.n_values < 2 * N_ROWS3; ++n_checks) {
+		ib_trx_t	count_trx;
+		ib_crsr_t	count_crsr;
+
+		check_aggregates3(crsr);
+
+		count_trx = ib_trx_begin(IB_TRX_READ_COMMITTED);
+		assert(count_trx != NULL);
+
+		err = open_table(DATABASE, TABLE3, count_trx, &count_crsr);
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_aggregate(
+			count_crsr, NULL, IB_CUR_G, &count, 1);
+		assert(err == DB_SUCCESS);
+		assert(count.n_values >= N_ROWS3);
+
+		err = ib_cursor_close(count_crsr);
+		assert(err == DB_SUCCESS);
+
+		err = ib_trx_commit(count_trx);
+		assert(err == DB_SUCCESS);
+	}
+
+	retval = pthread_join(insert_thread, NULL);
+	assert(retval == 0);
+
+	printf("checked the aggregates %d times during the inserts\n",
+	       n_checks);
+
+	check_aggregates3(crsr);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(drop_table(DATABASE, TABLE3));
+}
+
+int main(int argc, char* argv[])
+{
+	int		ret;
+	ib_err_t	err;
+	ib_crsr_t	crsr;
+	ib_trx_t	ib_trx;
+	ib_tpl_t	tpl = NULL;
+
+        printf("Calling ib_init()\n");
+        err = ib_init();
+        assert(err == DB_SUCCESS);
+
+        test_configure();
+
+        printf("Calling ib_startup()\n");
+        err = ib_startup("barracuda");
+        assert(err == DB_SUCCESS);
+
+        printf("Calling create_database()\n");
+        err = create_database(DATABASE);
+        assert(err == DB_SUCCESS);
+
+        printf("Calling create_table()\n");
+        err = create_table(DATABASE, TABLE);
+        assert(err == DB_SUCCESS);
+
+        printf("Starting transaction\n");
+        ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+        assert(ib_trx != NULL);
+
+        printf("Opening table\n");
+        err = open_table(DATABASE, TABLE, ib_trx, &crsr);
+        assert(err == DB_SUCCESS);
+
+        printf("Locking cursor\n");
+        err = ib_cursor_lock(crsr, IB_LOCK_IX);
+        assert(err == DB_SUCCESS);
+
+        printf("Inserting rows\n");
+        err = insert_rows(crsr);
+        assert(err == DB_SUCCESS);
+
+	/*==========================================*/
+	printf("SELECT * FROM T;\n");
+	err = ib_cursor_first(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = iterate(crsr, NULL, print_all);
+	assert(err == DB_SUCCESS);
+
+	/*==========================================*/
+	printf("SELECT * FROM T WHERE c1 = 5;\n");
+	tpl = ib_clust_search_tuple_create(crsr);
+	assert(tpl != NULL);
+
+	err = ib_tuple_write_i32(tpl, 0, 5);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_moveto(crsr, tpl, IB_CUR_GE, &ret);
+	assert(err == DB_SUCCESS);
+	assert(ret == 0);
+
+	err = iterate(crsr, NULL, print_eq_5);
+	assert(err == DB_SUCCESS);
+
+	/*==========================================*/
+	printf("SELECT * FROM T WHERE c1 > 5;\n");
+
+	err = ib_cursor_moveto(crsr, tpl, IB_CUR_G, &ret);
+	assert(err == DB_SUCCESS);
+	assert(ret < 0);
+
+	err = iterate(crsr, NULL, print_all);
+	assert(err == DB_SUCCESS);
+
+	/*==========================================*/
+	printf("SELECT * FROM T WHERE c1 < 5;\n");
+	err = ib_cursor_first(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = iterate(crsr, NULL, print_lt_5);
+	assert(err == DB_SUCCESS);
+
+	/*==========================================*/
+	printf("SELECT * FROM T WHERE c1 >= 1 AND c1 < 5;\n");
+	tpl = ib_clust_search_tuple_create(crsr);
+	assert(tpl != NULL);
+
+	err = ib_tuple_write_i32(tpl, 0, 1);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_moveto(crsr, tpl, IB_CUR_GE, &ret);
+	assert(err == DB_SUCCESS);
+	assert(ret == 0);
+
+	err = iterate(crsr, NULL, print_lt_5);
+	assert(err == DB_SUCCESS);
+
+	/*==========================================*/
+	printf("SELECT * FROM T; (zero copy)\n");
+	ib_cursor_set_zero_copy(crsr, IB_TRUE);
+
+	{
+		int		n_rows = 0;
+
+		err = ib_cursor_first(crsr);
+		assert(err == DB_SUCCESS);
+
+		err = iterate(crsr, &n_rows, check_seq);
+		assert(err == DB_SUCCESS);
+		assert(n_rows == 10);
+	}
+
+	err = check_zero_copy(crsr);
+	assert(err == DB_SUCCESS);
+
+	ib_cursor_set_zero_copy(crsr, IB_FALSE);
+
+	/*==========================================*/
+	printf("SELECT c1 FROM T;\n");
+	{
+		ib_ulint_t	cols[] = { 0 };
+		ib_ulint_t	bad_cols[] = { 1 };
+
+		err = ib_cursor_set_columns(crsr, bad_cols, 1);
+		assert(err == DB_INVALID_INPUT);
+
+		err = ib_cursor_set_columns(crsr, cols, 1);
+		assert(err == DB_SUCCESS);
+	}
+
+	err = ib_cursor_first(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = iterate(crsr, NULL, print_all);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_set_columns(crsr, NULL, 0);
+	assert(err == DB_SUCCESS);
+
+	/*==========================================*/
+	printf("SELECT * FROM T WHERE c1 > 2 AND c1 <> 7; (pushed down)\n");
+	{
+		int		n_rows = 0;
+		ib_i32_t	gt = 2;
+		ib_i32_t	ne = 7;
+
+		err = ib_cursor_add_predicate(
+			crsr, 0, IB_PRED_LT, NULL, IB_SQL_NULL);
+		assert(err == DB_INVALID_INPUT);
+
+		err = ib_cursor_add_predicate(
+			crsr, 0, IB_PRED_GT, &gt, sizeof(gt));
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_add_predicate(
+			crsr, 0, IB_PRED_NE, &ne, sizeof(ne));
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_first(crsr);
+		assert(err == DB_SUCCESS);
+
+		err = iterate(crsr, &n_rows, print_gt_2_ne_7);
+		assert(err == DB_SUCCESS);
+		assert(n_rows == 6);
+	}
+
+	ib_cursor_clear_predicates(crsr);
+
+	/*==========================================*/
+	printf("SELECT COUNT(*), SUM(c1), MIN(c1), MAX(c1) FROM T\n"
+	       " WHERE c1 >= 2 AND c1 <= 6 AND c1 <> 4;\n");
+	{
+		ib_aggr_t	aggrs[4];
+		ib_i32_t	le = 6;
+		ib_i32_t	ne = 4;
+
+		memset(aggrs, 0, sizeof(aggrs));
+
+		aggrs[0].op = IB_AGGR_COUNT;
+		aggrs[1].op = IB_AGGR_SUM;
+		aggrs[2].op = IB_AGGR_MIN;
+		aggrs[3].op = IB_AGGR_MAX;
+
+		aggrs[1].col_no = 1;
+		err = ib_cursor_aggregate(crsr, NULL, IB_CUR_G, aggrs, 2);
+		assert(err == DB_INVALID_INPUT);
+
+		aggrs[1].col_no = 0;
+		err = ib_cursor_aggregate(crsr, NULL, IB_CUR_G, aggrs, 2);
+		assert(err == DB_SUCCESS);
+		assert(aggrs[0].n_values == 10);
+		assert(aggrs[1].n_values == 10 && aggrs[1].i64 == 45);
+
+		err = ib_cursor_add_predicate(
+			crsr, 0, IB_PRED_LE, &le, sizeof(le));
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_add_predicate(
+			crsr, 0, IB_PRED_NE, &ne, sizeof(ne));
+		assert(err == DB_SUCCESS);
+
+		err = ib_tuple_write_i32(tpl, 0, 2);
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_aggregate(crsr, tpl, IB_CUR_GE, aggrs, 4);
+		assert(err == DB_SUCCESS);
+
+		printf("%d|%d|%d|%d|\n",
+		       (int) aggrs[0].n_values, (int) aggrs[1].i64,
+		       (int) aggrs[2].i64, (int) aggrs[3].i64);
+
+		assert(aggrs[0].n_values == 4);
+		assert(aggrs[1].i64 == 16);
+		assert(aggrs[2].i64 == 2);
+		assert(aggrs[3].i64 == 6);
+	}
+
+	ib_cursor_clear_predicates(crsr);
+
+	/*==========================================*/
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+	crsr = NULL;
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	err = drop_table(DATABASE, TABLE);
+	assert(err == DB_SUCCESS);
+
+	err = test_table2();
+	assert(err == DB_SUCCESS);
+
+	/*==========================================*/
+	printf("SELECT COUNT(*), SUM(c2), ... FROM T3; (aggregates)\n");
+	err = test_aggregates();
 	assert(err == DB_SUCCESS);
 
 	err = ib_shutdown(IB_SHUTDOWN_NORMAL);
@@ -25,6 +25,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  CREATE INDEX T_C2 ON T(c2);
  CREATE INDEX T_C2 ON T(c3(10));
  DROP TABLE T;
+ CREATE INDEX T_C1 ON T(c1); while another thread deletes rows and opens
+ read views, and read the index in those read views.
+ Execute a prepared INSERT statement of the internal SQL parser on a
+ table before and after an index is created on it, and after the table
+ is dropped and created again.
  
  The test will create all the relevant sub-directories in the current
  working directory. */
@@ -33,6 +38,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "test0aux.h"
 
@@ -42,6 +48,35 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #define DATABASE	"test"
 #define TABLE		"ib_ddl"
+#define SQL_TABLE	"ib_ddl_sql"
+#define MVCC_TABLE	"ib_ddl_mvcc"
+
+/* Number of read views that delete_rows() opens */
+#define N_VIEWS		64
+
+#ifndef __WIN__
+/* Private functions of the API for the internal SQL parser, declared in
+include/api0api.h. They are not exported from the Windows DLL. */
+typedef struct ib_sql_stmt_struct	ib_sql_stmt_t;
+
+ib_err_t
+ib_sql_prepare(
+/*===========*/
+	const char*	sql,		/*!< in: sql to prepare */
+	ib_sql_stmt_t**	stmt);		/*!< out: prepared statement */
+
+ib_err_t
+ib_exec_prepared_sql(
+/*=================*/
+	ib_sql_stmt_t*	stmt,		/*!< in/out: prepared statement */
+	ib_ulint_t	n_args,		/*!< in: no. of args */
+	...);
+
+void
+ib_sql_free(
+/*========*/
+	ib_sql_stmt_t*	stmt);		/*!< in, own: prepared statement */
+#endif /* !__WIN__ */
 
 /*********************************************************************
 Create an InnoDB database (sub-directory). */
@@ -193,6 +228,110 @@ insert_random_rows(
 	return(err);
 }
 
+/** Set when modify_rows() should stop */
+static volatile int	modify_rows_stop;
+
+/*********************************************************************
+Keep inserting, updating and deleting rows while the indexes are being
+created, committing and rolling back the changes in turn.
+@return	NULL */
+static
+void*
+modify_rows(
+/*========*/
+	void*		arg)		/*!< in: unused */
+{
+	ib_i32_t	i;
+	ib_err_t	err;
+	char		ptr[64];
+
+	(void) arg;
+
+	for (i = 0; !modify_rows_stop; ++i) {
+		int		l;
+		ib_i32_t	c1;
+		ib_crsr_t	crsr;
+		ib_trx_t	ib_trx;
+		ib_tpl_t	tpl;
+		ib_tpl_t	new_tpl;
+
+		ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+		assert(ib_trx != NULL);
+
+		err = open_table(DATABASE, TABLE, ib_trx, &crsr);
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_lock(crsr, IB_LOCK_IX);
+		assert(err == DB_SUCCESS);
+
+		tpl = ib_clust_read_tuple_create(crsr);
+		assert(tpl != NULL);
+
+		err = ib_tuple_write_i32(tpl, 0, 100 + i % 10);
+		assert(err == DB_SUCCESS);
+
+		l = gen_rand_text(ptr, 10);
+		err = ib_col_set_value(tpl, 1, ptr, l);
+		assert(err == DB_SUCCESS);
+
+		l = gen_rand_text(ptr, sizeof(ptr));
+		err = ib_col_set_value(tpl, 2, ptr, l);
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_insert_row(crsr, tpl);
+		assert(err == DB_SUCCESS);
+
+		tpl = ib_tuple_clear(tpl);
+		assert(tpl != NULL);
+
+		/* Update or delete the first row. */
+		err = ib_cursor_set_lock_mode(crsr, IB_LOCK_X);
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_first(crsr);
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_read_row(crsr, tpl);
+		assert(err == DB_SUCCESS);
+
+		if (i % 2) {
+			err = ib_cursor_delete_row(crsr);
+			assert(err == DB_SUCCESS);
+		} else {
+			new_tpl = ib_clust_read_tuple_create(crsr);
+			assert(new_tpl != NULL);
+
+			err = ib_tuple_copy(new_tpl, tpl);
+			assert(err == DB_SUCCESS);
+
+			err = ib_tuple_read_i32(new_tpl, 0, &c1);
+			assert(err == DB_SUCCESS);
+
+			err = ib_tuple_write_i32(new_tpl, 0, c1 + 1);
+			assert(err == DB_SUCCESS);
+
+			err = ib_cursor_update_row(crsr, tpl, new_tpl);
+			assert(err == DB_SUCCESS);
+
+			ib_tuple_delete(new_tpl);
+		}
+
+		ib_tuple_delete(tpl);
+
+		err = ib_cursor_close(crsr);
+		assert(err == DB_SUCCESS);
+
+		if (i % 3) {
+			err = ib_trx_commit(ib_trx);
+		} else {
+			err = ib_trx_rollback(ib_trx);
+		}
+		assert(err == DB_SUCCESS);
+	}
+
+	return(NULL);
+}
+
 /*********************************************************************
 Create a secondary indexes on a table.
 @return	DB_SUCCESS or error code */
@@ -238,10 +377,13 @@ create_sec_index(
 
 	if (err == DB_SUCCESS) {
 		err = ib_trx_commit(ib_trx);
+		assert(err == DB_SUCCESS);
 	} else {
-		err = ib_trx_rollback(ib_trx);
+		ib_err_t	rollback_err;
+
+		rollback_err = ib_trx_rollback(ib_trx);
+		assert(rollback_err == DB_SUCCESS);
 	}
-	assert(err == DB_SUCCESS);
 
 	return(err);
 }
@@ -277,6 +419,31 @@ create_sec_index_1(
 	return(err);
 }
 
+/*********************************************************************
+Count the rows that a cursor reads.
+@return	number of rows */
+static
+int
+count_rows(
+/*=======*/
+	ib_crsr_t	crsr)		/*!< in: cusor */
+{
+	ib_err_t	err;
+	int		n_rows = 0;
+
+	err = ib_cursor_first(crsr);
+
+	while (err == DB_SUCCESS) {
+		++n_rows;
+
+		err = ib_cursor_next(crsr);
+	}
+
+	assert(err == DB_END_OF_INDEX || err == DB_RECORD_NOT_FOUND);
+
+	return(n_rows);
+}
+
 /*********************************************************************
 Open the secondary index. */
 static
@@ -292,6 +459,10 @@ open_sec_index(
 	err = ib_cursor_open_index_using_name(crsr, index_name, &idx_crsr);
 	assert(err == DB_SUCCESS);
 
+	/* The index must have an entry for each row, although the
+	rows were modified while the index was being created. */
+	assert(count_rows(crsr) == count_rows(idx_crsr));
+
 	err = ib_cursor_close(idx_crsr);
 	assert(err == DB_SUCCESS);
 
@@ -356,11 +527,419 @@ open_sec_index_1(
 	return(err);
 }
 
+/** A read view that is open while an index is being created. A
+transaction must be used by the thread that started it. */
+typedef struct {
+	ib_trx_t	ib_trx;		/*!< transaction */
+	int		n_rows;		/*!< number of rows it sees */
+} view_t;
+
+/** Set when delete_rows() should stop */
+static volatile int	delete_rows_stop;
+
+/** Number of read views that could not use the index on MVCC_TABLE */
+static int		n_unusable_views;
+
+/*********************************************************************
+Open a read view on MVCC_TABLE and count the rows in it. */
+static
+void
+open_view(
+/*======*/
+	view_t*		view)		/*!< out: read view */
+{
+	ib_err_t	err;
+	ib_crsr_t	crsr;
+
+	view->ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(view->ib_trx != NULL);
+
+	err = open_table(DATABASE, MVCC_TABLE, view->ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	view->n_rows = count_rows(crsr);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+}
+
+/*********************************************************************
+Read the index on MVCC_TABLE(c1) in a read view and close the view. The
+index must have all the rows of the read view, unless the read view
+cannot use it.
+@return	1 if the read view could not use the index, else 0 */
+static
+int
+check_view(
+/*=======*/
+	view_t*		view)		/*!< in/out: read view */
+{
+	int		unusable;
+	ib_err_t	err;
+	ib_crsr_t	crsr;
+	ib_crsr_t	idx_crsr;
+	char		index_name[IB_MAX_TABLE_NAME_LEN];
+
+	snprintf(index_name, sizeof(index_name), "%s/%s_c1",
+		 DATABASE, MVCC_TABLE);
+
+	err = open_table(DATABASE, MVCC_TABLE, view->ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_open_index_using_name(crsr, index_name, &idx_crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_first(idx_crsr);
+	unusable = err == DB_MISSING_HISTORY;
+
+	if (!unusable) {
+		assert(count_rows(idx_crsr) == view->n_rows);
+	}
+
+	err = ib_cursor_close(idx_crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(view->ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(unusable);
+}
+
+/*********************************************************************
+Keep deleting the first row of MVCC_TABLE while an index is being
+created on it, opening a read view before each delete. Read the index
+in those read views when told to stop.
+@return	NULL */
+static
+void*
+delete_rows(
+/*========*/
+	void*		arg)		/*!< in: unused */
+{
+	int		i;
+	int		n_views = 0;
+	ib_err_t	err;
+	view_t		views[N_VIEWS];
+
+	(void) arg;
+
+	while (!delete_rows_stop) {
+		ib_crsr_t	crsr;
+		ib_trx_t	ib_trx;
+
+		if (n_views < N_VIEWS) {
+			open_view(&views[n_views++]);
+		}
+
+		ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+		assert(ib_trx != NULL);
+
+		err = open_table(DATABASE, MVCC_TABLE, ib_trx, &crsr);
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_lock(crsr, IB_LOCK_IX);
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_set_lock_mode(crsr, IB_LOCK_X);
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_first(crsr);
+		assert(err == DB_SUCCESS || err == DB_END_OF_INDEX);
+
+		if (err == DB_SUCCESS) {
+			err = ib_cursor_delete_row(crsr);
+			assert(err == DB_SUCCESS);
+		}
+
+		err = ib_cursor_close(crsr);
+		assert(err == DB_SUCCESS);
+
+		err = ib_trx_commit(ib_trx);
+		assert(err == DB_SUCCESS);
+	}
+
+	for (i = 0; i < n_views; ++i) {
+		n_unusable_views += check_view(&views[i]);
+	}
+
+	printf("%d read views were opened during the index creation\n",
+	       n_views);
+
+	return(NULL);
+}
+
+/*********************************************************************
+Create an index online while another thread deletes rows and opens read
+views. The entries of the deleted rows are removed from the index, so
+that a read view that was opened before the index was completed must
+not use it. The other read views must find all their rows in it. */
+static
+ib_err_t
+test_online_mvcc(
+/*=============*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name)		/*!< in: table name */
+{
+	int		retval;
+	ib_err_t	err;
+	ib_crsr_t	crsr;
+	ib_trx_t	ib_trx;
+	view_t		view;
+	pthread_t	delete_thread;
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+
+	snprintf(table_name, sizeof(table_name), "%s/%s", dbname, name);
+
+	err = create_table(dbname, name);
+	assert(err == DB_SUCCESS);
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = open_table(dbname, name, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_lock(crsr, IB_LOCK_IX);
+	assert(err == DB_SUCCESS);
+
+	err = insert_random_rows(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	/* This read view is open before the index is created. */
+	open_view(&view);
+
+	retval = pthread_create(&delete_thread, NULL, delete_rows, NULL);
+	assert(retval == 0);
+
+	err = create_sec_index(table_name, "c1", 0);
+	assert(err == DB_SUCCESS);
+
+	delete_rows_stop = 1;
+
+	retval = pthread_join(delete_thread, NULL);
+	assert(retval == 0);
+
+	assert(check_view(&view));
+	++n_unusable_views;
+
+	/* This read view is open after the index was created. */
+	open_view(&view);
+	assert(!check_view(&view));
+
+	printf("%d read views could not use the new index\n",
+	       n_unusable_views);
+
+	return(drop_table(dbname, name));
+}
+
+#ifndef __WIN__
+/*********************************************************************
+CREATE TABLE T(c1 INT, c2 VARCHAR(10), PK(c1)); The internal SQL
+parser holds dict_sys->mutex while it executes a statement, so that it
+cannot insert into a table that has no primary key. */
+static
+ib_err_t
+create_sql_table(
+/*=============*/
+	const char*	dbname,			/*!< in: database name */
+	const char*	name)			/*!< in: table name */
+{
+	ib_trx_t	ib_trx;
+	ib_id_t		table_id = 0;
+	ib_err_t	err = DB_SUCCESS;
+	ib_tbl_sch_t	ib_tbl_sch = NULL;
+	ib_idx_sch_t	ib_idx_sch = NULL;
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+
+	snprintf(table_name, sizeof(table_name), "%s/%s", dbname, name);
+
+	err = ib_table_schema_create(
+		table_name, &ib_tbl_sch, IB_TBL_COMPACT, 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c1", IB_INT, IB_COL_NONE, 0, sizeof(ib_i32_t));
+	assert(err == DB_SUCCESS);
+
+	err = ib_tbl_sch_add_varchar_col(ib_tbl_sch, "c2", 10);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_index(ib_tbl_sch, "PRIMARY", &ib_idx_sch);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_add_col(ib_idx_sch, "c1", 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_set_clustered(ib_idx_sch);
+	assert(err == DB_SUCCESS);
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	err = ib_schema_lock_exclusive(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_create(ib_trx, ib_tbl_sch, &table_id);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	ib_table_schema_delete(ib_tbl_sch);
+
+	return(err);
+}
+
+/*********************************************************************
+INSERT INTO T VALUES(c1, 'c1'); using a prepared statement. */
+static
+ib_err_t
+exec_prepared_insert(
+/*=================*/
+	ib_sql_stmt_t*	stmt,		/*!< in/out: prepared INSERT */
+	const char*	table_name,	/*!< in: table name */
+	int		c1)		/*!< in: value of c1 */
+{
+	char		str[16];
+
+	snprintf(str, sizeof(str), "%d", c1);
+
+	return(ib_exec_prepared_sql(
+		stmt, 3,
+		IB_VARCHAR, "$t", table_name,
+		/* Integer literals are named without the ':' prefix. */
+		IB_INT, (ib_ulint_t) sizeof(ib_i32_t), (ib_ulint_t) IB_TRUE,
+		"c1", (ib_i32_t) c1,
+		IB_VARCHAR, ":c2", str));
+}
+
+/*********************************************************************
+Count the rows of a table, through its clustered index or through its
+secondary index on c2.
+@return	number of rows */
+static
+int
+count_table_rows(
+/*=============*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name,		/*!< in: table name */
+	ib_bool_t	sec_index)	/*!< in: IB_TRUE to count the
+					entries of the index on c2 */
+{
+	int		n_rows;
+	ib_err_t	err;
+	ib_crsr_t	crsr;
+	ib_crsr_t	idx_crsr;
+	ib_trx_t	ib_trx;
+	char		index_name[IB_MAX_TABLE_NAME_LEN];
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = open_table(dbname, name, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	if (sec_index) {
+		snprintf(index_name, sizeof(index_name), "%s/%s_c2",
+			 dbname, name);
+
+		err = ib_cursor_open_index_using_name(
+			crsr, index_name, &idx_crsr);
+		assert(err == DB_SUCCESS);
+
+		n_rows = count_rows(idx_crsr);
+
+		err = ib_cursor_close(idx_crsr);
+		assert(err == DB_SUCCESS);
+	} else {
+		n_rows = count_rows(crsr);
+	}
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(n_rows);
+}
+
+/*********************************************************************
+Execute a prepared statement with different values. The statement must
+be parsed again after an index is created on the table, or else the new
+index would miss the rows that it inserts, and after the table is
+dropped and created again. */
+static
+ib_err_t
+test_prepared_sql(
+/*==============*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name)		/*!< in: table name */
+{
+	ib_err_t	err;
+	ib_sql_stmt_t*	stmt;
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+
+	snprintf(table_name, sizeof(table_name), "%s/%s", dbname, name);
+
+	err = create_sql_table(dbname, name);
+	assert(err == DB_SUCCESS);
+
+	err = ib_sql_prepare(
+		"PROCEDURE P () IS\n"
+		"BEGIN\n"
+		"INSERT INTO $t VALUES (:c1, :c2);\n"
+		"END;\n", &stmt);
+	assert(err == DB_SUCCESS);
+
+	err = exec_prepared_insert(stmt, table_name, 1);
+	assert(err == DB_SUCCESS);
+
+	err = exec_prepared_insert(stmt, table_name, 2);
+	assert(err == DB_SUCCESS);
+
+	assert(count_table_rows(dbname, name, IB_FALSE) == 2);
+
+	err = create_sec_index(table_name, "c2", 0);
+	assert(err == DB_SUCCESS);
+
+	err = exec_prepared_insert(stmt, table_name, 3);
+	assert(err == DB_SUCCESS);
+
+	assert(count_table_rows(dbname, name, IB_FALSE) == 3);
+	assert(count_table_rows(dbname, name, IB_TRUE) == 3);
+
+	err = drop_table(dbname, name);
+	assert(err == DB_SUCCESS);
+
+	err = create_sql_table(dbname, name);
+	assert(err == DB_SUCCESS);
+
+	err = exec_prepared_insert(stmt, table_name, 4);
+	assert(err == DB_SUCCESS);
+
+	assert(count_table_rows(dbname, name, IB_FALSE) == 1);
+
+	ib_sql_free(stmt);
+
+	return(drop_table(dbname, name));
+}
+#endif /* !__WIN__ */
+
 int main(int argc, char* argv[])
 {
 	ib_err_t	err;
 	ib_crsr_t	crsr;
 	ib_trx_t	ib_trx;
+	int		retval;
+	pthread_t	modify_thread;
 
 	err = ib_init();
 	assert(err == DB_SUCCESS);
@@ -395,15 +974,32 @@ int main(int argc, char* argv[])
 	err = ib_trx_commit(ib_trx);
 	assert(err == DB_SUCCESS);
 
+	/* The indexes are created while the table is being modified. */
+	retval = pthread_create(&modify_thread, NULL, modify_rows, NULL);
+	assert(retval == 0);
+
 	err = create_sec_index_1(DATABASE, TABLE);
 	assert(err == DB_SUCCESS);
 
+	modify_rows_stop = 1;
+
+	retval = pthread_join(modify_thread, NULL);
+	assert(retval == 0);
+
 	err = open_sec_index_1(DATABASE, TABLE);
 	assert(err == DB_SUCCESS);
 
 	err = drop_table(DATABASE, TABLE);
 	assert(err == DB_SUCCESS);
 
+	err = test_online_mvcc(DATABASE, MVCC_TABLE);
+	assert(err == DB_SUCCESS);
+
+#ifndef __WIN__
+	err = test_prepared_sql(DATABASE, SQL_TABLE);
+	assert(err == DB_SUCCESS);
+#endif /* !__WIN__ */
+
 	err = ib_shutdown(IB_SHUTDOWN_NORMAL);
 	assert(err == DB_SUCCESS);
 
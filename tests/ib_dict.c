@@ -23,13 +23,20 @@ including the system tables.
  CREATE TABLE t1(C1 INT, C2 UNSIGNED INT, c3 VARCHAR(10) NOT NULL, PK(C1, C2)); 
  ...
  CREATE TABLE tn(C1 INT, C2 UNSIGNED INT, c3 VARCHAR(10) NOT NULL, PK(C1, C2)); 
- Print the schema using the API */
+ Print the schema using the API
+ Lower dict_cache_max_tables, wait for the tables to be evicted from
+ the dictionary cache and check that they can be reopened and read.
+ Open and close cursors on a cached table in several threads while
+ another thread creates, indexes, renames and drops it, and check that
+ DROP of a table that is in use is deferred until its handles are closed. */
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "test0aux.h"
 
@@ -39,6 +46,13 @@ including the system tables.
 
 #define DATABASE	"dict_test"
 #define TABLE		"t"
+#define HOT_TABLE	"h"
+#define RENAMED_TABLE	"r"
+#define N_CURSOR_THREADS 4
+#define N_DDL_CYCLES	10
+
+/* Set when the cursor threads of test_dict_handles() should stop */
+static volatile int	cursor_threads_stop;
 
 typedef struct visitor_arg {
 	FILE*		fp;
@@ -541,6 +555,532 @@ drop_table_n(
 	return(err);
 }
 
+/*********************************************************************
+Read a status variable.
+@return	value of the variable */
+static
+ib_i64_t
+get_status(
+/*=======*/
+	const char*	name)	/*!< in: status variable name */
+{
+	ib_i64_t	val;
+	ib_err_t	err;
+
+	err = ib_status_get_i64(name, &val);
+	assert(err == DB_SUCCESS);
+
+	return(val);
+}
+
+/*********************************************************************
+INSERT INTO D.Tn VALUES('n', 'n', n); and close the table.
+@return	DB_SUCCESS or error code */
+static
+ib_err_t
+insert_row_n(
+/*=========*/
+	const char*	dbname,	/*!< in: database name */
+	const char*	name,	/*!< in: table name */
+	int		n)	/*!< in: table suffix */
+{
+	ib_trx_t	ib_trx;
+	ib_crsr_t	crsr;
+	ib_tpl_t	tpl;
+	ib_err_t	err;
+	char		buf[16];
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+
+#ifdef __WIN__
+	sprintf(table_name, "%s/%s%d", dbname, name, n);
+	sprintf(buf, "%d", n);
+#else
+	snprintf(table_name, sizeof(table_name), "%s/%s%d", dbname, name, n);
+	snprintf(buf, sizeof(buf), "%d", n);
+#endif
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = ib_cursor_open_table(table_name, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_lock(crsr, IB_LOCK_IX);
+	assert(err == DB_SUCCESS);
+
+	tpl = ib_clust_read_tuple_create(crsr);
+	assert(tpl != NULL);
+
+	err = ib_col_set_value(tpl, 0, buf, strlen(buf));
+	assert(err == DB_SUCCESS);
+
+	err = ib_col_set_value(tpl, 1, buf, strlen(buf));
+	assert(err == DB_SUCCESS);
+
+	err = ib_tuple_write_u32(tpl, 2, n);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_insert_row(crsr, tpl);
+	assert(err == DB_SUCCESS);
+
+	ib_tuple_delete(tpl);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(err);
+}
+
+/*********************************************************************
+Open D.Tn and check that it contains the row written by insert_row_n().
+@return	DB_SUCCESS or error code */
+static
+ib_err_t
+read_row_n(
+/*=======*/
+	const char*	dbname,	/*!< in: database name */
+	const char*	name,	/*!< in: table name */
+	int		n)	/*!< in: table suffix */
+{
+	ib_trx_t	ib_trx;
+	ib_crsr_t	crsr;
+	ib_tpl_t	tpl;
+	ib_err_t	err;
+	ib_u32_t	c3;
+	char		buf[16];
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+
+#ifdef __WIN__
+	sprintf(table_name, "%s/%s%d", dbname, name, n);
+	sprintf(buf, "%d", n);
+#else
+	snprintf(table_name, sizeof(table_name), "%s/%s%d", dbname, name, n);
+	snprintf(buf, sizeof(buf), "%d", n);
+#endif
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = ib_cursor_open_table(table_name, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_first(crsr);
+	assert(err == DB_SUCCESS);
+
+	tpl = ib_clust_read_tuple_create(crsr);
+	assert(tpl != NULL);
+
+	err = ib_cursor_read_row(crsr, tpl);
+	assert(err == DB_SUCCESS);
+
+	assert(ib_col_get_len(tpl, 0) == strlen(buf));
+	assert(memcmp(ib_col_get_value(tpl, 0), buf, strlen(buf)) == 0);
+
+	assert(ib_col_get_len(tpl, 1) == strlen(buf));
+	assert(memcmp(ib_col_get_value(tpl, 1), buf, strlen(buf)) == 0);
+
+	err = ib_tuple_read_u32(tpl, 2, &c3);
+	assert(err == DB_SUCCESS);
+	assert(c3 == (ib_u32_t) n);
+
+	err = ib_cursor_next(crsr);
+	assert(err == DB_END_OF_INDEX);
+
+	ib_tuple_delete(tpl);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(err);
+}
+
+/*********************************************************************
+Shrink the dictionary cache so that the master thread evicts the
+closed tables, then reopen and read every table.
+@return	DB_SUCCESS or error code */
+static
+ib_err_t
+test_dict_cache_eviction(
+/*=====================*/
+	const char*	dbname,	/*!< in: database name */
+	const char*	name,	/*!< in: table name */
+	int		n_tables)/*!< in: number of tables */
+{
+	int		i;
+	ib_err_t	err;
+	ib_i64_t	evictions;
+	ib_i64_t	misses;
+
+	for (i = 0; i < n_tables; ++i) {
+		err = insert_row_n(dbname, name, i);
+		assert(err == DB_SUCCESS);
+	}
+
+	evictions = get_status("dict_cache_evictions");
+	misses = get_status("dict_cache_misses");
+
+	err = ib_cfg_set("dict_cache_max_tables", 1);
+	assert(err == DB_SUCCESS);
+
+	/* The master thread makes room in the cache about once a
+	second; the first pass may only clear the accessed bits. */
+	for (i = 0; i < 30; ++i) {
+		if (get_status("dict_cache_evictions")
+		    >= evictions + n_tables / 2) {
+
+			break;
+		}
+
+		sleep(1);
+	}
+
+	assert(get_status("dict_cache_evictions") > evictions);
+
+	err = ib_cfg_set("dict_cache_max_tables", 0);
+	assert(err == DB_SUCCESS);
+
+	/* The evicted tables are loaded again from SYS_TABLES. */
+	for (i = 0; i < n_tables; ++i) {
+		err = read_row_n(dbname, name, i);
+		assert(err == DB_SUCCESS);
+	}
+
+	assert(get_status("dict_cache_misses") > misses);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************
+Check whether D.Tn exists in the data dictionary.
+@return	IB_TRUE if the table exists */
+static
+ib_bool_t
+table_exists_n(
+/*===========*/
+	const char*	dbname,	/*!< in: database name */
+	const char*	name,	/*!< in: table name */
+	int		n)	/*!< in: table suffix */
+{
+	ib_err_t	err;
+	ib_id_t		table_id;
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+
+#ifdef __WIN__
+	sprintf(table_name, "%s/%s%d", dbname, name, n);
+#else
+	snprintf(table_name, sizeof(table_name), "%s/%s%d", dbname, name, n);
+#endif
+
+	err = ib_table_get_id(table_name, &table_id);
+	assert(err == DB_SUCCESS || err == DB_TABLE_NOT_FOUND);
+
+	return(err == DB_SUCCESS ? IB_TRUE : IB_FALSE);
+}
+
+/*********************************************************************
+Wait until the master thread has dropped D.Tn in the background. */
+static
+void
+wait_for_drop_n(
+/*============*/
+	const char*	dbname,	/*!< in: database name */
+	const char*	name,	/*!< in: table name */
+	int		n)	/*!< in: table suffix */
+{
+	int		i;
+
+	/* The master thread works through the background drop list
+	about once a second. */
+	for (i = 0; i < 60 && table_exists_n(dbname, name, n); ++i) {
+		sleep(1);
+	}
+
+	assert(!table_exists_n(dbname, name, n));
+}
+
+/*********************************************************************
+CREATE INDEX C3 ON D.Tn(C3);
+@return	DB_SUCCESS or error code */
+static
+ib_err_t
+create_sec_index_n(
+/*===============*/
+	const char*	dbname,	/*!< in: database name */
+	const char*	name,	/*!< in: table name */
+	int		n)	/*!< in: table suffix */
+{
+	ib_trx_t	ib_trx;
+	ib_err_t	err;
+	ib_id_t		index_id = 0;
+	ib_idx_sch_t	ib_idx_sch = NULL;
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+
+#ifdef __WIN__
+	sprintf(table_name, "%s/%s%d", dbname, name, n);
+#else
+	snprintf(table_name, sizeof(table_name), "%s/%s%d", dbname, name, n);
+#endif
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = ib_schema_lock_exclusive(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_create(ib_trx, "C3", table_name, &ib_idx_sch);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_add_col(ib_idx_sch, "C3", 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_create(ib_idx_sch, &index_id);
+	assert(err == DB_SUCCESS);
+
+	ib_index_schema_delete(ib_idx_sch);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(err);
+}
+
+/*********************************************************************
+RENAME TABLE D.Tn TO D.Rm;
+@return	DB_SUCCESS or error code */
+static
+ib_err_t
+rename_table_n(
+/*===========*/
+	const char*	dbname,	/*!< in: database name */
+	const char*	name,	/*!< in: table name */
+	int		n,	/*!< in: table suffix */
+	const char*	new_name,/*!< in: new table name */
+	int		m)	/*!< in: new table suffix */
+{
+	ib_trx_t	ib_trx;
+	ib_err_t	err;
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+	char		new_table_name[IB_MAX_TABLE_NAME_LEN];
+
+#ifdef __WIN__
+	sprintf(table_name, "%s/%s%d", dbname, name, n);
+	sprintf(new_table_name, "%s/%s%d", dbname, new_name, m);
+#else
+	snprintf(table_name, sizeof(table_name), "%s/%s%d", dbname, name, n);
+	snprintf(new_table_name, sizeof(new_table_name),
+		 "%s/%s%d", dbname, new_name, m);
+#endif
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = ib_schema_lock_exclusive(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_rename(ib_trx, table_name, new_table_name);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(err);
+}
+
+/*********************************************************************
+Open cursors on D.H0 and on its index C3 when they exist, read through
+them and close them, until cursor_threads_stop is set. The table may be
+renamed or dropped while the cursors are open.
+@return	NULL */
+static
+void*
+open_cursors(
+/*=========*/
+	void*		arg)	/*!< in: unused */
+{
+	ib_trx_t	ib_trx;
+	ib_crsr_t	crsr;
+	ib_crsr_t	index_crsr;
+	ib_err_t	err;
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+
+#ifdef __WIN__
+	sprintf(table_name, "%s/%s0", DATABASE, HOT_TABLE);
+#else
+	snprintf(table_name, sizeof(table_name), "%s/%s0", DATABASE, HOT_TABLE);
+#endif
+
+	while (!cursor_threads_stop) {
+		ib_trx = ib_trx_begin(IB_TRX_READ_COMMITTED);
+		assert(ib_trx != NULL);
+
+		err = ib_cursor_open_table(table_name, ib_trx, &crsr);
+		assert(err == DB_SUCCESS || err == DB_TABLE_NOT_FOUND);
+
+		if (err == DB_SUCCESS) {
+			err = ib_cursor_first(crsr);
+			assert(err == DB_SUCCESS || err == DB_END_OF_INDEX);
+
+			/* Let the DDL run while the table is in use. */
+			usleep(100);
+
+			err = ib_cursor_open_index_using_name(
+				crsr, "C3", &index_crsr);
+			assert(err == DB_SUCCESS || err == DB_TABLE_NOT_FOUND);
+
+			if (err == DB_SUCCESS) {
+				err = ib_cursor_first(index_crsr);
+				assert(err == DB_SUCCESS
+				       || err == DB_END_OF_INDEX
+				       || err == DB_MISSING_HISTORY);
+
+				err = ib_cursor_close(index_crsr);
+				assert(err == DB_SUCCESS);
+			}
+
+			err = ib_cursor_close(crsr);
+			assert(err == DB_SUCCESS);
+		}
+
+		err = ib_trx_commit(ib_trx);
+		assert(err == DB_SUCCESS);
+	}
+
+	return(NULL);
+}
+
+/*********************************************************************
+Open and close cursors on D.H0 in several threads while this thread
+creates, indexes, renames and drops the table. Check that the handle
+counts return to zero, so that every drop completes, and that a table
+is not dropped while a cursor is open on it.
+@return	DB_SUCCESS or error code */
+static
+ib_err_t
+test_dict_handles(
+/*==============*/
+	const char*	dbname)	/*!< in: database name */
+{
+	int		i;
+	ib_err_t	err;
+	ib_trx_t	ib_trx;
+	ib_crsr_t	crsr;
+	ib_tpl_t	tpl;
+	ib_u32_t	c3;
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+	pthread_t	threads[N_CURSOR_THREADS];
+
+	cursor_threads_stop = 0;
+
+	for (i = 0; i < N_CURSOR_THREADS; ++i) {
+		int	ret;
+
+		ret = pthread_create(&threads[i], NULL, open_cursors, NULL);
+		assert(ret == 0);
+	}
+
+	/* DROP returns at once when the table is in use, and the master
+	thread drops the table after its last handle is closed. */
+	for (i = 0; i < N_DDL_CYCLES; ++i) {
+		err = create_table(dbname, HOT_TABLE, 0);
+		assert(err == DB_SUCCESS);
+
+		err = insert_row_n(dbname, HOT_TABLE, 0);
+		assert(err == DB_SUCCESS);
+
+		err = create_sec_index_n(dbname, HOT_TABLE, 0);
+		assert(err == DB_SUCCESS);
+
+		err = rename_table_n(dbname, HOT_TABLE, 0, RENAMED_TABLE, i);
+		assert(err == DB_SUCCESS);
+
+		err = drop_table_n(dbname, RENAMED_TABLE, i);
+		assert(err == DB_SUCCESS);
+	}
+
+	cursor_threads_stop = 1;
+
+	for (i = 0; i < N_CURSOR_THREADS; ++i) {
+		int	ret;
+
+		ret = pthread_join(threads[i], NULL);
+		assert(ret == 0);
+	}
+
+	for (i = 0; i < N_DDL_CYCLES; ++i) {
+		wait_for_drop_n(dbname, RENAMED_TABLE, i);
+	}
+
+	/* Without open handles the table is dropped at once. */
+	err = create_table(dbname, HOT_TABLE, 0);
+	assert(err == DB_SUCCESS);
+
+	err = insert_row_n(dbname, HOT_TABLE, 0);
+	assert(err == DB_SUCCESS);
+
+	err = read_row_n(dbname, HOT_TABLE, 0);
+	assert(err == DB_SUCCESS);
+
+	err = drop_table_n(dbname, HOT_TABLE, 0);
+	assert(err == DB_SUCCESS);
+
+	assert(!table_exists_n(dbname, HOT_TABLE, 0));
+
+	/* With a cursor open the table stays readable after DROP. */
+	err = create_table(dbname, HOT_TABLE, 0);
+	assert(err == DB_SUCCESS);
+
+	err = insert_row_n(dbname, HOT_TABLE, 0);
+	assert(err == DB_SUCCESS);
+
+#ifdef __WIN__
+	sprintf(table_name, "%s/%s0", dbname, HOT_TABLE);
+#else
+	snprintf(table_name, sizeof(table_name), "%s/%s0", dbname, HOT_TABLE);
+#endif
+
+	ib_trx = ib_trx_begin(IB_TRX_READ_COMMITTED);
+	assert(ib_trx != NULL);
+
+	err = ib_cursor_open_table(table_name, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	err = drop_table_n(dbname, HOT_TABLE, 0);
+	assert(err == DB_SUCCESS);
+
+	assert(table_exists_n(dbname, HOT_TABLE, 0));
+
+	err = ib_cursor_first(crsr);
+	assert(err == DB_SUCCESS);
+
+	tpl = ib_clust_read_tuple_create(crsr);
+	assert(tpl != NULL);
+
+	err = ib_cursor_read_row(crsr, tpl);
+	assert(err == DB_SUCCESS);
+
+	err = ib_tuple_read_u32(tpl, 2, &c3);
+	assert(err == DB_SUCCESS);
+	assert(c3 == 0);
+
+	ib_tuple_delete(tpl);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	wait_for_drop_n(dbname, HOT_TABLE, 0);
+
+	return(DB_SUCCESS);
+}
+
 int
 main(int argc, char* argv[])
 {
@@ -568,6 +1108,12 @@ main(int argc, char* argv[])
 	err = print_entire_schema();
 	assert(err == DB_SUCCESS);
 
+	err = test_dict_cache_eviction(DATABASE, TABLE, 10);
+	assert(err == DB_SUCCESS);
+
+	err = test_dict_handles(DATABASE);
+	assert(err == DB_SUCCESS);
+
 	for (i = 0; i < 10; ++i) {
 		err = drop_table_n(DATABASE, TABLE, i);
 		assert(err == DB_SUCCESS);
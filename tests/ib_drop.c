@@ -22,6 +22,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  CREATE TABLE D.T1(c1 INT); 
  ...
  CREATE TABLE D.Tn(c1 INT); 
+ Open and close the tables, checking that the closed cursors are reused
+ until an index is created and that the oldest ones are evicted.
+ Lower open_files below the number of tables, then fill all the
+ tables and read them back.
  DROP DATABASE D;
  
  InnoDB should drop all tables and remove the underlying directory.
@@ -34,6 +38,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef __linux__
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
 #include "test0aux.h"
 
 #ifdef UNIV_DEBUG_VALGRIND
@@ -43,6 +52,15 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #define DATABASE	"drop_test"
 #define TABLE		"t"
 
+/* More tables than the number of closed cursors that the API caches */
+#define N_TABLES	70
+
+/* Fewer than N_TABLES, and the smallest value that open_files accepts */
+#define N_OPEN_FILES	10
+
+/* Enough rows that all the tables do not fit in the buffer pool */
+#define N_ROWS		2000
+
 /*********************************************************************
 Create an InnoDB database (sub-directory). */
 static
@@ -137,6 +155,361 @@ open_table(
 	return(err);
 }
 
+/*********************************************************************
+Read a status variable.
+@return	value of the variable */
+static
+ib_i64_t
+get_status(
+/*=======*/
+	const char*	name)	/*!< in: status variable name */
+{
+	ib_i64_t	val;
+	ib_err_t	err;
+
+	err = ib_status_get_i64(name, &val);
+	assert(err == DB_SUCCESS);
+
+	return(val);
+}
+
+/*********************************************************************
+Open and close a cursor on D.Tn. */
+static
+ib_err_t
+open_close_table(
+/*=============*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name,		/*!< in: table name */
+	int		n)		/*!< in: table suffix */
+{
+	ib_err_t	err;
+	ib_crsr_t	crsr;
+	ib_trx_t	ib_trx;
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = open_table(dbname, name, n, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	/* A reused cursor must still work. */
+	err = ib_cursor_first(crsr);
+	assert(err == DB_END_OF_INDEX);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(err);
+}
+
+/*********************************************************************
+CREATE INDEX Tn_c1 ON D.Tn(c1); */
+static
+ib_err_t
+create_sec_index(
+/*=============*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name,		/*!< in: table name */
+	int		n)		/*!< in: table suffix */
+{
+	ib_err_t	err;
+	ib_trx_t	ib_trx;
+	ib_id_t		index_id = 0;
+	ib_idx_sch_t	ib_idx_sch = NULL;
+	char		index_name[IB_MAX_TABLE_NAME_LEN];
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+
+#ifdef __WIN__
+	sprintf(table_name, "%s/%s%d", dbname, name, n);
+	sprintf(index_name, "%s%d_c1", name, n);
+#else
+	snprintf(table_name, sizeof(table_name), "%s/%s%d", dbname, name, n);
+	snprintf(index_name, sizeof(index_name), "%s%d_c1", name, n);
+#endif
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+
+	err = ib_schema_lock_exclusive(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_create(
+		ib_trx, index_name, table_name, &ib_idx_sch);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_add_col(ib_idx_sch, "c1", 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_create(ib_idx_sch, &index_id);
+	assert(err == DB_SUCCESS);
+
+	ib_index_schema_delete(ib_idx_sch);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(err);
+}
+
+/*********************************************************************
+Check that the cursor of a table that was closed is reused when the
+table is opened again, but not after an index was created on the table,
+and that opening many tables evicts the least recently closed cursors. */
+static
+ib_err_t
+test_cursor_cache(
+/*==============*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name)		/*!< in: table name */
+{
+	int		i;
+	ib_err_t	err;
+	ib_i64_t	hits;
+	ib_i64_t	misses;
+	ib_i64_t	evictions;
+
+	/* Reopening the same table reuses its cursor. */
+	err = open_close_table(dbname, name, 0);
+	assert(err == DB_SUCCESS);
+
+	hits = get_status("cursor_cache_hits");
+	misses = get_status("cursor_cache_misses");
+
+	err = open_close_table(dbname, name, 0);
+	assert(err == DB_SUCCESS);
+
+	assert(get_status("cursor_cache_hits") == hits + 1);
+	assert(get_status("cursor_cache_misses") == misses);
+
+	/* The cached cursor was built for the old set of indexes. */
+	err = create_sec_index(dbname, name, 0);
+	assert(err == DB_SUCCESS);
+
+	err = open_close_table(dbname, name, 0);
+	assert(err == DB_SUCCESS);
+
+	assert(get_status("cursor_cache_hits") == hits + 1);
+	assert(get_status("cursor_cache_misses") == misses + 1);
+
+	err = open_close_table(dbname, name, 0);
+	assert(err == DB_SUCCESS);
+
+	assert(get_status("cursor_cache_hits") == hits + 2);
+
+	/* Only the most recently closed cursors are kept. */
+	evictions = get_status("cursor_cache_evictions");
+
+	for (i = 0; i < N_TABLES; i++) {
+		err = open_close_table(dbname, name, i);
+		assert(err == DB_SUCCESS);
+	}
+
+	assert(get_status("cursor_cache_evictions") > evictions);
+
+	/* T0 was closed first, so its cursor was evicted. */
+	hits = get_status("cursor_cache_hits");
+
+	err = open_close_table(dbname, name, 0);
+	assert(err == DB_SUCCESS);
+
+	assert(get_status("cursor_cache_hits") == hits);
+
+	err = open_close_table(dbname, name, N_TABLES - 1);
+	assert(err == DB_SUCCESS);
+
+	assert(get_status("cursor_cache_hits") == hits + 1);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************
+INSERT INTO D.Tn VALUES(0), ..., (N_ROWS - 1); */
+static
+ib_err_t
+insert_rows(
+/*========*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name,		/*!< in: table name */
+	int		n)		/*!< in: table suffix */
+{
+	int		i;
+	ib_err_t	err;
+	ib_crsr_t	crsr;
+	ib_trx_t	ib_trx;
+	ib_tpl_t	tpl;
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = open_table(dbname, name, n, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_lock(crsr, IB_LOCK_IX);
+	assert(err == DB_SUCCESS);
+
+	tpl = ib_clust_read_tuple_create(crsr);
+	assert(tpl != NULL);
+
+	for (i = 0; i < N_ROWS; i++) {
+		err = ib_tuple_write_u32(tpl, 0, i);
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_insert_row(crsr, tpl);
+		assert(err == DB_SUCCESS);
+	}
+
+	ib_tuple_delete(tpl);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(err);
+}
+
+/*********************************************************************
+SELECT * FROM D.Tn; and check that it returns the rows of insert_rows(). */
+static
+ib_err_t
+check_rows(
+/*=======*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name,		/*!< in: table name */
+	int		n)		/*!< in: table suffix */
+{
+	int		n_rows = 0;
+	ib_u64_t	sum = 0;
+	ib_err_t	err;
+	ib_crsr_t	crsr;
+	ib_trx_t	ib_trx;
+	ib_tpl_t	tpl;
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = open_table(dbname, name, n, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	tpl = ib_clust_read_tuple_create(crsr);
+	assert(tpl != NULL);
+
+	for (err = ib_cursor_first(crsr);
+	     err == DB_SUCCESS;
+	     err = ib_cursor_next(crsr)) {
+
+		ib_u32_t	c1;
+
+		err = ib_cursor_read_row(crsr, tpl);
+		assert(err == DB_SUCCESS);
+
+		err = ib_tuple_read_u32(tpl, 0, &c1);
+		assert(err == DB_SUCCESS);
+
+		sum += c1;
+		++n_rows;
+	}
+
+	assert(err == DB_END_OF_INDEX);
+	assert(n_rows == N_ROWS);
+	assert(sum == (ib_u64_t) N_ROWS * (N_ROWS - 1) / 2);
+
+	ib_tuple_delete(tpl);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(err);
+}
+
+#ifdef __linux__
+/*********************************************************************
+Count the .ibd files that this process has open.
+@return	number of open .ibd files */
+static
+int
+count_open_ibd_files(void)
+/*======================*/
+{
+	int		n_files = 0;
+	DIR*		dir;
+	struct dirent*	entry;
+
+	dir = opendir("/proc/self/fd");
+	assert(dir != NULL);
+
+	while ((entry = readdir(dir)) != NULL) {
+		ssize_t	len;
+		char	path[sizeof("/proc/self/fd/") + sizeof(entry->d_name)];
+		char	target[1024];
+
+		snprintf(path, sizeof(path), "/proc/self/fd/%s", entry->d_name);
+
+		len = readlink(path, target, sizeof(target) - 1);
+
+		if (len > 0) {
+			target[len] = 0;
+
+			if (strstr(target, ".ibd") != NULL) {
+				++n_files;
+			}
+		}
+	}
+
+	closedir(dir);
+
+	return(n_files);
+}
+#endif /* __linux__ */
+
+/*********************************************************************
+Lower open_files while the engine is running, below the number of
+tablespaces, and check that all the tables can still be written and
+read back while their files are closed and opened again. */
+static
+ib_err_t
+test_open_files(
+/*============*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name)		/*!< in: table name */
+{
+	int		i;
+	ib_err_t	err;
+	ib_ulint_t	val;
+
+	err = ib_cfg_set("open_files", N_OPEN_FILES);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cfg_get("open_files", &val);
+	assert(err == DB_SUCCESS);
+	assert(val == N_OPEN_FILES);
+
+	for (i = 0; i < N_TABLES; i++) {
+		err = insert_rows(dbname, name, i);
+		assert(err == DB_SUCCESS);
+	}
+
+	/* Read the tables twice: the second pass must read back the
+	pages that the first pass evicted from the buffer pool. */
+	for (i = 0; i < 2 * N_TABLES; i++) {
+		err = check_rows(dbname, name, i % N_TABLES);
+		assert(err == DB_SUCCESS);
+	}
+
+#ifdef __linux__
+	assert(count_open_ibd_files() <= N_OPEN_FILES);
+#endif /* __linux__ */
+
+	return(DB_SUCCESS);
+}
+
 int main(int argc, char* argv[])
 {
 	int		i;
@@ -156,7 +529,7 @@ int main(int argc, char* argv[])
 	assert(err == DB_SUCCESS);
 
 	/* Create the tables. */
-	for (i = 0; i < 10; i++) {
+	for (i = 0; i < N_TABLES; i++) {
 		err = create_table(DATABASE, TABLE, i);
 		assert(err == DB_SUCCESS);
 	}
@@ -165,7 +538,7 @@ int main(int argc, char* argv[])
 	assert(ib_trx != NULL);
 
 	/* Open and close the cursor. */
-	for (i = 0; i < 10; i++) {
+	for (i = 0; i < N_TABLES; i++) {
 		err = open_table(DATABASE, TABLE, i, ib_trx, &crsr);
 		assert(err == DB_SUCCESS);
 
@@ -177,6 +550,12 @@ int main(int argc, char* argv[])
 	err = ib_trx_commit(ib_trx);
 	assert(err == DB_SUCCESS);
 
+	err = test_cursor_cache(DATABASE, TABLE);
+	assert(err == DB_SUCCESS);
+
+	err = test_open_files(DATABASE, TABLE);
+	assert(err == DB_SUCCESS);
+
 	err = ib_database_drop(DATABASE);
 	assert(err == DB_SUCCESS);
 
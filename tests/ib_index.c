@@ -32,6 +32,15 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  Test whether we catch attempts to create prefix length indexes on
  INT, FLOAT, DOUBLE and DECIMAL column types.
 
+ CREATE TABLE T2(c1 INT, c2 VARCHAR(16), c3 CHAR(16), PRIMARY KEY(c1));
+ INSERT INTO T2 VALUES(...); -- NULLs and strings that differ only in
+ trailing spaces
+ CREATE INDEX T2_C2 ON T2(c2);
+ CREATE INDEX T2_C3 ON T2(c3);
+ Check the order and the number of the entries in the new indexes.
+ Repeat with enough rows that the entries of each index are sorted in
+ several runs by several threads, and merged.
+
  The test will create all the relevant sub-directories in the current
  working directory. */
 
@@ -48,6 +57,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #define DATABASE	"test"
 #define TABLE		"t"
+#define TABLE2		"t2"
+
+/* Number of rows in TABLE2, enough that the index entries are sorted
+by their sort keys in row0merge.c */
+#define N_ROWS2		256
+
+/* Size of a sort buffer, the smallest that sort_buffer_size accepts */
+#define SORT_BUFFER_SIZE	65536
+
+/* Number of rows in TABLE2 whose index entries do not fit in one sort
+buffer */
+#define N_ROWS3		20000
 
 /*********************************************************************
 Create an InnoDB database (sub-directory). */
@@ -237,6 +258,416 @@ insert_rows(
 	ib_tuple_delete(tpl);
 }
 
+/*********************************************************************
+CREATE TABLE T2(c1 INT, c2 VARCHAR(16), c3 CHAR(16), PRIMARY KEY(c1)); */
+static
+ib_err_t
+create_table2(
+/*==========*/
+	const char*	dbname,			/*!< in: database name */
+	const char*	name)			/*!< in: table name */
+{
+	ib_trx_t	ib_trx;
+	ib_id_t		table_id = 0;
+	ib_err_t	err = DB_SUCCESS;
+	ib_tbl_sch_t	ib_tbl_sch = NULL;
+	ib_idx_sch_t	ib_idx_sch = NULL;
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+
+#ifdef __WIN__
+	sprintf(table_name, "%s/%s", dbname, name);
+#else
+	snprintf(table_name, sizeof(table_name), "%s/%s", dbname, name);
+#endif
+
+	err = ib_table_schema_create(
+		table_name, &ib_tbl_sch, IB_TBL_COMPACT, 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c1", IB_INT, IB_COL_UNSIGNED, 0,
+		sizeof(ib_u32_t));
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c2", IB_VARCHAR, IB_COL_NONE, 0, 16);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_col(
+		ib_tbl_sch, "c3", IB_CHAR, IB_COL_NONE, 0, 16);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_schema_add_index(ib_tbl_sch, "PRIMARY", &ib_idx_sch);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_add_col(ib_idx_sch, "c1", 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_set_clustered(ib_idx_sch);
+	assert(err == DB_SUCCESS);
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	err = ib_schema_lock_exclusive(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	err = ib_table_create(ib_trx, ib_tbl_sch, &table_id);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	ib_table_schema_delete(ib_tbl_sch);
+
+	return(err);
+}
+
+/*********************************************************************
+Insert n_rows rows into T2. The values of c2 and c3 are NULLs, empty
+strings, strings that differ only in trailing spaces, strings that end
+in a byte that sorts before the space, and strings that only differ
+after the first 7 bytes. */
+static
+void
+insert_rows2(
+/*=========*/
+	ib_crsr_t	crsr,		/*!< in, out: cursor to use for write */
+	int		n_rows)		/*!< in: number of rows */
+{
+	int		i;
+	ib_tpl_t	tpl;
+	ib_err_t	err;
+
+	tpl = ib_clust_read_tuple_create(crsr);
+	assert(tpl != NULL);
+
+	for (i = 0; i < n_rows; i++) {
+		char		str[32];
+		ib_ulint_t	len;
+		int		base = (i / 8) % 16;
+
+		/* Use a different mix of values in each column. */
+		switch (i % 8) {
+		case 0:
+			len = IB_SQL_NULL;
+			break;
+		case 1:
+			len = snprintf(str, sizeof(str), "v%02d", base);
+			break;
+		case 2:
+			len = snprintf(str, sizeof(str), "v%02d ", base);
+			break;
+		case 3:
+			len = snprintf(str, sizeof(str), "v%02d   ", base);
+			break;
+		case 4:
+			len = snprintf(str, sizeof(str), "v%02d\001", base);
+			break;
+		case 5:
+			len = 0;
+			break;
+		case 6:
+			len = snprintf(str, sizeof(str), "long prefix %02d",
+				       base);
+			break;
+		default:
+			len = snprintf(str, sizeof(str), "v%02da", base);
+			break;
+		}
+
+		err = ib_tuple_write_u32(tpl, 0, i);
+		assert(err == DB_SUCCESS);
+
+		err = ib_col_set_value(
+			tpl, 1, len == IB_SQL_NULL ? NULL : str, len);
+		assert(err == DB_SUCCESS);
+
+		/* Shift the values of c3 relative to those of c2. */
+		if (len != IB_SQL_NULL && (i % 3) == 0) {
+			str[len++] = ' ';
+		}
+
+		err = ib_col_set_value(
+			tpl, 2, len == IB_SQL_NULL ? NULL : str, len);
+		assert(err == DB_SUCCESS);
+
+		err = ib_cursor_insert_row(crsr, tpl);
+		assert(err == DB_SUCCESS);
+
+		tpl = ib_tuple_clear(tpl);
+		assert(tpl != NULL);
+	}
+
+	ib_tuple_delete(tpl);
+}
+
+/*********************************************************************
+CREATE INDEX T2_Cn ON T2(cn); */
+static
+ib_err_t
+create_sec_index2(
+/*==============*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name,		/*!< in: table name */
+	const char*	col_name)	/*!< in: column name */
+{
+	ib_err_t	err;
+	ib_trx_t	ib_trx;
+	ib_id_t		index_id = 0;
+	ib_idx_sch_t	ib_idx_sch = NULL;
+	char		index_name[IB_MAX_TABLE_NAME_LEN];
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+
+#ifdef __WIN__
+	sprintf(table_name, "%s/%s", dbname, name);
+	sprintf(index_name, "%s_%s", name, col_name);
+#else
+	snprintf(table_name, sizeof(table_name), "%s/%s", dbname, name);
+	snprintf(index_name, sizeof(index_name), "%s_%s", name, col_name);
+#endif
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+
+	err = ib_schema_lock_exclusive(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_create(
+		ib_trx, index_name, table_name, &ib_idx_sch);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_schema_add_col(ib_idx_sch, col_name, 0);
+	assert(err == DB_SUCCESS);
+
+	err = ib_index_create(ib_idx_sch, &index_id);
+	assert(err == DB_SUCCESS);
+
+	ib_index_schema_delete(ib_idx_sch);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(err);
+}
+
+/*********************************************************************
+Compare two string values the way InnoDB compares latin1 strings: the
+shorter one is padded with spaces, and SQL NULL is the smallest value.
+@return	1, 0, -1, if a is greater, equal, less than b, respectively */
+static
+int
+cmp_padded(
+/*=======*/
+	const ib_byte_t*	a,	/*!< in: value */
+	ib_ulint_t		a_len,	/*!< in: length or IB_SQL_NULL */
+	const ib_byte_t*	b,	/*!< in: value */
+	ib_ulint_t		b_len)	/*!< in: length or IB_SQL_NULL */
+{
+	ib_ulint_t	i;
+
+	if (a_len == IB_SQL_NULL || b_len == IB_SQL_NULL) {
+		return((a_len != IB_SQL_NULL) - (b_len != IB_SQL_NULL));
+	}
+
+	for (i = 0; i < a_len || i < b_len; i++) {
+		int	a_byte = i < a_len ? a[i] : ' ';
+		int	b_byte = i < b_len ? b[i] : ' ';
+
+		if (a_byte != b_byte) {
+			return(a_byte > b_byte ? 1 : -1);
+		}
+	}
+
+	return(0);
+}
+
+/*********************************************************************
+Check that the entries of the index T2_Cn on T2(cn) are in the order of
+(cn, c1) and that there is one for each row.
+@return	number of index entries */
+static
+int
+check_sec_index2(
+/*=============*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name,		/*!< in: table name */
+	const char*	col_name,	/*!< in: column name */
+	ib_ulint_t	col_no)		/*!< in: column number of cn */
+{
+	int		n_rows = 0;
+	ib_err_t	err;
+	ib_trx_t	ib_trx;
+	ib_crsr_t	crsr;
+	ib_crsr_t	idx_crsr;
+	ib_tpl_t	tpl;
+	ib_u32_t	prev_c1 = 0;
+	ib_byte_t	prev[32];
+	ib_ulint_t	prev_len = IB_SQL_NULL;
+	char		table_name[IB_MAX_TABLE_NAME_LEN];
+	char		index_name[IB_MAX_TABLE_NAME_LEN];
+
+#ifdef __WIN__
+	sprintf(table_name, "%s/%s", dbname, name);
+	sprintf(index_name, "%s_%s", name, col_name);
+#else
+	snprintf(table_name, sizeof(table_name), "%s/%s", dbname, name);
+	snprintf(index_name, sizeof(index_name), "%s_%s", name, col_name);
+#endif
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = ib_cursor_open_table(table_name, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_open_index_using_name(crsr, index_name, &idx_crsr);
+	assert(err == DB_SUCCESS);
+
+	ib_cursor_set_cluster_access(idx_crsr);
+
+	/* The columns of a row tuple are in the order of the table. */
+	tpl = ib_clust_read_tuple_create(idx_crsr);
+	assert(tpl != NULL);
+
+	for (err = ib_cursor_first(idx_crsr);
+	     err == DB_SUCCESS;
+	     err = ib_cursor_next(idx_crsr)) {
+
+		ib_u32_t		c1;
+		ib_ulint_t		len;
+		const ib_byte_t*	val;
+
+		err = ib_cursor_read_row(idx_crsr, tpl);
+		assert(err == DB_SUCCESS);
+
+		len = ib_col_get_len(tpl, col_no);
+		val = ib_col_get_value(tpl, col_no);
+
+		err = ib_tuple_read_u32(tpl, 0, &c1);
+		assert(err == DB_SUCCESS);
+
+		if (n_rows > 0) {
+			int	ret = cmp_padded(prev, prev_len, val, len);
+
+			assert(ret < 0 || (ret == 0 && prev_c1 < c1));
+		}
+
+		assert(len == IB_SQL_NULL || len <= sizeof(prev));
+
+		if (len != IB_SQL_NULL) {
+			memcpy(prev, val, len);
+		}
+
+		prev_len = len;
+		prev_c1 = c1;
+		++n_rows;
+
+		tpl = ib_tuple_clear(tpl);
+		assert(tpl != NULL);
+	}
+
+	assert(err == DB_END_OF_INDEX);
+
+	ib_tuple_delete(tpl);
+
+	err = ib_cursor_close(idx_crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(n_rows);
+}
+
+/*********************************************************************
+SELECT COUNT(*) FROM T2;
+@return	number of rows in the clustered index */
+static
+int
+count_rows2(
+/*========*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name)		/*!< in: table name */
+{
+	int		n_rows = 0;
+	ib_err_t	err;
+	ib_trx_t	ib_trx;
+	ib_crsr_t	crsr;
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = open_table(dbname, name, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	for (err = ib_cursor_first(crsr);
+	     err == DB_SUCCESS;
+	     err = ib_cursor_next(crsr)) {
+
+		++n_rows;
+	}
+
+	assert(err == DB_END_OF_INDEX);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(n_rows);
+}
+
+/*********************************************************************
+Create indexes on the VARCHAR and CHAR columns of T2, whose entries
+are sorted by the sort keys of their first field, and check them. */
+static
+void
+test_sort_keys(
+/*===========*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name,		/*!< in: table name */
+	int		n_rows)		/*!< in: number of rows to insert */
+{
+	ib_err_t	err;
+	ib_crsr_t	crsr;
+	ib_trx_t	ib_trx;
+
+	err = create_table2(dbname, name);
+	assert(err == DB_SUCCESS);
+
+	ib_trx = ib_trx_begin(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = open_table(dbname, name, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_lock(crsr, IB_LOCK_IX);
+	assert(err == DB_SUCCESS);
+
+	insert_rows2(crsr, n_rows);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	err = create_sec_index2(dbname, name, "c2");
+	assert(err == DB_SUCCESS);
+
+	err = create_sec_index2(dbname, name, "c3");
+	assert(err == DB_SUCCESS);
+
+	assert(count_rows2(dbname, name) == n_rows);
+	assert(check_sec_index2(dbname, name, "c2", 1) == n_rows);
+	assert(check_sec_index2(dbname, name, "c3", 2) == n_rows);
+
+	err = drop_table(dbname, name);
+	assert(err == DB_SUCCESS);
+}
+
 int main(int argc, char* argv[])
 {
 	ib_err_t	err;
@@ -255,6 +686,9 @@ int main(int argc, char* argv[])
 
 	test_configure();
 
+	err = ib_cfg_set_int("sort_buffer_size", SORT_BUFFER_SIZE);
+	assert(err == DB_SUCCESS);
+
 	err = ib_startup("barracuda");
 	assert(err == DB_SUCCESS);
 
@@ -285,6 +719,14 @@ int main(int argc, char* argv[])
 	err = drop_table(DATABASE, TABLE);
 	assert(err == DB_SUCCESS);
 
+	test_sort_keys(DATABASE, TABLE2, N_ROWS2);
+
+	/* Sort the runs of the indexes in parallel and merge them. */
+	err = ib_cfg_set_int("sort_threads", 4);
+	assert(err == DB_SUCCESS);
+
+	test_sort_keys(DATABASE, TABLE2, N_ROWS3);
+
 	err = ib_shutdown(IB_SHUTDOWN_NORMAL);
 	assert(err == DB_SUCCESS);
 
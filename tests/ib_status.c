@@ -18,6 +18,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 ************************************************************************/
 #include <stdio.h>
 #include <assert.h>
+#include <string.h>
 
 #include "innodb.h"
 
@@ -71,6 +72,45 @@ get_all()
 		"lock_total_wait_time_in_secs",
 		"lock_wait_time_avg_in_secs",
 		"lock_max_wait_time_in_secs",
+		"lock_deadlock_checks",
+		"lock_deadlocks",
+		"lock_deadlock_search_too_long",
+		"lock_deadlock_check_time_in_us",
+		"lock_deadlock_check_max_time_in_us",
+		"lock_rec_hash_cells",
+		"lock_rec_hash_searches",
+		"lock_rec_hash_chain_steps",
+		"lock_rec_hash_max_chain_steps",
+		"lock_rec_nolock_checks",
+
+		/* Memory heaps */
+		"mem_heap_block_cache_hits",
+		"mem_heap_block_cache_misses",
+
+		/* Dictionary cache */
+		"dict_cache_tables",
+		"dict_cache_hits",
+		"dict_cache_misses",
+		"dict_cache_evictions",
+
+		/* Cursor cache */
+		"cursor_cache_hits",
+		"cursor_cache_misses",
+		"cursor_cache_evictions",
+
+		/* Mutex and rw-lock spin waits */
+		"sync_mutex_spin_waits",
+		"sync_mutex_spin_rounds",
+		"sync_mutex_os_waits",
+		"sync_mutex_os_yields",
+		"sync_rw_shared_spin_waits",
+		"sync_rw_shared_spin_rounds",
+		"sync_rw_shared_os_waits",
+		"sync_rw_shared_os_yields",
+		"sync_rw_excl_spin_waits",
+		"sync_rw_excl_spin_rounds",
+		"sync_rw_excl_os_waits",
+		"sync_rw_excl_os_yields",
 
 		/* Row operations */
 		"row_total_read",
@@ -97,6 +137,104 @@ get_all()
 	}
 }
 
+/** Maximum number of latch creation sites that the test remembers */
+#define MAX_LATCH_SITES	1024
+
+/** Latch counters by creation site, reported by ib_status_latch_iterate() */
+typedef struct {
+	ib_ulint_t	n_sites;	/*!< Number of sites with
+					n_latches > 0 */
+	ib_ulint_t	n_recorded;	/*!< Number of sites in site[] */
+	ib_latch_stats_t
+			site[MAX_LATCH_SITES];
+					/*!< Counters of the sites that
+					acquired latches */
+	const ib_latch_stats_t*
+			old_sites;	/*!< in: sites recorded before
+					the reset, or NULL */
+	ib_ulint_t	n_old_sites;	/*!< in: number of old_sites */
+	ib_ulint_t	n_lower;	/*!< Number of old_sites that now
+					report fewer acquisitions */
+} latch_sites_t;
+
+/*********************************************************************
+Remember the counters of the latches created at one source line, and
+compare them with the counters recorded before the reset.
+@return	0 */
+static
+int
+visit_latch(
+/*========*/
+	void*			arg,	/*!< in/out: latch_sites_t */
+	const ib_latch_stats_t*	stats)	/*!< in: latch counters */
+{
+	ib_ulint_t	i;
+	latch_sites_t*	sites = (latch_sites_t*) arg;
+
+	assert(stats->file != NULL);
+
+	if (stats->n_latches > 0) {
+		++sites->n_sites;
+	}
+
+	if (stats->n_acquired > 0 && sites->n_recorded < MAX_LATCH_SITES) {
+		sites->site[sites->n_recorded++] = *stats;
+	}
+
+	for (i = 0; i < sites->n_old_sites; ++i) {
+		const ib_latch_stats_t*	old = &sites->old_sites[i];
+
+		if (old->line == stats->line
+		    && strcmp(old->file, stats->file) == 0
+		    && stats->n_acquired < old->n_acquired) {
+
+			++sites->n_lower;
+			break;
+		}
+	}
+
+	return(0);
+}
+
+/*********************************************************************
+Read the latch contention by creation site, then reset the counters. */
+static
+void
+get_latch_stats(void)
+/*=================*/
+{
+	ib_err_t		err;
+	static latch_sites_t	before;
+	static latch_sites_t	after;
+
+	memset(&before, 0x0, sizeof(before));
+
+	err = ib_status_latch_iterate(visit_latch, &before);
+	assert(err == DB_SUCCESS);
+
+	/* Starting up creates and acquires many latches. */
+	assert(before.n_recorded > 0);
+	assert(before.n_sites > 0);
+
+	ib_status_latch_reset();
+
+	memset(&after, 0x0, sizeof(after));
+	after.old_sites = before.site;
+	after.n_old_sites = before.n_recorded;
+
+	err = ib_status_latch_iterate(visit_latch, &after);
+	assert(err == DB_SUCCESS);
+
+	printf("latch sites: %lu, counted fewer after reset: %lu\n",
+	       (unsigned long) before.n_recorded,
+	       (unsigned long) after.n_lower);
+
+	/* The background threads may acquire some latches after the
+	reset, but not as often as they were acquired during startup. */
+	assert(after.n_lower > 0);
+	assert(after.n_sites > 0);
+}
+
 int
 main(int argc, char** argv)
 {
@@ -112,6 +250,8 @@ main(int argc, char** argv)
 
 	get_all();
 
+	get_latch_stats();
+
 	err = ib_shutdown(IB_SHUTDOWN_NORMAL);
 	assert(err == DB_SUCCESS);
 
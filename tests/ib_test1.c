@@ -423,6 +423,59 @@ do_query(
 	return(err);
 }
 
+/*********************************************************************
+Read the table in a read-only transaction and check that it cannot
+lock or modify the table. */
+static
+ib_err_t
+read_only_query(
+/*============*/
+	const char*	dbname,		/*!< in: database name */
+	const char*	name)		/*!< in: table name */
+{
+	ib_err_t	err;
+	ib_crsr_t	crsr;
+	ib_trx_t	ib_trx;
+	ib_tpl_t	tpl;
+
+	ib_trx = ib_trx_begin_read_only(IB_TRX_REPEATABLE_READ);
+	assert(ib_trx != NULL);
+
+	err = open_table(dbname, name, ib_trx, &crsr);
+	assert(err == DB_SUCCESS);
+
+	err = do_query(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_lock(crsr, IB_LOCK_IX);
+	assert(err == DB_READONLY);
+
+	tpl = ib_clust_read_tuple_create(crsr);
+	assert(tpl != NULL);
+
+	err = ib_col_set_value(tpl, 0, "z", 1);
+	assert(err == DB_SUCCESS);
+
+	err = ib_col_set_value(tpl, 1, "z", 1);
+	assert(err == DB_SUCCESS);
+
+	err = ib_col_set_value(tpl, 2, &in_rows[0].c3, sizeof(in_rows[0].c3));
+	assert(err == DB_SUCCESS);
+
+	err = ib_cursor_insert_row(crsr, tpl);
+	assert(err == DB_READONLY);
+
+	ib_tuple_delete(tpl);
+
+	err = ib_cursor_close(crsr);
+	assert(err == DB_SUCCESS);
+
+	err = ib_trx_commit(ib_trx);
+	assert(err == DB_SUCCESS);
+
+	return(err);
+}
+
 int main(int argc, char* argv[])
 {
 	ib_err_t	err;
@@ -496,6 +549,10 @@ int main(int argc, char* argv[])
 	err = ib_trx_commit(ib_trx);
 	assert(err == DB_SUCCESS);
 
+	printf("Query table in a read-only transaction\n");
+	err = read_only_query(DATABASE, TABLE);
+	assert(err == DB_SUCCESS);
+
 	printf("Drop table\n");
 	err = drop_table(DATABASE, TABLE);
 	assert(err == DB_SUCCESS);
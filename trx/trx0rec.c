@@ -1188,6 +1188,9 @@ trx_undo_report_row_operation(
 	trx = thr_get_trx(thr);
 	rseg = trx->rseg;
 
+	/* A read-only transaction has no rollback segment */
+	ut_ad(!trx->read_only);
+
 	mutex_enter(&(trx->undo_mutex));
 
 	/* If the undo log is not assigned yet, assign one */
@@ -251,6 +251,48 @@ trx_rseg_mem_create(
 	return(rseg);
 }
 
+/*********************************************************************//**
+Creates a rollback segment in the system tablespace, in the first free
+slot of the trx system header, together with its memory object.
+@return	rollback segment, or NULL if there is no free slot or no
+space left */
+UNIV_INTERN
+trx_rseg_t*
+trx_rseg_create(void)
+/*=================*/
+{
+	ulint		page_no;
+	ulint		slot_no;
+	trx_rseg_t*	rseg	= NULL;
+	mtr_t		mtr;
+
+	mtr_start(&mtr);
+
+	/* Note that below we first reserve the file space x-latch, and
+	then enter the kernel: we must do it in this order to conform
+	to the latching order rules. */
+
+	mtr_x_lock(fil_space_get_latch(TRX_SYS_SPACE, NULL), &mtr);
+	mutex_enter(&kernel_mutex);
+
+	page_no = trx_rseg_header_create(TRX_SYS_SPACE, 0, ULINT_MAX,
+					 &slot_no, &mtr);
+
+	if (page_no != FIL_NULL) {
+		/* The new segment has no undo logs: there is nothing
+		to recover. */
+
+		rseg = trx_rseg_mem_create(IB_RECOVERY_DEFAULT, slot_no,
+					   TRX_SYS_SPACE, 0, page_no, &mtr);
+	}
+
+	mutex_exit(&kernel_mutex);
+
+	mtr_commit(&mtr);
+
+	return(rseg);
+}
+
 /*********************************************************************//**
 Creates the memory copies for rollback segments and initializes the
 rseg list and array in trx_sys at a database startup. */
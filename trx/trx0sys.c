@@ -684,7 +684,7 @@ trx_sysf_rseg_find_free(
 
 	sys_header = trx_sysf_get(mtr);
 
-	for (i = 0; i < TRX_SYS_N_RSEGS; i++) {
+	for (i = 0; i < TRX_SYS_MAX_RSEGS; i++) {
 
 		page_no = trx_sysf_rseg_get_page_no(sys_header, i, mtr);
 
@@ -818,6 +818,7 @@ trx_sys_init_at_db_start(
 		2 * TRX_SYS_TRX_ID_WRITE_MARGIN);
 
 	UT_LIST_INIT(trx_sys->client_trx_list);
+	UT_LIST_INIT(trx_sys->trx_pool);
 	trx_dummy_sess = sess_open();
 	trx_lists_init_at_db_start(recovery);
 
@@ -883,6 +884,44 @@ trx_sys_create(
 	trx_sys_init_at_db_start(recovery);
 }
 
+/*****************************************************************//**
+Creates the rollback segments that do not exist yet, up to n_rsegs in
+total. This is called at every startup, so that data files created with
+fewer rollback segments get the missing ones.
+@return	number of rollback segments that exist */
+UNIV_INTERN
+ulint
+trx_sys_create_rsegs(
+/*=================*/
+	ulint	n_rsegs)	/*!< in: number of rollback segments wanted */
+{
+	ulint	n_used;
+
+	ut_a(n_rsegs > 0);
+	ut_a(n_rsegs <= TRX_SYS_MAX_RSEGS);
+
+	mutex_enter(&kernel_mutex);
+	n_used = UT_LIST_GET_LEN(trx_sys->rseg_list);
+	mutex_exit(&kernel_mutex);
+
+	while (n_used < n_rsegs) {
+
+		if (trx_rseg_create() == NULL) {
+			ut_print_timestamp(ib_stream);
+			ib_logger(ib_stream,
+				  "  InnoDB: Warning: could only create"
+				  " %lu of the %lu rollback segments"
+				  " requested\n",
+				  (ulong) n_used, (ulong) n_rsegs);
+			break;
+		}
+
+		++n_used;
+	}
+
+	return(n_used);
+}
+
 /*****************************************************************//**
 Update the file format tag.
 @return	always TRUE */
@@ -1422,6 +1461,8 @@ trx_sys_close(void)
 		UT_LIST_REMOVE(view_list, trx_sys->view_list, prev_view);
 	}
 
+	trx_pool_close();
+
 	ut_a(UT_LIST_GET_LEN(trx_sys->trx_list) == 0);
 	ut_a(UT_LIST_GET_LEN(trx_sys->rseg_list) == 0);
 	ut_a(UT_LIST_GET_LEN(trx_sys->view_list) == 0);
@@ -53,6 +53,9 @@ UNIV_INTERN sess_t*		trx_dummy_sess = NULL;
 the kernel mutex */
 UNIV_INTERN ulint		trx_n_transactions = 0;
 
+/* Maximum number of transaction objects kept in trx_sys->trx_pool */
+#define TRX_POOL_MAX_SIZE	1024
+
 /* Threads with unknown id. */
 UNIV_INTERN os_thread_id_t	NULL_THREAD_ID;
 
@@ -92,26 +95,22 @@ trx_set_detailed_error(
 }
 
 /****************************************************************//**
-Creates and initializes a transaction object.
-@return	own: the transaction */
-UNIV_INTERN
-trx_t*
-trx_create(
-/*=======*/
+Initializes the fields of a transaction object. This is used both for a
+freshly allocated object and for one taken from the trx pool. The mutex
+and the memory heaps of the object must already have been created. */
+UNIV_STATIC
+void
+trx_init(
+/*=====*/
+	trx_t*	trx,	/*!< out: transaction */
 	sess_t*	sess)	/*!< in: session */
 {
-	trx_t*	trx;
-
-	ut_ad(mutex_own(&kernel_mutex));
-	ut_ad(sess);
-
-	trx = mem_alloc(sizeof(trx_t));
-
 	trx->magic_n = TRX_MAGIC_N;
 
 	trx->op_info = "";
 
 	trx->is_purge = 0;
+	trx->read_only = FALSE;
 	trx->is_recovered = 0;
 	trx->conc_state = TRX_NOT_STARTED;
 	trx->start_time = time(NULL);
@@ -140,8 +139,6 @@ trx_create(
 	trx->n_client_tables_in_use = 0;
 	trx->client_n_tables_locked = 0;
 
-	mutex_create(&trx->undo_mutex, SYNC_TRX_UNDO);
-
 	trx->rseg = NULL;
 
 	trx->undo_no = ut_dulint_zero;
@@ -169,16 +166,15 @@ trx_create(
 	trx->was_chosen_as_deadlock_victim = FALSE;
 	UT_LIST_INIT(trx->wait_thrs);
 
-	trx->lock_heap = mem_heap_create_in_buffer(256);
 	UT_LIST_INIT(trx->trx_locks);
 
 	UT_LIST_INIT(trx->trx_savepoints);
 
 	trx->dict_operation_lock_mode = 0;
 	trx->has_search_latch = FALSE;
+	trx->deadlock_mark = 0;
 	trx->search_latch_timeout = BTR_SEA_TIMEOUT;
 
-	trx->global_read_view_heap = mem_heap_create(256);
 	trx->global_read_view = NULL;
 	trx->read_view = NULL;
 
@@ -187,6 +183,31 @@ trx_create(
 	memset(&trx->xid, 0, sizeof(trx->xid));
 	trx->xid.formatID = -1;
 #endif /* WITH_XOPEN */
+}
+
+/****************************************************************//**
+Creates and initializes a transaction object.
+@return	own: the transaction */
+UNIV_INTERN
+trx_t*
+trx_create(
+/*=======*/
+	sess_t*	sess)	/*!< in: session */
+{
+	trx_t*	trx;
+
+	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(sess);
+
+	trx = mem_alloc(sizeof(trx_t));
+
+	mutex_create(&trx->undo_mutex, SYNC_TRX_UNDO);
+
+	trx->lock_heap = mem_heap_create_in_buffer(256);
+
+	trx->global_read_view_heap = mem_heap_create(256);
+
+	trx_init(trx, sess);
 
 	return(trx);
 }
@@ -204,7 +225,18 @@ trx_allocate_for_client(
 
 	mutex_enter(&kernel_mutex);
 
-	trx = trx_create(trx_dummy_sess);
+	trx = UT_LIST_GET_FIRST(trx_sys->trx_pool);
+
+	if (trx != NULL) {
+		/* Reuse a transaction object released by the client,
+		together with its mutex and memory heaps. */
+
+		UT_LIST_REMOVE(client_trx_list, trx_sys->trx_pool, trx);
+
+		trx_init(trx, trx_dummy_sess);
+	} else {
+		trx = trx_create(trx_dummy_sess);
+	}
 
 	trx_n_transactions++;
 
@@ -329,7 +361,73 @@ trx_free(
 }
 
 /********************************************************************//**
-Frees a transaction object for client. */
+Checks that a transaction object can be recycled, resets its memory heaps
+and puts it to the trx pool. */
+UNIV_STATIC
+void
+trx_release_to_pool(
+/*================*/
+	trx_t*	trx)	/*!< in, own: trx object */
+{
+	ut_ad(mutex_own(&kernel_mutex));
+
+	ut_a(trx->magic_n == TRX_MAGIC_N);
+	ut_a(trx->conc_state == TRX_NOT_STARTED);
+
+	ut_a(trx->insert_undo == NULL);
+	ut_a(trx->update_undo == NULL);
+
+	if (trx->undo_no_arr) {
+		trx_undo_arr_free(trx->undo_no_arr);
+		trx->undo_no_arr = NULL;
+	}
+
+	ut_a(UT_LIST_GET_LEN(trx->signals) == 0);
+	ut_a(UT_LIST_GET_LEN(trx->reply_signals) == 0);
+
+	ut_a(trx->wait_lock == NULL);
+	ut_a(UT_LIST_GET_LEN(trx->wait_thrs) == 0);
+
+	ut_a(!trx->has_search_latch);
+
+	ut_a(trx->dict_operation_lock_mode == 0);
+
+	ut_a(UT_LIST_GET_LEN(trx->trx_locks) == 0);
+
+	ut_a(trx->read_view == NULL);
+
+	/* Keep the first block of each heap so that the next user of
+	this object does not have to allocate it again. */
+	mem_heap_empty(trx->lock_heap);
+	mem_heap_empty(trx->global_read_view_heap);
+
+	trx->global_read_view = NULL;
+
+	UT_LIST_ADD_FIRST(client_trx_list, trx_sys->trx_pool, trx);
+}
+
+/********************************************************************//**
+Frees the transaction objects in the trx pool at shutdown. */
+UNIV_INTERN
+void
+trx_pool_close(void)
+/*================*/
+{
+	trx_t*	trx;
+
+	ut_ad(mutex_own(&kernel_mutex));
+
+	while ((trx = UT_LIST_GET_FIRST(trx_sys->trx_pool)) != NULL) {
+
+		UT_LIST_REMOVE(client_trx_list, trx_sys->trx_pool, trx);
+
+		trx_free(trx);
+	}
+}
+
+/********************************************************************//**
+Frees a transaction object for client. The object is kept in the trx pool
+for reuse by trx_allocate_for_client() if the pool is not full. */
 UNIV_INTERN
 void
 trx_free_for_client(
@@ -340,7 +438,14 @@ trx_free_for_client(
 
 	UT_LIST_REMOVE(client_trx_list, trx_sys->client_trx_list, trx);
 
-	trx_free(trx);
+	if (UT_LIST_GET_LEN(trx_sys->trx_pool) < TRX_POOL_MAX_SIZE
+	    && trx->n_client_tables_in_use == 0
+	    && trx->client_n_tables_locked == 0) {
+
+		trx_release_to_pool(trx);
+	} else {
+		trx_free(trx);
+	}
 
 	ut_a(trx_n_transactions > 0);
 
@@ -601,7 +706,8 @@ trx_lists_init_at_db_start(
 
 /******************************************************************//**
 Assigns a rollback segment to a transaction in a round-robin fashion.
-Skips the SYSTEM rollback segment if another is available.
+Only the first srv_rollback_segments segments are used. Skips the SYSTEM
+rollback segment if another is available.
 @return	assigned rollback segment id */
 UNIV_INLINE
 ulint
@@ -620,11 +726,16 @@ loop:
 		rseg = UT_LIST_GET_FIRST(trx_sys->rseg_list);
 	}
 
-	/* If it is the SYSTEM rollback segment, and there exist others, skip
-	it */
+	if (rseg->id >= srv_rollback_segments) {
+		goto loop;
+	}
+
+	/* If it is the SYSTEM rollback segment, and there exist others
+	that may be used, skip it */
 
-	if ((rseg->id == TRX_SYS_SYSTEM_RSEG_ID)
-	    && (UT_LIST_GET_LEN(trx_sys->rseg_list) > 1)) {
+	if (rseg->id == TRX_SYS_SYSTEM_RSEG_ID
+	    && srv_rollback_segments > 1
+	    && trx_sys_get_nth_rseg(trx_sys, TRX_SYS_SYSTEM_RSEG_ID + 1)) {
 		goto loop;
 	}
 
@@ -661,6 +772,20 @@ trx_start_low(
 
 	ut_ad(trx->conc_state != TRX_ACTIVE);
 
+	if (trx->read_only) {
+		/* A read-only transaction only needs a read view: it is
+		not given an id or a rollback segment, and it is not put
+		to trx_sys->trx_list, which keeps it out of the read views
+		of the other transactions. */
+
+		trx->id = ut_dulint_zero;
+		trx->no = ut_dulint_max;
+		trx->conc_state = TRX_ACTIVE;
+		trx->start_time = time(NULL);
+
+		return(TRUE);
+	}
+
 	if (rseg_id == ULINT_UNDEFINED) {
 
 		rseg_id = trx_assign_rseg();
@@ -940,7 +1065,9 @@ trx_commit_off_kernel(
 	ut_ad(UT_LIST_GET_LEN(trx->wait_thrs) == 0);
 	ut_ad(UT_LIST_GET_LEN(trx->trx_locks) == 0);
 
-	UT_LIST_REMOVE(trx_list, trx_sys->trx_list, trx);
+	if (!trx->read_only) {
+		UT_LIST_REMOVE(trx_list, trx_sys->trx_list, trx);
+	}
 }
 
 /****************************************************************//**
@@ -43,11 +43,15 @@ typedef struct ut_mem_block_struct ut_mem_block_t;
 
 /** The total amount of memory currently allocated from the operating
 system with os_mem_alloc_large() or malloc().  Does not count malloc()
-if srv_use_sys_malloc is set.  Protected by ut_list_mutex. */
+if srv_use_sys_malloc is set.  Updated with ut_total_allocated_memory_add()
+and ut_total_allocated_memory_sub(). */
 UNIV_INTERN ulint		ut_total_allocated_memory	= 0;
 
-/** Mutex protecting ut_total_allocated_memory and ut_mem_block_list */
-UNIV_INTERN os_fast_mutex_t	ut_list_mutex;
+#ifndef HAVE_ATOMIC_BUILTINS
+/** Mutex protecting ut_total_allocated_memory on platforms without
+atomic builtins */
+UNIV_STATIC os_fast_mutex_t	ut_total_mutex;
+#endif /* !HAVE_ATOMIC_BUILTINS */
 
 /** Dynamically allocated memory block */
 struct ut_mem_block_struct{
@@ -61,13 +65,36 @@ struct ut_mem_block_struct{
 memory corruption. */
 #define UT_MEM_MAGIC_N	1601650166
 
+/** Number of shards of the list of memory blocks.  A block is linked
+to the shard selected by its address, so that threads allocating and
+freeing memory concurrently seldom contend for the same mutex. */
+#define UT_MEM_N_SHARDS	32
+
+/** A shard of the list of memory blocks allocated with malloc */
+typedef struct ut_mem_shard_struct	ut_mem_shard_t;
+
+/** A shard of the list of memory blocks allocated with malloc */
+struct ut_mem_shard_struct{
+	os_fast_mutex_t	mutex;	/*!< mutex protecting list */
+	UT_LIST_BASE_NODE_T(ut_mem_block_t) list;
+				/*!< memory blocks of this shard */
+};
+
 /** List of all memory blocks allocated from the operating system
-with malloc.  Protected by ut_list_mutex. */
-UNIV_STATIC UT_LIST_BASE_NODE_T(ut_mem_block_t)   ut_mem_block_list;
+with malloc, split into shards.  Each shard is protected by its own
+mutex. */
+UNIV_STATIC ut_mem_shard_t	ut_mem_shards[UT_MEM_N_SHARDS];
 
-/** Flag: has ut_mem_block_list been initialized? */
+/** Flag: has ut_mem_shards been initialized? */
 UNIV_STATIC ibool  ut_mem_block_list_inited = FALSE;
 
+/** Get the shard of the memory block list a block belongs to.
+@param block	in: memory block
+@return	shard */
+#define UT_MEM_SHARD(block)						\
+	(&ut_mem_shards[(((ulint) (block) >> 4)				\
+			 ^ ((ulint) (block) >> 12)) % UT_MEM_N_SHARDS])
+
 /** A dummy pointer for generating a null pointer exception in
 ut_malloc_low() */
 UNIV_STATIC ulint*	ut_mem_null_ptr	= NULL;
@@ -81,9 +108,11 @@ ut_mem_var_init(void)
 {
 	ut_total_allocated_memory = 0;
 
-	memset(&ut_mem_block_list, 0x0, sizeof(ut_mem_block_list));
+	memset(ut_mem_shards, 0x0, sizeof(ut_mem_shards));
 
-	memset(&ut_list_mutex, 0x0, sizeof(ut_list_mutex));
+#ifndef HAVE_ATOMIC_BUILTINS
+	memset(&ut_total_mutex, 0x0, sizeof(ut_total_mutex));
+#endif /* !HAVE_ATOMIC_BUILTINS */
 
 	ut_mem_block_list_inited = FALSE;
 
@@ -100,11 +129,60 @@ ut_mem_init(void)
 	ut_a(!srv_was_started);
 
 	if (!ut_mem_block_list_inited) {
-		os_fast_mutex_init(&ut_list_mutex);
-		UT_LIST_INIT(ut_mem_block_list);
+		ulint	i;
+
+		for (i = 0; i < UT_MEM_N_SHARDS; i++) {
+			os_fast_mutex_init(&ut_mem_shards[i].mutex);
+			UT_LIST_INIT(ut_mem_shards[i].list);
+		}
+
+#ifndef HAVE_ATOMIC_BUILTINS
+		os_fast_mutex_init(&ut_total_mutex);
+#endif /* !HAVE_ATOMIC_BUILTINS */
+
 		ut_mem_block_list_inited = TRUE;
 	}
 }
+
+/**********************************************************************//**
+Adds to the count of memory allocated from the operating system. */
+UNIV_INTERN
+void
+ut_total_allocated_memory_add(
+/*==========================*/
+	ulint	n)	/*!< in: number of bytes allocated */
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	os_atomic_increment_ulint(&ut_total_allocated_memory, n);
+#else /* HAVE_ATOMIC_BUILTINS */
+	os_fast_mutex_lock(&ut_total_mutex);
+	ut_total_allocated_memory += n;
+	os_fast_mutex_unlock(&ut_total_mutex);
+#endif /* HAVE_ATOMIC_BUILTINS */
+}
+
+/**********************************************************************//**
+Subtracts from the count of memory allocated from the operating system. */
+UNIV_INTERN
+void
+ut_total_allocated_memory_sub(
+/*==========================*/
+	ulint	n)	/*!< in: number of bytes freed */
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	ulint	total;
+
+	total = os_atomic_increment_ulint(&ut_total_allocated_memory, 0 - n);
+
+	/* The count before the subtraction must have been at least n. */
+	ut_a(total + n >= n);
+#else /* HAVE_ATOMIC_BUILTINS */
+	os_fast_mutex_lock(&ut_total_mutex);
+	ut_a(ut_total_allocated_memory >= n);
+	ut_total_allocated_memory -= n;
+	os_fast_mutex_unlock(&ut_total_mutex);
+#endif /* HAVE_ATOMIC_BUILTINS */
+}
 #endif /* !UNIV_HOTBACKUP */
 
 /**********************************************************************//**
@@ -123,8 +201,9 @@ ut_malloc_low(
 				memory cannot be allocated */
 {
 #ifndef UNIV_HOTBACKUP
-	ulint	retry_count;
-	void*	ret;
+	ulint		retry_count;
+	void*		ret;
+	ut_mem_shard_t*	shard;
 
 	if (UNIV_LIKELY(srv_use_sys_malloc)) {
 		ret = malloc(n);
@@ -144,8 +223,6 @@ ut_malloc_low(
 
 	retry_count = 0;
 retry:
-	os_fast_mutex_lock(&ut_list_mutex);
-
 	ret = malloc(n + sizeof(ut_mem_block_t));
 
 	if (ret == NULL && retry_count < 60) {
@@ -180,8 +257,6 @@ retry:
 				);
 		}
 
-		os_fast_mutex_unlock(&ut_list_mutex);
-
 		/* Sleep for a second and retry the allocation; maybe this is
 		just a temporary shortage of memory */
 
@@ -193,8 +268,6 @@ retry:
 	}
 
 	if (ret == NULL) {
-		os_fast_mutex_unlock(&ut_list_mutex);
-
 		/* Make an intentional seg fault so that we get a stack
 		trace */
 		/* Intentional segfault on NetWare causes an abend. Avoid this
@@ -230,11 +303,14 @@ retry:
 	((ut_mem_block_t*)ret)->size = n + sizeof(ut_mem_block_t);
 	((ut_mem_block_t*)ret)->magic_n = UT_MEM_MAGIC_N;
 
-	ut_total_allocated_memory += n + sizeof(ut_mem_block_t);
+	ut_total_allocated_memory_add(n + sizeof(ut_mem_block_t));
+
+	shard = UT_MEM_SHARD(ret);
 
-	UT_LIST_ADD_FIRST(mem_block_list, ut_mem_block_list,
+	os_fast_mutex_lock(&shard->mutex);
+	UT_LIST_ADD_FIRST(mem_block_list, shard->list,
 			  ((ut_mem_block_t*)ret));
-	os_fast_mutex_unlock(&ut_list_mutex);
+	os_fast_mutex_unlock(&shard->mutex);
 
 	return((void*)((byte*)ret + sizeof(ut_mem_block_t)));
 #else /* !UNIV_HOTBACKUP */
@@ -319,6 +395,7 @@ ut_free(
 {
 #ifndef UNIV_HOTBACKUP
 	ut_mem_block_t* block;
+	ut_mem_shard_t*	shard;
 
 	if (!ptr) {
 		return;
@@ -329,17 +406,17 @@ ut_free(
 
 	block = (ut_mem_block_t*)((byte*)ptr - sizeof(ut_mem_block_t));
 
-	os_fast_mutex_lock(&ut_list_mutex);
-
 	ut_a(block->magic_n == UT_MEM_MAGIC_N);
-	ut_a(ut_total_allocated_memory >= block->size);
 
-	ut_total_allocated_memory -= block->size;
+	ut_total_allocated_memory_sub(block->size);
 
-	UT_LIST_REMOVE(mem_block_list, ut_mem_block_list, block);
-	free(block);
+	shard = UT_MEM_SHARD(block);
 
-	os_fast_mutex_unlock(&ut_list_mutex);
+	os_fast_mutex_lock(&shard->mutex);
+	UT_LIST_REMOVE(mem_block_list, shard->list, block);
+	os_fast_mutex_unlock(&shard->mutex);
+
+	free(block);
 #else /* !UNIV_HOTBACKUP */
 	free(ptr);
 #endif /* !UNIV_HOTBACKUP */
@@ -432,24 +509,29 @@ void
 ut_free_all_mem(void)
 /*=================*/
 {
-	ut_mem_block_t* block;
+	ulint	i;
 
 	/* If the sub-system hasn't been initialized, then ignore request. */
 	if (!ut_mem_block_list_inited) {
 		return;
 	}
 
-	os_fast_mutex_free(&ut_list_mutex);
+	for (i = 0; i < UT_MEM_N_SHARDS; i++) {
+		ut_mem_shard_t*	shard = &ut_mem_shards[i];
+		ut_mem_block_t*	block;
+
+		os_fast_mutex_free(&shard->mutex);
 
-	while ((block = UT_LIST_GET_FIRST(ut_mem_block_list))) {
+		while ((block = UT_LIST_GET_FIRST(shard->list))) {
 
-		ut_a(block->magic_n == UT_MEM_MAGIC_N);
-		ut_a(ut_total_allocated_memory >= block->size);
+			ut_a(block->magic_n == UT_MEM_MAGIC_N);
+			ut_a(ut_total_allocated_memory >= block->size);
 
-		ut_total_allocated_memory -= block->size;
+			ut_total_allocated_memory -= block->size;
 
-		UT_LIST_REMOVE(mem_block_list, ut_mem_block_list, block);
-		free(block);
+			UT_LIST_REMOVE(mem_block_list, shard->list, block);
+			free(block);
+		}
 	}
 
 	if (ut_total_allocated_memory != 0) {
@@ -459,6 +541,10 @@ ut_free_all_mem(void)
 			(ulong) ut_total_allocated_memory);
 	}
 
+#ifndef HAVE_ATOMIC_BUILTINS
+	os_fast_mutex_free(&ut_total_mutex);
+#endif /* !HAVE_ATOMIC_BUILTINS */
+
 	ut_mem_block_list_inited = FALSE;
 }
 #endif /* !UNIV_HOTBACKUP */